@@ -390,6 +390,10 @@ bool rotation_equal(enum Rotation r1, enum Rotation r2)
     if (r1 == r2) {
         return true;
     }
+    if (r1 < ROTATION_MAX && r2 < ROTATION_MAX) {
+        return rotation_canonical(r1) == rotation_canonical(r2);
+    }
+    // custom rotations can only be compared numerically
     Vector3f v(1,2,3);
     Vector3f v1 = v;
     Vector3f v2 = v;
@@ -435,58 +439,109 @@ float calc_lowpass_alpha_dt(float dt, float cutoff_freq)
     return dt / (dt + rc);
 }
 
-#ifndef AP_MATH_FILL_NANF_USE_MEMCPY
-#define AP_MATH_FILL_NANF_USE_MEMCPY (CONFIG_HAL_BOARD == HAL_BOARD_SITL)
-#endif
+/*
+  calculate sin and cos together. The angle is reduced to +-PI/4 and a
+  quadrant using a three part PI/2 (Cody-Waite) then the cephes sinf
+  and cosf minimax polynomials are evaluated
+ */
+void fast_sincosf(float rad, float &s, float &c)
+{
+    // round to nearest with a truncating conversion, avoiding a roundf() call
+    const float qf = rad * float(2.0 / M_PI);
+    const int32_t quadrant = int32_t(qf + (qf >= 0 ? 0.5f : -0.5f));
+    const float q = float(quadrant);
+    // PI/2 split into three parts with short mantissas so the products are exact
+    const float x = ((rad - q * 1.5703125f) - q * 4.837512969970703125e-4f) - q * 7.54978995489188216e-8f;
+    const float x2 = x * x;
+    const float sp = x + x * x2 * (-1.6666654611e-1f + x2 * (8.3321608736e-3f + x2 * -1.9515295891e-4f));
+    const float cp = 1.0f - 0.5f * x2 + x2 * x2 * (4.166664568298827e-2f + x2 * (-1.388731625493765e-3f + x2 * 2.443315711809948e-5f));
+    // select the quadrant without branches, as random angles mispredict
+    const bool swap = quadrant & 1;
+    const float ss = swap ? cp : sp;
+    const float cc = swap ? sp : cp;
+    s = (quadrant & 2) ? -ss : ss;
+    c = ((quadrant + 1) & 2) ? -cc : cc;
+}
 
-#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
-// fill an array of float with NaN, used to invalidate memory in SITL
-void fill_nanf(float *f, uint16_t count)
-{
-#if AP_MATH_FILL_NANF_USE_MEMCPY
-    static bool created;
-    static float many_nanfs[2048];
-    if (!created) {
-        for (uint16_t i=0; i<ARRAY_SIZE(many_nanfs); i++) {
-            created = true;
-            many_nanfs[i] = std::numeric_limits<float>::signaling_NaN();
-        }
-    }
-    if (count > ARRAY_SIZE(many_nanfs)) {
-        /* standalone build: no HAL panic */ return;
+/*
+  fill an array with a value. The first few elements are written
+  directly, then the filled prefix is copied onto the rest of the
+  array with memcpy, doubling in size each time
+ */
+template <typename T>
+static void fill_value(T *v, size_t count, const T value)
+{
+    size_t filled = MIN(count, size_t(16));
+    for (size_t i = 0; i < filled; i++) {
+        v[i] = value;
     }
-    memcpy(f, many_nanfs, count*sizeof(many_nanfs[0]));
-#else
-    const float n = std::numeric_limits<float>::signaling_NaN();
-    while (count--) {
-        *f++ = n;
+    while (filled < count) {
+        const size_t chunk = MIN(filled, count - filled);
+        memcpy(&v[filled], v, chunk * sizeof(T));
+        filled += chunk;
     }
-#endif
 }
 
-void fill_nanf(double *f, uint16_t count)
+// fill an array of float with NaN, used to invalidate memory in SITL
+void fill_nanf(float *f, size_t count)
 {
-#if AP_MATH_FILL_NANF_USE_MEMCPY
-    static bool created;
-    static double many_nanfs[2048];
-    if (!created) {
-        for (uint16_t i=0; i<ARRAY_SIZE(many_nanfs); i++) {
-            created = true;
-            many_nanfs[i] = std::numeric_limits<double>::signaling_NaN();
+    fill_value(f, count, std::numeric_limits<float>::signaling_NaN());
+}
+
+void fill_nanf(double *f, size_t count)
+{
+    fill_value(f, count, std::numeric_limits<double>::signaling_NaN());
+}
+
+/*
+  find the first NaN in an array. The test is done on the bit pattern
+  so that reading a signalling NaN can't raise a floating point
+  exception. The array is scanned in blocks with no early exit inside
+  a block so the inner loop can be vectorised
+ */
+template <typename T, typename U>
+static size_t find_nan_bits(const T *v, size_t count)
+{
+    static_assert(sizeof(T) == sizeof(U), "mismatched sizes");
+    // all exponent bits set and a non-zero mantissa
+    const U abs_mask = std::numeric_limits<U>::max() >> 1;
+    U inf_bits;
+    const T inf = std::numeric_limits<T>::infinity();
+    memcpy(&inf_bits, &inf, sizeof(inf_bits));
+
+    const size_t block = 64;
+    size_t i = 0;
+    while (i + block <= count) {
+        U any = 0;
+        for (size_t j = 0; j < block; j++) {
+            U bits;
+            memcpy(&bits, &v[i+j], sizeof(bits));
+            any |= U((bits & abs_mask) > inf_bits);
         }
+        if (any) {
+            break;
+        }
+        i += block;
     }
-    if (count > ARRAY_SIZE(many_nanfs)) {
-        /* standalone build: no HAL panic */ return;
-    }
-    memcpy(f, many_nanfs, count*sizeof(many_nanfs[0]));
-#else
-    while (count--) {
-        *f++ = std::numeric_limits<double>::signaling_NaN();
+    for (; i < count; i++) {
+        U bits;
+        memcpy(&bits, &v[i], sizeof(bits));
+        if ((bits & abs_mask) > inf_bits) {
+            return i;
+        }
     }
-#endif
+    return count;
 }
 
-#endif // CONFIG_HAL_BOARD == HAL_BOARD_SITL
+size_t find_nanf(const float *f, size_t count)
+{
+    return find_nan_bits<float, uint32_t>(f, count);
+}
+
+size_t find_nanf(const double *f, size_t count)
+{
+    return find_nan_bits<double, uint64_t>(f, count);
+}
 
 // Convert 16-bit fixed-point to float
 float fixed2float(const uint16_t input, const uint8_t fractional_bits)
@@ -597,3 +652,157 @@ int32_t get_twos_complement(uint32_t raw, uint8_t length)
     }
     return raw;
 }
+
+/*
+  branch free equivalent of constrain_float() for the array conversion
+  functions, so the loops can be vectorised. NaN gives the midpoint
+  like constrain_float(), but without reporting an internal error
+ */
+static inline float constrain_float_nb(const float amt, const float low, const float high)
+{
+    const float c = amt < low ? low : (amt > high ? high : amt);
+    return isnan(amt) ? (low + high) / 2 : c;
+}
+
+void fixed2float(const uint16_t *input, float *output, uint32_t count, const uint8_t fractional_bits)
+{
+    // multiplying by the reciprocal of a power of two is exact
+    const float scale = 1.0f / (float)(1U << fractional_bits);
+    for (uint32_t i = 0; i < count; i++) {
+        output[i] = (float)input[i] * scale;
+    }
+}
+
+void float2fixed(const float *input, uint16_t *output, uint32_t count, const uint8_t fractional_bits)
+{
+    const float scale = (float)(1U << fractional_bits);
+    for (uint32_t i = 0; i < count; i++) {
+        output[i] = (uint16_t)(roundf(input[i] * scale));
+    }
+}
+
+void float_to_int16(const float *v, int16_t *output, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        output[i] = int16_t(constrain_float_nb(v[i], INT16_MIN, INT16_MAX));
+    }
+}
+
+void float_to_uint16(const float *v, uint16_t *output, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        output[i] = uint16_t(constrain_float_nb(v[i], 0, UINT16_MAX));
+    }
+}
+
+void float_to_int32(const float *v, int32_t *output, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        output[i] = int32_t(constrain_float_nb(v[i], INT32_MIN, INT32_MAX));
+    }
+}
+
+void float_to_uint32(const float *v, uint32_t *output, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        output[i] = uint32_t(constrain_float_nb(v[i], 0, UINT32_MAX));
+    }
+}
+
+void int32_to_float_le(const uint32_t *value, float *output, uint32_t count)
+{
+    static_assert(sizeof(value[0]) == sizeof(output[0]), "mismatched sizes");
+    memcpy(output, value, count * sizeof(output[0]));
+}
+
+void uint64_to_double_le(const uint64_t *value, double *output, uint32_t count)
+{
+    static_assert(sizeof(value[0]) == sizeof(output[0]), "mismatched sizes");
+    memcpy(output, value, count * sizeof(output[0]));
+}
+
+void get_twos_complement(const uint32_t *raw, int32_t *output, uint32_t count, uint8_t length)
+{
+    if (length == 0 || length >= 32) {
+        for (uint32_t i = 0; i < count; i++) {
+            output[i] = get_twos_complement(raw[i], length);
+        }
+        return;
+    }
+    // shift the sign bit to the top and arithmetic shift back down,
+    // matching get_twos_complement() for values with no bits above length
+    const uint8_t shift = 32 - length;
+    for (uint32_t i = 0; i < count; i++) {
+        output[i] = ((int32_t)(raw[i] << shift)) >> shift;
+    }
+}
+
+/*
+  sign extend the low 'bits' bits of a raw sample
+ */
+static inline int32_t sign_extend(const uint32_t raw, const uint8_t bits)
+{
+    return ((int32_t)(raw << (32 - bits))) >> (32 - bits);
+}
+
+static inline void store_sample(int32_t &output, const int32_t v, const float)
+{
+    output = v;
+}
+
+static inline void store_sample(float &output, const int32_t v, const float scale)
+{
+    output = (float)v * scale;
+}
+
+/*
+  common implementation of the int32_t and float unpack functions. The
+  12 and 20 bit widths are decoded in pairs so each iteration starts on
+  a byte boundary
+ */
+template <typename T>
+static bool unpack_le_samples_T(const uint8_t *buf, uint8_t bits, uint32_t count, float scale, T *output)
+{
+    uint32_t i = 0;
+    switch (bits) {
+    case 12:
+        for (; i + 1 < count; i += 2, buf += 3) {
+            store_sample(output[i], sign_extend(buf[0] | ((buf[1] & 0x0F) << 8), 12), scale);
+            store_sample(output[i+1], sign_extend((buf[1] >> 4) | (buf[2] << 4), 12), scale);
+        }
+        if (i < count) {
+            store_sample(output[i], sign_extend(buf[0] | ((buf[1] & 0x0F) << 8), 12), scale);
+        }
+        return true;
+    case 16:
+        for (; i < count; i++, buf += 2) {
+            store_sample(output[i], (int16_t)(buf[0] | (buf[1] << 8)), scale);
+        }
+        return true;
+    case 20:
+        for (; i + 1 < count; i += 2, buf += 5) {
+            store_sample(output[i], sign_extend(buf[0] | (buf[1] << 8) | ((buf[2] & 0x0F) << 16), 20), scale);
+            store_sample(output[i+1], sign_extend((buf[2] >> 4) | (buf[3] << 4) | (buf[4] << 12), 20), scale);
+        }
+        if (i < count) {
+            store_sample(output[i], sign_extend(buf[0] | (buf[1] << 8) | ((buf[2] & 0x0F) << 16), 20), scale);
+        }
+        return true;
+    case 24:
+        for (; i < count; i++, buf += 3) {
+            store_sample(output[i], sign_extend(buf[0] | (buf[1] << 8) | (buf[2] << 16), 24), scale);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool unpack_le_samples(const uint8_t *buf, uint8_t bits, uint32_t count, int32_t *output)
+{
+    return unpack_le_samples_T(buf, bits, count, 1.0f, output);
+}
+
+bool unpack_le_samples(const uint8_t *buf, uint8_t bits, uint32_t count, float scale, float *output)
+{
+    return unpack_le_samples_T(buf, bits, count, scale, output);
+}
@@ -395,11 +395,22 @@ Vector3F get_vel_correction_for_sensor_offset(const Vector3F &sensor_offset_bf,
  */
 float calc_lowpass_alpha_dt(float dt, float cutoff_freq);
 
-#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+/*
+  calculate sin and cos of an angle in radians together using a
+  polynomial approximation. Error is below 2e-7 for angles within
+  +-10000 radians
+ */
+void fast_sincosf(float rad, float &s, float &c);
+
 // fill an array of float with NaN, used to invalidate memory in SITL
-void fill_nanf(float *f, uint16_t count);
-void fill_nanf(double *f, uint16_t count);
-#endif
+// and debug builds
+void fill_nanf(float *f, size_t count);
+void fill_nanf(double *f, size_t count);
+
+// return the index of the first NaN (signalling or quiet) in an array,
+// or count if there are none. Safe to use with FPE traps enabled
+size_t find_nanf(const float *f, size_t count) WARN_IF_UNUSED;
+size_t find_nanf(const double *f, size_t count) WARN_IF_UNUSED;
 
 // from https://embeddedartistry.com/blog/2018/07/12/simple-fixed-point-conversion-in-c/
 // Convert to/from 16-bit fixed-point and float
@@ -445,3 +456,37 @@ double uint64_to_double_le(const uint64_t& value) WARN_IF_UNUSED;
   With thanks to betaflight
  */
 int32_t get_twos_complement(uint32_t raw, uint8_t length) WARN_IF_UNUSED;
+
+/*
+  array versions of the conversion functions above. They give the same
+  results as calling the scalar version on each element (including the
+  midpoint result for NaN inputs) but are written without branches so
+  the compiler can vectorise them. The input and output arrays must not
+  overlap
+ */
+void fixed2float(const uint16_t *input, float *output, uint32_t count, const uint8_t fractional_bits = 8);
+void float2fixed(const float *input, uint16_t *output, uint32_t count, const uint8_t fractional_bits = 8);
+void float_to_int16(const float *v, int16_t *output, uint32_t count);
+void float_to_uint16(const float *v, uint16_t *output, uint32_t count);
+void float_to_int32(const float *v, int32_t *output, uint32_t count);
+void float_to_uint32(const float *v, uint32_t *output, uint32_t count);
+void int32_to_float_le(const uint32_t *value, float *output, uint32_t count);
+void uint64_to_double_le(const uint64_t *value, double *output, uint32_t count);
+
+/*
+  array version of get_twos_complement(). For lengths from 1 to 31 the
+  bits above 'length' are ignored, so the result only matches the scalar
+  version when they are zero. Other lengths use the scalar version
+ */
+void get_twos_complement(const uint32_t *raw, int32_t *output, uint32_t count, uint8_t length);
+
+/*
+  unpack 'count' little-endian two's-complement samples of 'bits' width
+  from a packed byte stream. Samples are packed LSB first with no
+  padding, so 12 bit samples take 3 bytes per pair and 20 bit samples
+  take 5 bytes per pair. Supported widths are 12, 16, 20 and 24 bits,
+  false is returned for any other width.
+  The float version multiplies each sample by scale
+ */
+bool unpack_le_samples(const uint8_t *buf, uint8_t bits, uint32_t count, int32_t *output) WARN_IF_UNUSED;
+bool unpack_le_samples(const uint8_t *buf, uint8_t bits, uint32_t count, float scale, float *output) WARN_IF_UNUSED;
@@ -21,6 +21,7 @@
 #include <AP_Logger/AP_Logger.h>
 #endif
 #include "SCurve.h"
+#include "instrumentation.h"
 
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
 #include <stdio.h>
@@ -487,6 +488,8 @@ void SCurve::set_destination_speed_max(float speed)
 // returns true if vehicle has passed the apex of the corner
 bool SCurve::advance_target_along_track(SCurve &prev_leg, SCurve &next_leg, float wp_radius, float accel_corner, bool fast_waypoint, float dt, Vector3f &target_pos, Vector3f &target_vel, Vector3f &target_accel)
 {
+    AP_MATH_PROBE("SCurve::advance_target_along_track");
+
     prev_leg.move_to_pos_vel_accel(dt, target_pos, target_vel, target_accel);
     move_from_pos_vel_accel(dt, target_pos, target_vel, target_accel);
     bool s_finished = finished();
@@ -537,9 +540,9 @@ void SCurve::move_from_pos_vel_accel(float dt, Vector3f &pos, Vector3f &vel, Vec
     float scurve_P1 = 0.0f;
     float scurve_V1, scurve_A1, scurve_J1;
     get_jerk_accel_vel_pos_at_time(time, scurve_J1, scurve_A1, scurve_V1, scurve_P1);
-    pos += delta_unit * scurve_P1;
-    vel += delta_unit * scurve_V1;
-    accel += delta_unit * scurve_A1;
+    pos.axpy(scurve_P1, delta_unit);
+    vel.axpy(scurve_V1, delta_unit);
+    accel.axpy(scurve_A1, delta_unit);
     position_sq = sq(scurve_P1);
 }
 
@@ -550,9 +553,9 @@ void SCurve::move_to_pos_vel_accel(float dt, Vector3f &pos, Vector3f &vel, Vecto
     float scurve_P1 = 0.0f;
     float scurve_V1, scurve_A1, scurve_J1;
     get_jerk_accel_vel_pos_at_time(time, scurve_J1, scurve_A1, scurve_V1, scurve_P1);
-    pos += delta_unit * scurve_P1;
-    vel += delta_unit * scurve_V1;
-    accel += delta_unit * scurve_A1;
+    pos.axpy(scurve_P1, delta_unit);
+    vel.axpy(scurve_V1, delta_unit);
+    accel.axpy(scurve_A1, delta_unit);
     position_sq = sq(scurve_P1);
     pos -= track;
 }
@@ -563,9 +566,9 @@ void SCurve::move_from_time_pos_vel_accel(float time_now, Vector3f &pos, Vector3
     float scurve_P1 = 0.0f;
     float scurve_V1 = 0.0f, scurve_A1 = 0.0f, scurve_J1 = 0.0f;
     get_jerk_accel_vel_pos_at_time(time_now, scurve_J1, scurve_A1, scurve_V1, scurve_P1);
-    pos += delta_unit * scurve_P1;
-    vel += delta_unit * scurve_V1;
-    accel += delta_unit * scurve_A1;
+    pos.axpy(scurve_P1, delta_unit);
+    vel.axpy(scurve_V1, delta_unit);
+    accel.axpy(scurve_A1, delta_unit);
 }
 
 // time at the end of the sequence
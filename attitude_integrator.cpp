@@ -0,0 +1,50 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma GCC optimize("O2")
+
+#include "attitude_integrator.h"
+
+template <typename T>
+void AttitudeIntegratorT<T>::update(const Vector3<T> *gyro, uint32_t count, T dt)
+{
+    // keep the state in locals for the whole block
+    T q1 = _q.q1, q2 = _q.q2, q3 = _q.q3, q4 = _q.q4;
+    T prev_x = _prev_delta_angle.x, prev_y = _prev_delta_angle.y, prev_z = _prev_delta_angle.z;
+    const T threshold = _renorm_threshold;
+    for (uint32_t i = 0; i < count; i++) {
+        step(q1, q2, q3, q4, prev_x, prev_y, prev_z,
+             gyro[i].x * dt, gyro[i].y * dt, gyro[i].z * dt, threshold);
+    }
+    _q = QuaternionT<T>(q1, q2, q3, q4);
+    _prev_delta_angle = Vector3<T>(prev_x, prev_y, prev_z);
+}
+
+template <typename T>
+void AttitudeIntegratorT<T>::update_delta_angles(const Vector3<T> *delta_angle, uint32_t count)
+{
+    T q1 = _q.q1, q2 = _q.q2, q3 = _q.q3, q4 = _q.q4;
+    T prev_x = _prev_delta_angle.x, prev_y = _prev_delta_angle.y, prev_z = _prev_delta_angle.z;
+    const T threshold = _renorm_threshold;
+    for (uint32_t i = 0; i < count; i++) {
+        step(q1, q2, q3, q4, prev_x, prev_y, prev_z,
+             delta_angle[i].x, delta_angle[i].y, delta_angle[i].z, threshold);
+    }
+    _q = QuaternionT<T>(q1, q2, q3, q4);
+    _prev_delta_angle = Vector3<T>(prev_x, prev_y, prev_z);
+}
+
+template class AttitudeIntegratorT<float>;
+template class AttitudeIntegratorT<double>;
@@ -0,0 +1,188 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  attitude integration of high rate gyro samples.
+
+  Each sample is treated as a delta angle over the sample period
+  (gyro rate times dt). Integrating the delta angles one at a time
+  leaves a drift under coning motion, because rotations don't
+  commute. Each step therefore uses the rotation vector
+
+    phi = a[k] + 1/12 a[k-1] x a[k]
+
+  which is the "one plus previous" coning correction. The body
+  rotation by phi uses the same small angle series as
+  QuaternionT::rotate_fast(), written in terms of |phi|^2 so it needs
+  no square root. Delta angles should be below 0.17 rad (10 degrees).
+
+  The quaternion is not normalised every step. It is renormalised
+  with one Newton step for 1/|q| when |q|^2 drifts more than a
+  threshold away from 1. The default threshold is 64 machine epsilon.
+
+  AttitudeIntegratorSoA integrates N independent attitudes, for
+  example the vehicles of a swarm simulation. It keeps the state as
+  structure of arrays so each step is one loop over the vehicles.
+  Every lane gives bitwise the same result as AttitudeIntegratorT.
+ */
+#pragma once
+
+#include "quaternion_batch.h"
+
+template <typename T>
+class AttitudeIntegratorT {
+public:
+    AttitudeIntegratorT() { reset(); }
+
+    // reset to the given attitude with no previous sample
+    void reset(const QuaternionT<T> &attitude = QuaternionT<T>()) {
+        _q = attitude;
+        _q.normalize();
+        _prev_delta_angle.zero();
+    }
+
+    // integrate one gyro sample in rad/s, averaged over dt seconds
+    void update(const Vector3<T> &gyro, T dt) {
+        update_delta_angle(gyro * dt);
+    }
+
+    // integrate one delta angle in radians
+    void update_delta_angle(const Vector3<T> &delta_angle) {
+        step(_q.q1, _q.q2, _q.q3, _q.q4,
+             _prev_delta_angle.x, _prev_delta_angle.y, _prev_delta_angle.z,
+             delta_angle.x, delta_angle.y, delta_angle.z, _renorm_threshold);
+    }
+
+    // integrate count gyro samples with a constant sample period
+    void update(const Vector3<T> *gyro, uint32_t count, T dt);
+
+    // integrate count delta angles
+    void update_delta_angles(const Vector3<T> *delta_angle, uint32_t count);
+
+    // attitude as a body to earth rotation, unit length to within the threshold
+    const QuaternionT<T> &get_attitude() const { return _q; }
+
+    // maximum drift of |q|^2 from 1 before renormalising
+    void set_renormalise_threshold(T threshold) { _renorm_threshold = threshold; }
+
+    /*
+      one coning corrected step on a quaternion and previous delta
+      angle stored as separate values, shared with
+      AttitudeIntegratorSoA
+     */
+    static void step(T &q1, T &q2, T &q3, T &q4, T &prev_x, T &prev_y, T &prev_z,
+                     const T ax, const T ay, const T az, const T renorm_threshold) {
+        // coning corrected rotation vector
+        const T px = ax + (prev_y * az - prev_z * ay) * T(1.0/12);
+        const T py = ay + (prev_z * ax - prev_x * az) * T(1.0/12);
+        const T pz = az + (prev_x * ay - prev_y * ax) * T(1.0/12);
+        prev_x = ax;
+        prev_y = ay;
+        prev_z = az;
+
+        // rotation quaternion from the series for cos(theta/2) and sin(theta/2)/theta
+        const T theta_sq = px*px + py*py + pz*pz;
+        const T w2 = 1 - theta_sq * T(1.0/8) + theta_sq * theta_sq * T(1.0/384);
+        const T s = T(0.5) - theta_sq * T(1.0/48);
+        const T x2 = px * s;
+        const T y2 = py * s;
+        const T z2 = pz * s;
+
+        const T w1 = q1;
+        const T x1 = q2;
+        const T y1 = q3;
+        const T z1 = q4;
+        const T n1 = w1*w2 - x1*x2 - y1*y2 - z1*z2;
+        const T n2 = w1*x2 + x1*w2 + y1*z2 - z1*y2;
+        const T n3 = w1*y2 - x1*z2 + y1*w2 + z1*x2;
+        const T n4 = w1*z2 + x1*y2 - y1*x2 + z1*w2;
+
+        // renormalise only once |q|^2 has drifted, using a select so
+        // the SoA loop stays branch free
+        const T len_sq = n1*n1 + n2*n2 + n3*n3 + n4*n4;
+        const bool renormalise = (len_sq > 1 + renorm_threshold) | (len_sq < 1 - renorm_threshold);
+        const T scale = renormalise ? T(1.5) - T(0.5) * len_sq : T(1);
+        q1 = n1 * scale;
+        q2 = n2 * scale;
+        q3 = n3 * scale;
+        q4 = n4 * scale;
+    }
+
+    static constexpr T default_renormalise_threshold = 64 * std::numeric_limits<T>::epsilon();
+
+private:
+    QuaternionT<T> _q;
+    Vector3<T> _prev_delta_angle;
+    T _renorm_threshold = default_renormalise_threshold;
+};
+
+typedef AttitudeIntegratorT<float> AttitudeIntegrator;
+typedef AttitudeIntegratorT<double> AttitudeIntegratorD;
+
+/*
+  N independent attitude integrators
+ */
+template <typename T, uint16_t N>
+class AttitudeIntegratorSoA {
+public:
+    AttitudeIntegratorSoA() { reset(); }
+
+    // reset every attitude to level with no previous sample
+    void reset() {
+        for (uint16_t i = 0; i < N; i++) {
+            reset(i, QuaternionT<T>());
+        }
+    }
+
+    void reset(uint16_t i, QuaternionT<T> attitude) {
+        attitude.normalize();
+        get_attitudes().set(i, attitude);
+        _prev_x[i] = _prev_y[i] = _prev_z[i] = 0;
+    }
+
+    // integrate one gyro sample in rad/s for every integrator
+    void update(const Vector3SoA<T> &gyro, T dt) {
+        const T threshold = _renorm_threshold;
+        for (uint16_t i = 0; i < N; i++) {
+            AttitudeIntegratorT<T>::step(_q1[i], _q2[i], _q3[i], _q4[i], _prev_x[i], _prev_y[i], _prev_z[i],
+                                         gyro.x[i] * dt, gyro.y[i] * dt, gyro.z[i] * dt, threshold);
+        }
+    }
+
+    // integrate one delta angle in radians for every integrator
+    void update_delta_angle(const Vector3SoA<T> &delta_angle) {
+        const T threshold = _renorm_threshold;
+        for (uint16_t i = 0; i < N; i++) {
+            AttitudeIntegratorT<T>::step(_q1[i], _q2[i], _q3[i], _q4[i], _prev_x[i], _prev_y[i], _prev_z[i],
+                                         delta_angle.x[i], delta_angle.y[i], delta_angle.z[i], threshold);
+        }
+    }
+
+    QuaternionT<T> get_attitude(uint16_t i) const {
+        return QuaternionT<T>(_q1[i], _q2[i], _q3[i], _q4[i]);
+    }
+
+    // view of all the attitudes, e.g. for the batch rotations in quaternion_batch.h
+    QuaternionSoA<T> get_attitudes() {
+        return QuaternionSoA<T>(_q1, _q2, _q3, _q4);
+    }
+
+    void set_renormalise_threshold(T threshold) { _renorm_threshold = threshold; }
+
+private:
+    T _q1[N], _q2[N], _q3[N], _q4[N];
+    T _prev_x[N], _prev_y[N], _prev_z[N];
+    T _renorm_threshold = AttitudeIntegratorT<T>::default_renormalise_threshold;
+};
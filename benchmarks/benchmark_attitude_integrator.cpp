@@ -0,0 +1,81 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/attitude_integrator.h>
+
+#include "benchmark_common.h"
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define BM_NUM_SAMPLES 8000
+#define BM_NUM_VEHICLES 64
+
+static Vector3f gyro[BM_NUM_SAMPLES];
+
+static void setup_gyro()
+{
+    BenchmarkRandom rand;
+    for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+        gyro[i] = Vector3f(rand.next_float(), rand.next_float(), rand.next_float()) * 5;
+    }
+}
+
+// one second of 8kHz samples, as replay integrated them before
+static void BM_RotateFastNormalize(benchmark::State& state)
+{
+    setup_gyro();
+    Quaternion q;
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            q.rotate_fast(gyro[i] * (1.0f / 8000));
+            q.normalize();
+        }
+        gbenchmark_escape(&q);
+    }
+}
+
+static void BM_IntegratorSingle(benchmark::State& state)
+{
+    setup_gyro();
+    AttitudeIntegrator integrator;
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            integrator.update(gyro[i], 1.0f / 8000);
+        }
+        gbenchmark_escape(&integrator);
+    }
+}
+
+static void BM_IntegratorBlock(benchmark::State& state)
+{
+    setup_gyro();
+    AttitudeIntegrator integrator;
+    while (state.KeepRunning()) {
+        integrator.update(gyro, BM_NUM_SAMPLES, 1.0f / 8000);
+        gbenchmark_escape(&integrator);
+    }
+}
+
+// one sample for each of BM_NUM_VEHICLES vehicles per step
+static void BM_IntegratorSoA(benchmark::State& state)
+{
+    BenchmarkRandom rand;
+    static float gx[BM_NUM_VEHICLES], gy[BM_NUM_VEHICLES], gz[BM_NUM_VEHICLES];
+    Vector3SoA<float> swarm_gyro{gx, gy, gz};
+    for (uint16_t v = 0; v < BM_NUM_VEHICLES; v++) {
+        swarm_gyro.set(v, Vector3f(rand.next_float(), rand.next_float(), rand.next_float()) * 5);
+    }
+    static AttitudeIntegratorSoA<float, BM_NUM_VEHICLES> swarm;
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES / BM_NUM_VEHICLES; i++) {
+            swarm.update(swarm_gyro, 1.0f / 8000);
+        }
+        gbenchmark_escape(&swarm);
+    }
+}
+
+BENCHMARK(BM_RotateFastNormalize);
+BENCHMARK(BM_IntegratorSingle);
+BENCHMARK(BM_IntegratorBlock);
+BENCHMARK(BM_IntegratorSoA);
+
+BENCHMARK_MAIN();
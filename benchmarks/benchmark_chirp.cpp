@@ -0,0 +1,32 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/chirp.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// a 400Hz rate loop
+#define BM_DT 0.0025f
+#define BM_NUM_STEPS 8000
+
+/*
+  a 20 second system identification sweep from 0.5 to 40Hz, counting
+  each update() as an operation
+ */
+static void BM_ChirpUpdate(benchmark::State& state)
+{
+    Chirp chirp;
+    chirp.init(20, 0.5f, 40, 2, 2, 1);
+    static float out[BM_NUM_STEPS];
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_STEPS; i++) {
+            out[i] = chirp.update(i * BM_DT, 0.2f);
+        }
+        gbenchmark_escape(out);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_STEPS);
+}
+
+BENCHMARK(BM_ChirpUpdate);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,50 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  helpers shared by the per module benchmarks.
+
+  Inputs come from a BenchmarkRandom with a fixed seed, so each run
+  times the same data. Benchmarks that do a block of operations per
+  iteration pass the count to SetItemsProcessed(), which google
+  benchmark reports as items_per_second. Record a run with
+  --benchmark_out=<file> --benchmark_out_format=json, as make run does
+  in the standalone Makefile, and check it against a stored baseline
+  with compare_baseline.py.
+ */
+#pragma once
+
+#include <stdint.h>
+
+// xorshift32, independent of rand_float() and the HAL
+class BenchmarkRandom {
+public:
+    explicit BenchmarkRandom(uint32_t seed = 0x2545F491) : _state(seed) {}
+
+    uint32_t next() {
+        _state ^= _state << 13;
+        _state ^= _state >> 17;
+        _state ^= _state << 5;
+        return _state;
+    }
+
+    // uniform between lo and hi
+    float next_float(float lo = -1, float hi = 1) {
+        return lo + (hi - lo) * (float)(next() >> 8) * (1.0f / 16777216);
+    }
+
+private:
+    uint32_t _state;
+};
@@ -0,0 +1,118 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+#include "benchmark_common.h"
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define BM_NUM_SAMPLES 1024
+
+static float error[BM_NUM_SAMPLES];
+static Vector2f error_xy[BM_NUM_SAMPLES];
+static Vector2f vel_xy[BM_NUM_SAMPLES];
+static Vector3f direction[BM_NUM_SAMPLES];
+
+static void setup_samples()
+{
+    BenchmarkRandom rand;
+    for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+        error[i] = rand.next_float(-20, 20);
+        error_xy[i] = Vector2f(rand.next_float(-20, 20), rand.next_float(-20, 20));
+        vel_xy[i] = Vector2f(rand.next_float(-10, 10), rand.next_float(-10, 10));
+        direction[i] = Vector3f(rand.next_float(), rand.next_float(), rand.next_float());
+    }
+}
+
+static void BM_SqrtController(benchmark::State& state)
+{
+    setup_samples();
+    float out[BM_NUM_SAMPLES];
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            out[i] = sqrt_controller(error[i], 1.0f, 5.0f, 0.0025f);
+        }
+        gbenchmark_escape(out);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+}
+
+static void BM_SqrtControllerXY(benchmark::State& state)
+{
+    setup_samples();
+    Vector2f out[BM_NUM_SAMPLES];
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            out[i] = sqrt_controller(error_xy[i], 1.0f, 5.0f, 0.0025f);
+        }
+        gbenchmark_escape(out);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+}
+
+// one position controller step per sample, as in AC_PosControl
+static void BM_ShapePosVelAccelXY(benchmark::State& state)
+{
+    setup_samples();
+    Vector2f accel;
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            shape_pos_vel_accel_xy(Vector2p(), Vector2f(), Vector2f(),
+                                   Vector2p(error_xy[i].x, error_xy[i].y), vel_xy[i], accel,
+                                   10.0f, 5.0f, 20.0f, 0.0025f, false);
+        }
+        gbenchmark_escape(&accel);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+}
+
+static void BM_UpdatePosVelAccelXY(benchmark::State& state)
+{
+    setup_samples();
+    Vector2p pos;
+    Vector2f vel;
+    const Vector2f limit;
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            update_pos_vel_accel_xy(pos, vel, error_xy[i], 0.0025f, limit, Vector2f(), Vector2f());
+        }
+        gbenchmark_escape(&pos);
+        gbenchmark_escape(&vel);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+}
+
+static void BM_KinematicLimit(benchmark::State& state)
+{
+    setup_samples();
+    float out[BM_NUM_SAMPLES];
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            out[i] = kinematic_limit(direction[i], 5.0f, 2.5f, 1.5f);
+        }
+        gbenchmark_escape(out);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+}
+
+static void BM_InputExpo(benchmark::State& state)
+{
+    setup_samples();
+    float out[BM_NUM_SAMPLES];
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            out[i] = input_expo(error[i] * 0.05f, 0.3f);
+        }
+        gbenchmark_escape(out);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+}
+
+BENCHMARK(BM_SqrtController);
+BENCHMARK(BM_SqrtControllerXY);
+BENCHMARK(BM_ShapePosVelAccelXY);
+BENCHMARK(BM_UpdatePosVelAccelXY);
+BENCHMARK(BM_KinematicLimit);
+BENCHMARK(BM_InputExpo);
+
+BENCHMARK_MAIN();
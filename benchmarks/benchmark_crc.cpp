@@ -0,0 +1,67 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+#include "benchmark_common.h"
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define BM_MAX_BYTES 4096
+
+// word aligned for crc_crc64()
+static uint32_t buffer_words[BM_MAX_BYTES / 4];
+static uint8_t *buffer = (uint8_t *)buffer_words;
+
+static void setup_buffer()
+{
+    BenchmarkRandom rand;
+    for (uint16_t i = 0; i < BM_MAX_BYTES / 4; i++) {
+        buffer_words[i] = rand.next();
+    }
+}
+
+/*
+  one checksum of state.range(0) bytes per iteration, reported as
+  checksums and bytes per second
+ */
+#define BM_CRC(name, expr) \
+static void BM_ ## name(benchmark::State& state) \
+{ \
+    setup_buffer(); \
+    const uint32_t len = state.range(0); \
+    while (state.KeepRunning()) { \
+        auto crc = expr; \
+        gbenchmark_escape(&crc); \
+    } \
+    state.SetItemsProcessed(state.iterations()); \
+    state.SetBytesProcessed(state.iterations() * len); \
+} \
+BENCHMARK(BM_ ## name)->Arg(64)->Arg(1024)->Arg(BM_MAX_BYTES)
+
+BM_CRC(Crc8DvbS2, crc8_dvb_s2_update(0, buffer, len));
+BM_CRC(Crc8Maxim, crc8_maxim(buffer, len));
+BM_CRC(CrcXmodem, crc_xmodem(buffer, len));
+BM_CRC(Crc16Ccitt, crc16_ccitt(buffer, len, 0));
+BM_CRC(CrcModbus, calc_crc_modbus(buffer, len));
+BM_CRC(CrcFletcher16, crc_fletcher16(buffer, len));
+BM_CRC(Crc24, crc_crc24(buffer, len));
+BM_CRC(Crc32, crc_crc32(0, buffer, len));
+BM_CRC(Crc32Small, crc32_small(0, buffer, len));
+BM_CRC(Crc64, crc_crc64(buffer_words, len / 4));
+BM_CRC(SumOfBytes, crc_sum_of_bytes(buffer, len));
+
+static void BM_HashFnv1a(benchmark::State& state)
+{
+    setup_buffer();
+    const uint32_t len = state.range(0);
+    while (state.KeepRunning()) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        hash_fnv_1a(len, buffer, &hash);
+        gbenchmark_escape(&hash);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * len);
+}
+BENCHMARK(BM_HashFnv1a)->Arg(64)->Arg(1024)->Arg(BM_MAX_BYTES);
+
+BENCHMARK_MAIN();
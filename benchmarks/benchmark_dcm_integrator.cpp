@@ -0,0 +1,116 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/dcm_integrator.h>
+
+#include "benchmark_common.h"
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define BM_NUM_SAMPLES 8000
+
+static Vector3f gyro[BM_NUM_SAMPLES];
+
+static void setup_gyro()
+{
+    BenchmarkRandom rand;
+    for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+        gyro[i] = Vector3f(rand.next_float(), rand.next_float(), rand.next_float()) * 5;
+    }
+}
+
+// largest element of m * m^T - I
+static double orthogonality_error(const Matrix3f &m)
+{
+    const Matrix3d md = m.todouble();
+    const Matrix3d e = md * md.transposed();
+    double err = 0;
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            err = MAX(err, std::fabs(e[i][j] - (i == j ? 1 : 0)));
+        }
+    }
+    return err;
+}
+
+// largest element difference from a double precision integration of one second
+static double drift(const Matrix3f &m)
+{
+    DcmIntegratorD reference;
+    for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+        reference.update(gyro[i].todouble(), 1.0 / 8000);
+    }
+    double err = 0;
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            err = MAX(err, std::fabs(m[i][j] - reference.get_dcm()[i][j]));
+        }
+    }
+    return err;
+}
+
+/*
+  one second of 8kHz samples per iteration. The counters give the
+  integration steps per second, the orthogonality error at the end and
+  the drift of the first second from a double precision integration
+ */
+static void BM_RotateNormalize(benchmark::State& state)
+{
+    setup_gyro();
+    Matrix3f m;
+    m.identity();
+    for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+        m.rotate(gyro[i] * (1.0f / 8000));
+        m.normalize();
+    }
+    const double first_second_drift = drift(m);
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            m.rotate(gyro[i] * (1.0f / 8000));
+            m.normalize();
+        }
+        gbenchmark_escape(&m);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+    state.counters["orthogonality"] = orthogonality_error(m);
+    state.counters["drift"] = first_second_drift;
+}
+
+static void BM_DcmIntegratorSingle(benchmark::State& state)
+{
+    setup_gyro();
+    DcmIntegrator integrator;
+    for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+        integrator.update(gyro[i], 1.0f / 8000);
+    }
+    const double first_second_drift = drift(integrator.get_dcm());
+    integrator.reset();
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            integrator.update(gyro[i], 1.0f / 8000);
+        }
+        gbenchmark_escape(&integrator);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+    state.counters["orthogonality"] = orthogonality_error(integrator.get_dcm());
+    state.counters["renormalisations"] = integrator.get_renormalise_count();
+    state.counters["drift"] = first_second_drift;
+}
+
+static void BM_DcmIntegratorBlock(benchmark::State& state)
+{
+    setup_gyro();
+    DcmIntegrator integrator;
+    while (state.KeepRunning()) {
+        integrator.update(gyro, BM_NUM_SAMPLES, 1.0f / 8000);
+        gbenchmark_escape(&integrator);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+    state.counters["orthogonality"] = orthogonality_error(integrator.get_dcm());
+    state.counters["renormalisations"] = integrator.get_renormalise_count();
+}
+
+BENCHMARK(BM_RotateNormalize);
+BENCHMARK(BM_DcmIntegratorSingle);
+BENCHMARK(BM_DcmIntegratorBlock);
+
+BENCHMARK_MAIN();
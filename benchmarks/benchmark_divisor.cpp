@@ -0,0 +1,77 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/divisor.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define BM_DIV_COUNT 1024
+
+/*
+  fill an array with pseudo random values and return a runtime divisor
+  the compiler can't see through
+ */
+template <typename T>
+static T setup_values(T *n)
+{
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    for (uint16_t i = 0; i < BM_DIV_COUNT; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        n[i] = T(state);
+    }
+    volatile T d = 1000;
+    return d;
+}
+
+template <typename T>
+static void BM_HardwareDivision(benchmark::State& state)
+{
+    T n[BM_DIV_COUNT], q[BM_DIV_COUNT];
+    const T d = setup_values(n);
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_DIV_COUNT; i++) {
+            q[i] = n[i] / d;
+        }
+        gbenchmark_escape(q);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_DIV_COUNT);
+}
+
+template <typename T, typename D>
+static void BM_RuntimeDivisor(benchmark::State& state)
+{
+    T n[BM_DIV_COUNT], q[BM_DIV_COUNT];
+    const D div(setup_values(n));
+
+    while (state.KeepRunning()) {
+        div.divide(n, q, BM_DIV_COUNT);
+        gbenchmark_escape(q);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_DIV_COUNT);
+}
+
+static void BM_Div1000(benchmark::State& state)
+{
+    uint64_t n[BM_DIV_COUNT], q[BM_DIV_COUNT];
+    setup_values(n);
+
+    while (state.KeepRunning()) {
+        ConstDivisor<uint64_t, 1000ULL>::divide(n, q, BM_DIV_COUNT);
+        gbenchmark_escape(q);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_DIV_COUNT);
+}
+
+BENCHMARK_TEMPLATE(BM_HardwareDivision, uint32_t);
+BENCHMARK_TEMPLATE(BM_RuntimeDivisor, uint32_t, UDivisor<uint32_t>);
+BENCHMARK_TEMPLATE(BM_HardwareDivision, uint64_t);
+BENCHMARK_TEMPLATE(BM_RuntimeDivisor, uint64_t, UDivisor<uint64_t>);
+BENCHMARK_TEMPLATE(BM_HardwareDivision, int32_t);
+BENCHMARK_TEMPLATE(BM_RuntimeDivisor, int32_t, SDivisor<int32_t>);
+BENCHMARK_TEMPLATE(BM_HardwareDivision, int64_t);
+BENCHMARK_TEMPLATE(BM_RuntimeDivisor, int64_t, SDivisor<int64_t>);
+BENCHMARK(BM_Div1000);
+
+BENCHMARK_MAIN();
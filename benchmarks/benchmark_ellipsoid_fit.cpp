@@ -0,0 +1,77 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/ellipsoid_fit.h>
+
+#include "benchmark_common.h"
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// 10M samples are fed as ten passes over 1M
+#define BM_NUM_SAMPLES 1000000
+#define BM_NUM_PASSES 10
+
+static Vector3f samples[BM_NUM_SAMPLES];
+
+static void setup_samples()
+{
+    BenchmarkRandom rand;
+    const Vector3f offset(-80, 210, 35);
+    const Matrix3f S_inv(0.91f, -0.03f, 0.02f,
+                         -0.03f, 1.09f, -0.02f,
+                         0.02f, -0.02f, 1.0f);
+    for (uint32_t i = 0; i < BM_NUM_SAMPLES; i++) {
+        Vector3f v(rand.next_float(), rand.next_float(), rand.next_float());
+        if (v.is_zero()) {
+            v.x = 1;
+        }
+        v.normalize();
+        samples[i] = S_inv * (v * 400) - offset + Vector3f(rand.next_float(), rand.next_float(), rand.next_float());
+    }
+}
+
+static void BM_EllipsoidFitUpdate(benchmark::State& state)
+{
+    setup_samples();
+    EllipsoidFit fit;
+    while (state.KeepRunning()) {
+        fit.reset();
+        for (uint8_t i = 0; i < BM_NUM_PASSES; i++) {
+            fit.update(samples, BM_NUM_SAMPLES);
+        }
+        gbenchmark_escape(&fit);
+    }
+}
+
+static void BM_EllipsoidFitSphere(benchmark::State& state)
+{
+    setup_samples();
+    EllipsoidFit fit;
+    fit.update(samples, BM_NUM_SAMPLES);
+    EllipsoidFit::Result result;
+    bool ok;
+    while (state.KeepRunning()) {
+        ok = fit.fit_sphere(result);
+        gbenchmark_escape(&ok);
+        gbenchmark_escape(&result);
+    }
+}
+
+static void BM_EllipsoidFitEllipsoid(benchmark::State& state)
+{
+    setup_samples();
+    EllipsoidFit fit;
+    fit.update(samples, BM_NUM_SAMPLES);
+    EllipsoidFit::Result result;
+    bool ok;
+    while (state.KeepRunning()) {
+        ok = fit.fit_ellipsoid(result);
+        gbenchmark_escape(&ok);
+        gbenchmark_escape(&result);
+    }
+}
+
+BENCHMARK(BM_EllipsoidFitUpdate);
+BENCHMARK(BM_EllipsoidFitSphere);
+BENCHMARK(BM_EllipsoidFitEllipsoid);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,83 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/filter.h>
+
+#include "benchmark_common.h"
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// 8 harmonics on 3 axes of 4 IMUs
+#define BM_NUM_CHANNELS 12
+#define BM_HARMONICS 0xFF
+
+static void BM_HarmonicNotchScalar(benchmark::State& state)
+{
+    BenchmarkRandom rand;
+    HarmonicNotchFilterFloat notch[BM_NUM_CHANNELS];
+    for (uint8_t c = 0; c < BM_NUM_CHANNELS; c++) {
+        notch[c].init(4000, BM_HARMONICS, 80, 20, 40);
+    }
+    float sample[BM_NUM_CHANNELS];
+    for (uint8_t c = 0; c < BM_NUM_CHANNELS; c++) {
+        sample[c] = rand.next_float();
+    }
+
+    while (state.KeepRunning()) {
+        for (uint8_t c = 0; c < BM_NUM_CHANNELS; c++) {
+            sample[c] = notch[c].apply(sample[c]);
+        }
+        gbenchmark_escape(sample);
+    }
+}
+
+static void BM_HarmonicNotchBank(benchmark::State& state)
+{
+    BenchmarkRandom rand;
+    HarmonicNotchBank<8, BM_NUM_CHANNELS> bank;
+    bank.init(4000, BM_HARMONICS, 80, 20, 40);
+    float sample[BM_NUM_CHANNELS];
+    for (uint8_t c = 0; c < BM_NUM_CHANNELS; c++) {
+        sample[c] = rand.next_float();
+    }
+
+    while (state.KeepRunning()) {
+        bank.apply(sample);
+        gbenchmark_escape(sample);
+    }
+}
+
+static void BM_HarmonicNotchUpdate(benchmark::State& state)
+{
+    HarmonicNotchBank<8, BM_NUM_CHANNELS> bank;
+    bank.init(4000, BM_HARMONICS, 80, 20, 40);
+    float freq = 80;
+
+    while (state.KeepRunning()) {
+        freq = freq > 120 ? 80 : freq + 0.1f;
+        bank.update(freq);
+        gbenchmark_escape(&bank);
+    }
+}
+
+static void BM_NotchUpdateLibm(benchmark::State& state)
+{
+    BiquadCoefficients coeff[8];
+    float A, Q;
+    BiquadCoefficients::calc_A_Q(80, 20, 40, A, Q);
+    float freq = 80;
+
+    while (state.KeepRunning()) {
+        freq = freq > 120 ? 80 : freq + 0.1f;
+        for (uint8_t h = 0; h < 8; h++) {
+            coeff[h].notch_A_Q(4000, freq * (h + 1), A, Q);
+        }
+        gbenchmark_escape(coeff);
+    }
+}
+
+BENCHMARK(BM_HarmonicNotchScalar);
+BENCHMARK(BM_HarmonicNotchBank);
+BENCHMARK(BM_HarmonicNotchUpdate);
+BENCHMARK(BM_NotchUpdateLibm);
+
+BENCHMARK_MAIN();
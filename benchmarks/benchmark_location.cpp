@@ -0,0 +1,84 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+#include "benchmark_common.h"
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define BM_NUM_SAMPLES 1024
+
+static Vector2f origin[BM_NUM_SAMPLES];
+static Vector2f destination[BM_NUM_SAMPLES];
+static Vector3d llh[BM_NUM_SAMPLES];
+static Vector3d ecef[BM_NUM_SAMPLES];
+
+static void setup_samples()
+{
+    BenchmarkRandom rand;
+    for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+        origin[i] = Vector2f(rand.next_float(-1000, 1000), rand.next_float(-1000, 1000));
+        destination[i] = Vector2f(rand.next_float(-1000, 1000), rand.next_float(-1000, 1000));
+        llh[i] = Vector3d(radians(rand.next_float(-80, 80)), radians(rand.next_float(-180, 180)), rand.next_float(0, 3000));
+        wgsllh2ecef(llh[i], ecef[i]);
+    }
+}
+
+static void BM_GetHorizontalDistance(benchmark::State& state)
+{
+    setup_samples();
+    float distance[BM_NUM_SAMPLES];
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            distance[i] = get_horizontal_distance(origin[i], destination[i]);
+        }
+        gbenchmark_escape(distance);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+}
+
+static void BM_GetBearingRad(benchmark::State& state)
+{
+    setup_samples();
+    float bearing[BM_NUM_SAMPLES];
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            bearing[i] = get_bearing_rad(origin[i], destination[i]);
+        }
+        gbenchmark_escape(bearing);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+}
+
+static void BM_WgsLlhToEcef(benchmark::State& state)
+{
+    setup_samples();
+    Vector3d out[BM_NUM_SAMPLES];
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            wgsllh2ecef(llh[i], out[i]);
+        }
+        gbenchmark_escape(out);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+}
+
+static void BM_WgsEcefToLlh(benchmark::State& state)
+{
+    setup_samples();
+    Vector3d out[BM_NUM_SAMPLES];
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            wgsecef2llh(ecef[i], out[i]);
+        }
+        gbenchmark_escape(out);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+}
+
+BENCHMARK(BM_GetHorizontalDistance);
+BENCHMARK(BM_GetBearingRad);
+BENCHMARK(BM_WgsLlhToEcef);
+BENCHMARK(BM_WgsEcefToLlh);
+
+BENCHMARK_MAIN();
@@ -1,6 +1,10 @@
 #include <AP_gbenchmark.h>
 
 #include <AP_Math/AP_Math.h>
+#include <AP_Math/matrixN.h>
+#include <AP_Math/vectorN.h>
+
+#include "benchmark_common.h"
 
 const AP_HAL::HAL& hal = AP_HAL::get_HAL();
 
@@ -19,6 +23,45 @@ static void BM_MatrixMultiplication(benchmark::State& state)
     }
 }
 
+// outer product accumulation, as in a small Kalman filter covariance update
+static void BM_MatrixNOuterProductAdd(benchmark::State& state)
+{
+    BenchmarkRandom rand;
+    VectorN<float,4> a, b;
+    for (uint8_t i = 0; i < 4; i++) {
+        a[i] = rand.next_float();
+        b[i] = rand.next_float();
+    }
+    MatrixN<float,4> P, K;
+    while (state.KeepRunning()) {
+        K.mult(a, b);
+        P += K;
+        P.force_symmetry();
+        gbenchmark_escape(&P);
+    }
+}
+
+// general inverse of a diagonally dominant dim x dim matrix
+static void BM_MatInverse(benchmark::State& state)
+{
+    const uint16_t dim = state.range(0);
+    BenchmarkRandom rand;
+    float x[16 * 16], y[16 * 16];
+    for (uint16_t i = 0; i < dim; i++) {
+        for (uint16_t j = 0; j < dim; j++) {
+            x[i * dim + j] = rand.next_float() + (i == j ? dim : 0);
+        }
+    }
+    bool ok;
+    while (state.KeepRunning()) {
+        ok = mat_inverse(x, y, dim);
+        gbenchmark_escape(&ok);
+        gbenchmark_escape(y);
+    }
+}
+
 BENCHMARK(BM_MatrixMultiplication);
+BENCHMARK(BM_MatrixNOuterProductAdd);
+BENCHMARK(BM_MatInverse)->Arg(3)->Arg(4)->Arg(6)->Arg(16);
 
 BENCHMARK_MAIN();
@@ -0,0 +1,171 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/matrix_batch.h>
+
+#include "benchmark_common.h"
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define BM_NUM_MATRICES 1024
+
+static Matrix3f mat3[BM_NUM_MATRICES];
+static Matrix3f inv3[BM_NUM_MATRICES];
+static float mat4[BM_NUM_MATRICES*16];
+static float inv4[BM_NUM_MATRICES*16];
+static float storage3[BM_NUM_MATRICES*9], inv_storage3[BM_NUM_MATRICES*9];
+static MatrixSoA<float,3> soa3{storage3, BM_NUM_MATRICES};
+static MatrixSoA<float,3> inv_soa3{inv_storage3, BM_NUM_MATRICES};
+static float storage4[BM_NUM_MATRICES*16], inv_storage4[BM_NUM_MATRICES*16];
+static MatrixSoA<float,4> soa4{storage4, BM_NUM_MATRICES};
+static MatrixSoA<float,4> inv_soa4{inv_storage4, BM_NUM_MATRICES};
+static float det[BM_NUM_MATRICES];
+static bool singular[BM_NUM_MATRICES];
+
+static void setup_matrices()
+{
+    BenchmarkRandom rand;
+    float m3[BM_NUM_MATRICES*9];
+    for (uint16_t i = 0; i < BM_NUM_MATRICES; i++) {
+        for (uint8_t r = 0; r < 3; r++) {
+            mat3[i][r] = Vector3f(rand.next_float(), rand.next_float(), rand.next_float());
+            m3[i*9 + r*3] = mat3[i][r].x;
+            m3[i*9 + r*3 + 1] = mat3[i][r].y;
+            m3[i*9 + r*3 + 2] = mat3[i][r].z;
+        }
+        for (uint8_t k = 0; k < 16; k++) {
+            mat4[i*16 + k] = rand.next_float();
+        }
+    }
+    soa3.pack(m3, BM_NUM_MATRICES);
+    soa4.pack(mat4, BM_NUM_MATRICES);
+}
+
+static void BM_Matrix3Det(benchmark::State& state)
+{
+    setup_matrices();
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_MATRICES; i++) {
+            det[i] = mat3[i].det();
+        }
+        gbenchmark_escape(det);
+    }
+}
+
+static void BM_BatchDet3(benchmark::State& state)
+{
+    setup_matrices();
+    while (state.KeepRunning()) {
+        mat_det(soa3, det, BM_NUM_MATRICES);
+        gbenchmark_escape(det);
+    }
+}
+
+static void BM_Matrix3Inverse(benchmark::State& state)
+{
+    setup_matrices();
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_MATRICES; i++) {
+            singular[i] = !mat3[i].inverse(inv3[i]);
+        }
+        gbenchmark_escape(inv3);
+        gbenchmark_escape(singular);
+    }
+}
+
+static void BM_BatchInverse3(benchmark::State& state)
+{
+    setup_matrices();
+    while (state.KeepRunning()) {
+        mat_inverse(soa3, inv_soa3, singular, BM_NUM_MATRICES);
+        gbenchmark_escape(inv_storage3);
+        gbenchmark_escape(singular);
+    }
+}
+
+static void BM_MatInverse4(benchmark::State& state)
+{
+    setup_matrices();
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_MATRICES; i++) {
+            singular[i] = !mat_inverse(&mat4[i*16], &inv4[i*16], 4);
+        }
+        gbenchmark_escape(inv4);
+        gbenchmark_escape(singular);
+    }
+}
+
+static void BM_BatchInverse4(benchmark::State& state)
+{
+    setup_matrices();
+    while (state.KeepRunning()) {
+        mat_inverse(soa4, inv_soa4, singular, BM_NUM_MATRICES);
+        gbenchmark_escape(inv_storage4);
+        gbenchmark_escape(singular);
+    }
+}
+
+static void BM_Matrix3SymmetricEigen(benchmark::State& state)
+{
+    setup_matrices();
+    Vector3f values;
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_MATRICES; i++) {
+            // only the upper triangle is used
+            mat3[i].symmetric_eigen(values, inv3[i]);
+        }
+        gbenchmark_escape(inv3);
+        gbenchmark_escape(&values);
+    }
+}
+
+static void BM_BatchSymmetricEigen(benchmark::State& state)
+{
+    setup_matrices();
+    const Vector3SoA<float> values{&inv_storage4[0], &inv_storage4[BM_NUM_MATRICES], &inv_storage4[2*BM_NUM_MATRICES]};
+    while (state.KeepRunning()) {
+        mat_symmetric_eigen(soa3, values, inv_soa3, BM_NUM_MATRICES);
+        gbenchmark_escape(inv_storage3);
+        gbenchmark_escape(inv_storage4);
+    }
+}
+
+static void BM_Matrix3SVD(benchmark::State& state)
+{
+    setup_matrices();
+    Matrix3f U;
+    Vector3f S;
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_MATRICES; i++) {
+            mat3[i].svd(U, S, inv3[i]);
+        }
+        gbenchmark_escape(inv3);
+        gbenchmark_escape(&U);
+        gbenchmark_escape(&S);
+    }
+}
+
+static void BM_BatchSVD(benchmark::State& state)
+{
+    setup_matrices();
+    // the 4x4 storage is big enough for U and S
+    const MatrixSoA<float,3> u{inv_storage4, BM_NUM_MATRICES};
+    const Vector3SoA<float> s{&inv_storage4[9*BM_NUM_MATRICES], &inv_storage4[10*BM_NUM_MATRICES], &inv_storage4[11*BM_NUM_MATRICES]};
+    while (state.KeepRunning()) {
+        mat_svd(soa3, u, s, inv_soa3, BM_NUM_MATRICES);
+        gbenchmark_escape(inv_storage3);
+        gbenchmark_escape(inv_storage4);
+    }
+}
+
+BENCHMARK(BM_Matrix3Det);
+BENCHMARK(BM_BatchDet3);
+BENCHMARK(BM_Matrix3Inverse);
+BENCHMARK(BM_BatchInverse3);
+BENCHMARK(BM_MatInverse4);
+BENCHMARK(BM_BatchInverse4);
+BENCHMARK(BM_Matrix3SymmetricEigen);
+BENCHMARK(BM_BatchSymmetricEigen);
+BENCHMARK(BM_Matrix3SVD);
+BENCHMARK(BM_BatchSVD);
+
+BENCHMARK_MAIN();
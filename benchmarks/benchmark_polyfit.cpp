@@ -0,0 +1,60 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/polyfit.h>
+
+#include "benchmark_common.h"
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define BM_NUM_SAMPLES 1024
+
+static double x[BM_NUM_SAMPLES];
+static Vector3f y[BM_NUM_SAMPLES];
+
+// noisy cubics, as fitted for compass motor or temperature compensation
+static void setup_samples()
+{
+    BenchmarkRandom rand;
+    for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+        const float t = rand.next_float(-10, 60);
+        x[i] = t;
+        y[i] = Vector3f(0.5f + 0.01f * t - 0.002f * t * t,
+                        -0.3f + 0.02f * t + 0.0001f * t * t * t,
+                        0.1f * t) + Vector3f(rand.next_float(), rand.next_float(), rand.next_float()) * 0.01f;
+    }
+}
+
+static void BM_PolyFitUpdate(benchmark::State& state)
+{
+    setup_samples();
+    while (state.KeepRunning()) {
+        PolyFit<4, double, Vector3f> fit {};
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            fit.update(x[i], y[i]);
+        }
+        gbenchmark_escape(&fit);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+}
+
+static void BM_PolyFitGetPolynomial(benchmark::State& state)
+{
+    setup_samples();
+    PolyFit<4, double, Vector3f> fit {};
+    for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+        fit.update(x[i], y[i]);
+    }
+    Vector3f res[4];
+    bool ok;
+    while (state.KeepRunning()) {
+        ok = fit.get_polynomial(res);
+        gbenchmark_escape(&ok);
+        gbenchmark_escape(res);
+    }
+}
+
+BENCHMARK(BM_PolyFitUpdate);
+BENCHMARK(BM_PolyFitGetPolynomial);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,84 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+#include "benchmark_common.h"
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define BM_NUM_SAMPLES 1024
+#define BM_MAX_VERTICES 128
+
+static Vector2f point[BM_NUM_SAMPLES];
+static Vector2f line_end[BM_NUM_SAMPLES];
+
+// closed polygon with the first vertex repeated at the end. Polygon_intersects()
+// and Polygon_closest_distance_line() index with uint8_t, so at most 255 points
+static Vector2f polygon[BM_MAX_VERTICES + 1];
+
+/*
+  a star shaped fence of radius 50 to 100 with n vertices, and
+  points and lines spread over and around it
+ */
+static unsigned setup_samples(unsigned n)
+{
+    BenchmarkRandom rand;
+    for (unsigned i = 0; i < n; i++) {
+        const float angle = i * (M_2PI / n);
+        const float radius = rand.next_float(50, 100);
+        polygon[i] = Vector2f(cosf(angle), sinf(angle)) * radius;
+    }
+    polygon[n] = polygon[0];
+    for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+        point[i] = Vector2f(rand.next_float(-120, 120), rand.next_float(-120, 120));
+        line_end[i] = point[i] + Vector2f(rand.next_float(-20, 20), rand.next_float(-20, 20));
+    }
+    return n + 1;
+}
+
+static void BM_PolygonOutside(benchmark::State& state)
+{
+    const unsigned n = setup_samples(state.range(0));
+    bool outside[BM_NUM_SAMPLES];
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            outside[i] = Polygon_outside(point[i], polygon, n);
+        }
+        gbenchmark_escape(outside);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+}
+
+static void BM_PolygonIntersects(benchmark::State& state)
+{
+    const unsigned n = setup_samples(state.range(0));
+    bool intersects[BM_NUM_SAMPLES];
+    Vector2f intersection;
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            intersects[i] = Polygon_intersects(polygon, n, point[i], line_end[i], intersection);
+        }
+        gbenchmark_escape(intersects);
+        gbenchmark_escape(&intersection);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+}
+
+static void BM_PolygonClosestDistanceLine(benchmark::State& state)
+{
+    const unsigned n = setup_samples(state.range(0));
+    float distance[BM_NUM_SAMPLES];
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            distance[i] = Polygon_closest_distance_line(polygon, n, point[i], line_end[i]);
+        }
+        gbenchmark_escape(distance);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+}
+
+BENCHMARK(BM_PolygonOutside)->Arg(8)->Arg(32)->Arg(BM_MAX_VERTICES);
+BENCHMARK(BM_PolygonIntersects)->Arg(8)->Arg(32)->Arg(BM_MAX_VERTICES);
+BENCHMARK(BM_PolygonClosestDistanceLine)->Arg(8)->Arg(32)->Arg(BM_MAX_VERTICES);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,167 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/precision.h>
+
+#include "benchmark_common.h"
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define BM_NUM_SAMPLES 1024
+
+static Vector3d angles[BM_NUM_SAMPLES];
+static Vector2d positions[BM_NUM_SAMPLES];
+
+static void setup_samples()
+{
+    BenchmarkRandom random;
+    for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+        angles[i] = Vector3d(random.next_float() * M_PI, random.next_float() * 1.5, random.next_float() * M_PI);
+        positions[i] = Vector2d(random.next_float(-1000, 1000), random.next_float(-1000, 1000));
+    }
+}
+
+/*
+  each benchmark runs one policy over the samples. The max_error
+  counter is the largest difference from the exact answer, in radians
+  for angles and m/s for the sqrt controller
+ */
+template <typename P>
+static void BM_QuaternionEulerRoundTrip(benchmark::State& state)
+{
+    typedef typename P::type F;
+    setup_samples();
+    QuaternionT<F> q;
+    double max_error = 0;
+    for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+        F r, p, y;
+        q.template from_euler<P>(angles[i].x, angles[i].y, angles[i].z);
+        q.template to_euler<P>(r, p, y);
+        max_error = MAX(max_error, (Vector3d(r, p, y) - angles[i]).length<PrecisionDouble>());
+    }
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            F r, p, y;
+            q.template from_euler<P>(angles[i].x, angles[i].y, angles[i].z);
+            q.template to_euler<P>(r, p, y);
+            gbenchmark_escape(&r);
+            gbenchmark_escape(&p);
+            gbenchmark_escape(&y);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+    state.counters["max_error"] = max_error;
+}
+
+template <typename P>
+static void BM_Matrix3EulerRoundTrip(benchmark::State& state)
+{
+    typedef typename P::type F;
+    setup_samples();
+    Matrix3<F> m;
+    double max_error = 0;
+    for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+        F r, p, y;
+        m.template from_euler<P>(angles[i].x, angles[i].y, angles[i].z);
+        m.template to_euler<P>(&r, &p, &y);
+        max_error = MAX(max_error, (Vector3d(r, p, y) - angles[i]).length<PrecisionDouble>());
+    }
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            F r, p, y;
+            m.template from_euler<P>(angles[i].x, angles[i].y, angles[i].z);
+            m.template to_euler<P>(&r, &p, &y);
+            gbenchmark_escape(&r);
+            gbenchmark_escape(&p);
+            gbenchmark_escape(&y);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+    state.counters["max_error"] = max_error;
+}
+
+// max_error is the largest difference of the length from 1
+template <typename P>
+static void BM_QuaternionNormalize(benchmark::State& state)
+{
+    typedef typename P::type F;
+    setup_samples();
+    QuaternionT<F> q[BM_NUM_SAMPLES];
+    double max_error = 0;
+    for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+        q[i].from_euler(angles[i].x, angles[i].y, angles[i].z);
+        QuaternionT<F> n = q[i];
+        n.q1 *= 1.1;
+        n.template normalize<P>();
+        const QuaternionD d = n.todouble();
+        max_error = MAX(max_error, fabs(std::sqrt(d.q1*d.q1 + d.q2*d.q2 + d.q3*d.q3 + d.q4*d.q4) - 1));
+    }
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            QuaternionT<F> n = q[i];
+            n.template normalize<P>();
+            gbenchmark_escape(&n);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+    state.counters["max_error"] = max_error;
+}
+
+template <typename P>
+static void BM_SqrtController(benchmark::State& state)
+{
+    typedef typename P::type F;
+    setup_samples();
+    double max_error = 0;
+    for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+        const double error = positions[i].x;
+        const double exact = error > 0 ? std::sqrt(2 * 2.0 * error) : -std::sqrt(2 * 2.0 * -error);
+        max_error = MAX(max_error, fabs(sqrt_controller<P>(F(error), F(0), F(2), F(0)) - exact));
+    }
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            F rate = sqrt_controller<P>(F(positions[i].x), F(1), F(2), F(0.0025));
+            gbenchmark_escape(&rate);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+    state.counters["max_error"] = max_error;
+}
+
+template <typename P>
+static void BM_Bearing(benchmark::State& state)
+{
+    typedef typename P::type F;
+    setup_samples();
+    const Vector2<F> origin(F(0.5), F(-0.25));
+    double max_error = 0;
+    for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+        const Vector2d d = positions[i] - Vector2d(0.5, -0.25);
+        const double bearing = atan2(d.y, d.x);
+        const double exact = bearing < 0 ? bearing + M_2PI : bearing;
+        const Vector2<F> destination(positions[i].x, positions[i].y);
+        max_error = MAX(max_error, fabs(get_bearing_rad<P>(origin, destination) - exact));
+    }
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            const Vector2<F> destination(positions[i].x, positions[i].y);
+            F bearing = get_bearing_rad<P>(origin, destination);
+            gbenchmark_escape(&bearing);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+    state.counters["max_error"] = max_error;
+}
+
+#define BM_PRECISION(bm) \
+    BENCHMARK_TEMPLATE(bm, PrecisionFast); \
+    BENCHMARK_TEMPLATE(bm, PrecisionFloat); \
+    BENCHMARK_TEMPLATE(bm, PrecisionDouble)
+
+BM_PRECISION(BM_QuaternionEulerRoundTrip);
+BM_PRECISION(BM_Matrix3EulerRoundTrip);
+BM_PRECISION(BM_QuaternionNormalize);
+BM_PRECISION(BM_SqrtController);
+BM_PRECISION(BM_Bearing);
+
+BENCHMARK_MAIN();
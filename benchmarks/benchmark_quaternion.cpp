@@ -0,0 +1,155 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/quaternion_batch.h>
+
+#include "benchmark_common.h"
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define BM_NUM_SAMPLES 1024
+
+static Quaternion quat[BM_NUM_SAMPLES];
+static Vector3f vec[BM_NUM_SAMPLES];
+static float q1[BM_NUM_SAMPLES], q2[BM_NUM_SAMPLES], q3[BM_NUM_SAMPLES], q4[BM_NUM_SAMPLES];
+static QuaternionSoA<float> quat_soa{q1, q2, q3, q4};
+static float vx[BM_NUM_SAMPLES], vy[BM_NUM_SAMPLES], vz[BM_NUM_SAMPLES];
+static Vector3SoA<float> vec_soa{vx, vy, vz};
+
+static void setup_samples()
+{
+    BenchmarkRandom rand;
+    for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+        quat[i] = Quaternion(rand.next_float(), rand.next_float(), rand.next_float(), rand.next_float());
+        quat[i].normalize();
+        vec[i] = Vector3f(rand.next_float(), rand.next_float(), rand.next_float()) * 10;
+    }
+    quat_soa.pack(quat, BM_NUM_SAMPLES);
+    vec_soa.pack(vec, BM_NUM_SAMPLES);
+}
+
+// the previous earth_to_body(), through a rotation matrix per vector
+static void BM_RotateViaMatrix(benchmark::State& state)
+{
+    setup_samples();
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            Matrix3f m;
+            quat[0].rotation_matrix(m);
+            vec[i] = m * vec[i];
+        }
+        gbenchmark_escape(vec);
+    }
+}
+
+static void BM_EarthToBody(benchmark::State& state)
+{
+    setup_samples();
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            quat[0].earth_to_body(vec[i]);
+        }
+        gbenchmark_escape(vec);
+    }
+}
+
+static void BM_BodyToEarth(benchmark::State& state)
+{
+    setup_samples();
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            quat[0].body_to_earth(vec[i]);
+        }
+        gbenchmark_escape(vec);
+    }
+}
+
+static void BM_EarthToBodyBatch(benchmark::State& state)
+{
+    setup_samples();
+    while (state.KeepRunning()) {
+        earth_to_body(quat[0], vec, BM_NUM_SAMPLES);
+        gbenchmark_escape(vec);
+    }
+}
+
+static void BM_EarthToBodyBatchSoA(benchmark::State& state)
+{
+    setup_samples();
+    while (state.KeepRunning()) {
+        earth_to_body(quat[0], vec_soa, vec_soa, BM_NUM_SAMPLES);
+        gbenchmark_escape(vx);
+    }
+}
+
+static void BM_EarthToBodyPerSampleSoA(benchmark::State& state)
+{
+    setup_samples();
+    while (state.KeepRunning()) {
+        earth_to_body(quat_soa, vec_soa, vec_soa, BM_NUM_SAMPLES);
+        gbenchmark_escape(vx);
+    }
+}
+
+static void BM_FromEuler(benchmark::State& state)
+{
+    setup_samples();
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            quat[i].from_euler(vec[i]);
+        }
+        gbenchmark_escape(quat);
+    }
+}
+
+static void BM_FromEulerFast(benchmark::State& state)
+{
+    setup_samples();
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            quat[i].from_euler_fast(vec[i].x, vec[i].y, vec[i].z);
+        }
+        gbenchmark_escape(quat);
+    }
+}
+
+static void BM_FromEulerBatch(benchmark::State& state)
+{
+    setup_samples();
+    while (state.KeepRunning()) {
+        from_euler(vec_soa, quat_soa, BM_NUM_SAMPLES);
+        gbenchmark_escape(q1);
+    }
+}
+
+static void BM_FromEulerBatchFast(benchmark::State& state)
+{
+    setup_samples();
+    while (state.KeepRunning()) {
+        from_euler_fast(vec_soa, quat_soa, BM_NUM_SAMPLES);
+        gbenchmark_escape(q1);
+    }
+}
+
+static void BM_MatrixFromEulerBatchFast(benchmark::State& state)
+{
+    setup_samples();
+    static Matrix3f m[BM_NUM_SAMPLES];
+    while (state.KeepRunning()) {
+        from_euler_fast(vec_soa, m, BM_NUM_SAMPLES);
+        gbenchmark_escape(m);
+    }
+}
+
+BENCHMARK(BM_RotateViaMatrix);
+BENCHMARK(BM_EarthToBody);
+BENCHMARK(BM_BodyToEarth);
+BENCHMARK(BM_EarthToBodyBatch);
+BENCHMARK(BM_EarthToBodyBatchSoA);
+BENCHMARK(BM_EarthToBodyPerSampleSoA);
+BENCHMARK(BM_FromEuler);
+BENCHMARK(BM_FromEulerFast);
+BENCHMARK(BM_FromEulerBatch);
+BENCHMARK(BM_FromEulerBatchFast);
+BENCHMARK(BM_MatrixFromEulerBatchFast);
+
+BENCHMARK_MAIN();
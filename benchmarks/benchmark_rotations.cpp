@@ -0,0 +1,84 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define BM_NUM_SAMPLES 1024
+
+// in a random order, so the branch predictor can't learn the sequence
+static enum Rotation rotation[BM_NUM_SAMPLES];
+
+static void setup_rotations()
+{
+    for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+        rotation[i] = (enum Rotation)(get_random16() % ROTATION_MAX);
+    }
+}
+
+// the previous Matrix3::from_rotation(), rotating the basis through the Vector3::rotate() switch
+static void BM_Matrix3FromRotationSwitch(benchmark::State& state)
+{
+    setup_rotations();
+    Matrix3f m;
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            m.a = {1,0,0};
+            m.b = {0,1,0};
+            m.c = {0,0,1};
+            m.a.rotate(rotation[i]);
+            m.b.rotate(rotation[i]);
+            m.c.rotate(rotation[i]);
+            m.transpose();
+            gbenchmark_escape(&m);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+}
+
+static void BM_Matrix3FromRotation(benchmark::State& state)
+{
+    setup_rotations();
+    Matrix3f m;
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            m.from_rotation(rotation[i]);
+            gbenchmark_escape(&m);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+}
+
+static void BM_QuaternionFromRotation(benchmark::State& state)
+{
+    setup_rotations();
+    Quaternion q;
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            q.from_rotation(rotation[i]);
+            gbenchmark_escape(&q);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+}
+
+static void BM_QuaternionRotate(benchmark::State& state)
+{
+    setup_rotations();
+    Quaternion q;
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SAMPLES; i++) {
+            q.rotate(rotation[i]);
+        }
+        q.normalize();
+        gbenchmark_escape(&q);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+}
+
+BENCHMARK(BM_Matrix3FromRotationSwitch);
+BENCHMARK(BM_Matrix3FromRotation);
+BENCHMARK(BM_QuaternionFromRotation);
+BENCHMARK(BM_QuaternionRotate);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,105 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/sample_log.h>
+
+#include <stdio.h>
+
+#include "benchmark_common.h"
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define BM_NUM_SAMPLES (1 << 20)
+
+static const char *path = "benchmark_sample_log.bin";
+
+static void write_log()
+{
+    static float gyro[3][BM_NUM_SAMPLES];
+    static float att[4][BM_NUM_SAMPLES];
+    BenchmarkRandom random;
+    for (uint32_t i = 0; i < BM_NUM_SAMPLES; i++) {
+        gyro[0][i] = random.next_float();
+        gyro[1][i] = random.next_float();
+        gyro[2][i] = random.next_float();
+        QuaternionF q;
+        q.from_euler(random.next_float(), random.next_float(), random.next_float(-M_PI, M_PI));
+        att[0][i] = q.q1;
+        att[1][i] = q.q2;
+        att[2][i] = q.q3;
+        att[3][i] = q.q4;
+    }
+    SampleLogWriter writer(BM_NUM_SAMPLES);
+    if (!writer.add_column("gyro", Vector3SoA<float>(gyro[0], gyro[1], gyro[2])) ||
+        !writer.add_column("att", QuaternionSoA<float>(att[0], att[1], att[2], att[3])) ||
+        !writer.write(path)) {
+        abort();
+    }
+}
+
+/*
+  rotate every gyro sample of a log to earth frame in place. The first
+  argument is the chunk size in samples, the second the number of
+  chunks read ahead. The file was just written so it is in the page
+  cache, where faulting pages in costs more than copying them; the map
+  wins once the log doesn't fit in memory
+ */
+static void BM_SampleLogBodyToEarth(benchmark::State& state)
+{
+    write_log();
+    SampleLogReader reader;
+    Vector3SoA<float> g;
+    QuaternionSoA<float> q;
+    while (state.KeepRunning()) {
+        if (!reader.open(path) || !reader.get_view("gyro", g) || !reader.get_view("att", q)) {
+            state.SkipWithError("can't read log");
+            break;
+        }
+        reader.for_each_chunk(state.range(0), state.range(1), [&](uint32_t start, uint32_t count) {
+            body_to_earth(q.offset(start), g.offset(start), g.offset(start), count);
+            gbenchmark_escape(g.x + start);
+        });
+        reader.close();
+    }
+    remove(path);
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+    state.SetBytesProcessed(state.iterations() * BM_NUM_SAMPLES * 7 * sizeof(float));
+}
+
+// the same with the whole log copied into memory first
+static void BM_SampleLogBodyToEarthCopy(benchmark::State& state)
+{
+    write_log();
+    static float g[3][BM_NUM_SAMPLES];
+    static float q[4][BM_NUM_SAMPLES];
+    while (state.KeepRunning()) {
+        FILE *f = fopen(path, "rb");
+        if (f == nullptr) {
+            state.SkipWithError("can't read log");
+            break;
+        }
+        SampleLogHeader header;
+        SampleLogColumn columns[2];
+        bool ok = fread(&header, sizeof(header), 1, f) == 1 && fread(columns, sizeof(columns), 1, f) == 1;
+        fseek(f, columns[0].offset, SEEK_SET);
+        ok = ok && fread(g, sizeof(g), 1, f) == 1;
+        fseek(f, columns[1].offset, SEEK_SET);
+        ok = ok && fread(q, sizeof(q), 1, f) == 1;
+        fclose(f);
+        if (!ok) {
+            state.SkipWithError("can't read log");
+            break;
+        }
+        const Vector3SoA<float> gyro(g[0], g[1], g[2]);
+        body_to_earth(QuaternionSoA<float>(q[0], q[1], q[2], q[3]), gyro, gyro, BM_NUM_SAMPLES);
+        gbenchmark_escape(g);
+    }
+    remove(path);
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+    state.SetBytesProcessed(state.iterations() * BM_NUM_SAMPLES * 7 * sizeof(float));
+}
+
+BENCHMARK(BM_SampleLogBodyToEarth)->Args({4096, 0})->Args({65536, 0})->Args({65536, 4})->Args({BM_NUM_SAMPLES, 0});
+BENCHMARK(BM_SampleLogBodyToEarthCopy);
+
+BENCHMARK_MAIN();
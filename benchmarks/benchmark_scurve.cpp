@@ -0,0 +1,66 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/SCurve.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// a 400Hz position controller
+#define BM_DT 0.0025f
+
+static void calculate_leg(SCurve &leg, const Vector3f &origin, const Vector3f &destination)
+{
+    leg.calculate_track(origin, destination, 10.0f, 2.5f, 1.5f, 2.5f, 1.0f, 15.0f, 5.0f);
+}
+
+static void BM_SCurveCalculateTrack(benchmark::State& state)
+{
+    SCurve leg;
+    while (state.KeepRunning()) {
+        calculate_leg(leg, Vector3f(), Vector3f(1000, 500, 50));
+        gbenchmark_escape(&leg);
+    }
+}
+
+/*
+  fly a 3 leg mission, counting each advance_target_along_track() call
+  as an operation
+ */
+static void BM_SCurveAdvanceTargetAlongTrack(benchmark::State& state)
+{
+    const Vector3f wp[4] { Vector3f(), Vector3f(300, 0, 20), Vector3f(300, 300, 20), Vector3f(0, 300, 0) };
+    uint64_t steps = 0;
+    while (state.KeepRunning()) {
+        SCurve prev_leg, this_leg, next_leg;
+        calculate_leg(this_leg, wp[0], wp[1]);
+        calculate_leg(next_leg, wp[1], wp[2]);
+        Vector3f target_pos, target_vel, target_accel;
+        for (uint8_t leg = 0; leg < 3; leg++) {
+            // the last leg stops at its destination
+            const bool fast_waypoint = leg < 2;
+            bool leg_finished = false;
+            while (!leg_finished) {
+                // positions are relative to the leg origin
+                target_pos.zero();
+                target_vel.zero();
+                target_accel.zero();
+                leg_finished = this_leg.advance_target_along_track(prev_leg, next_leg, 2.0f, 5.0f, fast_waypoint, BM_DT, target_pos, target_vel, target_accel);
+                steps++;
+            }
+            prev_leg = this_leg;
+            this_leg = next_leg;
+            if (leg < 1) {
+                calculate_leg(next_leg, wp[leg + 2], wp[leg + 3]);
+            } else {
+                next_leg.init();
+            }
+        }
+        gbenchmark_escape(&target_pos);
+    }
+    state.SetItemsProcessed(steps);
+}
+
+BENCHMARK(BM_SCurveCalculateTrack);
+BENCHMARK(BM_SCurveAdvanceTargetAlongTrack);
+
+BENCHMARK_MAIN();
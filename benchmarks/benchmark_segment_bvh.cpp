@@ -0,0 +1,114 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/segment_bvh.h>
+
+#include "benchmark_common.h"
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define BM_NUM_SEGMENTS 100000
+
+static Vector3f start_v[BM_NUM_SEGMENTS], end_v[BM_NUM_SEGMENTS];
+
+static void setup_segments()
+{
+    BenchmarkRandom rand;
+    for (uint32_t i = 0; i < BM_NUM_SEGMENTS; i++) {
+        start_v[i] = Vector3f(rand.next_float(), rand.next_float(), rand.next_float() * 0.1f) * 10000;
+        end_v[i] = start_v[i] + Vector3f(rand.next_float(), rand.next_float(), rand.next_float()) * 50;
+    }
+}
+
+static Vector3f rand_point(BenchmarkRandom &rand)
+{
+    return Vector3f(rand.next_float(), rand.next_float(), rand.next_float() * 0.1f) * 10000;
+}
+
+static void BM_SegmentBVHBuild(benchmark::State& state)
+{
+    setup_segments();
+    SegmentBVH bvh;
+    while (state.KeepRunning()) {
+        bvh.build(start_v, end_v, BM_NUM_SEGMENTS);
+        gbenchmark_escape(&bvh);
+    }
+}
+
+static void BM_SegmentBVHNearest(benchmark::State& state)
+{
+    // query points from a different sequence to the segments
+    BenchmarkRandom rand(0x9E3779B9);
+    setup_segments();
+    SegmentBVH bvh;
+    bvh.build(start_v, end_v, BM_NUM_SEGMENTS);
+    uint32_t index;
+    float dist;
+    while (state.KeepRunning()) {
+        const Vector3f p = rand_point(rand);
+        bvh.nearest(p, index, dist);
+        gbenchmark_escape(&index);
+    }
+}
+
+static void BM_SegmentBVHNearestToSegment(benchmark::State& state)
+{
+    // query points from a different sequence to the segments
+    BenchmarkRandom rand(0x9E3779B9);
+    setup_segments();
+    SegmentBVH bvh;
+    bvh.build(start_v, end_v, BM_NUM_SEGMENTS);
+    uint32_t index;
+    float dist;
+    while (state.KeepRunning()) {
+        const Vector3f p = rand_point(rand);
+        bvh.nearest_to_segment(p, p + Vector3f(100, 0, 0), index, dist);
+        gbenchmark_escape(&index);
+    }
+}
+
+static void BM_SegmentBVHRadius(benchmark::State& state)
+{
+    // query points from a different sequence to the segments
+    BenchmarkRandom rand(0x9E3779B9);
+    setup_segments();
+    SegmentBVH bvh;
+    bvh.build(start_v, end_v, BM_NUM_SEGMENTS);
+    uint32_t indices[256];
+    while (state.KeepRunning()) {
+        const Vector3f p = rand_point(rand);
+        uint32_t n = bvh.within_radius(p, 200, indices, ARRAY_SIZE(indices));
+        gbenchmark_escape(&n);
+    }
+}
+
+// linear scan for comparison
+static void BM_SegmentNearestBruteForce(benchmark::State& state)
+{
+    // query points from a different sequence to the segments
+    BenchmarkRandom rand(0x9E3779B9);
+    setup_segments();
+    static float sx[BM_NUM_SEGMENTS], sy[BM_NUM_SEGMENTS], sz[BM_NUM_SEGMENTS];
+    static float ex[BM_NUM_SEGMENTS], ey[BM_NUM_SEGMENTS], ez[BM_NUM_SEGMENTS];
+    Segment3SoA<float> seg{{sx, sy, sz}, {ex, ey, ez}};
+    seg.start.pack(start_v, BM_NUM_SEGMENTS);
+    seg.end.pack(end_v, BM_NUM_SEGMENTS);
+    float px, py, pz;
+    float dist;
+    uint32_t index;
+    while (state.KeepRunning()) {
+        const Vector3f p = rand_point(rand);
+        px = p.x;
+        py = p.y;
+        pz = p.z;
+        points_segments_nearest(Vector3SoA<float>(&px, &py, &pz), 1, seg, BM_NUM_SEGMENTS, &dist, &index);
+        gbenchmark_escape(&index);
+    }
+}
+
+BENCHMARK(BM_SegmentBVHBuild);
+BENCHMARK(BM_SegmentBVHNearest);
+BENCHMARK(BM_SegmentBVHNearestToSegment);
+BENCHMARK(BM_SegmentBVHRadius);
+BENCHMARK(BM_SegmentNearestBruteForce);
+
+BENCHMARK_MAIN();
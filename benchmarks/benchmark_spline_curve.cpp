@@ -0,0 +1,49 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/SplineCurve.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// a 400Hz position controller
+#define BM_DT 0.0025f
+
+static void setup_spline(SplineCurve &spline)
+{
+    spline.set_speed_accel(10.0f, 2.5f, 1.5f, 2.5f, 1.0f);
+    spline.set_origin_and_destination(Vector3f(), Vector3f(300, 200, 20), Vector3f(5, 0, 0), Vector3f(0, 5, 0));
+}
+
+static void BM_SplineCurveSetOriginAndDestination(benchmark::State& state)
+{
+    SplineCurve spline;
+    while (state.KeepRunning()) {
+        setup_spline(spline);
+        gbenchmark_escape(&spline);
+    }
+}
+
+/*
+  fly the spline to its destination, counting each
+  advance_target_along_track() call as an operation
+ */
+static void BM_SplineCurveAdvanceTargetAlongTrack(benchmark::State& state)
+{
+    uint64_t steps = 0;
+    while (state.KeepRunning()) {
+        SplineCurve spline;
+        setup_spline(spline);
+        Vector3f target_pos, target_vel;
+        while (!spline.reached_destination()) {
+            spline.advance_target_along_track(BM_DT, target_pos, target_vel);
+            steps++;
+        }
+        gbenchmark_escape(&target_pos);
+    }
+    state.SetItemsProcessed(steps);
+}
+
+BENCHMARK(BM_SplineCurveSetOriginAndDestination);
+BENCHMARK(BM_SplineCurveAdvanceTargetAlongTrack);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,85 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/matrix_batch.h>
+#include <AP_Math/thread_pool.h>
+
+#include "benchmark_common.h"
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define BM_NUM_POINTS 1024
+#define BM_NUM_SEGMENTS 1024
+#define BM_NUM_MATRICES 16384
+
+/*
+  the argument is the number of threads. Without
+  AP_MATH_THREAD_POOL_ENABLED every run is serial
+ */
+
+// cost of handing a call to the workers and waiting for them
+static void BM_ThreadPoolEmptyCall(benchmark::State& state)
+{
+    MathThreadPool pool(state.range(0));
+    while (state.KeepRunning()) {
+        pool.parallel_for(0, 64, 1, [](uint32_t start, uint32_t end) {
+            gbenchmark_escape(&start);
+            gbenchmark_escape(&end);
+        });
+    }
+}
+
+static void BM_PointsSegmentsNearest(benchmark::State& state)
+{
+    static float p[3][BM_NUM_POINTS];
+    static float s[6][BM_NUM_SEGMENTS];
+    BenchmarkRandom random;
+    for (auto &a : p) {
+        for (float &v : a) {
+            v = random.next_float(-100, 100);
+        }
+    }
+    for (auto &a : s) {
+        for (float &v : a) {
+            v = random.next_float(-100, 100);
+        }
+    }
+    const Vector3SoA<float> points(p[0], p[1], p[2]);
+    const Segment3SoA<float> seg { Vector3SoA<float>(s[0], s[1], s[2]), Vector3SoA<float>(s[3], s[4], s[5]) };
+    static float min_dist[BM_NUM_POINTS];
+    static uint32_t index[BM_NUM_POINTS];
+
+    MathThreadPool::get_shared().set_threads(state.range(0));
+    while (state.KeepRunning()) {
+        points_segments_nearest(points, BM_NUM_POINTS, seg, BM_NUM_SEGMENTS, min_dist, index);
+        gbenchmark_escape(min_dist);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_POINTS * BM_NUM_SEGMENTS);
+}
+
+static void BM_MatSvd(benchmark::State& state)
+{
+    static float m[9 * BM_NUM_MATRICES];
+    static float u[9 * BM_NUM_MATRICES];
+    static float s[3 * BM_NUM_MATRICES];
+    static float v[9 * BM_NUM_MATRICES];
+    BenchmarkRandom random;
+    for (float &e : m) {
+        e = random.next_float();
+    }
+
+    MathThreadPool::get_shared().set_threads(state.range(0));
+    while (state.KeepRunning()) {
+        mat_svd(MatrixSoA<float,3>(m, BM_NUM_MATRICES), MatrixSoA<float,3>(u, BM_NUM_MATRICES),
+                Vector3SoA<float>(s, s + BM_NUM_MATRICES, s + 2 * BM_NUM_MATRICES),
+                MatrixSoA<float,3>(v, BM_NUM_MATRICES), BM_NUM_MATRICES);
+        gbenchmark_escape(s);
+    }
+    state.SetItemsProcessed(state.iterations() * BM_NUM_MATRICES);
+}
+
+BENCHMARK(BM_ThreadPoolEmptyCall)->Arg(1)->Arg(2)->Arg(4);
+BENCHMARK(BM_PointsSegmentsNearest)->Arg(1)->Arg(2)->Arg(4);
+BENCHMARK(BM_MatSvd)->Arg(1)->Arg(2)->Arg(4);
+
+BENCHMARK_MAIN();
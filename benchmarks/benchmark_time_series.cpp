@@ -0,0 +1,115 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/time_series.h>
+
+#include <stdio.h>
+
+#include "benchmark_common.h"
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define BM_NUM_SAMPLES (1 << 17)
+
+static const char *path = "benchmark_time_series.bin";
+
+// bytes of a sample without compression
+static const uint32_t raw_sample_size = sizeof(uint64_t) + 7 * sizeof(float) + 3 * sizeof(double);
+
+// a smooth trajectory at 400Hz with a little noise
+static bool write_series(uint32_t block_samples)
+{
+    BenchmarkRandom random;
+    TimeSeriesWriter writer(block_samples);
+    const int16_t c_pos = writer.add_column("pos", SampleLogType::FLOAT, 3);
+    const int16_t c_pos_d = writer.add_column("pos_d", SampleLogType::DOUBLE, 3);
+    const int16_t c_att = writer.add_column("att", SampleLogType::FLOAT, 4);
+    if (!writer.open(path)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < BM_NUM_SAMPLES; i++) {
+        const float s = i * 0.0025f;
+        QuaternionF q;
+        q.from_euler(0.1f * sinf(s), 0.05f + random.next_float(-0.001f, 0.001f), wrap_PI(s));
+        if (!writer.append(1000000 + i * 2500ULL)) {
+            return false;
+        }
+        writer.set(c_pos, Vector3f(10 * cosf(s), 10 * sinf(s), -5 - s));
+        writer.set(c_pos_d, Vector3d(-35.363261 + s * 1e-6, 149.165230, 584.0 + s));
+        writer.set(c_att, q);
+    }
+    return writer.close();
+}
+
+// the argument is the number of samples per block
+static void BM_TimeSeriesWrite(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        if (!write_series(state.range(0))) {
+            state.SkipWithError("can't write series");
+            break;
+        }
+    }
+    FILE *f = fopen(path, "rb");
+    if (f != nullptr) {
+        fseek(f, 0, SEEK_END);
+        state.counters["compression"] = double(BM_NUM_SAMPLES) * raw_sample_size / ftell(f);
+        fclose(f);
+    }
+    remove(path);
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+    state.SetBytesProcessed(state.iterations() * BM_NUM_SAMPLES * raw_sample_size);
+}
+
+static void BM_TimeSeriesRead(benchmark::State& state)
+{
+    if (!write_series(state.range(0))) {
+        state.SkipWithError("can't write series");
+        return;
+    }
+    TimeSeriesReader reader;
+    while (state.KeepRunning()) {
+        if (!reader.open(path)) {
+            state.SkipWithError("can't read series");
+            break;
+        }
+        while (reader.read_block()) {
+            gbenchmark_escape(reader.get_block_time_us());
+        }
+        reader.close();
+    }
+    remove(path);
+    state.SetItemsProcessed(state.iterations() * BM_NUM_SAMPLES);
+    state.SetBytesProcessed(state.iterations() * BM_NUM_SAMPLES * raw_sample_size);
+}
+
+// random access, one seek per iteration
+static void BM_TimeSeriesSeek(benchmark::State& state)
+{
+    if (!write_series(state.range(0))) {
+        state.SkipWithError("can't write series");
+        return;
+    }
+    TimeSeriesReader reader;
+    if (!reader.open(path)) {
+        state.SkipWithError("can't read series");
+        return;
+    }
+    BenchmarkRandom random;
+    while (state.KeepRunning()) {
+        const uint64_t time_us = 1000000 + (random.next() % BM_NUM_SAMPLES) * 2500ULL;
+        if (!reader.seek(time_us)) {
+            state.SkipWithError("seek failed");
+            break;
+        }
+        gbenchmark_escape(reader.get_block_time_us());
+    }
+    reader.close();
+    remove(path);
+}
+
+BENCHMARK(BM_TimeSeriesWrite)->Arg(256)->Arg(4096);
+BENCHMARK(BM_TimeSeriesRead)->Arg(256)->Arg(4096);
+BENCHMARK(BM_TimeSeriesSeek)->Arg(256)->Arg(4096);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,86 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  representative position controller expressions, written with the
+  vector operators and with the fused helpers
+ */
+
+static void BM_Vector3OperatorChain(benchmark::State& state)
+{
+    Vector3f pos{1, 2, 3}, vel{0.1f, -0.2f, 0.3f}, accel{0.01f, 0.02f, -0.03f};
+    const Vector3f omega{0.001f, 0.002f, 0.003f};
+    const float dt = 0.0025f;
+
+    while (state.KeepRunning()) {
+        pos += vel * dt + accel * (0.5f * sq(dt));
+        vel += accel * dt - omega % vel;
+        gbenchmark_escape(&pos);
+        gbenchmark_escape(&vel);
+    }
+}
+
+static void BM_Vector3FusedChain(benchmark::State& state)
+{
+    Vector3f pos{1, 2, 3}, vel{0.1f, -0.2f, 0.3f}, accel{0.01f, 0.02f, -0.03f};
+    const Vector3f omega{0.001f, 0.002f, 0.003f};
+    const float dt = 0.0025f;
+
+    while (state.KeepRunning()) {
+        pos.axpy(dt, vel).axpy(0.5f * sq(dt), accel);
+        vel.cross_add(vel, omega).axpy(dt, accel);
+        gbenchmark_escape(&pos);
+        gbenchmark_escape(&vel);
+    }
+}
+
+static void BM_Vector3Lerp(benchmark::State& state)
+{
+    const Vector3f a{1, 2, 3}, b{-4, 5, 6};
+    float t = 0;
+
+    while (state.KeepRunning()) {
+        t = t > 1 ? 0 : t + 0.001f;
+        Vector3f v = Vector3f::lerp(a, b, t);
+        gbenchmark_escape(&v);
+    }
+}
+
+static void BM_Vector2OperatorChain(benchmark::State& state)
+{
+    Vector2f pos{1, 2}, vel{0.1f, -0.2f};
+    const Vector2f accel{0.01f, 0.02f};
+    const float dt = 0.0025f;
+
+    while (state.KeepRunning()) {
+        pos += vel * dt + accel * (0.5f * sq(dt));
+        vel += accel * dt;
+        gbenchmark_escape(&pos);
+        gbenchmark_escape(&vel);
+    }
+}
+
+static void BM_Vector2FusedChain(benchmark::State& state)
+{
+    Vector2f pos{1, 2}, vel{0.1f, -0.2f};
+    const Vector2f accel{0.01f, 0.02f};
+    const float dt = 0.0025f;
+
+    while (state.KeepRunning()) {
+        pos.axpy(dt, vel).axpy(0.5f * sq(dt), accel);
+        vel.axpy(dt, accel);
+        gbenchmark_escape(&pos);
+        gbenchmark_escape(&vel);
+    }
+}
+
+BENCHMARK(BM_Vector3OperatorChain);
+BENCHMARK(BM_Vector3FusedChain);
+BENCHMARK(BM_Vector3Lerp);
+BENCHMARK(BM_Vector2OperatorChain);
+BENCHMARK(BM_Vector2FusedChain);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,104 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/vector2_batch.h>
+
+#include "benchmark_common.h"
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define BM_NUM_SEGMENTS 4096
+
+static Vector2f start_v[BM_NUM_SEGMENTS], end_v[BM_NUM_SEGMENTS];
+static float sx[BM_NUM_SEGMENTS], sy[BM_NUM_SEGMENTS];
+static float ex[BM_NUM_SEGMENTS], ey[BM_NUM_SEGMENTS];
+static Segment2SoA<float> seg{{sx, sy}, {ex, ey}};
+static float ox[BM_NUM_SEGMENTS], oy[BM_NUM_SEGMENTS];
+static Vector2SoA<float> out{ox, oy};
+static Vector2f out_v[BM_NUM_SEGMENTS];
+static bool hit[BM_NUM_SEGMENTS];
+
+static void setup_segments()
+{
+    BenchmarkRandom rand;
+    for (uint16_t i = 0; i < BM_NUM_SEGMENTS; i++) {
+        start_v[i] = Vector2f(rand.next_float(), rand.next_float()) * 1000;
+        end_v[i] = start_v[i] + Vector2f(rand.next_float(), rand.next_float()) * 200;
+    }
+    seg.start.pack(start_v, BM_NUM_SEGMENTS);
+    seg.end.pack(end_v, BM_NUM_SEGMENTS);
+}
+
+static void BM_SegmentIntersectionScalar(benchmark::State& state)
+{
+    setup_segments();
+    const Vector2f s1{-500, -300}, e1{400, 600};
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SEGMENTS; i++) {
+            hit[i] = Vector2f::segment_intersection(s1, e1, start_v[i], end_v[i], out_v[i]);
+        }
+        gbenchmark_escape(hit);
+    }
+}
+
+static void BM_SegmentIntersectionBatch(benchmark::State& state)
+{
+    setup_segments();
+    const Vector2f s1{-500, -300}, e1{400, 600};
+    while (state.KeepRunning()) {
+        segment_intersection(s1, e1, seg, out, hit, BM_NUM_SEGMENTS);
+        gbenchmark_escape(hit);
+    }
+}
+
+static void BM_CircleSegmentScalar(benchmark::State& state)
+{
+    setup_segments();
+    const Vector2f center{100, 200};
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SEGMENTS; i++) {
+            hit[i] = Vector2f::circle_segment_intersection(start_v[i], end_v[i], center, 300, out_v[i]);
+        }
+        gbenchmark_escape(hit);
+    }
+}
+
+static void BM_CircleSegmentBatch(benchmark::State& state)
+{
+    setup_segments();
+    const Vector2f center{100, 200};
+    while (state.KeepRunning()) {
+        circle_segment_intersection(seg, center, 300.0f, out, hit, BM_NUM_SEGMENTS);
+        gbenchmark_escape(hit);
+    }
+}
+
+static void BM_ClosestPointScalar(benchmark::State& state)
+{
+    setup_segments();
+    const Vector2f p{100, 200};
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SEGMENTS; i++) {
+            out_v[i] = Vector2f::closest_point(p, start_v[i], end_v[i]);
+        }
+        gbenchmark_escape(out_v);
+    }
+}
+
+static void BM_ClosestPointBatch(benchmark::State& state)
+{
+    setup_segments();
+    const Vector2f p{100, 200};
+    while (state.KeepRunning()) {
+        closest_point(p, seg, out, BM_NUM_SEGMENTS);
+        gbenchmark_escape(ox);
+    }
+}
+
+BENCHMARK(BM_SegmentIntersectionScalar);
+BENCHMARK(BM_SegmentIntersectionBatch);
+BENCHMARK(BM_CircleSegmentScalar);
+BENCHMARK(BM_CircleSegmentBatch);
+BENCHMARK(BM_ClosestPointScalar);
+BENCHMARK(BM_ClosestPointBatch);
+
+BENCHMARK_MAIN();
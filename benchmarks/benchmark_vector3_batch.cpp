@@ -0,0 +1,97 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/vector3_batch.h>
+
+#include "benchmark_common.h"
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define BM_NUM_SEGMENTS 2048
+#define BM_NUM_POINTS 16
+
+static Vector3f start_v[BM_NUM_SEGMENTS], end_v[BM_NUM_SEGMENTS];
+static float sx[BM_NUM_SEGMENTS], sy[BM_NUM_SEGMENTS], sz[BM_NUM_SEGMENTS];
+static float ex[BM_NUM_SEGMENTS], ey[BM_NUM_SEGMENTS], ez[BM_NUM_SEGMENTS];
+static Segment3SoA<float> seg{{sx, sy, sz}, {ex, ey, ez}};
+static Vector3f points_v[BM_NUM_POINTS];
+static float px[BM_NUM_POINTS], py[BM_NUM_POINTS], pz[BM_NUM_POINTS];
+static Vector3SoA<float> points{px, py, pz};
+
+static void setup_segments()
+{
+    BenchmarkRandom rand;
+    for (uint16_t i = 0; i < BM_NUM_SEGMENTS; i++) {
+        start_v[i] = Vector3f(rand.next_float(), rand.next_float(), rand.next_float()) * 1000;
+        end_v[i] = start_v[i] + Vector3f(rand.next_float(), rand.next_float(), rand.next_float()) * 50;
+    }
+    seg.start.pack(start_v, BM_NUM_SEGMENTS);
+    seg.end.pack(end_v, BM_NUM_SEGMENTS);
+    for (uint16_t p = 0; p < BM_NUM_POINTS; p++) {
+        points_v[p] = Vector3f(rand.next_float(), rand.next_float(), rand.next_float()) * 1000;
+    }
+    points.pack(points_v, BM_NUM_POINTS);
+}
+
+static void BM_ClosestDistanceScalar(benchmark::State& state)
+{
+    setup_segments();
+    static float dist[BM_NUM_SEGMENTS];
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SEGMENTS; i++) {
+            dist[i] = Vector3f::closest_distance_between_line_and_point(start_v[i], end_v[i], points_v[0]);
+        }
+        gbenchmark_escape(dist);
+    }
+}
+
+static void BM_ClosestDistanceBatch(benchmark::State& state)
+{
+    setup_segments();
+    static float dist[BM_NUM_SEGMENTS];
+    while (state.KeepRunning()) {
+        closest_distance_between_line_and_point(seg, points_v[0], dist, BM_NUM_SEGMENTS);
+        gbenchmark_escape(dist);
+    }
+}
+
+static void BM_SegmentToSegmentScalar(benchmark::State& state)
+{
+    setup_segments();
+    static Vector3f closest[BM_NUM_SEGMENTS];
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BM_NUM_SEGMENTS; i++) {
+            Vector3f::segment_to_segment_closest_point(points_v[0], points_v[1], start_v[i], end_v[i], closest[i]);
+        }
+        gbenchmark_escape(closest);
+    }
+}
+
+static void BM_SegmentToSegmentBatch(benchmark::State& state)
+{
+    setup_segments();
+    static float cx[BM_NUM_SEGMENTS], cy[BM_NUM_SEGMENTS], cz[BM_NUM_SEGMENTS];
+    const Vector3SoA<float> closest{cx, cy, cz};
+    while (state.KeepRunning()) {
+        segment_to_segment_closest_point(points_v[0], points_v[1], seg, closest, BM_NUM_SEGMENTS);
+        gbenchmark_escape(cx);
+    }
+}
+
+static void BM_PointsSegmentsNearest(benchmark::State& state)
+{
+    setup_segments();
+    float min_dist[BM_NUM_POINTS];
+    uint32_t index[BM_NUM_POINTS];
+    while (state.KeepRunning()) {
+        points_segments_nearest(points, BM_NUM_POINTS, seg, BM_NUM_SEGMENTS, min_dist, index);
+        gbenchmark_escape(min_dist);
+    }
+}
+
+BENCHMARK(BM_ClosestDistanceScalar);
+BENCHMARK(BM_ClosestDistanceBatch);
+BENCHMARK(BM_SegmentToSegmentScalar);
+BENCHMARK(BM_SegmentToSegmentBatch);
+BENCHMARK(BM_PointsSegmentsNearest);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+'''
+compare benchmark results against a stored baseline
+
+Each benchmark_*.cpp builds to its own binary. Record a run of each as
+JSON with
+
+  benchmark_x --benchmark_out=x.json --benchmark_out_format=json
+
+or build and run them all with the standalone Makefile, which writes
+build/benchmark_x.json for each:
+
+  make run
+
+then compare one or more result files with a baseline:
+
+  compare_baseline.py baseline.json x.json y.json --tolerance 10
+
+Every benchmark is reported in ns/op and ops/sec. Benchmarks that set
+items processed count one op per item, the others one op per
+iteration. The exit status is 1 if any benchmark is slower than the
+baseline by more than the tolerance, in percent. With --update the
+baseline is written from the results instead, keeping any entries the
+results don't have. Baselines depend on the machine and compiler, so
+keep one per test machine.
+
+Benchmarks run with --benchmark_repetitions are compared by their median.
+'''
+
+import argparse
+import json
+import sys
+
+TIME_UNIT_NS = {'ns': 1.0, 'us': 1.0e3, 'ms': 1.0e6, 's': 1.0e9}
+
+
+def ns_per_op(entry):
+    '''ns per op of one google benchmark result entry, from cpu time like items_per_second'''
+    if entry.get('items_per_second'):
+        return 1.0e9 / entry['items_per_second']
+    return entry['cpu_time'] * TIME_UNIT_NS[entry.get('time_unit', 'ns')]
+
+
+def load_results(filenames):
+    '''ns per op by benchmark name, from google benchmark JSON files'''
+    results = {}
+    medians = {}
+    for filename in filenames:
+        with open(filename) as f:
+            data = json.load(f)
+        for entry in data['benchmarks']:
+            if entry.get('error_occurred'):
+                continue
+            name = entry.get('run_name', entry['name'])
+            if entry.get('run_type') == 'aggregate':
+                if entry.get('aggregate_name') == 'median':
+                    medians[name] = ns_per_op(entry)
+                continue
+            results[name] = ns_per_op(entry)
+    results.update(medians)
+    return results
+
+
+def load_baseline(filename):
+    try:
+        with open(filename) as f:
+            return json.load(f)
+    except FileNotFoundError:
+        return {}
+
+
+def compare(baseline, results, tolerance):
+    '''print a table of the results against the baseline, returning the regressions'''
+    regressions = []
+    width = max([len(name) for name in results] + [9])
+    print('%-*s %12s %14s %12s %8s' % (width, 'benchmark', 'ns/op', 'ops/sec', 'baseline', 'change'))
+    for name in sorted(results):
+        ns = results[name]
+        if name not in baseline:
+            print('%-*s %12.3f %14.0f %12s %8s' % (width, name, ns, 1.0e9 / ns, '-', 'new'))
+            continue
+        base = baseline[name]['ns_per_op']
+        change = 100.0 * (ns - base) / base
+        flag = ''
+        if change > tolerance:
+            regressions.append(name)
+            flag = ' REGRESSION'
+        print('%-*s %12.3f %14.0f %12.3f %+7.1f%%%s' % (width, name, ns, 1.0e9 / ns, base, change, flag))
+    for name in sorted(set(baseline) - set(results)):
+        print('%-*s %12s %14s %12.3f %8s' % (width, name, '-', '-', baseline[name]['ns_per_op'], 'missing'))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description='compare benchmark results against a baseline')
+    parser.add_argument('baseline', help='baseline JSON file')
+    parser.add_argument('results', nargs='+', help='google benchmark JSON output files')
+    parser.add_argument('--tolerance', type=float, default=10.0,
+                        help='allowed slowdown in percent (default 10)')
+    parser.add_argument('--update', action='store_true',
+                        help='write the results to the baseline instead of comparing')
+    args = parser.parse_args()
+
+    results = load_results(args.results)
+    baseline = load_baseline(args.baseline)
+
+    if args.update:
+        for name, ns in results.items():
+            baseline[name] = {'ns_per_op': ns, 'ops_per_sec': 1.0e9 / ns}
+        with open(args.baseline, 'w') as f:
+            json.dump(baseline, f, indent=2, sort_keys=True)
+            f.write('\n')
+        print('wrote %u benchmarks to %s' % (len(baseline), args.baseline))
+        return 0
+
+    regressions = compare(baseline, results, args.tolerance)
+    if regressions:
+        print('%u of %u benchmarks slower than the baseline by more than %.1f%%' %
+              (len(regressions), len(results), args.tolerance))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,3 @@
+#pragma once
+
+#define AP_CUSTOMROTATIONS_ENABLED 0
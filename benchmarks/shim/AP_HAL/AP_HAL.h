@@ -0,0 +1,27 @@
+/*
+  the part of the HAL the math library and the benchmarks use, for the
+  standalone benchmark build
+ */
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+namespace AP_HAL {
+
+class HAL {};
+
+inline const HAL &get_HAL()
+{
+    static const HAL hal;
+    return hal;
+}
+
+inline uint64_t micros64()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000ULL + uint64_t(ts.tv_nsec) / 1000U;
+}
+
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+// errors are not reported in the benchmarks
+#define INTERNAL_ERROR(error_number) do {} while (0)
@@ -0,0 +1,3 @@
+#pragma once
+
+#define APM_BUILD_COPTER_OR_HELI 0
@@ -0,0 +1,17 @@
+/*
+  stand in for AP_gbenchmark.h in the standalone benchmark build, see
+  ../Makefile
+ */
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+
+// stop the compiler optimising away the writes to a result
+template <typename T>
+inline void gbenchmark_escape(T *p)
+{
+    benchmark::DoNotOptimize(p);
+    benchmark::ClobberMemory();
+}
@@ -22,6 +22,8 @@
 #include "Embed_Math.h"
 #include "vector2.h"
 #include "vector3.h"
+#include "instrumentation.h"
+#include "precision.h"
 
 // AP_InternalError removed: provide no-op INTERNAL_ERROR and feature flag
 #ifndef AP_INTERNALERROR_ENABLED
@@ -467,35 +469,48 @@ bool limit_accel_xy(const Vector2f& vel, Vector2f& accel, float accel_max)
     return false;
 }
 
+// safe_sqrt() in precision policy P
+template <typename P>
+static typename P::type precision_safe_sqrt(typename P::type v)
+{
+    if (isgreaterequal(v, 0)) {
+        return P::sqrt(v);
+    }
+    return 0;
+}
+
 // Piecewise square-root + linear controller that limits second-order response (acceleration).
 // - Behaves like a P controller near the setpoint.
 // - Switches to sqrt(2·a·Δx) shaping beyond a threshold to limit acceleration.
 // - `second_ord_lim` sets the max acceleration allowed.
 // - Returns the constrained correction rate for a given error and gain.
-float sqrt_controller(float error, float p, float second_ord_lim, float dt)
+template <typename P>
+typename P::type sqrt_controller(typename P::type error, typename P::type p, typename P::type second_ord_lim, typename P::type dt)
 {
-    float correction_rate;
+    typedef typename P::type F;
+
+    F correction_rate;
     if (is_negative(second_ord_lim) || is_zero(second_ord_lim)) {
         // No second-order limit: use pure linear controller
         correction_rate = error * p;
     } else if (is_zero(p)) {
         // No P gain, but with acceleration limit — use sqrt-shaped response only
         if (is_positive(error)) {
-            correction_rate = safe_sqrt(2.0 * second_ord_lim * (error));
+            correction_rate = precision_safe_sqrt<P>(F(2.0 * second_ord_lim * (error)));
         } else if (is_negative(error)) {
-            correction_rate = -safe_sqrt(2.0 * second_ord_lim * (-error));
+            correction_rate = -precision_safe_sqrt<P>(F(2.0 * second_ord_lim * (-error)));
         } else {
             correction_rate = 0.0;
         }
     } else {
         // Both P and second-order limits defined — use hybrid model
-        const float linear_dist = second_ord_lim / sq(p);
+        const F linear_dist = second_ord_lim / (p * p);
         if (error > linear_dist) {
             // Positive error beyond linear region — use sqrt branch
-            correction_rate = safe_sqrt(2.0 * second_ord_lim * (error - (linear_dist / 2.0)));
+            correction_rate = precision_safe_sqrt<P>(F(2.0 * second_ord_lim * (error - (linear_dist / 2.0))));
         } else if (error < -linear_dist) {
             // Negative error beyond linear region — use sqrt branch
-            correction_rate = -safe_sqrt(2.0 * second_ord_lim * (-error - (linear_dist / 2.0)));
+            correction_rate = -precision_safe_sqrt<P>(F(2.0 * second_ord_lim * (-error - (linear_dist / 2.0))));
         } else {
             // Inside linear region
             correction_rate = error * p;
@@ -503,12 +518,24 @@ float sqrt_controller(float error, float p, float second_ord_lim, float dt)
     }
     if (is_positive(dt)) {
         // Clamp to ensure we do not overshoot the error in the last time step
-        return constrain_float(correction_rate, -fabsf(error) / dt, fabsf(error) / dt);
+        return constrain_value_line(correction_rate, -P::fabs(error) / dt, P::fabs(error) / dt, uint32_t(__AP_LINE__));
     } else {
         return correction_rate;
     }
 }
 
+template float sqrt_controller<PrecisionFloat>(float error, float p, float second_ord_lim, float dt);
+template double sqrt_controller<PrecisionDouble>(double error, double p, double second_ord_lim, double dt);
+template float sqrt_controller<PrecisionFast>(float error, float p, float second_ord_lim, float dt);
+
+// float precision, as used by the controllers
+float sqrt_controller(float error, float p, float second_ord_lim, float dt)
+{
+    AP_MATH_PROBE("sqrt_controller");
+
+    return sqrt_controller<PrecisionFloat>(error, p, second_ord_lim, dt);
+}
+
 // Vector form of `sqrt_controller()`, applied along the direction of the input error vector.
 // - Returns a correction vector with magnitude shaped using `sqrt_controller()`.
 // - Direction is preserved from the input error.
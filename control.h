@@ -144,6 +144,11 @@ bool limit_accel_xy(const Vector2f& vel, Vector2f& accel, float accel_max);
 // - Returns the constrained correction rate for a given error and gain.
 float sqrt_controller(float error, float p, float second_ord_lim, float dt);
 
+// As above, computed in precision policy P (see precision.h).
+// - PrecisionFloat gives the same result as the float version.
+template <typename P>
+typename P::type sqrt_controller(typename P::type error, typename P::type p, typename P::type second_ord_lim, typename P::type dt);
+
 // Vector form of `sqrt_controller()`, applied along the direction of the input error vector.
 // - Returns a correction vector with magnitude shaped using `sqrt_controller()`.
 // - Direction is preserved from the input error.
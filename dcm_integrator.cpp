@@ -0,0 +1,101 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma GCC optimize("O2")
+
+#include "dcm_integrator.h"
+
+template <typename T>
+void DcmIntegratorT<T>::reset(const Matrix3<T> &dcm)
+{
+    _dcm = dcm;
+    _dcm.normalize();
+    // normalize() works in ftype, so finish with the Taylor correction
+    uint32_t count = 0;
+    for (uint8_t i = 0; i < 2; i++) {
+        check(_dcm, 0, count);
+    }
+    _error = 0;
+    _renorm_count = 0;
+    _steps_since_check = 0;
+}
+
+template <typename T>
+T DcmIntegratorT<T>::check(Matrix3<T> &m, const T renorm_threshold, uint32_t &renorm_count)
+{
+    // E = R * R^T - I
+    const T eaa = m.a * m.a - 1;
+    const T ebb = m.b * m.b - 1;
+    const T ecc = m.c * m.c - 1;
+    const T eab = m.a * m.b;
+    const T eac = m.a * m.c;
+    const T ebc = m.b * m.c;
+    const T error = MAX(MAX(MAX(std::fabs(eaa), std::fabs(ebb)), MAX(std::fabs(ecc), std::fabs(eab))),
+                        MAX(std::fabs(eac), std::fabs(ebc)));
+    if (error > renorm_threshold) {
+        const Vector3<T> a = m.a, b = m.b, c = m.c;
+        m.a -= (a * eaa + b * eab + c * eac) * T(0.5);
+        m.b -= (a * eab + b * ebb + c * ebc) * T(0.5);
+        m.c -= (a * eac + b * ebc + c * ecc) * T(0.5);
+        renorm_count++;
+    }
+    return error;
+}
+
+template <typename T>
+void DcmIntegratorT<T>::update(const Vector3<T> *gyro, uint32_t count, T dt)
+{
+    // keep the state in locals for the whole block
+    Matrix3<T> m = _dcm;
+    uint32_t renorm_count = _renorm_count;
+    uint8_t steps_since_check = _steps_since_check;
+    const T threshold = _renorm_threshold;
+    T error = _error;
+    for (uint32_t i = 0; i < count; i++) {
+        rotate(m, gyro[i] * dt);
+        if (++steps_since_check >= CHECK_INTERVAL) {
+            steps_since_check = 0;
+            error = check(m, threshold, renorm_count);
+        }
+    }
+    _dcm = m;
+    _renorm_count = renorm_count;
+    _steps_since_check = steps_since_check;
+    _error = error;
+}
+
+template <typename T>
+void DcmIntegratorT<T>::update_delta_angles(const Vector3<T> *delta_angle, uint32_t count)
+{
+    Matrix3<T> m = _dcm;
+    uint32_t renorm_count = _renorm_count;
+    uint8_t steps_since_check = _steps_since_check;
+    const T threshold = _renorm_threshold;
+    T error = _error;
+    for (uint32_t i = 0; i < count; i++) {
+        rotate(m, delta_angle[i]);
+        if (++steps_since_check >= CHECK_INTERVAL) {
+            steps_since_check = 0;
+            error = check(m, threshold, renorm_count);
+        }
+    }
+    _dcm = m;
+    _renorm_count = renorm_count;
+    _steps_since_check = steps_since_check;
+    _error = error;
+}
+
+template class DcmIntegratorT<float>;
+template class DcmIntegratorT<double>;
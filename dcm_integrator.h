@@ -0,0 +1,142 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  direction cosine matrix integration of gyro delta angles, with lazy
+  renormalisation.
+
+  Matrix3::rotate() adds the first order term of each rotation, so the
+  matrix loses orthogonality every step and is usually followed by
+  Matrix3::normalize(), which takes three square roots. Instead each
+  step here multiplies by the Rodrigues rotation
+
+    R = R * (I + s [g]x + c [g]x^2)
+
+  with s = sin(theta)/theta and c = (1 - cos(theta))/theta^2 from their
+  series in theta^2, so no trigonometry or square root is needed. Delta
+  angles should be below 0.17 rad (10 degrees), where the series are
+  exact to the precision of float.
+
+  A rotation leaves R * R^T unchanged, so only rounding moves the
+  matrix away from orthogonality, by a few epsilon per step. The error
+  is therefore measured only every CHECK_INTERVAL steps, as the largest
+  element of E = R * R^T - I. When it passes the threshold the matrix
+  is corrected with the first order Taylor expansion of
+  (R * R^T)^-1/2:
+
+    R = (I - E/2) * R
+
+  which leaves an error of the order of E^2. The default threshold is
+  64 machine epsilon.
+ */
+#pragma once
+
+#include "Embed_Math.h"
+
+template <typename T>
+class DcmIntegratorT {
+public:
+    DcmIntegratorT() { reset(); }
+
+    // reset to the given body to earth rotation, renormalising it
+    void reset(const Matrix3<T> &dcm);
+
+    // reset to level
+    void reset() {
+        Matrix3<T> identity;
+        identity.identity();
+        reset(identity);
+    }
+
+    // integrate one gyro sample in rad/s, averaged over dt seconds
+    void update(const Vector3<T> &gyro, T dt) {
+        update_delta_angle(gyro * dt);
+    }
+
+    // integrate one delta angle in radians
+    void update_delta_angle(const Vector3<T> &delta_angle) {
+        rotate(_dcm, delta_angle);
+        if (++_steps_since_check >= CHECK_INTERVAL) {
+            _steps_since_check = 0;
+            _error = check(_dcm, _renorm_threshold, _renorm_count);
+        }
+    }
+
+    // integrate count gyro samples with a constant sample period
+    void update(const Vector3<T> *gyro, uint32_t count, T dt);
+
+    // integrate count delta angles
+    void update_delta_angles(const Vector3<T> *delta_angle, uint32_t count);
+
+    // body to earth rotation, orthogonal to within the threshold
+    const Matrix3<T> &get_dcm() const { return _dcm; }
+
+    // largest element of R * R^T - I at the last check, before any correction
+    T get_orthogonality_error() const { return _error; }
+
+    // number of renormalisations since reset
+    uint32_t get_renormalise_count() const { return _renorm_count; }
+
+    // maximum orthogonality error before renormalising
+    void set_renormalise_threshold(T threshold) { _renorm_threshold = threshold; }
+
+    // rotate a matrix by a body frame delta angle
+    static void rotate(Matrix3<T> &m, const Vector3<T> &g) {
+        // sin(theta)/theta and (1 - cos(theta))/theta^2
+        const T theta_sq = g * g;
+        const T s = 1 - theta_sq * (T(1.0/6) - theta_sq * T(1.0/120));
+        const T c = T(0.5) - theta_sq * (T(1.0/24) - theta_sq * T(1.0/720));
+
+        // each row r becomes r + s (r x g) + c ((r x g) x g), where
+        // (r x g) x g = g (r . g) - r theta^2. The small terms are added
+        // to r rather than scaling it, which would round its length
+        rotate_row(m.a, g, s, c, theta_sq);
+        rotate_row(m.b, g, s, c, theta_sq);
+        rotate_row(m.c, g, s, c, theta_sq);
+    }
+
+    /*
+      measure the orthogonality error of a matrix, renormalising it and
+      counting in renorm_count when it is above renorm_threshold.
+      Returns the error before any correction
+     */
+    static T check(Matrix3<T> &m, const T renorm_threshold, uint32_t &renorm_count);
+
+    // steps between checks of the orthogonality error
+    static constexpr uint8_t CHECK_INTERVAL = 8;
+
+    static constexpr T default_renormalise_threshold = 64 * std::numeric_limits<T>::epsilon();
+
+private:
+    // one row of rotate(), written out in scalars so it is inlined into the loops
+    static void rotate_row(Vector3<T> &r, const Vector3<T> &g, const T s, const T c, const T theta_sq) {
+        const T r_dot_g = r.x * g.x + r.y * g.y + r.z * g.z;
+        const T dx = (r.y * g.z - r.z * g.y) * s + (g.x * r_dot_g - r.x * theta_sq) * c;
+        const T dy = (r.z * g.x - r.x * g.z) * s + (g.y * r_dot_g - r.y * theta_sq) * c;
+        const T dz = (r.x * g.y - r.y * g.x) * s + (g.z * r_dot_g - r.z * theta_sq) * c;
+        r.x += dx;
+        r.y += dy;
+        r.z += dz;
+    }
+
+    Matrix3<T> _dcm;
+    T _error;
+    uint32_t _renorm_count;
+    uint8_t _steps_since_check;
+    T _renorm_threshold = default_renormalise_threshold;
+};
+
+typedef DcmIntegratorT<float> DcmIntegrator;
+typedef DcmIntegratorT<double> DcmIntegratorD;
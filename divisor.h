@@ -0,0 +1,333 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  division by an invariant integer using multiplication
+
+  This generalises uint64_div1000() in div1000.h to any divisor. The
+  magic numbers are computed once (at compile time for ConstDivisor,
+  at construction for UDivisor/SDivisor) and each division then costs
+  one high multiply, an add and a couple of shifts. This is mostly a
+  win for 64 bit division on 32 bit MCUs, where the compiler otherwise
+  calls into a slow library routine, and for divisors only known at
+  runtime (e.g. a configured sample rate).
+
+  Based on Granlund and Montgomery, "Division by Invariant Integers
+  using Multiplication", PLDI 1994, figures 4.1 and 5.2.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <type_traits>
+
+namespace divisor_internal {
+
+// high half of the product of two unsigned values
+static inline constexpr uint32_t mulhi(uint32_t a, uint32_t b)
+{
+    return uint32_t((uint64_t(a) * b) >> 32);
+}
+
+static inline constexpr uint64_t mulhi(uint64_t a, uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+    return uint64_t(((unsigned __int128)a * b) >> 64);
+#else
+    // 32x32 partial products, as in uint64_div1000()
+    const uint64_t a_lo = uint32_t(a);
+    const uint64_t a_hi = a >> 32;
+    const uint64_t b_lo = uint32_t(b);
+    const uint64_t b_hi = b >> 32;
+    const uint64_t a_x_b_mid = a_hi * b_lo;
+    const uint64_t b_x_a_mid = b_hi * a_lo;
+    // 32-bit carry + two 32-bit values can't overflow 64 bits
+    const uint64_t middle = ((a_lo * b_lo) >> 32) + uint32_t(a_x_b_mid) + uint32_t(b_x_a_mid);
+    return a_hi * b_hi + (a_x_b_mid >> 32) + (b_x_a_mid >> 32) + (middle >> 32);
+#endif
+}
+
+// high half of the product of two signed values
+static inline constexpr int32_t mulhs(int32_t a, int32_t b)
+{
+    return int32_t((int64_t(a) * b) >> 32);
+}
+
+static inline constexpr int64_t mulhs(int64_t a, int64_t b)
+{
+    // correct the unsigned product for the two's complement operands
+    return int64_t(mulhi(uint64_t(a), uint64_t(b)) -
+                   (a < 0 ? uint64_t(b) : 0U) -
+                   (b < 0 ? uint64_t(a) : 0U));
+}
+
+/*
+  floor((hi * 2^N + lo) / d) for N bit values, where hi < d so the
+  result fits in N bits
+ */
+static inline constexpr uint32_t udiv_wide(uint32_t hi, uint32_t lo, uint32_t d)
+{
+    return uint32_t(((uint64_t(hi) << 32) | lo) / d);
+}
+
+static inline constexpr uint64_t udiv_wide(uint64_t hi, uint64_t lo, uint64_t d)
+{
+    // restoring shift-subtract division, only used to setup the magic
+    uint64_t q = 0;
+    for (uint8_t i = 0; i < 64; i++) {
+        const bool carry = (hi >> 63) != 0;
+        hi = (hi << 1) | (lo >> 63);
+        lo <<= 1;
+        q <<= 1;
+        if (carry || hi >= d) {
+            hi -= d;
+            q |= 1;
+        }
+    }
+    return q;
+}
+
+// ceil(log2(d)), 0 for d <= 1
+template <typename U>
+static inline constexpr uint8_t ceil_log2(U d)
+{
+    uint8_t l = 0;
+    while (l < sizeof(U)*8 && (U(1) << l) < d) {
+        l++;
+    }
+    return l;
+}
+
+} // namespace divisor_internal
+
+/*
+  unsigned division by a runtime invariant divisor (uint32_t or uint64_t)
+ */
+template <typename T>
+class UDivisor {
+    static_assert(std::is_same<T, uint32_t>::value || std::is_same<T, uint64_t>::value,
+                  "UDivisor only supports uint32_t and uint64_t");
+public:
+    static constexpr uint8_t bits = sizeof(T) * 8;
+
+    // the divisor must not be zero
+    constexpr explicit UDivisor(const T d) :
+        _d(d),
+        _magic(calc_magic(d)),
+        _shift1(calc_shift1(d)),
+        _shift2(calc_shift2(d))
+    {}
+
+    // return n / d
+    constexpr T divide(const T n) const {
+        return divide(n, _magic, _shift1, _shift2);
+    }
+
+    // return n % d
+    constexpr T remainder(const T n) const {
+        return n - divide(n) * _d;
+    }
+
+    // divide count values from n into q. n and q may be the same array
+    void divide(const T *n, T *q, uint32_t count) const {
+        const T magic = _magic;
+        const uint8_t shift1 = _shift1;
+        const uint8_t shift2 = _shift2;
+        for (uint32_t i = 0; i < count; i++) {
+            q[i] = divide(n[i], magic, shift1, shift2);
+        }
+    }
+
+    constexpr T divisor() const { return _d; }
+
+    /*
+      magic number and shifts for divisor d, usable in constant
+      expressions. See figure 4.1 of Granlund and Montgomery
+     */
+    static constexpr T calc_magic(const T d) {
+        // floor(2^N * (2^l - d) / d) + 1, where 2^l - d is taken modulo 2^N
+        return divisor_internal::udiv_wide(T(calc_pow2(divisor_internal::ceil_log2(d)) - d), T(0), d) + 1;
+    }
+    static constexpr uint8_t calc_shift1(const T d) {
+        return divisor_internal::ceil_log2(d) > 0 ? 1 : 0;
+    }
+    static constexpr uint8_t calc_shift2(const T d) {
+        return divisor_internal::ceil_log2(d) > 0 ? divisor_internal::ceil_log2(d) - 1 : 0;
+    }
+
+    static constexpr T divide(const T n, const T magic, const uint8_t shift1, const uint8_t shift2) {
+        return (divisor_internal::mulhi(magic, n) + ((n - divisor_internal::mulhi(magic, n)) >> shift1)) >> shift2;
+    }
+
+private:
+    // 2^l modulo 2^N
+    static constexpr T calc_pow2(const uint8_t l) {
+        return l >= bits ? T(0) : T(T(1) << l);
+    }
+
+    T _d;
+    T _magic;
+    uint8_t _shift1;
+    uint8_t _shift2;
+};
+
+/*
+  signed division by a runtime invariant divisor (int32_t or
+  int64_t). Rounds towards zero like the / operator. Dividing the
+  most negative value by -1 overflows, as it does for the / operator
+ */
+template <typename T>
+class SDivisor {
+    static_assert(std::is_same<T, int32_t>::value || std::is_same<T, int64_t>::value,
+                  "SDivisor only supports int32_t and int64_t");
+    typedef typename std::make_unsigned<T>::type U;
+public:
+    static constexpr uint8_t bits = sizeof(T) * 8;
+
+    // the divisor must not be zero
+    constexpr explicit SDivisor(const T d) :
+        _d(d),
+        _magic(calc_magic(d)),
+        _shift(calc_shift(d)),
+        _sign(d < 0 ? T(-1) : T(0))
+    {}
+
+    // return n / d
+    constexpr T divide(const T n) const {
+        return divide(n, _magic, _shift, _sign);
+    }
+
+    // return n % d
+    constexpr T remainder(const T n) const {
+        return T(U(n) - U(divide(n)) * U(_d));
+    }
+
+    // divide count values from n into q. n and q may be the same array
+    void divide(const T *n, T *q, uint32_t count) const {
+        const T magic = _magic;
+        const uint8_t shift = _shift;
+        const T sign = _sign;
+        for (uint32_t i = 0; i < count; i++) {
+            q[i] = divide(n[i], magic, shift, sign);
+        }
+    }
+
+    constexpr T divisor() const { return _d; }
+
+    /*
+      magic number and shift for divisor d, usable in constant
+      expressions. See figure 5.2 of Granlund and Montgomery
+     */
+    static constexpr T calc_magic(const T d) {
+        // 1 + floor(2^(N+l-1) / |d|) - 2^N, which wraps to 1 for |d| == 1
+        return abs_u(d) == 1 ? T(1) :
+            T(divisor_internal::udiv_wide(U(U(1) << (calc_shift(d))), U(0), abs_u(d)) + 1);
+    }
+    static constexpr uint8_t calc_shift(const T d) {
+        return divisor_internal::ceil_log2(abs_u(d)) > 1 ? divisor_internal::ceil_log2(abs_u(d)) - 1 : 0;
+    }
+
+    static constexpr T divide(const T n, const T magic, const uint8_t shift, const T sign) {
+        // q0 = SRA(n + MULSH(m, n), l-1) - XSIGN(n), then apply the sign of d
+        // all in U so that n = -2^(N-1) and |d| = 1 don't overflow
+        return T(((U(sra(T(U(n) + U(divisor_internal::mulhs(magic, n))), shift)) - U(sra(n, bits - 1))) ^ U(sign)) - U(sign));
+    }
+
+private:
+    static constexpr U abs_u(const T d) {
+        return d < 0 ? U(0) - U(d) : U(d);
+    }
+
+    // arithmetic shift right
+    static constexpr T sra(const T v, const uint8_t shift) {
+        return v >> shift;
+    }
+
+    T _d;
+    T _magic;
+    uint8_t _shift;
+    T _sign;
+};
+
+/*
+  division by a compile time constant. All magic numbers are folded
+  into the instruction stream, e.g.
+      const uint64_t sec = ConstDivisor<uint64_t, 1000000ULL>::divide(usec);
+ */
+template <typename T, T D, bool is_signed = std::is_signed<T>::value>
+struct ConstDivisor;
+
+template <typename T, T D>
+struct ConstDivisor<T, D, false> {
+    static_assert(D != 0, "division by zero");
+    static constexpr T magic = UDivisor<T>::calc_magic(D);
+    static constexpr uint8_t shift1 = UDivisor<T>::calc_shift1(D);
+    static constexpr uint8_t shift2 = UDivisor<T>::calc_shift2(D);
+
+    static constexpr T divide(const T n) {
+        return UDivisor<T>::divide(n, magic, shift1, shift2);
+    }
+    static constexpr T remainder(const T n) {
+        return n - divide(n) * D;
+    }
+    static void divide(const T *n, T *q, uint32_t count) {
+        for (uint32_t i = 0; i < count; i++) {
+            q[i] = divide(n[i]);
+        }
+    }
+};
+
+template <typename T, T D>
+struct ConstDivisor<T, D, true> {
+    static_assert(D != 0, "division by zero");
+    typedef typename std::make_unsigned<T>::type U;
+    static constexpr T magic = SDivisor<T>::calc_magic(D);
+    static constexpr uint8_t shift = SDivisor<T>::calc_shift(D);
+    static constexpr T sign = D < 0 ? T(-1) : T(0);
+
+    static constexpr T divide(const T n) {
+        return SDivisor<T>::divide(n, magic, shift, sign);
+    }
+    static constexpr T remainder(const T n) {
+        return T(U(n) - U(divide(n)) * U(D));
+    }
+    static void divide(const T *n, T *q, uint32_t count) {
+        for (uint32_t i = 0; i < count; i++) {
+            q[i] = divide(n[i]);
+        }
+    }
+};
+
+/*
+  common time unit conversions for 64 bit timestamps
+ */
+static inline uint64_t uint64_div1e6(uint64_t x)
+{
+    return ConstDivisor<uint64_t, 1000000ULL>::divide(x);
+}
+
+static inline uint64_t uint64_div1e9(uint64_t x)
+{
+    return ConstDivisor<uint64_t, 1000000000ULL>::divide(x);
+}
+
+static inline uint64_t uint64_div60(uint64_t x)
+{
+    return ConstDivisor<uint64_t, 60ULL>::divide(x);
+}
+
+static inline uint64_t uint64_div3600(uint64_t x)
+{
+    return ConstDivisor<uint64_t, 3600ULL>::divide(x);
+}
@@ -0,0 +1,362 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma GCC optimize("O2")
+
+#include "ellipsoid_fit.h"
+#include "AP_Math.h"
+
+// parameters: offset, M = S^2 (xx, yy, zz, xy, xz, yz) and radius
+#define NUM_PARAMS 10
+
+void EllipsoidFit::reset(const Vector3f &centre)
+{
+    _centre = centre;
+    memset(_sums, 0, sizeof(_sums));
+    memset(_count, 0, sizeof(_count));
+    _total = 0;
+}
+
+bool EllipsoidFit::update(const Vector3f &sample)
+{
+    const int section = AP_GeodesicGrid::section(sample - _centre, true);
+    if (section < 0) {
+        return false;
+    }
+    const double x = double(sample.x) - double(_centre.x);
+    const double y = double(sample.y) - double(_centre.y);
+    const double z = double(sample.z) - double(_centre.z);
+    const double terms[NUM_TERMS] { x*x, y*y, z*z, x*y, x*z, y*z, x, y, z, 1 };
+    double *sums = _sums[section];
+    uint8_t k = 0;
+    for (uint8_t i = 0; i < NUM_TERMS; i++) {
+        for (uint8_t j = i; j < NUM_TERMS; j++) {
+            sums[k++] += terms[i] * terms[j];
+        }
+    }
+    _count[section]++;
+    _total++;
+    return true;
+}
+
+void EllipsoidFit::update(const Vector3f *samples, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        update(samples[i]);
+    }
+}
+
+uint8_t EllipsoidFit::num_sections_covered(uint32_t min_samples) const
+{
+    uint8_t ret = 0;
+    for (uint8_t i = 0; i < NUM_SECTIONS; i++) {
+        if (_count[i] >= MAX(min_samples, 1U)) {
+            ret++;
+        }
+    }
+    return ret;
+}
+
+double EllipsoidFit::weighted_sums(double sums[NUM_TERMS][NUM_TERMS]) const
+{
+    uint32_t cap = _section_cap;
+    if (cap == 0) {
+        // median count of the covered sections, by insertion sort
+        uint32_t counts[NUM_SECTIONS];
+        uint8_t covered = 0;
+        for (uint8_t s = 0; s < NUM_SECTIONS; s++) {
+            if (_count[s] == 0) {
+                continue;
+            }
+            uint8_t i = covered++;
+            for (; i > 0 && counts[i-1] > _count[s]; i--) {
+                counts[i] = counts[i-1];
+            }
+            counts[i] = _count[s];
+        }
+        cap = covered > 0 ? counts[covered / 2] : 1;
+    }
+
+    memset(sums, 0, sizeof(double) * NUM_TERMS * NUM_TERMS);
+    double total = 0;
+    for (uint8_t s = 0; s < NUM_SECTIONS; s++) {
+        if (_count[s] == 0) {
+            continue;
+        }
+        const double w = _count[s] > cap ? double(cap) / _count[s] : 1.0;
+        uint8_t k = 0;
+        for (uint8_t i = 0; i < NUM_TERMS; i++) {
+            for (uint8_t j = i; j < NUM_TERMS; j++) {
+                sums[i][j] += w * _sums[s][k++];
+            }
+        }
+        total += w * _count[s];
+    }
+    for (uint8_t i = 1; i < NUM_TERMS; i++) {
+        for (uint8_t j = 0; j < i; j++) {
+            sums[i][j] = sums[j][i];
+        }
+    }
+    return total;
+}
+
+/*
+  coefficients c of the residual in terms of the monomials, and their
+  derivatives J[i][k] = dc[i]/dp[k]
+ */
+static void residual_coefficients(const double p[NUM_PARAMS], double c[NUM_PARAMS], double J[NUM_PARAMS][NUM_PARAMS])
+{
+    const double ox = p[0], oy = p[1], oz = p[2];
+    const double xx = p[3], yy = p[4], zz = p[5], xy = p[6], xz = p[7], yz = p[8];
+    const double r = p[9];
+
+    // M * offset
+    const double mx = xx*ox + xy*oy + xz*oz;
+    const double my = xy*ox + yy*oy + yz*oz;
+    const double mz = xz*ox + yz*oy + zz*oz;
+
+    c[0] = xx;
+    c[1] = yy;
+    c[2] = zz;
+    c[3] = 2 * xy;
+    c[4] = 2 * xz;
+    c[5] = 2 * yz;
+    c[6] = 2 * mx;
+    c[7] = 2 * my;
+    c[8] = 2 * mz;
+    c[9] = ox*mx + oy*my + oz*mz - r*r;
+
+    memset(J, 0, sizeof(double) * NUM_PARAMS * NUM_PARAMS);
+    J[0][3] = 1;
+    J[1][4] = 1;
+    J[2][5] = 1;
+    J[3][6] = 2;
+    J[4][7] = 2;
+    J[5][8] = 2;
+
+    J[6][0] = 2*xx; J[6][1] = 2*xy; J[6][2] = 2*xz;
+    J[6][3] = 2*ox; J[6][6] = 2*oy; J[6][7] = 2*oz;
+
+    J[7][0] = 2*xy; J[7][1] = 2*yy; J[7][2] = 2*yz;
+    J[7][4] = 2*oy; J[7][6] = 2*ox; J[7][8] = 2*oz;
+
+    J[8][0] = 2*xz; J[8][1] = 2*yz; J[8][2] = 2*zz;
+    J[8][5] = 2*oz; J[8][7] = 2*ox; J[8][8] = 2*oy;
+
+    J[9][0] = 2*mx; J[9][1] = 2*my; J[9][2] = 2*mz;
+    J[9][3] = ox*ox; J[9][4] = oy*oy; J[9][5] = oz*oz;
+    J[9][6] = 2*ox*oy; J[9][7] = 2*ox*oz; J[9][8] = 2*oy*oz;
+    J[9][9] = -2*r;
+}
+
+// c^T * sums * c, the weighted sum of squared residuals
+static double quadratic_form(const double sums[NUM_PARAMS][NUM_PARAMS], const double c[NUM_PARAMS])
+{
+    double ret = 0;
+    for (uint8_t i = 0; i < NUM_PARAMS; i++) {
+        double row = 0;
+        for (uint8_t j = 0; j < NUM_PARAMS; j++) {
+            row += sums[i][j] * c[j];
+        }
+        ret += c[i] * row;
+    }
+    return ret;
+}
+
+/*
+  Levenberg-Marquardt on the free parameters. The cost is c^T * sums * c
+  and c is the residual of each monomial, so the Gauss-Newton matrix is
+  J^T * sums * J. The damped system is scaled to a unit diagonal before
+  inverting, as the parameters differ in scale by the square of the
+  sample size
+ */
+static bool lm_solve(const double sums[NUM_PARAMS][NUM_PARAMS], double p[NUM_PARAMS],
+                     const bool free[NUM_PARAMS], uint8_t max_iterations, double &cost)
+{
+    uint8_t idx[NUM_PARAMS];
+    uint8_t n = 0;
+    for (uint8_t k = 0; k < NUM_PARAMS; k++) {
+        if (free[k]) {
+            idx[n++] = k;
+        }
+    }
+
+    double c[NUM_PARAMS], J[NUM_PARAMS][NUM_PARAMS];
+    residual_coefficients(p, c, J);
+    cost = quadratic_form(sums, c);
+
+    double lambda = 1.0e-3;
+    for (uint8_t iter = 0; iter < max_iterations && cost > 0; iter++) {
+        // sums * c and sums * J
+        double sc[NUM_PARAMS], sJ[NUM_PARAMS][NUM_PARAMS];
+        for (uint8_t i = 0; i < NUM_PARAMS; i++) {
+            sc[i] = 0;
+            for (uint8_t j = 0; j < NUM_PARAMS; j++) {
+                sc[i] += sums[i][j] * c[j];
+            }
+            for (uint8_t k = 0; k < n; k++) {
+                sJ[i][k] = 0;
+                for (uint8_t j = 0; j < NUM_PARAMS; j++) {
+                    sJ[i][k] += sums[i][j] * J[j][idx[k]];
+                }
+            }
+        }
+
+        double g[NUM_PARAMS], H[NUM_PARAMS*NUM_PARAMS], scale[NUM_PARAMS];
+        for (uint8_t k = 0; k < n; k++) {
+            g[k] = 0;
+            for (uint8_t i = 0; i < NUM_PARAMS; i++) {
+                g[k] += J[i][idx[k]] * sc[i];
+            }
+            for (uint8_t l = 0; l < n; l++) {
+                double h = 0;
+                for (uint8_t i = 0; i < NUM_PARAMS; i++) {
+                    h += J[i][idx[k]] * sJ[i][l];
+                }
+                H[k*n+l] = h;
+            }
+        }
+        for (uint8_t k = 0; k < n; k++) {
+            if (!(H[k*n+k] > 0)) {
+                return false;
+            }
+            scale[k] = 1 / std::sqrt(H[k*n+k]);
+        }
+
+        // try larger damping until the cost goes down
+        bool improved = false;
+        double trial[NUM_PARAMS], trial_c[NUM_PARAMS], trial_J[NUM_PARAMS][NUM_PARAMS];
+        double trial_cost = cost;
+        while (!improved && iter < max_iterations) {
+            double A[NUM_PARAMS*NUM_PARAMS], Ainv[NUM_PARAMS*NUM_PARAMS];
+            for (uint8_t k = 0; k < n; k++) {
+                for (uint8_t l = 0; l < n; l++) {
+                    A[k*n+l] = H[k*n+l] * scale[k] * scale[l];
+                }
+                A[k*n+k] += lambda;
+            }
+            if (mat_inverse(A, Ainv, n)) {
+                memcpy(trial, p, sizeof(trial));
+                for (uint8_t k = 0; k < n; k++) {
+                    double step = 0;
+                    for (uint8_t l = 0; l < n; l++) {
+                        step -= Ainv[k*n+l] * scale[l] * g[l];
+                    }
+                    trial[idx[k]] += step * scale[k];
+                }
+                residual_coefficients(trial, trial_c, trial_J);
+                trial_cost = quadratic_form(sums, trial_c);
+                improved = trial_cost < cost;
+            }
+            if (!improved) {
+                lambda *= 10;
+                iter++;
+            }
+        }
+        if (!improved) {
+            break;
+        }
+
+        const double decrease = cost - trial_cost;
+        memcpy(p, trial, sizeof(trial));
+        memcpy(c, trial_c, sizeof(c));
+        memcpy(J, trial_J, sizeof(J));
+        cost = trial_cost;
+        lambda = MAX(lambda * 0.1, 1.0e-9);
+        if (decrease <= 1.0e-12 * cost) {
+            break;
+        }
+    }
+
+    for (uint8_t k = 0; k < NUM_PARAMS; k++) {
+        if (!std::isfinite(p[k])) {
+            return false;
+        }
+    }
+    return std::isfinite(cost);
+}
+
+bool EllipsoidFit::fit(Result &result, bool ellipsoid, uint8_t max_iterations) const
+{
+    if (_total < NUM_TERMS) {
+        return false;
+    }
+    double sums[NUM_TERMS][NUM_TERMS];
+    const double weight = weighted_sums(sums);
+
+    // start from the weighted mean and RMS distance from it
+    const double mean_x = sums[6][9] / weight;
+    const double mean_y = sums[7][9] / weight;
+    const double mean_z = sums[8][9] / weight;
+    const double mean_sq = (sums[0][9] + sums[1][9] + sums[2][9]) / weight;
+    const double var = mean_sq - (mean_x*mean_x + mean_y*mean_y + mean_z*mean_z);
+    if (!(var > 0)) {
+        return false;
+    }
+    double p[NUM_PARAMS] { -mean_x, -mean_y, -mean_z, 1, 1, 1, 0, 0, 0, std::sqrt(var) };
+
+    // sphere: offset and radius
+    bool free[NUM_PARAMS] { true, true, true, false, false, false, false, false, false, true };
+    double cost;
+    if (!lm_solve(sums, p, free, max_iterations, cost)) {
+        return false;
+    }
+
+    if (ellipsoid) {
+        // offset and shape with the sphere radius
+        for (uint8_t k = 3; k < 9; k++) {
+            free[k] = true;
+        }
+        free[9] = false;
+        if (!lm_solve(sums, p, free, max_iterations, cost)) {
+            return false;
+        }
+    }
+
+    // S is the square root of M, which must be positive definite
+    const Matrix3d M(p[3], p[6], p[7],
+                     p[6], p[4], p[8],
+                     p[7], p[8], p[5]);
+    Vector3d values;
+    Matrix3d V;
+    M.symmetric_eigen(values, V);
+    if (!(values.x > 0) || !(p[9] > 0)) {
+        return false;
+    }
+    const Vector3d root(std::sqrt(values.x), std::sqrt(values.y), std::sqrt(values.z));
+    Matrix3d S;
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = i; j < 3; j++) {
+            S[i][j] = S[j][i] = V[i][0]*root.x*V[j][0] + V[i][1]*root.y*V[j][1] + V[i][2]*root.z*V[j][2];
+        }
+    }
+
+    result.offset = (Vector3d(p[0], p[1], p[2]) - _centre.todouble()).tofloat();
+    result.diag = Vector3f(S.a.x, S.b.y, S.c.z);
+    result.offdiag = Vector3f(S.a.y, S.a.z, S.b.z);
+    result.radius = p[9];
+    result.fitness = std::sqrt(MAX(cost, 0.0) / weight) / (2 * p[9]);
+    return true;
+}
+
+bool EllipsoidFit::fit_sphere(Result &result, uint8_t max_iterations) const
+{
+    return fit(result, false, max_iterations);
+}
+
+bool EllipsoidFit::fit_ellipsoid(Result &result, uint8_t max_iterations) const
+{
+    return fit(result, true, max_iterations);
+}
@@ -0,0 +1,113 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  streaming sphere and ellipsoid fit for magnetometer calibration.
+
+  The model is the one used by the compass calibrator: a corrected
+  sample S * (x + offset) lies on a sphere of the given radius, where
+  S is symmetric with diagonal diag and off diagonal offdiag. The fit
+  minimises the algebraic residual
+
+    e = |S * (x + offset)|^2 - radius^2
+
+  which is close to 2 * radius times the distance from the sphere for
+  samples near it. e is linear in the monomials
+  (x^2, y^2, z^2, xy, xz, yz, x, y, z, 1) of the sample, so the sum of
+  e^2 over all samples only needs the 10x10 sums of their products.
+  These sums are kept per AP_GeodesicGrid section of the sample
+  direction, so memory is fixed however many samples are added.
+
+  When solving, a section holding more than the cap samples is
+  weighted down to the cap, so a vehicle held still in one direction
+  doesn't outweigh the rest of the sphere. The default cap is the
+  median count of the covered sections. The fit itself is Levenberg-Marquardt
+  on the weighted sums, first for a sphere (offset and radius) and then
+  for an ellipsoid (offset, diag and offdiag) with the sphere radius.
+
+  The sums are in double. Their conditioning depends on the size of
+  the samples relative to the centre given to reset(), so pass a rough
+  centre of the data when the offsets are large.
+ */
+#pragma once
+
+#include "AP_GeodesicGrid.h"
+
+class EllipsoidFit {
+public:
+    // number of AP_GeodesicGrid sections
+    static constexpr uint8_t NUM_SECTIONS = 20 * AP_GeodesicGrid::NUM_SUBTRIANGLES;
+
+    struct Result {
+        // corrected sample is S * (x + offset)
+        Vector3f offset;
+        Vector3f diag;
+        Vector3f offdiag;
+        float radius;
+        // RMS distance of the corrected samples from the sphere
+        float fitness;
+    };
+
+    explicit EllipsoidFit(const Vector3f &centre = Vector3f()) { reset(centre); }
+
+    // forget all samples. Sample directions are taken relative to centre
+    void reset(const Vector3f &centre = Vector3f());
+
+    // add a sample, returning false if it has no direction from the centre
+    bool update(const Vector3f &sample);
+
+    // add count samples
+    void update(const Vector3f *samples, uint32_t count);
+
+    // samples added to a section
+    uint32_t get_section_count(uint8_t section) const {
+        return section < NUM_SECTIONS ? _count[section] : 0;
+    }
+
+    // number of sections holding at least min_samples samples
+    uint8_t num_sections_covered(uint32_t min_samples = 1) const;
+
+    // total samples added
+    uint64_t get_sample_count() const { return _total; }
+
+    // weight sections down to cap samples, 0 for the median count of the covered sections
+    void set_section_cap(uint32_t cap) { _section_cap = cap; }
+
+    /*
+      fit a sphere, with diag of one and offdiag of zero. Returns false
+      if there are too few samples or the fit doesn't converge
+     */
+    bool fit_sphere(Result &result, uint8_t max_iterations = 20) const;
+
+    // fit an ellipsoid, starting from the sphere fit
+    bool fit_ellipsoid(Result &result, uint8_t max_iterations = 20) const;
+
+private:
+    // number of monomials and of unique products of two of them
+    static constexpr uint8_t NUM_TERMS = 10;
+    static constexpr uint8_t NUM_PRODUCTS = NUM_TERMS * (NUM_TERMS + 1) / 2;
+
+    // sum of the section sums weighted down to the cap, returning the total weight
+    double weighted_sums(double sums[NUM_TERMS][NUM_TERMS]) const;
+
+    bool fit(Result &result, bool ellipsoid, uint8_t max_iterations) const;
+
+    Vector3f _centre;
+    // upper triangle of the products of the monomials of each section
+    double _sums[NUM_SECTIONS][NUM_PRODUCTS];
+    uint32_t _count[NUM_SECTIONS];
+    uint64_t _total;
+    uint32_t _section_cap = 0;
+};
@@ -0,0 +1,249 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma GCC optimize("O2")
+
+#include "filter.h"
+
+void BiquadCoefficients::pass_through()
+{
+    b0 = 1;
+    b1 = b2 = a1 = a2 = 0;
+}
+
+/*
+  second order butterworth low pass, using the bilinear transform with
+  frequency prewarping
+ */
+void BiquadCoefficients::lowpass(float sample_freq_hz, float cutoff_freq_hz)
+{
+    if (!is_positive(cutoff_freq_hz) || !is_positive(sample_freq_hz) || cutoff_freq_hz >= 0.5f * sample_freq_hz) {
+        // no filtering
+        pass_through();
+        return;
+    }
+    const float ohm = tanf(M_PI * cutoff_freq_hz / sample_freq_hz);
+    const float ohm2 = ohm * ohm;
+    const float c = 1.0f + 2.0f * HALF_SQRT_2 * ohm + ohm2;
+    b0 = ohm2 / c;
+    b1 = 2.0f * b0;
+    b2 = b0;
+    a1 = 2.0f * (ohm2 - 1.0f) / c;
+    a2 = (1.0f - 2.0f * HALF_SQRT_2 * ohm + ohm2) / c;
+}
+
+/*
+  calculate the notch A (amplitude) and Q from the bandwidth and
+  attenuation, as used by notch_A_Q()
+ */
+void BiquadCoefficients::calc_A_Q(float center_freq_hz, float bandwidth_hz, float attenuation_dB, float &A, float &Q)
+{
+    A = powf(10, -attenuation_dB / 40.0f);
+    if (center_freq_hz > 0.5f * bandwidth_hz) {
+        const float octaves = log2f(center_freq_hz / (center_freq_hz - bandwidth_hz / 2.0f)) * 2.0f;
+        Q = sqrtf(powf(2, octaves)) / (powf(2, octaves) - 1.0f);
+    } else {
+        Q = 0.0f;
+    }
+}
+
+void BiquadCoefficients::notch(float sample_freq_hz, float center_freq_hz, float bandwidth_hz, float attenuation_dB)
+{
+    float A, Q;
+    calc_A_Q(center_freq_hz, bandwidth_hz, attenuation_dB, A, Q);
+    notch_A_Q(sample_freq_hz, center_freq_hz, A, Q);
+}
+
+void BiquadCoefficients::notch_A_Q(float sample_freq_hz, float center_freq_hz, float A, float Q)
+{
+    // don't allow the notch to be at or above the nyquist frequency
+    if (!is_positive(center_freq_hz) || !is_positive(Q) || center_freq_hz >= 0.5f * sample_freq_hz) {
+        pass_through();
+        return;
+    }
+    const float omega = M_2PI * center_freq_hz / sample_freq_hz;
+    notch_sincos(sinf(omega), cosf(omega), A, Q);
+}
+
+void BiquadCoefficients::notch_sincos(float sin_omega, float cos_omega, float A, float Q)
+{
+    const float alpha = sin_omega / (2 * Q);
+    const float inv_a0 = 1.0f / (1 + alpha);
+    b0 = (1 + alpha * sq(A)) * inv_a0;
+    b1 = -2.0f * cos_omega * inv_a0;
+    b2 = (1 - alpha * sq(A)) * inv_a0;
+    a1 = b1;
+    a2 = (1 - alpha) * inv_a0;
+}
+
+void BiquadCoefficients::harmonic_notches(float sample_freq_hz, float center_freq_hz, float A, float Q,
+                                          const uint8_t *mult, uint8_t count, BiquadCoefficients *coeff)
+{
+    if (!is_positive(center_freq_hz) || !is_positive(Q) || !is_positive(sample_freq_hz)) {
+        for (uint8_t i = 0; i < count; i++) {
+            coeff[i].pass_through();
+        }
+        return;
+    }
+    const float omega = M_2PI * center_freq_hz / sample_freq_hz;
+    float sin1, cos1;
+    fast_sincosf(omega, sin1, cos1);
+
+    // sin and cos of k*omega, stepping k with
+    // sin((k+1)w) = 2cos(w)sin(kw) - sin((k-1)w), and similarly for cos
+    float sin_k = sin1, cos_k = cos1;
+    float sin_km1 = 0, cos_km1 = 1;
+    uint8_t k = 1;
+    const float nyquist_mult = 0.5f * sample_freq_hz / center_freq_hz;
+    for (uint8_t i = 0; i < count; i++) {
+        while (k < mult[i]) {
+            const float sin_kp1 = 2 * cos1 * sin_k - sin_km1;
+            const float cos_kp1 = 2 * cos1 * cos_k - cos_km1;
+            sin_km1 = sin_k;
+            cos_km1 = cos_k;
+            sin_k = sin_kp1;
+            cos_k = cos_kp1;
+            k++;
+        }
+        if (mult[i] >= nyquist_mult) {
+            coeff[i].pass_through();
+        } else {
+            coeff[i].notch_sincos(sin_k, cos_k, A, Q);
+        }
+    }
+}
+
+template <class T>
+void LowPassFilter1<T>::apply(const T *in, T *out, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        out[i] = apply(in[i]);
+    }
+}
+
+template <class T>
+void LowPassFilter1<T>::set_cutoff_frequency(float dt, float cutoff_freq_hz)
+{
+    _alpha = calc_lowpass_alpha_dt(dt, cutoff_freq_hz);
+}
+
+template <class T>
+void BiquadFilter<T>::apply(const T *in, T *out, uint32_t count)
+{
+    // keep the state in locals so it can stay in registers
+    const BiquadCoefficients c = _coeff;
+    T s1 = _s1;
+    T s2 = _s2;
+    for (uint32_t i = 0; i < count; i++) {
+        const T x = in[i];
+        const T y = x * c.b0 + s1;
+        s1 = x * c.b1 - y * c.a1 + s2;
+        s2 = x * c.b2 - y * c.a2;
+        out[i] = y;
+    }
+    _s1 = s1;
+    _s2 = s2;
+}
+
+template <class T>
+void BiquadFilter<T>::reset(const T &value)
+{
+    // the state for which a constant input gives the same constant output,
+    // scaled by the DC gain of the filter
+    const float sum_a = 1 + _coeff.a1 + _coeff.a2;
+    const float dc_gain = is_zero(sum_a) ? 1.0f : (_coeff.b0 + _coeff.b1 + _coeff.b2) / sum_a;
+    const T y = value * dc_gain;
+    _s2 = value * _coeff.b2 - y * _coeff.a2;
+    _s1 = value * _coeff.b1 - y * _coeff.a1 + _s2;
+}
+
+template <class T>
+void HarmonicNotchFilter<T>::init(float sample_freq_hz, uint8_t harmonics, float center_freq_hz, float bandwidth_hz, float attenuation_dB)
+{
+    _sample_freq_hz = sample_freq_hz;
+    _num_notches = 0;
+    for (uint8_t i = 0; i < HARMONIC_NOTCH_MAX_HARMONICS; i++) {
+        if (harmonics & (1U << i)) {
+            _harmonic_mult[_num_notches++] = i + 1;
+        }
+    }
+    // A and Q come from the fundamental. The notches on the harmonics
+    // use the same Q, so their bandwidth scales with frequency
+    BiquadCoefficients::calc_A_Q(center_freq_hz, bandwidth_hz, attenuation_dB, _A, _Q);
+    reset();
+    update(center_freq_hz);
+}
+
+template <class T>
+void HarmonicNotchFilter<T>::update(float center_freq_hz)
+{
+    _center_freq_hz = center_freq_hz;
+    _enabled = is_positive(center_freq_hz) && is_positive(_Q);
+    if (!_enabled) {
+        return;
+    }
+    BiquadCoefficients coeff[HARMONIC_NOTCH_MAX_HARMONICS];
+    BiquadCoefficients::harmonic_notches(_sample_freq_hz, center_freq_hz, _A, _Q, _harmonic_mult, _num_notches, coeff);
+    for (uint8_t i = 0; i < _num_notches; i++) {
+        _notch[i].set_coefficients(coeff[i]);
+    }
+}
+
+template <class T>
+T HarmonicNotchFilter<T>::apply(const T &sample)
+{
+    if (!_enabled) {
+        return sample;
+    }
+    T out = sample;
+    for (uint8_t i = 0; i < _num_notches; i++) {
+        out = _notch[i].apply(out);
+    }
+    return out;
+}
+
+template <class T>
+void HarmonicNotchFilter<T>::apply(const T *in, T *out, uint32_t count)
+{
+    if (!_enabled || _num_notches == 0) {
+        if (in != out) {
+            memcpy(out, in, count * sizeof(T));
+        }
+        return;
+    }
+    // run each notch over the whole block in turn
+    _notch[0].apply(in, out, count);
+    for (uint8_t i = 1; i < _num_notches; i++) {
+        _notch[i].apply(out, out, count);
+    }
+}
+
+template <class T>
+void HarmonicNotchFilter<T>::reset()
+{
+    for (uint8_t i = 0; i < HARMONIC_NOTCH_MAX_HARMONICS; i++) {
+        _notch[i].reset();
+    }
+}
+
+template class LowPassFilter1<float>;
+template class LowPassFilter1<Vector2f>;
+template class LowPassFilter1<Vector3f>;
+template class BiquadFilter<float>;
+template class BiquadFilter<Vector2f>;
+template class BiquadFilter<Vector3f>;
+template class HarmonicNotchFilter<float>;
+template class HarmonicNotchFilter<Vector2f>;
+template class HarmonicNotchFilter<Vector3f>;
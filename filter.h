@@ -0,0 +1,382 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  digital filters: first order low pass, biquad low pass and notch,
+  and a cascaded harmonic notch.
+
+  The filters are templated on the sample type and instantiated for
+  float, Vector2f and Vector3f. Coefficients are computed when the
+  frequencies are set so apply() is only a few multiply-adds.
+
+  The *SoA classes filter N independent float channels (e.g. the axes
+  of several IMUs) with one set of coefficients. The state is stored
+  per channel in arrays so the per-sample loop over channels can be
+  vectorised. HarmonicNotchBank does the same for a harmonic notch,
+  with per-channel coefficients so groups of channels can track
+  different frequencies.
+ */
+#pragma once
+
+#include "Embed_Math.h"
+
+/*
+  normalised biquad coefficients, a0 == 1
+ */
+struct BiquadCoefficients {
+    float b0, b1, b2;
+    float a1, a2;
+
+    // pass-through
+    void pass_through();
+
+    // second order butterworth low pass
+    void lowpass(float sample_freq_hz, float cutoff_freq_hz);
+
+    // notch with the given -3dB bandwidth and attenuation at the centre frequency
+    void notch(float sample_freq_hz, float center_freq_hz, float bandwidth_hz, float attenuation_dB);
+
+    // notch from the precomputed A and Q values, see calc_A_Q()
+    void notch_A_Q(float sample_freq_hz, float center_freq_hz, float A, float Q);
+
+    // notch using a precomputed sin and cos of the normalised centre frequency
+    void notch_sincos(float sin_omega, float cos_omega, float A, float Q);
+
+    // calculate the A and Q notch parameters from bandwidth and attenuation
+    static void calc_A_Q(float center_freq_hz, float bandwidth_hz, float attenuation_dB, float &A, float &Q);
+
+    /*
+      notches on the multiples mult[0..count-1] of center_freq_hz, which
+      must be in increasing order. Uses one fast_sincosf() for the
+      fundamental and the Chebyshev recurrence for the harmonics.
+      Harmonics at or above the nyquist frequency pass through
+     */
+    static void harmonic_notches(float sample_freq_hz, float center_freq_hz, float A, float Q,
+                                 const uint8_t *mult, uint8_t count, BiquadCoefficients *coeff);
+};
+
+/*
+  first order low pass filter
+ */
+template <class T>
+class LowPassFilter1 {
+public:
+    // apply a new sample, returning the filtered value
+    T apply(const T &sample) {
+        _output += (sample - _output) * _alpha;
+        return _output;
+    }
+
+    // filter a block of samples, in and out may be the same array
+    void apply(const T *in, T *out, uint32_t count);
+
+    // set the filter alpha directly, or from the sample period and cutoff
+    void set_alpha(float alpha) { _alpha = alpha; }
+    void set_cutoff_frequency(float dt, float cutoff_freq_hz);
+
+    float get_alpha() const { return _alpha; }
+    const T &get() const { return _output; }
+
+    void reset(const T &value) { _output = value; }
+    void reset() { _output = T(); }
+
+private:
+    float _alpha = 1.0f;
+    T _output = T();
+};
+
+/*
+  biquad filter in transposed direct form II
+ */
+template <class T>
+class BiquadFilter {
+public:
+    BiquadFilter() { _coeff.pass_through(); }
+
+    // apply a new sample, returning the filtered value
+    T apply(const T &sample) {
+        const T out = sample * _coeff.b0 + _s1;
+        _s1 = sample * _coeff.b1 - out * _coeff.a1 + _s2;
+        _s2 = sample * _coeff.b2 - out * _coeff.a2;
+        return out;
+    }
+
+    // filter a block of samples, in and out may be the same array
+    void apply(const T *in, T *out, uint32_t count);
+
+    // configure as a low pass or notch filter, keeping the filter state
+    void set_lowpass(float sample_freq_hz, float cutoff_freq_hz) {
+        _coeff.lowpass(sample_freq_hz, cutoff_freq_hz);
+    }
+    void set_notch(float sample_freq_hz, float center_freq_hz, float bandwidth_hz, float attenuation_dB) {
+        _coeff.notch(sample_freq_hz, center_freq_hz, bandwidth_hz, attenuation_dB);
+    }
+    void set_coefficients(const BiquadCoefficients &coeff) { _coeff = coeff; }
+    const BiquadCoefficients &get_coefficients() const { return _coeff; }
+
+    // reset the state to the steady state for a constant input
+    void reset(const T &value);
+    void reset() { _s1 = _s2 = T(); }
+
+private:
+    BiquadCoefficients _coeff;
+    T _s1 = T();
+    T _s2 = T();
+};
+
+/*
+  cascade of notch filters on a fundamental frequency and its harmonics
+ */
+#define HARMONIC_NOTCH_MAX_HARMONICS 8
+
+template <class T>
+class HarmonicNotchFilter {
+public:
+    /*
+      setup the filter. harmonics is a bitmask, bit 0 is the
+      fundamental, bit 1 the 2nd harmonic and so on. The bandwidth is
+      for the notch on the fundamental at center_freq_hz, the other
+      notches have the same Q so their bandwidth scales with frequency
+     */
+    void init(float sample_freq_hz, uint8_t harmonics, float center_freq_hz, float bandwidth_hz, float attenuation_dB);
+
+    // move the notches to a new fundamental frequency
+    void update(float center_freq_hz);
+
+    // apply a new sample, returning the filtered value
+    T apply(const T &sample);
+
+    // filter a block of samples, in and out may be the same array
+    void apply(const T *in, T *out, uint32_t count);
+
+    void reset();
+
+    uint8_t num_notches() const { return _num_notches; }
+
+private:
+    BiquadFilter<T> _notch[HARMONIC_NOTCH_MAX_HARMONICS];
+    uint8_t _harmonic_mult[HARMONIC_NOTCH_MAX_HARMONICS] {};
+    uint8_t _num_notches = 0;
+    float _sample_freq_hz = 0.0f;
+    float _A = 1.0f;
+    float _Q = 0.0f;
+    float _center_freq_hz = 0.0f;
+    bool _enabled = false;
+};
+
+/*
+  first order low pass filter over N float channels
+ */
+template <uint8_t N>
+class LowPassFilter1SoA {
+public:
+    LowPassFilter1SoA() { reset(); }
+
+    // apply one sample for every channel
+    void apply(const float *in, float *out) {
+        const float alpha = _alpha;
+        for (uint8_t i = 0; i < N; i++) {
+            _output[i] += (in[i] - _output[i]) * alpha;
+            out[i] = _output[i];
+        }
+    }
+
+    // filter count samples of N interleaved channels
+    void apply(const float *in, float *out, uint32_t count) {
+        for (uint32_t s = 0; s < count; s++) {
+            apply(&in[s*N], &out[s*N]);
+        }
+    }
+
+    void set_alpha(float alpha) { _alpha = alpha; }
+    void set_cutoff_frequency(float dt, float cutoff_freq_hz) {
+        _alpha = calc_lowpass_alpha_dt(dt, cutoff_freq_hz);
+    }
+
+    const float *get() const { return _output; }
+
+    void reset() {
+        for (uint8_t i = 0; i < N; i++) {
+            _output[i] = 0;
+        }
+    }
+
+private:
+    float _alpha = 1.0f;
+    float _output[N];
+};
+
+/*
+  biquad filter over N float channels sharing one set of coefficients
+ */
+template <uint8_t N>
+class BiquadFilterSoA {
+public:
+    BiquadFilterSoA() {
+        _coeff.pass_through();
+        reset();
+    }
+
+    // apply one sample for every channel
+    void apply(const float *in, float *out) {
+        const BiquadCoefficients c = _coeff;
+        for (uint8_t i = 0; i < N; i++) {
+            const float x = in[i];
+            const float y = x * c.b0 + _s1[i];
+            _s1[i] = x * c.b1 - y * c.a1 + _s2[i];
+            _s2[i] = x * c.b2 - y * c.a2;
+            out[i] = y;
+        }
+    }
+
+    // filter count samples of N interleaved channels
+    void apply(const float *in, float *out, uint32_t count) {
+        for (uint32_t s = 0; s < count; s++) {
+            apply(&in[s*N], &out[s*N]);
+        }
+    }
+
+    void set_lowpass(float sample_freq_hz, float cutoff_freq_hz) {
+        _coeff.lowpass(sample_freq_hz, cutoff_freq_hz);
+    }
+    void set_notch(float sample_freq_hz, float center_freq_hz, float bandwidth_hz, float attenuation_dB) {
+        _coeff.notch(sample_freq_hz, center_freq_hz, bandwidth_hz, attenuation_dB);
+    }
+    void set_coefficients(const BiquadCoefficients &coeff) { _coeff = coeff; }
+
+    void reset() {
+        for (uint8_t i = 0; i < N; i++) {
+            _s1[i] = _s2[i] = 0;
+        }
+    }
+
+private:
+    BiquadCoefficients _coeff;
+    float _s1[N];
+    float _s2[N];
+};
+
+/*
+  harmonic notch over NUM_CHANNELS float channels, e.g. 3 axes of
+  several IMUs. State and coefficients are stored [harmonic][channel]
+  so each notch stage is one vectorisable loop over the channels. The
+  notches run in series, so harmonics can't be vectorised against each
+  other for the same sample.
+ */
+template <uint8_t MAX_HARMONICS, uint8_t NUM_CHANNELS>
+class HarmonicNotchBank {
+public:
+    HarmonicNotchBank() { reset(); }
+
+    /*
+      setup the bank. harmonics is a bitmask as for HarmonicNotchFilter,
+      with no more than MAX_HARMONICS bits set. All channels start on
+      center_freq_hz
+     */
+    void init(float sample_freq_hz, uint16_t harmonics, float center_freq_hz, float bandwidth_hz, float attenuation_dB) {
+        _sample_freq_hz = sample_freq_hz;
+        _num_notches = 0;
+        for (uint8_t i = 0; i < 16 && _num_notches < MAX_HARMONICS; i++) {
+            if (harmonics & (1U << i)) {
+                _harmonic_mult[_num_notches++] = i + 1;
+            }
+        }
+        BiquadCoefficients::calc_A_Q(center_freq_hz, bandwidth_hz, attenuation_dB, _A, _Q);
+        reset();
+        update(center_freq_hz);
+    }
+
+    // move all channels to a new fundamental frequency
+    void update(float center_freq_hz) {
+        BiquadCoefficients coeff[MAX_HARMONICS];
+        BiquadCoefficients::harmonic_notches(_sample_freq_hz, center_freq_hz, _A, _Q, _harmonic_mult, _num_notches, coeff);
+        for (uint8_t h = 0; h < _num_notches; h++) {
+            for (uint8_t c = 0; c < NUM_CHANNELS; c++) {
+                set_coefficients(h, c, coeff[h]);
+            }
+        }
+    }
+
+    // move channels [first_channel, first_channel+count) to a new fundamental frequency
+    void update(uint8_t first_channel, uint8_t count, float center_freq_hz) {
+        BiquadCoefficients coeff[MAX_HARMONICS];
+        BiquadCoefficients::harmonic_notches(_sample_freq_hz, center_freq_hz, _A, _Q, _harmonic_mult, _num_notches, coeff);
+        for (uint8_t h = 0; h < _num_notches; h++) {
+            for (uint8_t c = first_channel; c < first_channel + count && c < NUM_CHANNELS; c++) {
+                set_coefficients(h, c, coeff[h]);
+            }
+        }
+    }
+
+    // filter one sample for every channel in place
+    void apply(float *sample) {
+        for (uint8_t h = 0; h < _num_notches; h++) {
+            // for a notch a1 == b1, so the middle term shares one multiply
+            for (uint8_t c = 0; c < NUM_CHANNELS; c++) {
+                const float x = sample[c];
+                const float y = x * _b0[h][c] + _s1[h][c];
+                _s1[h][c] = (x - y) * _b1[h][c] + _s2[h][c];
+                _s2[h][c] = x * _b2[h][c] - y * _a2[h][c];
+                sample[c] = y;
+            }
+        }
+    }
+
+    // filter count samples of NUM_CHANNELS interleaved channels
+    void apply(const float *in, float *out, uint32_t count) {
+        if (in != out) {
+            memcpy(out, in, count * NUM_CHANNELS * sizeof(float));
+        }
+        for (uint32_t s = 0; s < count; s++) {
+            apply(&out[s*NUM_CHANNELS]);
+        }
+    }
+
+    void reset() {
+        memset(_s1, 0, sizeof(_s1));
+        memset(_s2, 0, sizeof(_s2));
+    }
+
+    uint8_t num_notches() const { return _num_notches; }
+
+private:
+    void set_coefficients(uint8_t h, uint8_t c, const BiquadCoefficients &coeff) {
+        _b0[h][c] = coeff.b0;
+        _b1[h][c] = coeff.b1;
+        _b2[h][c] = coeff.b2;
+        _a2[h][c] = coeff.a2;
+    }
+
+    float _b0[MAX_HARMONICS][NUM_CHANNELS];
+    float _b1[MAX_HARMONICS][NUM_CHANNELS];
+    float _b2[MAX_HARMONICS][NUM_CHANNELS];
+    float _a2[MAX_HARMONICS][NUM_CHANNELS];
+    float _s1[MAX_HARMONICS][NUM_CHANNELS];
+    float _s2[MAX_HARMONICS][NUM_CHANNELS];
+    uint8_t _harmonic_mult[MAX_HARMONICS];
+    uint8_t _num_notches = 0;
+    float _sample_freq_hz;
+    float _A;
+    float _Q;
+};
+
+typedef LowPassFilter1<float> LowPassFilter1Float;
+typedef LowPassFilter1<Vector2f> LowPassFilter1Vector2f;
+typedef LowPassFilter1<Vector3f> LowPassFilter1Vector3f;
+typedef BiquadFilter<float> BiquadFilterFloat;
+typedef BiquadFilter<Vector2f> BiquadFilterVector2f;
+typedef BiquadFilter<Vector3f> BiquadFilterVector3f;
+typedef HarmonicNotchFilter<float> HarmonicNotchFilterFloat;
+typedef HarmonicNotchFilter<Vector3f> HarmonicNotchFilterVector3f;
@@ -62,6 +62,12 @@ typedef float ftype;
 #define toftype tofloat
 #endif
 
+/*
+  sin and cos of the same angle. Keeping the two calls together lets
+  gcc replace them with one sincos call when the C library provides it
+ */
+#define sincosF(x, s, c) do { const ftype _sincos_x = (x); s = sinF(_sincos_x); c = cosF(_sincos_x); } while (0)
+
 #if MATH_CHECK_INDEXES
 #define ZERO_FARRAY(a) a.zero()
 #else
@@ -0,0 +1,305 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "instrumentation.h"
+#include "Embed_Math.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#if AP_MATH_INSTRUMENTATION_ENABLED
+#include <atomic>
+
+namespace {
+
+constexpr uint16_t MAX_PROBES = MathInstrumentation::MAX_PROBES;
+constexpr uint8_t HISTOGRAM_BUCKETS = MathProbeStats::HISTOGRAM_BUCKETS;
+
+/*
+  counters of one thread. Only the owning thread writes them, so the
+  atomics are for snapshot() reading them at the same time and compile
+  to plain loads and stores
+ */
+struct ThreadCounters {
+    std::atomic<uint64_t> calls[MAX_PROBES];
+    std::atomic<uint64_t> cycles[MAX_PROBES];
+    std::atomic<uint64_t> histogram[MAX_PROBES][HISTOGRAM_BUCKETS];
+    // cleared when the owning thread exits, so a new thread can take them over
+    std::atomic<bool> in_use;
+    ThreadCounters *next;
+};
+
+// gives up this thread's counters when it exits
+struct ThreadCountersOwner {
+    ThreadCounters *counters;
+
+    ~ThreadCountersOwner() {
+        if (counters != nullptr) {
+            counters->in_use.store(false, std::memory_order_release);
+            counters = nullptr;
+        }
+    }
+};
+
+std::atomic<uint16_t> num_probes;
+std::atomic<const char *> probe_names[MAX_PROBES];
+
+// every thread that has recorded a call, newest first
+std::atomic<ThreadCounters *> thread_list;
+thread_local ThreadCountersOwner thread_counters;
+
+void add(std::atomic<uint64_t> &counter, uint64_t v)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+}
+
+/*
+  the counters of a thread that has exited, or new ones. Counts of the
+  old thread are kept, so totals still include it
+ */
+ThreadCounters *get_thread_counters()
+{
+    if (thread_counters.counters != nullptr) {
+        return thread_counters.counters;
+    }
+    for (ThreadCounters *c = thread_list.load(std::memory_order_acquire); c != nullptr; c = c->next) {
+        bool in_use = false;
+        if (!c->in_use.load(std::memory_order_relaxed) &&
+            c->in_use.compare_exchange_strong(in_use, true, std::memory_order_acquire, std::memory_order_relaxed)) {
+            thread_counters.counters = c;
+            return c;
+        }
+    }
+    // value initialisation zeroes the counters
+    ThreadCounters *c = NEW_NOTHROW ThreadCounters();
+    if (c == nullptr) {
+        return nullptr;
+    }
+    c->in_use.store(true, std::memory_order_relaxed);
+    c->next = thread_list.load(std::memory_order_relaxed);
+    while (!thread_list.compare_exchange_weak(c->next, c, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+    thread_counters.counters = c;
+    return c;
+}
+
+}
+
+MathProbe::MathProbe(const char *name) :
+    _name(name)
+{
+    uint16_t id = num_probes.load(std::memory_order_relaxed);
+    do {
+        if (id >= MAX_PROBES) {
+            _id = MAX_PROBES;
+            return;
+        }
+    } while (!num_probes.compare_exchange_weak(id, id + 1, std::memory_order_relaxed));
+    _id = id;
+    probe_names[id].store(name, std::memory_order_release);
+}
+
+const char *MathInstrumentation::cycle_unit()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return "tsc";
+#elif defined(__aarch64__)
+    return "cntvct";
+#else
+    return "ns";
+#endif
+}
+
+void MathInstrumentation::record(const MathProbe &probe, uint64_t cycles)
+{
+    const uint16_t id = probe.get_id();
+    ThreadCounters *c = get_thread_counters();
+    if (id >= MAX_PROBES || c == nullptr) {
+        return;
+    }
+    const uint8_t bucket = cycles == 0 ? 0 : MIN(63 - __builtin_clzll(cycles), HISTOGRAM_BUCKETS - 1);
+    add(c->calls[id], 1);
+    add(c->cycles[id], cycles);
+    add(c->histogram[id][bucket], 1);
+}
+
+uint16_t MathInstrumentation::get_num_probes()
+{
+    return MIN(num_probes.load(std::memory_order_relaxed), MAX_PROBES);
+}
+
+bool MathInstrumentation::get_stats(uint16_t id, MathProbeStats &stats)
+{
+    if (id >= get_num_probes()) {
+        return false;
+    }
+    // a probe may have its id but not yet its name
+    const char *name = probe_names[id].load(std::memory_order_acquire);
+    if (name == nullptr) {
+        return false;
+    }
+    stats = {};
+    stats.name = name;
+    for (const ThreadCounters *c = thread_list.load(std::memory_order_acquire); c != nullptr; c = c->next) {
+        stats.calls += c->calls[id].load(std::memory_order_relaxed);
+        stats.cycles += c->cycles[id].load(std::memory_order_relaxed);
+        for (uint8_t b = 0; b < HISTOGRAM_BUCKETS; b++) {
+            stats.histogram[b] += c->histogram[id][b].load(std::memory_order_relaxed);
+        }
+    }
+    return true;
+}
+
+void MathInstrumentation::reset()
+{
+    for (ThreadCounters *c = thread_list.load(std::memory_order_acquire); c != nullptr; c = c->next) {
+        for (uint16_t id = 0; id < MAX_PROBES; id++) {
+            c->calls[id].store(0, std::memory_order_relaxed);
+            c->cycles[id].store(0, std::memory_order_relaxed);
+            for (uint8_t b = 0; b < HISTOGRAM_BUCKETS; b++) {
+                c->histogram[id][b].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+#else  // AP_MATH_INSTRUMENTATION_ENABLED
+
+MathProbe::MathProbe(const char *name) :
+    _name(name),
+    _id(MathInstrumentation::MAX_PROBES)
+{
+}
+
+const char *MathInstrumentation::cycle_unit()
+{
+    return "none";
+}
+
+void MathInstrumentation::record(const MathProbe &, uint64_t)
+{
+}
+
+uint16_t MathInstrumentation::get_num_probes()
+{
+    return 0;
+}
+
+bool MathInstrumentation::get_stats(uint16_t, MathProbeStats &)
+{
+    return false;
+}
+
+void MathInstrumentation::reset()
+{
+}
+
+#endif  // AP_MATH_INSTRUMENTATION_ENABLED
+
+uint16_t MathInstrumentation::snapshot(MathProbeStats *stats, uint16_t max_probes)
+{
+    uint16_t count = 0;
+    const uint16_t n = get_num_probes();
+    for (uint16_t id = 0; id < n && count < max_probes; id++) {
+        if (get_stats(id, stats[count])) {
+            count++;
+        }
+    }
+    return count;
+}
+
+namespace {
+
+// appends formatted text to a buffer, counting what didn't fit
+class Writer {
+public:
+    Writer(char *buf, size_t len) :
+        _buf(buf),
+        _len(len),
+        _pos(0)
+    {
+        if (len > 0) {
+            buf[0] = 0;
+        }
+    }
+
+    void append(const char *fmt, ...) FMT_PRINTF(2, 3) {
+        const size_t space = _pos < _len ? _len - _pos : 0;
+        va_list ap;
+        va_start(ap, fmt);
+        const int n = vsnprintf(space > 0 ? _buf + _pos : nullptr, space, fmt, ap);
+        va_end(ap);
+        if (n > 0) {
+            _pos += n;
+        }
+    }
+
+    size_t length() const { return _pos; }
+
+private:
+    char *_buf;
+    size_t _len;
+    size_t _pos;
+};
+
+}
+
+size_t MathInstrumentation::export_text(char *buf, size_t len)
+{
+    Writer w(buf, len);
+    w.append("%-40s %12s %16s %10s  histogram (log2 %s: calls)\n", "probe", "calls", cycle_unit(), "mean", cycle_unit());
+    // one probe at a time, to keep the stack small
+    const uint16_t n = get_num_probes();
+    MathProbeStats s;
+    for (uint16_t id = 0; id < n; id++) {
+        if (!get_stats(id, s)) {
+            continue;
+        }
+        w.append("%-40s %12llu %16llu %10.1f ", s.name,
+                 (unsigned long long)s.calls, (unsigned long long)s.cycles,
+                 s.calls > 0 ? double(s.cycles) / double(s.calls) : 0.0);
+        for (uint8_t b = 0; b < MathProbeStats::HISTOGRAM_BUCKETS; b++) {
+            if (s.histogram[b] != 0) {
+                w.append(" %u:%llu", unsigned(b), (unsigned long long)s.histogram[b]);
+            }
+        }
+        w.append("\n");
+    }
+    return w.length();
+}
+
+size_t MathInstrumentation::export_json(char *buf, size_t len)
+{
+    Writer w(buf, len);
+    w.append("{\"unit\":\"%s\",\"probes\":[", cycle_unit());
+    const uint16_t n = get_num_probes();
+    MathProbeStats s;
+    bool first = true;
+    for (uint16_t id = 0; id < n; id++) {
+        if (!get_stats(id, s)) {
+            continue;
+        }
+        // probe names are identifiers, so need no escaping
+        w.append("%s{\"name\":\"%s\",\"calls\":%llu,\"cycles\":%llu,\"histogram\":[", first ? "" : ",",
+                 s.name, (unsigned long long)s.calls, (unsigned long long)s.cycles);
+        for (uint8_t b = 0; b < MathProbeStats::HISTOGRAM_BUCKETS; b++) {
+            w.append("%s%llu", b > 0 ? "," : "", (unsigned long long)s.histogram[b]);
+        }
+        w.append("]}");
+        first = false;
+    }
+    w.append("]}\n");
+    return w.length();
+}
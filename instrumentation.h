@@ -0,0 +1,163 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  opt-in call counting and timing of hot functions, for finding which
+  ones dominate under load without an external profiler.
+
+  A function is instrumented by starting it with
+
+    AP_MATH_PROBE("name");
+
+  which expands to nothing unless the library is built with
+  AP_MATH_INSTRUMENTATION_ENABLED set to 1. When enabled, each call
+  adds one to the probe's call count and adds the cycles spent in the
+  function to its total and to a histogram with one bucket per power of
+  two. Cycles are the time stamp counter on x86, the virtual counter on
+  AArch64 and nanoseconds from clock_gettime() elsewhere; cycle_unit()
+  says which.
+
+  Each thread writes its own counters, taken the first time it passes
+  a probe, so recording takes no lock and no atomic read-modify-write.
+  Counters are never freed: those of a thread that exits keep their
+  counts and are taken over by the next new thread, so pools that
+  restart their threads don't grow them. snapshot() sums the counters
+  of every thread that has run, while they keep running. Threads are needed
+  for thread_local storage, so this is meant for Linux and SITL
+  profiling builds rather than flight firmware.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef AP_MATH_INSTRUMENTATION_ENABLED
+#define AP_MATH_INSTRUMENTATION_ENABLED 0
+#endif
+
+#if AP_MATH_INSTRUMENTATION_ENABLED
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#elif !defined(__aarch64__)
+#include <time.h>
+#endif
+#endif
+
+// totals of one probe over all threads
+struct MathProbeStats {
+    static constexpr uint8_t HISTOGRAM_BUCKETS = 32;
+
+    const char *name;
+    uint64_t calls;
+    uint64_t cycles;
+    // histogram[i] counts calls of 2^i to 2^(i+1)-1 cycles, the last bucket everything longer
+    uint64_t histogram[HISTOGRAM_BUCKETS];
+};
+
+// a named function, registered the first time it is called
+class MathProbe {
+public:
+    explicit MathProbe(const char *name);
+
+    const char *get_name() const { return _name; }
+
+    // index of the probe, MAX_PROBES if there was no room for it
+    uint16_t get_id() const { return _id; }
+
+private:
+    const char *_name;
+    uint16_t _id;
+};
+
+class MathInstrumentation {
+public:
+    static constexpr uint16_t MAX_PROBES = 64;
+
+    // current cycle count in cycle_unit()
+    static uint64_t cycles() {
+#if !AP_MATH_INSTRUMENTATION_ENABLED
+        return 0;
+#elif defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        uint64_t v;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+        return v;
+#else
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return uint64_t(ts.tv_sec) * 1000000000ULL + uint64_t(ts.tv_nsec);
+#endif
+    }
+
+    // "tsc", "cntvct" or "ns", or "none" when disabled
+    static const char *cycle_unit();
+
+    // add one call of the given number of cycles to a probe, for this thread
+    static void record(const MathProbe &probe, uint64_t cycles);
+
+    // number of probes registered, including any without a name yet
+    static uint16_t get_num_probes();
+
+    // totals of the probe with the given id. Returns false if it isn't registered
+    static bool get_stats(uint16_t id, MathProbeStats &stats);
+
+    /*
+      fill stats with the totals of up to max_probes probes, in the order
+      they were registered. Returns the number filled, 0 when disabled
+     */
+    static uint16_t snapshot(MathProbeStats *stats, uint16_t max_probes);
+
+    /*
+      write a snapshot as a table or as JSON, always nul terminated.
+      Like snprintf(), return the length the full output needs, so a
+      return of len or more means it was truncated
+     */
+    static size_t export_text(char *buf, size_t len);
+    static size_t export_json(char *buf, size_t len);
+
+    /*
+      zero the counters of every thread. Calls being recorded at the
+      same time may keep their counts
+     */
+    static void reset();
+};
+
+// times its enclosing scope into a probe
+class MathProbeScope {
+public:
+    explicit MathProbeScope(const MathProbe &probe) :
+        _probe(probe),
+        _start(MathInstrumentation::cycles()) {}
+
+    ~MathProbeScope() {
+        MathInstrumentation::record(_probe, MathInstrumentation::cycles() - _start);
+    }
+
+    MathProbeScope(const MathProbeScope &) = delete;
+    MathProbeScope &operator=(const MathProbeScope &) = delete;
+
+private:
+    const MathProbe &_probe;
+    const uint64_t _start;
+};
+
+#if AP_MATH_INSTRUMENTATION_ENABLED
+#define AP_MATH_PROBE(name) \
+    static MathProbe _math_probe(name); \
+    MathProbeScope _math_probe_scope(_math_probe)
+#else
+#define AP_MATH_PROBE(name)
+#endif
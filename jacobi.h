@@ -0,0 +1,67 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  the rotation of the cyclic Jacobi eigen decomposition of a symmetric
+  matrix, shared by Matrix3::symmetric_eigen(), mat_symmetric_eigen()
+  and QuaternionAverage
+ */
+#pragma once
+
+#include <cmath>
+#include <stdint.h>
+
+/*
+  rotate rows and columns p and q of the symmetric N x N matrix m to
+  zero m[p][q], accumulating the rotation into the columns of v. See
+  Numerical Recipes, section 11.1. There are no branches, so it can be
+  used in loops vectorised across matrices: when m[p][q] is already
+  zero the rotation is the identity
+ */
+template <uint8_t p, uint8_t q, uint8_t N, typename T>
+inline void jacobi_rotate(T (&m)[N][N], T (&v)[N][N])
+{
+    static_assert(p < q && q < N, "p and q must be different rows of the matrix");
+    const T apq = m[p][q];
+    const bool skip = apq == 0;
+    const T theta = (m[q][q] - m[p][p]) / (2 * (skip ? T(1) : apq));
+    const T abs_theta = theta < 0 ? -theta : theta;
+    // the smaller rotation angle, with t = 0 if theta^2 overflows
+    const T t0 = 1 / (abs_theta + std::sqrt(theta * theta + 1));
+    const T t = skip ? T(0) : (theta < 0 ? -t0 : t0);
+    const T c = 1 / std::sqrt(t * t + 1);
+    const T s = t * c;
+
+    m[p][p] -= t * apq;
+    m[q][q] += t * apq;
+    m[p][q] = m[q][p] = 0;
+#pragma GCC unroll 16
+    for (uint8_t r = 0; r < N; r++) {
+        if (r != p && r != q) {
+            const T arp = m[r][p];
+            const T arq = m[r][q];
+            m[r][p] = m[p][r] = c * arp - s * arq;
+            m[r][q] = m[q][r] = s * arp + c * arq;
+        }
+    }
+
+#pragma GCC unroll 16
+    for (uint8_t k = 0; k < N; k++) {
+        const T vkp = v[k][p];
+        const T vkq = v[k][q];
+        v[k][p] = c * vkp - s * vkq;
+        v[k][q] = s * vkp + c * vkq;
+    }
+}
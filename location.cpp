@@ -22,6 +22,7 @@
 #include <stdlib.h>
 #include "AP_Math.h"
 #include "location.h"
+#include "precision.h"
 
 // return bearing_rad in radians between two positions
 float get_bearing_rad(const Vector2f &origin, const Vector2f &destination)
@@ -29,6 +30,28 @@ float get_bearing_rad(const Vector2f &origin, const Vector2f &destination)
     return wrap_2PI(atan2f(destination.y - origin.y, destination.x - origin.x));
 }
 
+template <typename P>
+typename P::type get_horizontal_distance(const Vector2<typename P::type> &origin, const Vector2<typename P::type> &destination)
+{
+    const Vector2<typename P::type> diff = destination - origin;
+    return P::sqrt(diff.x*diff.x + diff.y*diff.y);
+}
+
+template <typename P>
+typename P::type get_bearing_rad(const Vector2<typename P::type> &origin, const Vector2<typename P::type> &destination)
+{
+    typedef typename P::type F;
+    const F bearing = P::atan2(destination.y - origin.y, destination.x - origin.x);
+    return bearing < 0 ? F(bearing + M_2PI) : bearing;
+}
+
+#define LOCATION_PRECISION(P) \
+    template P::type get_horizontal_distance<P>(const Vector2<P::type> &origin, const Vector2<P::type> &destination); \
+    template P::type get_bearing_rad<P>(const Vector2<P::type> &origin, const Vector2<P::type> &destination);
+LOCATION_PRECISION(PrecisionFloat)
+LOCATION_PRECISION(PrecisionDouble)
+LOCATION_PRECISION(PrecisionFast)
+
 // return bearing_cd in centi-degrees between two positions
 float get_bearing_cd(const Vector2f &origin, const Vector2f &destination)
 {
@@ -20,6 +20,12 @@ float get_horizontal_distance(const Vector2<T> &origin, const Vector2<T> &destin
 // return bearing in radians between two positions
 float        get_bearing_rad(const Vector2f &origin, const Vector2f &destination);
 
+// get_horizontal_distance() and get_bearing_rad() in precision policy P (see precision.h)
+template <typename P>
+typename P::type get_horizontal_distance(const Vector2<typename P::type> &origin, const Vector2<typename P::type> &destination);
+template <typename P>
+typename P::type get_bearing_rad(const Vector2<typename P::type> &origin, const Vector2<typename P::type> &destination);
+
 // return bearing in centi-degrees between two positions
 float        get_bearing_cd(const Vector2f &origin, const Vector2f &destination);
 
@@ -19,19 +19,33 @@
 #pragma GCC optimize("O2")
 
 #include "AP_Math.h"
+#include "jacobi.h"
 
 // create a rotation matrix given some euler angles
 // this is based on https://github.com/ArduPilot/Datasheets/blob/main/References/EulerAngles.pdf
 template <typename T>
 void Matrix3<T>::from_euler(T roll, T pitch, T yaw)
 {
-    const T cp = cosF(pitch);
-    const T sp = sinF(pitch);
-    const T sr = sinF(roll);
-    const T cr = cosF(roll);
-    const T sy = sinF(yaw);
-    const T cy = cosF(yaw);
+    T sr, cr, sp, cp, sy, cy;
+    sincosF(roll, sr, cr);
+    sincosF(pitch, sp, cp);
+    sincosF(yaw, sy, cy);
+    from_euler_sin_cos(sr, cr, sp, cp, sy, cy);
+}
+
+template <typename T>
+void Matrix3<T>::from_euler_fast(T roll, T pitch, T yaw)
+{
+    float sr, cr, sp, cp, sy, cy;
+    fast_sincosf(roll, sr, cr);
+    fast_sincosf(pitch, sp, cp);
+    fast_sincosf(yaw, sy, cy);
+    from_euler_sin_cos(sr, cr, sp, cp, sy, cy);
+}
 
+template <typename T>
+void Matrix3<T>::from_euler_sin_cos(T sr, T cr, T sp, T cp, T sy, T cy)
+{
     a.x = cp * cy;
     a.y = (sr * sp * cy) - (cr * sy);
     a.z = (cr * sp * cy) + (sr * sy);
@@ -62,6 +76,16 @@ void Matrix3<T>::to_euler(T *roll, T *pitch, T *yaw) const
 template <typename T>
 void Matrix3<T>::from_rotation(enum Rotation rotation)
 {
+    if (rotation < ROTATION_MAX) {
+        // from the same table as the quaternions, see rotations.cpp
+        const double (*m)[3] = rotation_constants.matrix[rotation];
+        a = Vector3<T>(T(m[0][0]), T(m[0][1]), T(m[0][2]));
+        b = Vector3<T>(T(m[1][0]), T(m[1][1]), T(m[1][2]));
+        c = Vector3<T>(T(m[2][0]), T(m[2][1]), T(m[2][2]));
+        return;
+    }
+
+    // custom rotations
     (*this).a = {1,0,0};
     (*this).b = {0,1,0};
     (*this).c = {0,0,1};
@@ -91,12 +115,32 @@ Vector3<T> Matrix3<T>::to_euler312() const
 template <typename T>
 void Matrix3<T>::from_euler312(T roll, T pitch, T yaw)
 {
-    const T c3 = cosF(pitch);
-    const T s3 = sinF(pitch);
-    const T s2 = sinF(roll);
-    const T c2 = cosF(roll);
-    const T s1 = sinF(yaw);
-    const T c1 = cosF(yaw);
+    T sr, cr, sp, cp, sy, cy;
+    sincosF(roll, sr, cr);
+    sincosF(pitch, sp, cp);
+    sincosF(yaw, sy, cy);
+    from_euler312_sin_cos(sr, cr, sp, cp, sy, cy);
+}
+
+template <typename T>
+void Matrix3<T>::from_euler312_fast(T roll, T pitch, T yaw)
+{
+    float sr, cr, sp, cp, sy, cy;
+    fast_sincosf(roll, sr, cr);
+    fast_sincosf(pitch, sp, cp);
+    fast_sincosf(yaw, sy, cy);
+    from_euler312_sin_cos(sr, cr, sp, cp, sy, cy);
+}
+
+template <typename T>
+void Matrix3<T>::from_euler312_sin_cos(T sr, T cr, T sp, T cp, T sy, T cy)
+{
+    const T c3 = cp;
+    const T s3 = sp;
+    const T s2 = sr;
+    const T c2 = cr;
+    const T s1 = sy;
+    const T c1 = cy;
 
     a.x = c1 * c3 - s1 * s2 * s3;
     b.y = c1 * c2;
@@ -227,6 +271,167 @@ bool Matrix3<T>::invert()
     return success;
 }
 
+/*
+  trigonometric solution of the characteristic cubic of a symmetric
+  matrix, see https://en.wikipedia.org/wiki/Eigenvalue_algorithm#3%C3%973_matrices
+*/
+template <typename T>
+Vector3<T> Matrix3<T>::symmetric_eigenvalues() const
+{
+    const T q = (a.x + b.y + c.z) / 3;
+    const T p1 = a.y * a.y + a.z * a.z + b.z * b.z;
+    const T dx = a.x - q;
+    const T dy = b.y - q;
+    const T dz = c.z - q;
+    const T p2 = dx * dx + dy * dy + dz * dz + 2 * p1;
+    if (p2 <= 0) {
+        // multiple of the identity
+        return Vector3<T>(q, q, q);
+    }
+    const T p = std::sqrt(p2 / 6);
+
+    // half the determinant of (A - qI)/p, which is in [-1, 1]
+    const T bx = dx / p;
+    const T by = dy / p;
+    const T bz = dz / p;
+    const T bxy = a.y / p;
+    const T bxz = a.z / p;
+    const T byz = b.z / p;
+    const T r = 0.5f * (bx * (by * bz - byz * byz) - bxy * (bxy * bz - byz * bxz) + bxz * (bxy * byz - by * bxz));
+    const T phi = std::acos(constrain_value(r, T(-1), T(1))) / 3;
+
+    const T largest = q + 2 * p * std::cos(phi);
+    const T smallest = q + 2 * p * std::cos(phi + T(2 * M_PI / 3));
+    return Vector3<T>(smallest, 3 * q - largest - smallest, largest);
+}
+
+template <typename T>
+static void swap_columns(Matrix3<T> &m, uint8_t i, uint8_t j)
+{
+    for (uint8_t k = 0; k < 3; k++) {
+        const T tmp = m[k][i];
+        m[k][i] = m[k][j];
+        m[k][j] = tmp;
+    }
+}
+
+template <typename T>
+void Matrix3<T>::symmetric_eigen(Vector3<T> &values, Matrix3<T> &vectors) const
+{
+    T m[3][3] = {{a.x, a.y, a.z},
+                 {a.y, b.y, b.z},
+                 {a.z, b.z, c.z}};
+    T v[3][3] = {{1, 0, 0},
+                 {0, 1, 0},
+                 {0, 0, 1}};
+
+    // sq() is only ftype precision, so squares are written out here
+    const T eps = std::numeric_limits<T>::epsilon();
+    // convergence is quadratic, so this limit is only reached for NaN
+    for (uint8_t sweep = 0; sweep < 16; sweep++) {
+        const T off = m[0][1] * m[0][1] + m[0][2] * m[0][2] + m[1][2] * m[1][2];
+        const T diag = m[0][0] * m[0][0] + m[1][1] * m[1][1] + m[2][2] * m[2][2];
+        if (off <= eps * eps * diag) {
+            break;
+        }
+        jacobi_rotate<0, 1>(m, v);
+        jacobi_rotate<0, 2>(m, v);
+        jacobi_rotate<1, 2>(m, v);
+    }
+    vectors = Matrix3<T>(v[0][0], v[0][1], v[0][2],
+                         v[1][0], v[1][1], v[1][2],
+                         v[2][0], v[2][1], v[2][2]);
+
+    values = Vector3<T>(m[0][0], m[1][1], m[2][2]);
+    for (uint8_t i = 0; i < 2; i++) {
+        for (uint8_t j = 2; j > i; j--) {
+            if (values[j] < values[j-1]) {
+                const T tmp = values[j];
+                values[j] = values[j-1];
+                values[j-1] = tmp;
+                swap_columns(vectors, j, j-1);
+            }
+        }
+    }
+}
+
+// a unit vector perpendicular to the unit vector v
+template <typename T>
+static Vector3<T> perpendicular(const Vector3<T> &v)
+{
+    // cross with the axis v is furthest from
+    Vector3<T> axis;
+    if (std::fabs(v.x) <= std::fabs(v.y) && std::fabs(v.x) <= std::fabs(v.z)) {
+        axis.x = 1;
+    } else if (std::fabs(v.y) <= std::fabs(v.z)) {
+        axis.y = 1;
+    } else {
+        axis.z = 1;
+    }
+    const Vector3<T> p = v % axis;
+    return p / std::sqrt(p.length_squared());
+}
+
+/*
+  V is found from the eigenvectors of A^T A. The columns of A*V are
+  then orthogonal with lengths of the singular values, and a Gram
+  Schmidt QR of them gives U. Taking the singular values from A*V
+  rather than the square root of the eigenvalues keeps the small ones
+  accurate
+*/
+template <typename T>
+void Matrix3<T>::svd(Matrix3<T> &U, Vector3<T> &S, Matrix3<T> &V) const
+{
+    Vector3<T> lambda;
+    (transposed() * *this).symmetric_eigen(lambda, V);
+    // largest first
+    swap_columns(V, 0, 2);
+
+    const Matrix3<T> B = *this * V;
+    const Vector3<T> b0 = B.colx();
+    const Vector3<T> b1 = B.coly();
+    const Vector3<T> b2 = B.colz();
+
+    // columns that are zero to within rounding of the largest have no
+    // direction of their own, so any orthogonal completion will do
+    // length() is only ftype precision
+    const T s0 = std::sqrt(b0.length_squared());
+    const Vector3<T> u0 = s0 > std::numeric_limits<T>::min() ? b0 / s0 : Vector3<T>(1, 0, 0);
+    const Vector3<T> w1 = b1 - u0 * (u0 * b1);
+    T s1 = std::sqrt(w1.length_squared());
+    Vector3<T> u1;
+    if (s1 > std::numeric_limits<T>::epsilon() * s0) {
+        u1 = w1 / s1;
+    } else {
+        u1 = perpendicular(u0);
+        s1 = 0;
+    }
+    Vector3<T> u2 = u0 % u1;
+    T s2 = u2 * b2;
+    if (s2 < 0) {
+        u2 = -u2;
+        s2 = -s2;
+    }
+
+    U = Matrix3<T>(u0.x, u1.x, u2.x,
+                   u0.y, u1.y, u2.y,
+                   u0.z, u1.z, u2.z);
+    S = Vector3<T>(s0, s1, s2);
+
+    // rounding can leave near equal singular values out of order
+    for (uint8_t i = 0; i < 2; i++) {
+        for (uint8_t j = 2; j > i; j--) {
+            if (S[j] > S[j-1]) {
+                const T tmp = S[j];
+                S[j] = S[j-1];
+                S[j-1] = tmp;
+                swap_columns(U, j, j-1);
+                swap_columns(V, j, j-1);
+            }
+        }
+    }
+}
+
 // create rotation matrix for rotation about the vector v by angle theta
 // See: http://www.euclideanspace.com/maths/geometry/rotations/conversions/angleToMatrix/
 template <typename T>
@@ -218,6 +218,30 @@ public:
      */
     bool invert() WARN_IF_UNUSED;
 
+    /*
+      eigenvalues of a symmetric matrix in ascending order, in closed
+      form from the characteristic cubic. Only the upper triangle is
+      used. Close eigenvalues lose precision, use symmetric_eigen()
+      when they matter
+    */
+    Vector3<T> symmetric_eigenvalues() const;
+
+    /*
+      eigen decomposition of a symmetric matrix by cyclic Jacobi
+      rotations. Only the upper triangle is used. values are in
+      ascending order and the columns of vectors are the matching unit
+      eigenvectors, so *this = vectors * diag(values) * vectors^T
+    */
+    void symmetric_eigen(Vector3<T> &values, Matrix3<T> &vectors) const;
+
+    /*
+      singular value decomposition *this = U * diag(S) * V^T, with S
+      non-negative and in descending order and U and V orthogonal. U
+      and V may be reflections, for the nearest rotation (Kabsch)
+      negate the last column of U when U*V^T has a negative determinant
+    */
+    void svd(Matrix3<T> &U, Vector3<T> &S, Matrix3<T> &V) const;
+
     // zero the matrix
     void        zero(void) {
         memset((void*)this, 0, sizeof(*this));
@@ -240,6 +264,23 @@ public:
     */
     void        from_euler(T roll, T pitch, T yaw);
 
+    // as from_euler(), using fast_sincosf() in float precision
+    void        from_euler_fast(T roll, T pitch, T yaw);
+
+    // as from_euler(), given the sin and cos of each angle
+    void        from_euler_sin_cos(T sr, T cr, T sp, T cp, T sy, T cy);
+
+    // as from_euler(), in precision policy P (see precision.h)
+    template <typename P>
+    void        from_euler(T roll, T pitch, T yaw)
+    {
+        typename P::type sr, cr, sp, cp, sy, cy;
+        P::sincos(roll, sr, cr);
+        P::sincos(pitch, sp, cp);
+        P::sincos(yaw, sy, cy);
+        from_euler_sin_cos(sr, cr, sp, cp, sy, cy);
+    }
+
     /* create eulers from a rotation matrix.
        roll is from -Pi to Pi
        pitch is from -Pi/2 to Pi/2
@@ -248,6 +289,21 @@ public:
     */
     void        to_euler(T *roll, T *pitch, T *yaw) const;
 
+    // as to_euler(), in precision policy P
+    template <typename P>
+    void        to_euler(T *roll, T *pitch, T *yaw) const
+    {
+        if (pitch != nullptr) {
+            *pitch = -P::safe_asin(c.x);
+        }
+        if (roll != nullptr) {
+            *roll = P::atan2(c.y, c.z);
+        }
+        if (yaw != nullptr) {
+            *yaw = P::atan2(b.x, a.x);
+        }
+    }
+
     // create matrix from rotation enum
     void from_rotation(enum Rotation rotation);
     
@@ -263,6 +319,12 @@ public:
     */
     void from_euler312(T roll, T pitch, T yaw);
 
+    // as from_euler312(), using fast_sincosf() in float precision
+    void from_euler312_fast(T roll, T pitch, T yaw);
+
+    // as from_euler312(), given the sin and cos of each angle
+    void from_euler312_sin_cos(T sr, T cr, T sp, T cp, T sy, T cy);
+
     // apply an additional rotation from a body frame gyro vector
     // to a rotation matrix.
     void        rotate(const Vector3<T> &g);
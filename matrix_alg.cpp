@@ -18,6 +18,7 @@
 
 #include <AP_HAL/AP_HAL.h>
 #include "AP_Math.h"
+#include "instrumentation.h"
 
 #include <stdio.h>
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
@@ -431,6 +432,8 @@ static bool inverse4x4(const T m[],T invOut[])
 template<typename T>
 bool mat_inverse(const T x[], T y[], uint16_t dim)
 {
+    AP_MATH_PROBE(sizeof(T) == sizeof(double) ? "mat_inverse<double>" : "mat_inverse<float>");
+
     switch(dim){
     case 3: return inverse3x3(x,y);
     case 4: return inverse4x4(x,y);
@@ -0,0 +1,459 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma GCC optimize("O2")
+
+#include "matrix_batch.h"
+#include "thread_pool.h"
+#include "jacobi.h"
+
+// matrices per thread pool chunk for the decompositions
+#define MATRIX_BATCH_CHUNK 1024
+
+template <typename T, uint8_t N>
+void MatrixSoA<T,N>::pack(const T *m, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        for (uint8_t k = 0; k < N*N; k++) {
+            e[k][i] = m[i*N*N + k];
+        }
+    }
+}
+
+template <typename T, uint8_t N>
+void MatrixSoA<T,N>::unpack(T *m, uint32_t count) const
+{
+    for (uint32_t i = 0; i < count; i++) {
+        for (uint8_t k = 0; k < N*N; k++) {
+            m[i*N*N + k] = e[k][i];
+        }
+    }
+}
+
+/*
+  adjugate and determinant of one row major matrix, as inverse3x3()
+  in matrix_alg.cpp
+ */
+template <typename T>
+static inline T adjugate(const T (&m)[9], T (&adj)[9])
+{
+    adj[0] = m[4] * m[8] - m[7] * m[5];
+    adj[1] = m[2] * m[7] - m[1] * m[8];
+    adj[2] = m[1] * m[5] - m[2] * m[4];
+    adj[3] = m[5] * m[6] - m[3] * m[8];
+    adj[4] = m[0] * m[8] - m[2] * m[6];
+    adj[5] = m[3] * m[2] - m[0] * m[5];
+    adj[6] = m[3] * m[7] - m[6] * m[4];
+    adj[7] = m[6] * m[1] - m[0] * m[7];
+    adj[8] = m[0] * m[4] - m[3] * m[1];
+    return m[0] * adj[0] + m[1] * adj[3] + m[2] * adj[6];
+}
+
+template <typename T>
+static inline T determinant(const T (&m)[9])
+{
+    return m[0] * (m[4] * m[8] - m[7] * m[5]) -
+           m[1] * (m[3] * m[8] - m[5] * m[6]) +
+           m[2] * (m[3] * m[7] - m[4] * m[6]);
+}
+
+/*
+  4x4 adjugate from the 2x2 minors of the top and bottom row pairs,
+  which needs far fewer multiplies than the cofactor expansion used by
+  inverse4x4() in matrix_alg.cpp
+ */
+template <typename T>
+static inline T adjugate(const T (&m)[16], T (&adj)[16])
+{
+    const T s0 = m[0] * m[5] - m[4] * m[1];
+    const T s1 = m[0] * m[6] - m[4] * m[2];
+    const T s2 = m[0] * m[7] - m[4] * m[3];
+    const T s3 = m[1] * m[6] - m[5] * m[2];
+    const T s4 = m[1] * m[7] - m[5] * m[3];
+    const T s5 = m[2] * m[7] - m[6] * m[3];
+
+    const T c5 = m[10] * m[15] - m[14] * m[11];
+    const T c4 = m[9] * m[15] - m[13] * m[11];
+    const T c3 = m[9] * m[14] - m[13] * m[10];
+    const T c2 = m[8] * m[15] - m[12] * m[11];
+    const T c1 = m[8] * m[14] - m[12] * m[10];
+    const T c0 = m[8] * m[13] - m[12] * m[9];
+
+    adj[0] = m[5] * c5 - m[6] * c4 + m[7] * c3;
+    adj[1] = -m[1] * c5 + m[2] * c4 - m[3] * c3;
+    adj[2] = m[13] * s5 - m[14] * s4 + m[15] * s3;
+    adj[3] = -m[9] * s5 + m[10] * s4 - m[11] * s3;
+
+    adj[4] = -m[4] * c5 + m[6] * c2 - m[7] * c1;
+    adj[5] = m[0] * c5 - m[2] * c2 + m[3] * c1;
+    adj[6] = -m[12] * s5 + m[14] * s2 - m[15] * s1;
+    adj[7] = m[8] * s5 - m[10] * s2 + m[11] * s1;
+
+    adj[8] = m[4] * c4 - m[5] * c2 + m[7] * c0;
+    adj[9] = -m[0] * c4 + m[1] * c2 - m[3] * c0;
+    adj[10] = m[12] * s4 - m[13] * s2 + m[15] * s0;
+    adj[11] = -m[8] * s4 + m[9] * s2 - m[11] * s0;
+
+    adj[12] = -m[4] * c3 + m[5] * c1 - m[6] * c0;
+    adj[13] = m[0] * c3 - m[1] * c1 + m[2] * c0;
+    adj[14] = -m[12] * s3 + m[13] * s1 - m[14] * s0;
+    adj[15] = m[8] * s3 - m[9] * s1 + m[10] * s0;
+
+    return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+}
+
+template <typename T>
+static inline T determinant(const T (&m)[16])
+{
+    const T s0 = m[0] * m[5] - m[4] * m[1];
+    const T s1 = m[0] * m[6] - m[4] * m[2];
+    const T s2 = m[0] * m[7] - m[4] * m[3];
+    const T s3 = m[1] * m[6] - m[5] * m[2];
+    const T s4 = m[1] * m[7] - m[5] * m[3];
+    const T s5 = m[2] * m[7] - m[6] * m[3];
+
+    const T c5 = m[10] * m[15] - m[14] * m[11];
+    const T c4 = m[9] * m[15] - m[13] * m[11];
+    const T c3 = m[9] * m[14] - m[13] * m[10];
+    const T c2 = m[8] * m[15] - m[12] * m[11];
+    const T c1 = m[8] * m[14] - m[12] * m[10];
+    const T c0 = m[8] * m[13] - m[12] * m[9];
+
+    return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+}
+
+template <typename T, uint8_t N>
+void mat_det(const MatrixSoA<T,N> &m, T *det, uint32_t count)
+{
+    // local copy of the element pointers so they stay in registers.
+    // The element loops are unrolled so each pointer is a separate
+    // value and the loop over matrices can be vectorised
+    const MatrixSoA<T,N> in = m;
+    for (uint32_t i = 0; i < count; i++) {
+        T a[N*N];
+#pragma GCC unroll 16
+        for (uint8_t k = 0; k < N*N; k++) {
+            a[k] = in.e[k][i];
+        }
+        det[i] = determinant(a);
+    }
+}
+
+template <typename T, uint8_t N>
+void mat_inverse(const MatrixSoA<T,N> &m, const MatrixSoA<T,N> &inv, bool *singular, uint32_t count)
+{
+    const MatrixSoA<T,N> in = m;
+    const MatrixSoA<T,N> out = inv;
+    // each matrix only reads and writes its own elements, so there is
+    // no need for the runtime overlap checks between the input and
+    // output arrays, of which there are too many for gcc to version
+    // the loop
+#pragma GCC ivdep
+    for (uint32_t i = 0; i < count; i++) {
+        T a[N*N];
+#pragma GCC unroll 16
+        for (uint8_t k = 0; k < N*N; k++) {
+            a[k] = in.e[k][i];
+        }
+        T adj[N*N];
+        const T d = adjugate(a, adj);
+        // same test as is_zero(det) || isinf(det) in mat_inverse()
+        const T abs_d = d < 0 ? -d : d;
+        const bool fail = (abs_d < T(FLT_EPSILON)) | (abs_d == std::numeric_limits<T>::infinity());
+        const T inv_d = 1 / (fail ? T(1) : d);
+#pragma GCC unroll 16
+        for (uint8_t k = 0; k < N*N; k++) {
+            out.e[k][i] = adj[k] * inv_d;
+        }
+        singular[i] = fail;
+    }
+}
+
+// swap values i and j and columns i and j of v when values[j] < values[i]
+template <uint8_t i, uint8_t j, typename T>
+static inline void sort_lane(T (&values)[3], T (&v)[3][3])
+{
+    const bool swap = values[j] < values[i];
+    const T vi = values[i];
+    values[i] = swap ? values[j] : vi;
+    values[j] = swap ? vi : values[j];
+#pragma GCC unroll 16
+    for (uint8_t k = 0; k < 3; k++) {
+        const T ki = v[k][i];
+        v[k][i] = swap ? v[k][j] : ki;
+        v[k][j] = swap ? ki : v[k][j];
+    }
+}
+
+/*
+  eigen decomposition of the symmetric matrix m, with the
+  values ascending. Jacobi convergence is quadratic, and over random
+  matrices with eigenvalues spread across 12 orders of magnitude no
+  more than 4 sweeps were needed to reach the convergence test of
+  Matrix3::symmetric_eigen() in either precision
+ */
+template <typename T>
+static inline void symmetric_eigen_lane(T (&m)[3][3], T (&values)[3], T (&v)[3][3])
+{
+    const uint8_t sweeps = sizeof(T) == sizeof(float) ? 4 : 5;
+#pragma GCC unroll 16
+    for (uint8_t r = 0; r < 3; r++) {
+#pragma GCC unroll 16
+        for (uint8_t c = 0; c < 3; c++) {
+            v[r][c] = r == c ? T(1) : T(0);
+        }
+    }
+#pragma GCC unroll 16
+    for (uint8_t sweep = 0; sweep < sweeps; sweep++) {
+        jacobi_rotate<0, 1>(m, v);
+        jacobi_rotate<0, 2>(m, v);
+        jacobi_rotate<1, 2>(m, v);
+    }
+    values[0] = m[0][0];
+    values[1] = m[1][1];
+    values[2] = m[2][2];
+    sort_lane<0, 1>(values, v);
+    sort_lane<1, 2>(values, v);
+    sort_lane<0, 1>(values, v);
+}
+
+template <typename T>
+static void mat_symmetric_eigen_range(const MatrixSoA<T,3> &m, const Vector3SoA<T> &values,
+                                      const MatrixSoA<T,3> &vectors, uint32_t count)
+{
+    const MatrixSoA<T,3> in = m;
+    const MatrixSoA<T,3> out = vectors;
+    T *vx = values.x;
+    T *vy = values.y;
+    T *vz = values.z;
+#pragma GCC ivdep
+    for (uint32_t i = 0; i < count; i++) {
+        // upper triangle only
+        T a[3][3];
+        a[0][0] = in.e[0][i];
+        a[0][1] = a[1][0] = in.e[1][i];
+        a[0][2] = a[2][0] = in.e[2][i];
+        a[1][1] = in.e[4][i];
+        a[1][2] = a[2][1] = in.e[5][i];
+        a[2][2] = in.e[8][i];
+        T val[3];
+        T vec[3][3];
+        symmetric_eigen_lane(a, val, vec);
+        vx[i] = val[0];
+        vy[i] = val[1];
+        vz[i] = val[2];
+#pragma GCC unroll 16
+        for (uint8_t r = 0; r < 3; r++) {
+#pragma GCC unroll 16
+            for (uint8_t c = 0; c < 3; c++) {
+                out.e[r*3+c][i] = vec[r][c];
+            }
+        }
+    }
+}
+
+// swap singular values i and j and their columns of u and v when s[j] > s[i]
+template <uint8_t i, uint8_t j, typename T>
+static inline void sort_svd_lane(T (&s)[3], T (&u)[9], T (&v)[9])
+{
+    const bool swap = s[j] > s[i];
+    const T si = s[i];
+    s[i] = swap ? s[j] : si;
+    s[j] = swap ? si : s[j];
+#pragma GCC unroll 16
+    for (uint8_t k = 0; k < 3; k++) {
+        const T ui = u[k*3+i];
+        u[k*3+i] = swap ? u[k*3+j] : ui;
+        u[k*3+j] = swap ? ui : u[k*3+j];
+        const T vi = v[k*3+i];
+        v[k*3+i] = swap ? v[k*3+j] : vi;
+        v[k*3+j] = swap ? vi : v[k*3+j];
+    }
+}
+
+/*
+  U and S of the row major matrix m, as Matrix3::svd(), given the
+  eigenvectors ve of m^T m with ascending eigenvalues. v is set to ve
+  with the largest first. The fallback directions for zero columns are
+  chosen by selects
+ */
+template <typename T>
+static inline void svd_lane(const T (&m)[9], const T (&ve)[9], T (&u)[9], T (&s)[3], T (&v)[9])
+{
+#pragma GCC unroll 16
+    for (uint8_t k = 0; k < 3; k++) {
+        v[k*3] = ve[k*3+2];
+        v[k*3+1] = ve[k*3+1];
+        v[k*3+2] = ve[k*3];
+    }
+
+    // columns of A*V
+    T b[3][3];
+#pragma GCC unroll 16
+    for (uint8_t c = 0; c < 3; c++) {
+#pragma GCC unroll 16
+        for (uint8_t r = 0; r < 3; r++) {
+            b[c][r] = m[r*3] * v[c] + m[r*3+1] * v[3+c] + m[r*3+2] * v[6+c];
+        }
+    }
+
+    const T s0 = std::sqrt(b[0][0] * b[0][0] + b[0][1] * b[0][1] + b[0][2] * b[0][2]);
+    const bool has0 = s0 > std::numeric_limits<T>::min();
+    const T inv0 = 1 / (has0 ? s0 : T(1));
+    const T u0x = has0 ? b[0][0] * inv0 : T(1);
+    const T u0y = b[0][1] * inv0;
+    const T u0z = b[0][2] * inv0;
+
+    const T d01 = u0x * b[1][0] + u0y * b[1][1] + u0z * b[1][2];
+    const T w1x = b[1][0] - u0x * d01;
+    const T w1y = b[1][1] - u0y * d01;
+    const T w1z = b[1][2] - u0z * d01;
+    const T s1 = std::sqrt(w1x * w1x + w1y * w1y + w1z * w1z);
+    const bool has1 = s1 > std::numeric_limits<T>::epsilon() * s0;
+
+    // perpendicular to u0, crossed with the axis it is furthest from
+    const T ax0 = u0x < 0 ? -u0x : u0x;
+    const T ay0 = u0y < 0 ? -u0y : u0y;
+    const T az0 = u0z < 0 ? -u0z : u0z;
+    const bool use_x = (ax0 <= ay0) & (ax0 <= az0);
+    const bool use_y = !use_x & (ay0 <= az0);
+    const T ex = use_x ? T(1) : T(0);
+    const T ey = use_y ? T(1) : T(0);
+    const T ez = 1 - ex - ey;
+    const T px = u0y * ez - u0z * ey;
+    const T py = u0z * ex - u0x * ez;
+    const T pz = u0x * ey - u0y * ex;
+    const T p_len = std::sqrt(px * px + py * py + pz * pz);
+    const T inv1 = 1 / (has1 ? s1 : p_len);
+    const T u1x = (has1 ? w1x : px) * inv1;
+    const T u1y = (has1 ? w1y : py) * inv1;
+    const T u1z = (has1 ? w1z : pz) * inv1;
+
+    T u2x = u0y * u1z - u0z * u1y;
+    T u2y = u0z * u1x - u0x * u1z;
+    T u2z = u0x * u1y - u0y * u1x;
+    const T s2 = u2x * b[2][0] + u2y * b[2][1] + u2z * b[2][2];
+    const bool neg = s2 < 0;
+    u2x = neg ? -u2x : u2x;
+    u2y = neg ? -u2y : u2y;
+    u2z = neg ? -u2z : u2z;
+
+    u[0] = u0x; u[1] = u1x; u[2] = u2x;
+    u[3] = u0y; u[4] = u1y; u[5] = u2y;
+    u[6] = u0z; u[7] = u1z; u[8] = u2z;
+    s[0] = s0;
+    s[1] = has1 ? s1 : T(0);
+    s[2] = neg ? -s2 : s2;
+
+    sort_svd_lane<0, 1>(s, u, v);
+    sort_svd_lane<1, 2>(s, u, v);
+    sort_svd_lane<0, 1>(s, u, v);
+}
+
+/*
+  done in passes, as the whole decomposition in one loop is too large
+  for gcc to if-convert. The outputs hold the intermediate values, m^T
+  m in u and its eigenvalues and vectors in s and v, so no other
+  memory is needed
+ */
+template <typename T>
+static void mat_svd_range(const MatrixSoA<T,3> &m, const MatrixSoA<T,3> &u, const Vector3SoA<T> &s,
+                          const MatrixSoA<T,3> &v, uint32_t count)
+{
+    const MatrixSoA<T,3> in = m;
+    const MatrixSoA<T,3> out_u = u;
+    const MatrixSoA<T,3> out_v = v;
+
+    // upper triangle of m^T m
+#pragma GCC ivdep
+    for (uint32_t i = 0; i < count; i++) {
+        T a[9];
+#pragma GCC unroll 16
+        for (uint8_t k = 0; k < 9; k++) {
+            a[k] = in.e[k][i];
+        }
+#pragma GCC unroll 16
+        for (uint8_t r = 0; r < 3; r++) {
+#pragma GCC unroll 16
+            for (uint8_t c = r; c < 3; c++) {
+                out_u.e[r*3+c][i] = a[r] * a[c] + a[3+r] * a[3+c] + a[6+r] * a[6+c];
+            }
+        }
+    }
+
+    mat_symmetric_eigen_range(out_u, s, out_v, count);
+
+    T *sx = s.x;
+    T *sy = s.y;
+    T *sz = s.z;
+#pragma GCC ivdep
+    for (uint32_t i = 0; i < count; i++) {
+        T a[9];
+        T ve[9];
+#pragma GCC unroll 16
+        for (uint8_t k = 0; k < 9; k++) {
+            a[k] = in.e[k][i];
+            ve[k] = out_v.e[k][i];
+        }
+        T uk[9];
+        T sk[3];
+        T vk[9];
+        svd_lane(a, ve, uk, sk, vk);
+        sx[i] = sk[0];
+        sy[i] = sk[1];
+        sz[i] = sk[2];
+#pragma GCC unroll 16
+        for (uint8_t k = 0; k < 9; k++) {
+            out_u.e[k][i] = uk[k];
+            out_v.e[k][i] = vk[k];
+        }
+    }
+}
+
+// the decompositions are split across the shared thread pool
+template <typename T>
+void mat_symmetric_eigen(const MatrixSoA<T,3> &m, const Vector3SoA<T> &values,
+                         const MatrixSoA<T,3> &vectors, uint32_t count)
+{
+    MathThreadPool::get_shared().parallel_for(0, count, MATRIX_BATCH_CHUNK, [&](uint32_t start, uint32_t end) {
+        mat_symmetric_eigen_range(m.offset(start), values.offset(start), vectors.offset(start), end - start);
+    });
+}
+
+template <typename T>
+void mat_svd(const MatrixSoA<T,3> &m, const MatrixSoA<T,3> &u, const Vector3SoA<T> &s,
+             const MatrixSoA<T,3> &v, uint32_t count)
+{
+    MathThreadPool::get_shared().parallel_for(0, count, MATRIX_BATCH_CHUNK, [&](uint32_t start, uint32_t end) {
+        mat_svd_range(m.offset(start), u.offset(start), s.offset(start), v.offset(start), end - start);
+    });
+}
+
+#define MATRIX_BATCH_INSTANTIATE(T, N) \
+    template struct MatrixSoA<T, N>; \
+    template void mat_det<T, N>(const MatrixSoA<T, N> &, T *, uint32_t); \
+    template void mat_inverse<T, N>(const MatrixSoA<T, N> &, const MatrixSoA<T, N> &, bool *, uint32_t);
+
+MATRIX_BATCH_INSTANTIATE(float, 3)
+MATRIX_BATCH_INSTANTIATE(float, 4)
+MATRIX_BATCH_INSTANTIATE(double, 3)
+MATRIX_BATCH_INSTANTIATE(double, 4)
+
+#define MATRIX3_BATCH_INSTANTIATE(T) \
+    template void mat_symmetric_eigen<T>(const MatrixSoA<T, 3> &, const Vector3SoA<T> &, const MatrixSoA<T, 3> &, uint32_t); \
+    template void mat_svd<T>(const MatrixSoA<T, 3> &, const MatrixSoA<T, 3> &, const Vector3SoA<T> &, const MatrixSoA<T, 3> &, uint32_t);
+
+MATRIX3_BATCH_INSTANTIATE(float)
+MATRIX3_BATCH_INSTANTIATE(double)
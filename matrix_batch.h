@@ -0,0 +1,105 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  determinant and inverse of many independent 3x3 or 4x4 matrices,
+  and eigen and singular value decompositions of 3x3 matrices.
+
+  The matrices are stored as structure of arrays, one array per
+  element, so each loop works on the same element of consecutive
+  matrices and is vectorised across matrices, as in vector3_batch.h.
+  The 3x3 kernels use the same formulas as mat_inverse(); the 4x4
+  kernels use 2x2 minors, which take far fewer multiplies. A matrix is
+  singular when its determinant is zero within FLT_EPSILON or
+  infinite, the same test as mat_inverse() in matrix_alg.cpp. The
+  inverse of a singular matrix is unspecified.
+
+  The decompositions take far longer per matrix than the other
+  kernels, so they are split across the shared thread pool (see
+  thread_pool.h). Each matrix is independent, so the results don't
+  depend on the number of threads.
+
+  Only N of 3 and 4 are instantiated.
+ */
+#pragma once
+
+#include "vector3_batch.h"
+
+/*
+  non-owning structure of arrays view of N x N matrices. e[i*N+j] is
+  the array of element (i, j) of every matrix
+ */
+template <typename T, uint8_t N>
+struct MatrixSoA {
+    T *e[N*N];
+
+    MatrixSoA() {
+        for (uint8_t i = 0; i < N*N; i++) {
+            e[i] = nullptr;
+        }
+    }
+
+    // view of N*N arrays of stride values each, one after another
+    MatrixSoA(T *storage, uint32_t stride) {
+        for (uint8_t i = 0; i < N*N; i++) {
+            e[i] = &storage[i * stride];
+        }
+    }
+
+    T *element(uint8_t i, uint8_t j) const { return e[i*N+j]; }
+
+    // view starting at matrix i
+    MatrixSoA<T,N> offset(uint32_t i) const {
+        MatrixSoA<T,N> ret;
+        for (uint8_t k = 0; k < N*N; k++) {
+            ret.e[k] = e[k] + i;
+        }
+        return ret;
+    }
+
+    // copy from/to count row major N x N matrices, as used by mat_inverse()
+    void pack(const T *m, uint32_t count);
+    void unpack(T *m, uint32_t count) const;
+};
+
+/*
+  determinant of each matrix
+ */
+template <typename T, uint8_t N>
+void mat_det(const MatrixSoA<T,N> &m, T *det, uint32_t count);
+
+/*
+  inverse of each matrix, with singular[i] set for matrices that can't
+  be inverted. inv may be the same arrays as m
+ */
+template <typename T, uint8_t N>
+void mat_inverse(const MatrixSoA<T,N> &m, const MatrixSoA<T,N> &inv, bool *singular, uint32_t count);
+
+/*
+  eigen decomposition of each symmetric 3x3 matrix, as
+  Matrix3::symmetric_eigen(). A fixed number of Jacobi sweeps is used
+  so the lanes don't branch, chosen to reach the precision of T
+ */
+template <typename T>
+void mat_symmetric_eigen(const MatrixSoA<T,3> &m, const Vector3SoA<T> &values,
+                         const MatrixSoA<T,3> &vectors, uint32_t count);
+
+/*
+  singular value decomposition of each 3x3 matrix, as Matrix3::svd().
+  u, s and v must not overlap m
+ */
+template <typename T>
+void mat_svd(const MatrixSoA<T,3> &m, const MatrixSoA<T,3> &u, const Vector3SoA<T> &s,
+             const MatrixSoA<T,3> &v, uint32_t count);
@@ -17,6 +17,7 @@
  */
 
 #include "AP_Math.h"
+#include "instrumentation.h"
 #include "float.h"
 
 #pragma GCC optimize("O2")
@@ -40,6 +41,8 @@
 template <typename T>
 bool Polygon_outside(const Vector2<T> &P, const Vector2<T> *V, unsigned n)
 {
+    AP_MATH_PROBE(sizeof(T) == sizeof(double) ? "Polygon_outside<double>" : "Polygon_outside<float>");
+
     const bool complete = Polygon_complete(V, n);
     if (complete) {
         // the last point is the same as the first point; treat as if
@@ -0,0 +1,161 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  precision policies, for choosing between speed and accuracy per call
+  instead of per build.
+
+  ftype and the sinF(), sqrtF() family are chosen once for the whole
+  build, so one binary can't do offline replay in double while its
+  real-time loops stay in float. Functions taking a policy as a
+  template parameter do their math in P::type using P's functions,
+  letting each caller pick:
+
+    q.from_euler<PrecisionDouble>(roll, pitch, yaw);
+    v.normalize<PrecisionFast>();
+    rate = sqrt_controller<PrecisionDouble>(error, p, accel_max, dt);
+
+  PrecisionFloat gives the same results as the functions without a
+  policy in a float build. PrecisionDouble works in double whatever
+  ftype is. PrecisionFast uses float polynomial approximations, with
+  the errors given below.
+
+  A policy is a struct with these static functions of its type:
+
+    sqrt(x), inv_sqrt(x)   square root and 1/square root
+    approx_inv_sqrt        true if inv_sqrt() is cheaper but less exact
+                           than dividing by sqrt()
+    sincos(x, s, c)        sine and cosine together
+    atan2(y, x)
+    safe_asin(x)           asin constrained like safe_asin()
+    fabs(x)
+ */
+#pragma once
+
+#include "Embed_Math.h"
+
+#include <string.h>
+
+struct PrecisionFloat {
+    typedef float type;
+    static constexpr bool approx_inv_sqrt = false;
+
+    static float sqrt(float x) { return sqrtf(x); }
+    static float inv_sqrt(float x) { return 1.0f / sqrtf(x); }
+    static void sincos(float x, float &s, float &c) {
+        s = sinf(x);
+        c = cosf(x);
+    }
+    static float atan2(float y, float x) { return atan2f(y, x); }
+    static float safe_asin(float x) { return ::safe_asin(x); }
+    static float fabs(float x) { return fabsf(x); }
+};
+
+struct PrecisionDouble {
+    typedef double type;
+    static constexpr bool approx_inv_sqrt = false;
+
+    static double sqrt(double x) { return ::sqrt(x); }
+    static double inv_sqrt(double x) { return 1.0 / ::sqrt(x); }
+    static void sincos(double x, double &s, double &c) {
+        s = ::sin(x);
+        c = ::cos(x);
+    }
+    static double atan2(double y, double x) { return ::atan2(y, x); }
+    static double safe_asin(double x) {
+        if (isnan(x)) {
+            return 0.0;
+        }
+        if (x >= 1.0) {
+            return M_PI / 2;
+        }
+        if (x <= -1.0) {
+            return -M_PI / 2;
+        }
+        return ::asin(x);
+    }
+    static double fabs(double x) { return ::fabs(x); }
+};
+
+struct PrecisionFast {
+    typedef float type;
+    static constexpr bool approx_inv_sqrt = true;
+
+    // no approximation beats the hardware square root
+    static float sqrt(float x) { return sqrtf(x); }
+
+    /*
+      bit pattern estimate refined by two Newton steps, relative error
+      below 5e-6. Avoids the divide and square root, which are slow or
+      done in software on small microcontrollers
+     */
+    static float inv_sqrt(float x) {
+        uint32_t i;
+        memcpy(&i, &x, sizeof(i));
+        i = 0x5f3759df - (i >> 1);
+        float y;
+        memcpy(&y, &i, sizeof(y));
+        const float half_x = 0.5f * x;
+        y = y * (1.5f - half_x * y * y);
+        y = y * (1.5f - half_x * y * y);
+        return y;
+    }
+
+    // error below 2e-7 for angles within +-10000 radians
+    static void sincos(float x, float &s, float &c) { fast_sincosf(x, s, c); }
+
+    /*
+      atan of the smaller over the larger magnitude as an odd
+      polynomial (Abramowitz and Stegun 4.4.49), then moved to the
+      right octant. Error is within a few float roundings of atan2f().
+      Returns 0 for atan2(0, 0)
+     */
+    static float atan2(float y, float x) {
+        const float ax = fabsf(x);
+        const float ay = fabsf(y);
+        const float mx = MAX(ax, ay);
+        if (mx <= 0) {
+            return 0;
+        }
+        const float a = MIN(ax, ay) / mx;
+        const float s = a * a;
+        float r = -0.0040540580f;
+        r = r * s + 0.0218612288f;
+        r = r * s - 0.0559098861f;
+        r = r * s + 0.0964200441f;
+        r = r * s - 0.1390853351f;
+        r = r * s + 0.1994653599f;
+        r = r * s - 0.3332985605f;
+        r = r * s + 0.9999993329f;
+        r *= a;
+        if (ay > ax) {
+            r = float(M_PI / 2) - r;
+        }
+        if (x < 0) {
+            r = float(M_PI) - r;
+        }
+        return y < 0 ? -r : r;
+    }
+
+    static float safe_asin(float x) {
+        if (isnan(x)) {
+            return 0.0f;
+        }
+        x = constrain_value(x, -1.0f, 1.0f);
+        return atan2(x, sqrtf((1.0f - x) * (1.0f + x)));
+    }
+
+    static float fabs(float x) { return fabsf(x); }
+};
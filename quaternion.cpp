@@ -24,11 +24,6 @@
 #include <AP_CustomRotations/AP_CustomRotations.h>
 #include <AP_Vehicle/AP_Vehicle_Type.h>
 
-#define HALF_SQRT_2_PlUS_SQRT_2 0.92387953251128673848313610506011 // sqrt(2 + sqrt(2)) / 2
-#define HALF_SQRT_2_MINUS_SQTR_2 0.38268343236508972626808144923416 // sqrt(2 - sqrt(2)) / 2
-#define HALF_SQRT_HALF_TIMES_TWO_PLUS_SQRT_TWO 0.65328148243818828788676000840496 // sqrt((2 + sqrt(2))/2) / 2
-#define HALF_SQRT_HALF_TIMES_TWO_MINUS_SQRT_TWO 0.27059805007309845059637609665515 // sqrt((2 - sqrt(2))/2) / 2
-
 // return the rotation matrix equivalent for this quaternion
 template <typename T>
 void QuaternionT<T>::rotation_matrix(Matrix3d &m) const
@@ -132,265 +127,22 @@ void QuaternionT<T>::from_rotation_matrix(const Matrix3<T> &m)
 template <typename T>
 void QuaternionT<T>::from_rotation(enum Rotation rotation)
 {
-    // the constants below can be calculated using the following formula:
-    //     Matrix3f m_from_rot;
-    //     m_from_rot.from_rotation(rotation);
-    //     Quaternion q_from_m;
-    //     from_rotation_matrix(m_from_rot);
-
-    switch (rotation) {
-    case ROTATION_NONE:
-        q1 = 1;
-        q2 = q3 = q4 = 0;
-        return;
-
-    case ROTATION_YAW_45:
-        q1 = HALF_SQRT_2_PlUS_SQRT_2;
-        q2 = q3 = 0;
-        q4 = HALF_SQRT_2_MINUS_SQTR_2;
-        return;
-
-    case ROTATION_YAW_90:
-        q1 = HALF_SQRT_2;
-        q2 = q3 = 0;
-        q4 = HALF_SQRT_2;
-        return;
-
-    case ROTATION_YAW_135:
-        q1 = HALF_SQRT_2_MINUS_SQTR_2;
-        q2 = q3 = 0;
-        q4 = HALF_SQRT_2_PlUS_SQRT_2;
-        return;
-
-    case ROTATION_YAW_180:
-        q1 = q2 = q3 = 0;
-        q4=1;
-        return;
-
-    case ROTATION_YAW_225:
-        q1 = -HALF_SQRT_2_MINUS_SQTR_2;
-        q2 = q3 = 0;
-        q4 = HALF_SQRT_2_PlUS_SQRT_2;
-        return;
-
-    case ROTATION_YAW_270:
-        q1 = HALF_SQRT_2;
-        q2 = q3 = 0;
-        q4 = -HALF_SQRT_2;
-        return;
-
-    case ROTATION_YAW_315:
-        q1 = HALF_SQRT_2_PlUS_SQRT_2;
-        q2 = q3 = 0;
-        q4 = -HALF_SQRT_2_MINUS_SQTR_2;
-        return;
-
-    case ROTATION_ROLL_180:
-        q1 = q3 = q4 = 0;
-        q2 = 1;
-        return;
-
-    case ROTATION_ROLL_180_YAW_45:
-        q1 = q4 = 0;
-        q2 = HALF_SQRT_2_PlUS_SQRT_2;
-        q3 = HALF_SQRT_2_MINUS_SQTR_2;
-        return;
-
-    case ROTATION_ROLL_180_YAW_90:
-    case ROTATION_PITCH_180_YAW_270:
-        q1 = q4 = 0;
-        q2 = q3 = HALF_SQRT_2;
-        return;
-
-    case ROTATION_ROLL_180_YAW_135:
-        q1 = q4 = 0;
-        q2 = HALF_SQRT_2_MINUS_SQTR_2;
-        q3 = HALF_SQRT_2_PlUS_SQRT_2;
-        return;
-
-    case ROTATION_PITCH_180:
-        q1 = q2 = q4 = 0;
-        q3 = 1;
-        return;
-
-    case ROTATION_ROLL_180_YAW_225:
-        q1 = q4 = 0;
-        q2 = -HALF_SQRT_2_MINUS_SQTR_2;
-        q3 = HALF_SQRT_2_PlUS_SQRT_2;
-        return;
-
-    case ROTATION_ROLL_180_YAW_270:
-    case ROTATION_PITCH_180_YAW_90:
-        q1 = q4 = 0;
-        q2 = -HALF_SQRT_2;
-        q3 = HALF_SQRT_2;
-        return;
-
-    case ROTATION_ROLL_180_YAW_315:
-        q1 = q4 = 0;
-        q2 = HALF_SQRT_2_PlUS_SQRT_2;
-        q3 = -HALF_SQRT_2_MINUS_SQTR_2;
-        return;
-
-    case ROTATION_ROLL_90:
-        q1 = q2 = HALF_SQRT_2;
-        q3 = q4 = 0;
-        return;
-
-    case ROTATION_ROLL_90_YAW_45:
-        q1 = HALF_SQRT_HALF_TIMES_TWO_PLUS_SQRT_TWO;
-        q2 = HALF_SQRT_HALF_TIMES_TWO_PLUS_SQRT_TWO;
-        q3 = q4 = HALF_SQRT_HALF_TIMES_TWO_MINUS_SQRT_TWO;
-        return;
-
-    case ROTATION_ROLL_90_YAW_90:
-        q1 = q2 = q3 = q4 = 0.5f;
-        return;
-
-    case ROTATION_ROLL_90_YAW_135:
-        q1 = q2 = HALF_SQRT_HALF_TIMES_TWO_MINUS_SQRT_TWO;
-        q3 = HALF_SQRT_HALF_TIMES_TWO_PLUS_SQRT_TWO;
-        q4 = HALF_SQRT_HALF_TIMES_TWO_PLUS_SQRT_TWO;
-        return;
-
-    case ROTATION_ROLL_270:
-        q1 = HALF_SQRT_2;
-        q2 = -HALF_SQRT_2;
-        q3 = q4 = 0;
-        return;
-
-    case ROTATION_ROLL_270_YAW_45:
-        q1 = HALF_SQRT_HALF_TIMES_TWO_PLUS_SQRT_TWO;
-        q2 = -HALF_SQRT_HALF_TIMES_TWO_PLUS_SQRT_TWO;
-        q3 = -HALF_SQRT_HALF_TIMES_TWO_MINUS_SQRT_TWO;
-        q4 = HALF_SQRT_HALF_TIMES_TWO_MINUS_SQRT_TWO;
-        return;
-
-    case ROTATION_ROLL_270_YAW_90:
-        q1 = q4 = 0.5f;
-        q2 = q3 = -0.5f;
-        return;
-
-    case ROTATION_ROLL_270_YAW_135:
-        q1 = HALF_SQRT_HALF_TIMES_TWO_MINUS_SQRT_TWO;
-        q2 = -HALF_SQRT_HALF_TIMES_TWO_MINUS_SQRT_TWO;
-        q3 = -HALF_SQRT_HALF_TIMES_TWO_PLUS_SQRT_TWO;
-        q4 = HALF_SQRT_HALF_TIMES_TWO_PLUS_SQRT_TWO;
-        return;
-
-    case ROTATION_PITCH_90:
-        q1 = q3 = HALF_SQRT_2;
-        q2 = q4 = 0;
-        return;
-
-    case ROTATION_PITCH_270:
-        q1 = HALF_SQRT_2;
-        q2 = q4 = 0;
-        q3 = -HALF_SQRT_2;
-        return;
-
-    case ROTATION_ROLL_90_PITCH_90:
-        q1 = q2 = q3 = -0.5f;
-        q4 = 0.5f;
-        return;
-
-    case ROTATION_ROLL_180_PITCH_90:
-        q1 = q3 = 0;
-        q2 = -HALF_SQRT_2;
-        q4 = HALF_SQRT_2;
-        return;
-
-    case ROTATION_ROLL_270_PITCH_90:
-        q1 = q3 = q4 = 0.5f;
-        q2 = -0.5f;
-        return;
-
-    case ROTATION_ROLL_90_PITCH_180:
-        q1 = q2 = 0;
-        q3 = -HALF_SQRT_2;
-        q4 = HALF_SQRT_2;
-        return;
-
-    case ROTATION_ROLL_270_PITCH_180:
-        q1 = q2 = 0;
-        q3 = q4 = HALF_SQRT_2;
-        return;
-
-    case ROTATION_ROLL_90_PITCH_270:
-        q1 = q2 = q4 = 0.5f;
-        q3 = -0.5;
-        return;
-
-    case ROTATION_ROLL_180_PITCH_270:
-        q1 = q3 = 0;
-        q2 = q4 = HALF_SQRT_2;
-        return;
-
-    case ROTATION_ROLL_270_PITCH_270:
-        q1 = -0.5f;
-        q2 = q3 = q4 = 0.5f;
-        return;
-
-    case ROTATION_ROLL_90_PITCH_180_YAW_90:
-        q1 = q3 = -0.5f;
-        q2 = q4 = 0.5f;
-        return;
-
-    case ROTATION_ROLL_90_YAW_270:
-        q1 = q2 = -0.5f;
-        q3 = q4 = 0.5f;
-        return;
-
-    case ROTATION_ROLL_90_PITCH_68_YAW_293:
-        q1 = 0.26774500501681575137524760066299;
-        q2 = 0.70698804688952421315661922562867;
-        q3 = 0.012957683254962659713527273197542;
-        q4 = -0.65445596665363614530264158020145;
-        return;
-
-    case ROTATION_PITCH_315:
-        q1 = HALF_SQRT_2_PlUS_SQRT_2;
-        q2 = q4 = 0;
-        q3 = -HALF_SQRT_2_MINUS_SQTR_2;
-        return;
-
-    case ROTATION_ROLL_90_PITCH_315:
-        q1 = HALF_SQRT_HALF_TIMES_TWO_PLUS_SQRT_TWO;
-        q2 = HALF_SQRT_HALF_TIMES_TWO_PLUS_SQRT_TWO;
-        q3 = -HALF_SQRT_HALF_TIMES_TWO_MINUS_SQRT_TWO;
-        q4 = HALF_SQRT_HALF_TIMES_TWO_MINUS_SQRT_TWO;
-        return;
-
-    case ROTATION_PITCH_7:
-        q1 = 0.99813479842186692003735970502021;
-        q2 = q4 = 0;
-        q3 = 0.061048539534856872956769535676358;
+    if (rotation < ROTATION_MAX) {
+        // generated from the rotation matrices, see rotations.cpp
+        const double *q = rotation_constants.quaternion[rotation];
+        q1 = T(q[0]);
+        q2 = T(q[1]);
+        q3 = T(q[2]);
+        q4 = T(q[3]);
         return;
-
-    case ROTATION_ROLL_45:
-        q1 = HALF_SQRT_2_PlUS_SQRT_2;
-        q2 = HALF_SQRT_2_MINUS_SQTR_2;
-        q3 = q4 = 0.0;
-        return;
-
-    case ROTATION_ROLL_315:
-        q1 = HALF_SQRT_2_PlUS_SQRT_2;
-        q2 = -HALF_SQRT_2_MINUS_SQTR_2;
-        q3 = q4 = 0.0;
-        return;
-
-    case ROTATION_CUSTOM_1:
-    case ROTATION_CUSTOM_2:
+    }
 #if AP_CUSTOMROTATIONS_ENABLED
+    if (rotation == ROTATION_CUSTOM_1 || rotation == ROTATION_CUSTOM_2) {
         // custom rotations not supported on eg. Periph by default
         AP::custom_rotations().from_rotation(rotation, *this);
         return;
-#endif
-    case ROTATION_MAX:
-    case ROTATION_CUSTOM_OLD:
-    case ROTATION_CUSTOM_END:
-        break;
     }
+#endif
     // rotation invalid
     INTERNAL_ERROR(AP_InternalError::error_t::bad_rotation);
 }
@@ -407,31 +159,36 @@ void QuaternionT<T>::rotate(enum Rotation rotation)
     *this *= q_from_rot;
 }
 
-// convert a vector from earth to body frame
+// create a quaternion from Euler angles
 template <typename T>
-void QuaternionT<T>::earth_to_body(Vector3<T> &v) const
+void QuaternionT<T>::from_euler(T roll, T pitch, T yaw)
 {
-    Matrix3<T> m;
-    rotation_matrix(m);
-    v = m * v;
+    T sr2, cr2, sp2, cp2, sy2, cy2;
+    sincosF(roll*0.5, sr2, cr2);
+    sincosF(pitch*0.5, sp2, cp2);
+    sincosF(yaw*0.5, sy2, cy2);
+    from_euler_sin_cos_half(sr2, cr2, sp2, cp2, sy2, cy2);
 }
 
-// create a quaternion from Euler angles
 template <typename T>
-void QuaternionT<T>::from_euler(T roll, T pitch, T yaw)
+void QuaternionT<T>::from_euler_fast(T roll, T pitch, T yaw)
 {
-    const T cr2 = cosF(roll*0.5);
-    const T cp2 = cosF(pitch*0.5);
-    const T cy2 = cosF(yaw*0.5);
-    const T sr2 = sinF(roll*0.5);
-    const T sp2 = sinF(pitch*0.5);
-    const T sy2 = sinF(yaw*0.5);
+    float sr2, cr2, sp2, cp2, sy2, cy2;
+    fast_sincosf(roll*0.5f, sr2, cr2);
+    fast_sincosf(pitch*0.5f, sp2, cp2);
+    fast_sincosf(yaw*0.5f, sy2, cy2);
+    from_euler_sin_cos_half(sr2, cr2, sp2, cp2, sy2, cy2);
+}
 
+template <typename T>
+void QuaternionT<T>::from_euler_sin_cos_half(T sr2, T cr2, T sp2, T cp2, T sy2, T cy2)
+{
     q1 = cr2*cp2*cy2 + sr2*sp2*sy2;
     q2 = sr2*cp2*cy2 - cr2*sp2*sy2;
     q3 = cr2*sp2*cy2 + sr2*cp2*sy2;
     q4 = cr2*cp2*sy2 - sr2*sp2*cy2;
 }
+
 template <typename T>
 void QuaternionT<T>::from_euler(const Vector3<T> &v)
 {
@@ -723,34 +480,6 @@ QuaternionT<T> QuaternionT<T>::operator*(const QuaternionT<T> &v) const
     return ret;
 }
 
-// Optimized quaternion rotation operator, equivalent to converting
-// (*this) to a rotation matrix then multiplying it to the argument `v`.
-//
-// 15 multiplies and 15 add / subtracts. Caches 3 floats
-template <typename T>
-Vector3<T> QuaternionT<T>::operator*(const Vector3<T> &v) const
-{
-    // This uses the formula
-    //
-    //    v2 = v1 + 2 q1 * qv x v1 + 2 qv x qv x v1
-    //
-    // where "x" is the cross product (explicitly inlined for performance below), 
-    // "q1" is the scalar part and "qv" is the vector part of this quaternion
-
-    Vector3<T> ret = v;
-
-    // Compute and cache "qv x v1"
-    T uv[] = {q3 * v.z - q4 * v.y, q4 * v.x - q2 * v.z, q2 * v.y - q3 * v.x};
-
-    uv[0] += uv[0];
-    uv[1] += uv[1];
-    uv[2] += uv[2];
-    ret.x += q1 * uv[0] + q3 * uv[2] - q4 * uv[1];
-    ret.y += q1 * uv[1] + q4 * uv[0] - q2 * uv[2];
-    ret.z += q1 * uv[2] + q2 * uv[1] - q3 * uv[0];
-    return ret;
-}
-
 template <typename T>
 QuaternionT<T> &QuaternionT<T>::operator*=(const QuaternionT<T> &v)
 {
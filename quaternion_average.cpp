@@ -0,0 +1,153 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma GCC optimize("O2")
+
+#include "quaternion_average.h"
+#include "jacobi.h"
+
+template <typename T>
+void QuaternionAverageT<T>::reset()
+{
+    memset(_m, 0, sizeof(_m));
+    _weight = 0;
+    _count = 0;
+    _rejected = 0;
+    _next_reference_count = _min_samples;
+    _have_reference = false;
+}
+
+template <typename T>
+void QuaternionAverageT<T>::set_outlier_rejection(T max_angle, uint32_t min_samples)
+{
+    _cos_half_max_angle = max_angle > 0 ? std::cos(MIN(max_angle, T(M_PI)) * T(0.5)) : -1;
+    _min_samples = MAX(min_samples, 1U);
+    _next_reference_count = MAX(_count, _min_samples);
+    _have_reference = false;
+}
+
+template <typename T>
+bool QuaternionAverageT<T>::update(const QuaternionT<T> &q, T weight)
+{
+    if (_have_reference) {
+        const T dot = q.q1*_reference.q1 + q.q2*_reference.q2 + q.q3*_reference.q3 + q.q4*_reference.q4;
+        if (std::fabs(dot) < _cos_half_max_angle) {
+            _rejected++;
+            return false;
+        }
+    }
+
+    const double w = weight;
+    const double q1 = q.q1, q2 = q.q2, q3 = q.q3, q4 = q.q4;
+    _m[0] += w * q1 * q1;
+    _m[1] += w * q1 * q2;
+    _m[2] += w * q1 * q3;
+    _m[3] += w * q1 * q4;
+    _m[4] += w * q2 * q2;
+    _m[5] += w * q2 * q3;
+    _m[6] += w * q2 * q4;
+    _m[7] += w * q3 * q3;
+    _m[8] += w * q3 * q4;
+    _m[9] += w * q4 * q4;
+    _weight += w;
+    _count++;
+
+    // refresh the mean used to reject outliers as the count doubles
+    if (_cos_half_max_angle > -1 && _count >= _next_reference_count) {
+        _have_reference = get_mean(_reference);
+        _next_reference_count = _count * 2;
+    }
+    return true;
+}
+
+template <typename T>
+void QuaternionAverageT<T>::update(const QuaternionT<T> *q, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        update(q[i]);
+    }
+}
+
+template <typename T>
+void QuaternionAverageT<T>::merge(const QuaternionAverageT<T> &other)
+{
+    for (uint8_t i = 0; i < ARRAY_SIZE(_m); i++) {
+        _m[i] += other._m[i];
+    }
+    _weight += other._weight;
+    _count += other._count;
+    _rejected += other._rejected;
+
+    // the reference no longer matches, solve again on the next sample
+    _next_reference_count = MAX(_count, _min_samples);
+    _have_reference = false;
+}
+
+template <typename T>
+bool QuaternionAverageT<T>::get_mean(QuaternionT<T> &mean, T *concentration) const
+{
+    if (!(_weight > 0)) {
+        return false;
+    }
+
+    double m[4][4], v[4][4];
+    uint8_t k = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        for (uint8_t j = i; j < 4; j++) {
+            m[i][j] = m[j][i] = _m[k++];
+        }
+        for (uint8_t j = 0; j < 4; j++) {
+            v[i][j] = i == j ? 1 : 0;
+        }
+    }
+
+    for (uint8_t sweep = 0; sweep < 16; sweep++) {
+        double off = 0, diag = 0;
+        for (uint8_t i = 0; i < 4; i++) {
+            diag += m[i][i] * m[i][i];
+            for (uint8_t j = i + 1; j < 4; j++) {
+                off += m[i][j] * m[i][j];
+            }
+        }
+        if (off <= diag * std::numeric_limits<double>::epsilon() * std::numeric_limits<double>::epsilon()) {
+            break;
+        }
+        jacobi_rotate<0, 1>(m, v);
+        jacobi_rotate<0, 2>(m, v);
+        jacobi_rotate<0, 3>(m, v);
+        jacobi_rotate<1, 2>(m, v);
+        jacobi_rotate<1, 3>(m, v);
+        jacobi_rotate<2, 3>(m, v);
+    }
+
+    uint8_t largest = 0;
+    for (uint8_t i = 1; i < 4; i++) {
+        if (m[i][i] > m[largest][largest]) {
+            largest = i;
+        }
+    }
+
+    // the columns of v are unit length. Keep a positive scalar part, as
+    // the sign is arbitrary
+    const double sign = v[0][largest] < 0 ? -1 : 1;
+    mean = QuaternionT<T>(sign * v[0][largest], sign * v[1][largest], sign * v[2][largest], sign * v[3][largest]);
+    if (concentration != nullptr) {
+        *concentration = m[largest][largest] / _weight;
+    }
+    return true;
+}
+
+template class QuaternionAverageT<float>;
+template class QuaternionAverageT<double>;
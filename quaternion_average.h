@@ -0,0 +1,101 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  streaming weighted average of attitudes.
+
+  The mean is the one of Markley et al, "Averaging Quaternions"
+  (2007): the eigenvector of the largest eigenvalue of
+
+    M = sum(w[i] * q[i] * q[i]^T)
+
+  which minimises the weighted sum of squared Frobenius distances
+  between the rotation matrices. q and -q give the same M, so the sign
+  of each sample doesn't matter. Only the 10 unique elements of M are
+  kept, in double, and the 4x4 eigen problem is solved by Jacobi
+  rotations when the mean is asked for.
+
+  Samples should be unit length. Accumulators filled on different
+  threads can be combined with merge(), which gives the same M as
+  adding every sample to one accumulator, up to rounding.
+
+  Optionally, samples further than an angle from the current mean are
+  rejected. The mean used for this is solved again each time the
+  number of accepted samples doubles, starting from min_samples, so
+  the cost stays O(log n) solves for n samples.
+ */
+#pragma once
+
+#include "Embed_Math.h"
+
+template <typename T>
+class QuaternionAverageT {
+public:
+    QuaternionAverageT() { reset(); }
+
+    // forget all samples
+    void reset();
+
+    /*
+      add a sample with the given weight. Returns false if it was
+      rejected as an outlier
+     */
+    bool update(const QuaternionT<T> &q, T weight = 1);
+
+    // add count samples with weight one
+    void update(const QuaternionT<T> *q, uint32_t count);
+
+    // add the samples of another accumulator
+    void merge(const QuaternionAverageT<T> &other);
+
+    /*
+      weighted mean attitude. Returns false if there are no samples.
+      If concentration is given it is set to the largest eigenvalue
+      over the total weight, which is one when all samples agree and
+      falls towards 0.25 as they spread over all attitudes
+     */
+    bool get_mean(QuaternionT<T> &mean, T *concentration = nullptr) const;
+
+    /*
+      reject samples more than max_angle radians from the mean, once
+      min_samples have been accepted. A max_angle of zero disables
+      rejection
+     */
+    void set_outlier_rejection(T max_angle, uint32_t min_samples = 16);
+
+    // accepted and rejected samples
+    uint32_t get_count() const { return _count; }
+    uint32_t get_rejected_count() const { return _rejected; }
+
+    // sum of the accepted weights
+    double get_weight() const { return _weight; }
+
+private:
+    // upper triangle of M, row by row
+    double _m[10];
+    double _weight;
+    uint32_t _count;
+    uint32_t _rejected;
+
+    // outlier rejection
+    T _cos_half_max_angle = -1;
+    uint32_t _min_samples = 16;
+    uint32_t _next_reference_count;
+    bool _have_reference;
+    QuaternionT<T> _reference;
+};
+
+typedef QuaternionAverageT<float> QuaternionAverage;
+typedef QuaternionAverageT<double> QuaternionAverageD;
@@ -0,0 +1,257 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma GCC optimize("O2")
+
+#include "quaternion_batch.h"
+
+template <typename T>
+void QuaternionSoA<T>::pack(const QuaternionT<T> *q, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        q1[i] = q[i].q1;
+        q2[i] = q[i].q2;
+        q3[i] = q[i].q3;
+        q4[i] = q[i].q4;
+    }
+}
+
+template <typename T>
+void QuaternionSoA<T>::unpack(QuaternionT<T> *q, uint32_t count) const
+{
+    for (uint32_t i = 0; i < count; i++) {
+        q[i].q1 = q1[i];
+        q[i].q2 = q2[i];
+        q[i].q3 = q3[i];
+        q[i].q4 = q4[i];
+    }
+}
+
+/*
+  one lane of QuaternionT::operator*(Vector3). Rotating by the inverse
+  is the same with the vector part negated, which gives exactly the
+  result of QuaternionT::body_to_earth()
+ */
+template <typename T>
+static inline void rotate_lane(const T q1, const T q2, const T q3, const T q4,
+                               const T x, const T y, const T z, T &ox, T &oy, T &oz)
+{
+    const T uvx = 2 * (q3 * z - q4 * y);
+    const T uvy = 2 * (q4 * x - q2 * z);
+    const T uvz = 2 * (q2 * y - q3 * x);
+    ox = x + q1 * uvx + q3 * uvz - q4 * uvy;
+    oy = y + q1 * uvy + q4 * uvx - q2 * uvz;
+    oz = z + q1 * uvz + q2 * uvy - q3 * uvx;
+}
+
+template <typename T>
+static void rotate_soa(const T q1, const T q2, const T q3, const T q4,
+                       const Vector3SoA<T> &v, const Vector3SoA<T> &out, uint32_t count)
+{
+    // local copies so the output stores don't force reloads of the
+    // input pointers
+    const T *vx = v.x;
+    const T *vy = v.y;
+    const T *vz = v.z;
+    T *ox = out.x;
+    T *oy = out.y;
+    T *oz = out.z;
+    for (uint32_t i = 0; i < count; i++) {
+        rotate_lane(q1, q2, q3, q4, vx[i], vy[i], vz[i], ox[i], oy[i], oz[i]);
+    }
+}
+
+template <typename T>
+static void rotate_soa(const QuaternionSoA<T> &q, bool inverse,
+                       const Vector3SoA<T> &v, const Vector3SoA<T> &out, uint32_t count)
+{
+    const T *q1 = q.q1;
+    const T *q2 = q.q2;
+    const T *q3 = q.q3;
+    const T *q4 = q.q4;
+    const T *vx = v.x;
+    const T *vy = v.y;
+    const T *vz = v.z;
+    T *ox = out.x;
+    T *oy = out.y;
+    T *oz = out.z;
+    if (inverse) {
+        for (uint32_t i = 0; i < count; i++) {
+            rotate_lane(q1[i], -q2[i], -q3[i], -q4[i], vx[i], vy[i], vz[i], ox[i], oy[i], oz[i]);
+        }
+    } else {
+        for (uint32_t i = 0; i < count; i++) {
+            rotate_lane(q1[i], q2[i], q3[i], q4[i], vx[i], vy[i], vz[i], ox[i], oy[i], oz[i]);
+        }
+    }
+}
+
+template <typename T>
+void earth_to_body(const QuaternionT<T> &q, Vector3<T> *v, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        q.earth_to_body(v[i]);
+    }
+}
+
+template <typename T>
+void earth_to_body(const QuaternionT<T> &q, const Vector3SoA<T> &v, const Vector3SoA<T> &out, uint32_t count)
+{
+    rotate_soa(q.q1, q.q2, q.q3, q.q4, v, out, count);
+}
+
+template <typename T>
+void body_to_earth(const QuaternionT<T> &q, Vector3<T> *v, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        q.body_to_earth(v[i]);
+    }
+}
+
+template <typename T>
+void body_to_earth(const QuaternionT<T> &q, const Vector3SoA<T> &v, const Vector3SoA<T> &out, uint32_t count)
+{
+    rotate_soa(q.q1, -q.q2, -q.q3, -q.q4, v, out, count);
+}
+
+template <typename T>
+void earth_to_body(const QuaternionT<T> *q, Vector3<T> *v, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        q[i].earth_to_body(v[i]);
+    }
+}
+
+template <typename T>
+void earth_to_body(const QuaternionSoA<T> &q, const Vector3SoA<T> &v, const Vector3SoA<T> &out, uint32_t count)
+{
+    rotate_soa(q, false, v, out, count);
+}
+
+template <typename T>
+void body_to_earth(const QuaternionT<T> *q, Vector3<T> *v, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        q[i].body_to_earth(v[i]);
+    }
+}
+
+template <typename T>
+void body_to_earth(const QuaternionSoA<T> &q, const Vector3SoA<T> &v, const Vector3SoA<T> &out, uint32_t count)
+{
+    rotate_soa(q, true, v, out, count);
+}
+
+template <typename T>
+void from_euler(const Vector3SoA<T> &euler, const QuaternionSoA<T> &q, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        T sr2, cr2, sp2, cp2, sy2, cy2;
+        sincosF(euler.x[i]*0.5, sr2, cr2);
+        sincosF(euler.y[i]*0.5, sp2, cp2);
+        sincosF(euler.z[i]*0.5, sy2, cy2);
+        QuaternionT<T> quat;
+        quat.from_euler_sin_cos_half(sr2, cr2, sp2, cp2, sy2, cy2);
+        q.q1[i] = quat.q1;
+        q.q2[i] = quat.q2;
+        q.q3[i] = quat.q3;
+        q.q4[i] = quat.q4;
+    }
+}
+
+template <typename T>
+void from_euler_fast(const Vector3SoA<T> &euler, const QuaternionSoA<T> &q, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        float sr2, cr2, sp2, cp2, sy2, cy2;
+        fast_sincosf(euler.x[i]*0.5f, sr2, cr2);
+        fast_sincosf(euler.y[i]*0.5f, sp2, cp2);
+        fast_sincosf(euler.z[i]*0.5f, sy2, cy2);
+        QuaternionT<T> quat;
+        quat.from_euler_sin_cos_half(sr2, cr2, sp2, cp2, sy2, cy2);
+        q.q1[i] = quat.q1;
+        q.q2[i] = quat.q2;
+        q.q3[i] = quat.q3;
+        q.q4[i] = quat.q4;
+    }
+}
+
+template <typename T>
+void from_euler(const Vector3SoA<T> &euler, Matrix3<T> *m, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        T sr, cr, sp, cp, sy, cy;
+        sincosF(euler.x[i], sr, cr);
+        sincosF(euler.y[i], sp, cp);
+        sincosF(euler.z[i], sy, cy);
+        m[i].from_euler_sin_cos(sr, cr, sp, cp, sy, cy);
+    }
+}
+
+template <typename T>
+void from_euler_fast(const Vector3SoA<T> &euler, Matrix3<T> *m, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        float sr, cr, sp, cp, sy, cy;
+        fast_sincosf(euler.x[i], sr, cr);
+        fast_sincosf(euler.y[i], sp, cp);
+        fast_sincosf(euler.z[i], sy, cy);
+        m[i].from_euler_sin_cos(sr, cr, sp, cp, sy, cy);
+    }
+}
+
+template <typename T>
+void from_euler312(const Vector3SoA<T> &euler, Matrix3<T> *m, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        T sr, cr, sp, cp, sy, cy;
+        sincosF(euler.x[i], sr, cr);
+        sincosF(euler.y[i], sp, cp);
+        sincosF(euler.z[i], sy, cy);
+        m[i].from_euler312_sin_cos(sr, cr, sp, cp, sy, cy);
+    }
+}
+
+template <typename T>
+void from_euler312_fast(const Vector3SoA<T> &euler, Matrix3<T> *m, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        float sr, cr, sp, cp, sy, cy;
+        fast_sincosf(euler.x[i], sr, cr);
+        fast_sincosf(euler.y[i], sp, cp);
+        fast_sincosf(euler.z[i], sy, cy);
+        m[i].from_euler312_sin_cos(sr, cr, sp, cp, sy, cy);
+    }
+}
+
+#define QUATERNION_BATCH_INSTANTIATE(T) \
+    template struct QuaternionSoA<T>; \
+    template void earth_to_body<T>(const QuaternionT<T> &, Vector3<T> *, uint32_t); \
+    template void earth_to_body<T>(const QuaternionT<T> &, const Vector3SoA<T> &, const Vector3SoA<T> &, uint32_t); \
+    template void body_to_earth<T>(const QuaternionT<T> &, Vector3<T> *, uint32_t); \
+    template void body_to_earth<T>(const QuaternionT<T> &, const Vector3SoA<T> &, const Vector3SoA<T> &, uint32_t); \
+    template void earth_to_body<T>(const QuaternionT<T> *, Vector3<T> *, uint32_t); \
+    template void earth_to_body<T>(const QuaternionSoA<T> &, const Vector3SoA<T> &, const Vector3SoA<T> &, uint32_t); \
+    template void body_to_earth<T>(const QuaternionT<T> *, Vector3<T> *, uint32_t); \
+    template void body_to_earth<T>(const QuaternionSoA<T> &, const Vector3SoA<T> &, const Vector3SoA<T> &, uint32_t); \
+    template void from_euler<T>(const Vector3SoA<T> &, const QuaternionSoA<T> &, uint32_t); \
+    template void from_euler_fast<T>(const Vector3SoA<T> &, const QuaternionSoA<T> &, uint32_t); \
+    template void from_euler<T>(const Vector3SoA<T> &, Matrix3<T> *, uint32_t); \
+    template void from_euler_fast<T>(const Vector3SoA<T> &, Matrix3<T> *, uint32_t); \
+    template void from_euler312<T>(const Vector3SoA<T> &, Matrix3<T> *, uint32_t); \
+    template void from_euler312_fast<T>(const Vector3SoA<T> &, Matrix3<T> *, uint32_t);
+
+QUATERNION_BATCH_INSTANTIATE(float)
+QUATERNION_BATCH_INSTANTIATE(double)
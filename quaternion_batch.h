@@ -0,0 +1,121 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  batch quaternion operations, for rotating blocks of sensor samples
+  without a rotation matrix per sample.
+
+  Vectors can be rotated by one quaternion or by a quaternion per
+  sample, either in place as arrays of Vector3 or as structure of
+  arrays (see vector3_batch.h). The results match
+  QuaternionT::earth_to_body() and QuaternionT::body_to_earth() exactly.
+  The output may be the same arrays as the input.
+
+  Arrays of Euler angles, with roll, pitch and yaw as x, y and z, can
+  be converted to quaternions or rotation matrices, for example when
+  exporting logged attitudes. The _fast versions use fast_sincosf().
+ */
+#pragma once
+
+#include "vector3_batch.h"
+
+/*
+  non-owning structure of arrays view of quaternions
+ */
+template <typename T>
+struct QuaternionSoA {
+    T *q1;
+    T *q2;
+    T *q3;
+    T *q4;
+
+    constexpr QuaternionSoA() : q1(nullptr), q2(nullptr), q3(nullptr), q4(nullptr) {}
+    constexpr QuaternionSoA(T *q10, T *q20, T *q30, T *q40) : q1(q10), q2(q20), q3(q30), q4(q40) {}
+
+    QuaternionT<T> get(uint32_t i) const {
+        return QuaternionT<T>(q1[i], q2[i], q3[i], q4[i]);
+    }
+    void set(uint32_t i, const QuaternionT<T> &q) {
+        q1[i] = q.q1;
+        q2[i] = q.q2;
+        q3[i] = q.q3;
+        q4[i] = q.q4;
+    }
+
+    // view starting at element i
+    QuaternionSoA<T> offset(uint32_t i) const {
+        return QuaternionSoA<T>(q1 + i, q2 + i, q3 + i, q4 + i);
+    }
+
+    // copy from/to an array of quaternions
+    void pack(const QuaternionT<T> *q, uint32_t count);
+    void unpack(QuaternionT<T> *q, uint32_t count) const;
+};
+
+/*
+  rotate each vector by q, as QuaternionT::earth_to_body()
+ */
+template <typename T>
+void earth_to_body(const QuaternionT<T> &q, Vector3<T> *v, uint32_t count);
+template <typename T>
+void earth_to_body(const QuaternionT<T> &q, const Vector3SoA<T> &v, const Vector3SoA<T> &out, uint32_t count);
+
+/*
+  rotate each vector by the inverse of q, as QuaternionT::body_to_earth()
+ */
+template <typename T>
+void body_to_earth(const QuaternionT<T> &q, Vector3<T> *v, uint32_t count);
+template <typename T>
+void body_to_earth(const QuaternionT<T> &q, const Vector3SoA<T> &v, const Vector3SoA<T> &out, uint32_t count);
+
+/*
+  rotate v[i] by q[i]
+ */
+template <typename T>
+void earth_to_body(const QuaternionT<T> *q, Vector3<T> *v, uint32_t count);
+template <typename T>
+void earth_to_body(const QuaternionSoA<T> &q, const Vector3SoA<T> &v, const Vector3SoA<T> &out, uint32_t count);
+
+/*
+  rotate v[i] by the inverse of q[i]
+ */
+template <typename T>
+void body_to_earth(const QuaternionT<T> *q, Vector3<T> *v, uint32_t count);
+template <typename T>
+void body_to_earth(const QuaternionSoA<T> &q, const Vector3SoA<T> &v, const Vector3SoA<T> &out, uint32_t count);
+
+/*
+  Euler angles in 321 ordering to quaternions, as QuaternionT::from_euler()
+ */
+template <typename T>
+void from_euler(const Vector3SoA<T> &euler, const QuaternionSoA<T> &q, uint32_t count);
+template <typename T>
+void from_euler_fast(const Vector3SoA<T> &euler, const QuaternionSoA<T> &q, uint32_t count);
+
+/*
+  Euler angles in 321 ordering to rotation matrices, as Matrix3::from_euler()
+ */
+template <typename T>
+void from_euler(const Vector3SoA<T> &euler, Matrix3<T> *m, uint32_t count);
+template <typename T>
+void from_euler_fast(const Vector3SoA<T> &euler, Matrix3<T> *m, uint32_t count);
+
+/*
+  Euler angles in 312 ordering to rotation matrices, as Matrix3::from_euler312()
+ */
+template <typename T>
+void from_euler312(const Vector3SoA<T> &euler, Matrix3<T> *m, uint32_t count);
+template <typename T>
+void from_euler312_fast(const Vector3SoA<T> &euler, Matrix3<T> *m, uint32_t count);
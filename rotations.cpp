@@ -0,0 +1,238 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  compile time tables of the matrix and quaternion of the rotations in
+  enum Rotation, and of their inverse, canonical form and composition
+ */
+
+#include "Embed_Math.h"
+
+namespace {
+
+struct RotationMatrix {
+    double m[3][3];
+};
+
+constexpr double H = HALF_SQRT_2;
+
+/*
+  matrix of each rotation, so that v.rotate(r) is m * v. These must
+  match Vector3::rotate(), which the rotations tests check
+ */
+constexpr RotationMatrix rotation_matrices[ROTATION_MAX] {
+    {{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}},                // ROTATION_NONE
+    {{{H, -H, 0}, {H, H, 0}, {0, 0, 1}}},               // ROTATION_YAW_45
+    {{{0, -1, 0}, {1, 0, 0}, {0, 0, 1}}},               // ROTATION_YAW_90
+    {{{-H, -H, 0}, {H, -H, 0}, {0, 0, 1}}},             // ROTATION_YAW_135
+    {{{-1, 0, 0}, {0, -1, 0}, {0, 0, 1}}},              // ROTATION_YAW_180
+    {{{-H, H, 0}, {-H, -H, 0}, {0, 0, 1}}},             // ROTATION_YAW_225
+    {{{0, 1, 0}, {-1, 0, 0}, {0, 0, 1}}},               // ROTATION_YAW_270
+    {{{H, H, 0}, {-H, H, 0}, {0, 0, 1}}},               // ROTATION_YAW_315
+    {{{1, 0, 0}, {0, -1, 0}, {0, 0, -1}}},              // ROTATION_ROLL_180
+    {{{H, H, 0}, {H, -H, 0}, {0, 0, -1}}},              // ROTATION_ROLL_180_YAW_45
+    {{{0, 1, 0}, {1, 0, 0}, {0, 0, -1}}},               // ROTATION_ROLL_180_YAW_90
+    {{{-H, H, 0}, {H, H, 0}, {0, 0, -1}}},              // ROTATION_ROLL_180_YAW_135
+    {{{-1, 0, 0}, {0, 1, 0}, {0, 0, -1}}},              // ROTATION_PITCH_180
+    {{{-H, -H, 0}, {-H, H, 0}, {0, 0, -1}}},            // ROTATION_ROLL_180_YAW_225
+    {{{0, -1, 0}, {-1, 0, 0}, {0, 0, -1}}},             // ROTATION_ROLL_180_YAW_270
+    {{{H, -H, 0}, {-H, -H, 0}, {0, 0, -1}}},            // ROTATION_ROLL_180_YAW_315
+    {{{1, 0, 0}, {0, 0, -1}, {0, 1, 0}}},               // ROTATION_ROLL_90
+    {{{H, 0, H}, {H, 0, -H}, {0, 1, 0}}},               // ROTATION_ROLL_90_YAW_45
+    {{{0, 0, 1}, {1, 0, 0}, {0, 1, 0}}},                // ROTATION_ROLL_90_YAW_90
+    {{{-H, 0, H}, {H, 0, H}, {0, 1, 0}}},               // ROTATION_ROLL_90_YAW_135
+    {{{1, 0, 0}, {0, 0, 1}, {0, -1, 0}}},               // ROTATION_ROLL_270
+    {{{H, 0, -H}, {H, 0, H}, {0, -1, 0}}},              // ROTATION_ROLL_270_YAW_45
+    {{{0, 0, -1}, {1, 0, 0}, {0, -1, 0}}},              // ROTATION_ROLL_270_YAW_90
+    {{{-H, 0, -H}, {H, 0, -H}, {0, -1, 0}}},            // ROTATION_ROLL_270_YAW_135
+    {{{0, 0, 1}, {0, 1, 0}, {-1, 0, 0}}},               // ROTATION_PITCH_90
+    {{{0, 0, -1}, {0, 1, 0}, {1, 0, 0}}},               // ROTATION_PITCH_270
+    {{{0, -1, 0}, {-1, 0, 0}, {0, 0, -1}}},             // ROTATION_PITCH_180_YAW_90
+    {{{0, 1, 0}, {1, 0, 0}, {0, 0, -1}}},               // ROTATION_PITCH_180_YAW_270
+    {{{0, 1, 0}, {0, 0, -1}, {-1, 0, 0}}},              // ROTATION_ROLL_90_PITCH_90
+    {{{0, 0, -1}, {0, -1, 0}, {-1, 0, 0}}},             // ROTATION_ROLL_180_PITCH_90
+    {{{0, -1, 0}, {0, 0, 1}, {-1, 0, 0}}},              // ROTATION_ROLL_270_PITCH_90
+    {{{-1, 0, 0}, {0, 0, -1}, {0, -1, 0}}},             // ROTATION_ROLL_90_PITCH_180
+    {{{-1, 0, 0}, {0, 0, 1}, {0, 1, 0}}},               // ROTATION_ROLL_270_PITCH_180
+    {{{0, -1, 0}, {0, 0, -1}, {1, 0, 0}}},              // ROTATION_ROLL_90_PITCH_270
+    {{{0, 0, 1}, {0, -1, 0}, {1, 0, 0}}},               // ROTATION_ROLL_180_PITCH_270
+    {{{0, 1, 0}, {0, 0, 1}, {1, 0, 0}}},                // ROTATION_ROLL_270_PITCH_270
+    {{{0, 0, 1}, {-1, 0, 0}, {0, -1, 0}}},              // ROTATION_ROLL_90_PITCH_180_YAW_90
+    {{{0, 0, -1}, {-1, 0, 0}, {0, 1, 0}}},              // ROTATION_ROLL_90_YAW_270
+    {{{0.14303897231223747232853327204793, 0.36877648650320382639478111741482, -0.91844638134308709265241077446262},
+      {-0.33213277779664740485543461545603, -0.85628942146641884303193137384369, -0.39554550256296522325882847326284},
+      {-0.93232380121551217122544130688766, 0.36162457008209242248497616856184, 0.00000000000000002214311861220361}}}, // ROTATION_ROLL_90_PITCH_68_YAW_293
+    {{{H, 0, -H}, {0, 1, 0}, {H, 0, H}}},               // ROTATION_PITCH_315
+    {{{H, -H, 0}, {0, 0, -1}, {H, H, 0}}},              // ROTATION_ROLL_90_PITCH_315
+    {{{0.99254615164132198312785249072476, 0, 0.1218693434051474899781908334262},
+      {0, 1, 0},
+      {-0.1218693434051474899781908334262, 0, 0.99254615164132198312785249072476}}}, // ROTATION_PITCH_7
+    {{{1, 0, 0}, {0, H, -H}, {0, H, H}}},               // ROTATION_ROLL_45
+    {{{1, 0, 0}, {0, H, H}, {0, -H, H}}},               // ROTATION_ROLL_315
+};
+
+// a * b
+constexpr RotationMatrix multiply(const RotationMatrix &a, const RotationMatrix &b)
+{
+    RotationMatrix ret {};
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            for (uint8_t k = 0; k < 3; k++) {
+                ret.m[i][j] += a.m[i][k] * b.m[k][j];
+            }
+        }
+    }
+    return ret;
+}
+
+constexpr RotationMatrix transpose(const RotationMatrix &a)
+{
+    RotationMatrix ret {};
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            ret.m[i][j] = a.m[j][i];
+        }
+    }
+    return ret;
+}
+
+// the entries are exact or within rounding of the irrational ones
+constexpr bool matrix_equal(const RotationMatrix &a, const RotationMatrix &b)
+{
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            const double d = a.m[i][j] - b.m[i][j];
+            if (d > 1.0e-6 || d < -1.0e-6) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// lowest numbered rotation with matrix m, ROTATION_MAX if none
+constexpr uint8_t find_rotation(const RotationMatrix &m)
+{
+    for (uint8_t r = 0; r < ROTATION_MAX; r++) {
+        if (matrix_equal(m, rotation_matrices[r])) {
+            return r;
+        }
+    }
+    return ROTATION_MAX;
+}
+
+// square root by Newton's method, for x up to 4
+constexpr double const_sqrt(double x)
+{
+    if (x <= 0) {
+        return 0;
+    }
+    // starting above the root the iterates fall until rounding stops them
+    double r = x > 1 ? x : 1;
+    for (uint8_t i = 0; i < 64; i++) {
+        const double next = 0.5 * (r + x / r);
+        if (next >= r) {
+            break;
+        }
+        r = next;
+    }
+    return r;
+}
+
+/*
+  the quaternion of a rotation matrix, taking the same branches as
+  QuaternionT::from_rotation_matrix() so the signs are the same
+ */
+constexpr void matrix_to_quaternion(const RotationMatrix &rm, double q[4])
+{
+    const auto &m = rm.m;
+    const double tr = m[0][0] + m[1][1] + m[2][2];
+    if (tr > 0) {
+        const double S = const_sqrt(tr + 1) * 2;
+        q[0] = 0.25 * S;
+        q[1] = (m[2][1] - m[1][2]) / S;
+        q[2] = (m[0][2] - m[2][0]) / S;
+        q[3] = (m[1][0] - m[0][1]) / S;
+    } else if ((m[0][0] > m[1][1]) && (m[0][0] > m[2][2])) {
+        const double S = const_sqrt(1 + m[0][0] - m[1][1] - m[2][2]) * 2;
+        q[0] = (m[2][1] - m[1][2]) / S;
+        q[1] = 0.25 * S;
+        q[2] = (m[0][1] + m[1][0]) / S;
+        q[3] = (m[0][2] + m[2][0]) / S;
+    } else if (m[1][1] > m[2][2]) {
+        const double S = const_sqrt(1 + m[1][1] - m[0][0] - m[2][2]) * 2;
+        q[0] = (m[0][2] - m[2][0]) / S;
+        q[1] = (m[0][1] + m[1][0]) / S;
+        q[2] = 0.25 * S;
+        q[3] = (m[1][2] + m[2][1]) / S;
+    } else {
+        const double S = const_sqrt(1 + m[2][2] - m[0][0] - m[1][1]) * 2;
+        q[0] = (m[1][0] - m[0][1]) / S;
+        q[1] = (m[0][2] + m[2][0]) / S;
+        q[2] = (m[1][2] + m[2][1]) / S;
+        q[3] = 0.25 * S;
+    }
+}
+
+constexpr RotationConstants make_rotation_constants()
+{
+    RotationConstants c {};
+    for (uint8_t r = 0; r < ROTATION_MAX; r++) {
+        for (uint8_t i = 0; i < 3; i++) {
+            for (uint8_t j = 0; j < 3; j++) {
+                c.matrix[r][i][j] = rotation_matrices[r].m[i][j];
+            }
+        }
+        matrix_to_quaternion(rotation_matrices[r], c.quaternion[r]);
+    }
+    return c;
+}
+
+constexpr RotationTables make_rotation_tables()
+{
+    RotationTables t {};
+    for (uint8_t r = 0; r < ROTATION_MAX; r++) {
+        t.canonical[r] = find_rotation(rotation_matrices[r]);
+        t.inverse[r] = find_rotation(transpose(rotation_matrices[r]));
+    }
+    for (uint8_t r1 = 0; r1 < ROTATION_MAX; r1++) {
+        for (uint8_t r2 = 0; r2 < ROTATION_MAX; r2++) {
+            // the composition of two duplicates is the composition of their canonical forms
+            if (t.canonical[r1] != r1) {
+                t.compose[r1][r2] = t.compose[t.canonical[r1]][r2];
+            } else if (t.canonical[r2] != r2) {
+                t.compose[r1][r2] = t.compose[r1][t.canonical[r2]];
+            } else {
+                t.compose[r1][r2] = find_rotation(multiply(rotation_matrices[r2], rotation_matrices[r1]));
+            }
+        }
+    }
+    return t;
+}
+
+}
+
+constexpr RotationConstants rotation_constants = make_rotation_constants();
+constexpr RotationTables rotation_tables = make_rotation_tables();
+
+static_assert(rotation_constants.quaternion[ROTATION_YAW_90][3] > 0.70710678 &&
+              rotation_constants.quaternion[ROTATION_YAW_90][3] < 0.70710679, "bad rotation quaternion");
+
+static_assert(rotation_tables.canonical[ROTATION_PITCH_180_YAW_90] == ROTATION_ROLL_180_YAW_270, "bad canonical rotation");
+static_assert(rotation_tables.canonical[ROTATION_PITCH_180_YAW_270] == ROTATION_ROLL_180_YAW_90, "bad canonical rotation");
+static_assert(rotation_tables.inverse[ROTATION_YAW_90] == ROTATION_YAW_270, "bad inverse rotation");
+static_assert(rotation_tables.inverse[ROTATION_PITCH_7] == ROTATION_MAX, "bad inverse rotation");
+static_assert(rotation_tables.compose[ROTATION_YAW_45][ROTATION_YAW_45] == ROTATION_YAW_90, "bad rotation composition");
+static_assert(rotation_tables.compose[ROTATION_ROLL_180][ROTATION_YAW_90] == ROTATION_ROLL_180_YAW_90, "bad rotation composition");
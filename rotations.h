@@ -82,6 +82,54 @@ enum Rotation : uint8_t {
     ROTATION_CUSTOM_END,
 };
 
+/*
+  matrix and quaternion of each rotation below ROTATION_MAX, generated
+  at compile time in rotations.cpp from one table of matrices. These
+  make Matrix3::from_rotation() and QuaternionT::from_rotation() a
+  lookup instead of a switch
+ */
+struct RotationConstants {
+    // v.rotate(r) is matrix[r] * v
+    double matrix[ROTATION_MAX][3][3];
+    // q1 to q4 of the quaternion with the same rotation matrix
+    double quaternion[ROTATION_MAX][4];
+};
+extern const RotationConstants rotation_constants;
+
+/*
+  algebra over the fixed rotations, from tables generated at compile
+  time in rotations.cpp from the rotation matrix of each entry. Only
+  rotations below ROTATION_MAX are covered; custom rotations are
+  treated as unique with no inverse or composition.
+ */
+struct RotationTables {
+    uint8_t inverse[ROTATION_MAX];
+    uint8_t canonical[ROTATION_MAX];
+    // compose[r1][r2] is r1 followed by r2
+    uint8_t compose[ROTATION_MAX][ROTATION_MAX];
+};
+extern const RotationTables rotation_tables;
+
+// the rotation that undoes r, or ROTATION_MAX if the list doesn't have it
+inline enum Rotation rotation_inverse(enum Rotation r)
+{
+    return r < ROTATION_MAX ? (enum Rotation)rotation_tables.inverse[r] : ROTATION_MAX;
+}
+
+// the lowest numbered rotation equivalent to r
+inline enum Rotation rotation_canonical(enum Rotation r)
+{
+    return r < ROTATION_MAX ? (enum Rotation)rotation_tables.canonical[r] : r;
+}
+
+/*
+  the rotation equivalent to rotating by r1 then by r2, as
+  v.rotate(r1); v.rotate(r2). ROTATION_MAX if the list doesn't have it
+ */
+inline enum Rotation rotation_compose(enum Rotation r1, enum Rotation r2)
+{
+    return (r1 < ROTATION_MAX && r2 < ROTATION_MAX) ? (enum Rotation)rotation_tables.compose[r1][r2] : ROTATION_MAX;
+}
 
 // definitions used by quaterion and vector3f
 #define HALF_SQRT_2 0.70710678118654752440084436210485
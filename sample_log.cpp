@@ -0,0 +1,411 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// 64 bit file offsets on 32 bit Linux, for logs over 2GB
+#ifndef _FILE_OFFSET_BITS
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include "sample_log.h"
+#include "crc.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+
+#if AP_MATH_SAMPLE_LOG_ENABLED
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(off_t) == 8, "sample logs need 64 bit file offsets");
+#endif
+
+namespace {
+
+constexpr uint32_t ALIGN = 64;
+
+uint64_t align_up(uint64_t n)
+{
+    return (n + ALIGN - 1) & ~uint64_t(ALIGN - 1);
+}
+
+// bytes from one component of a column to the next
+uint64_t component_stride(uint8_t type, uint64_t num_samples)
+{
+    return align_up(num_samples * sample_log_type_size(type));
+}
+
+uint64_t data_start(uint16_t num_columns)
+{
+    return align_up(sizeof(SampleLogHeader) + uint64_t(num_columns) * sizeof(SampleLogColumn));
+}
+
+}
+
+uint8_t sample_log_type_size(uint8_t type)
+{
+    switch (SampleLogType(type)) {
+    case SampleLogType::FLOAT:
+    case SampleLogType::INT32:
+        return 4;
+    case SampleLogType::DOUBLE:
+    case SampleLogType::UINT64:
+        return 8;
+    }
+    return 0;
+}
+
+#if AP_MATH_SAMPLE_LOG_ENABLED
+
+bool SampleLogReader::open(const char *path)
+{
+    close();
+
+    const int fd = ::open(path, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || uint64_t(st.st_size) < sizeof(SampleLogHeader)) {
+        ::close(fd);
+        return false;
+    }
+    const size_t size = st.st_size;
+    // private and writeable, so views can be changed without changing the file
+    void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+
+    const SampleLogHeader &header = *static_cast<const SampleLogHeader *>(base);
+    const SampleLogColumn *columns = reinterpret_cast<const SampleLogColumn *>(static_cast<const uint8_t *>(base) + sizeof(header));
+    bool valid = header.magic == SampleLogHeader::MAGIC &&
+                 header.version == SampleLogHeader::VERSION &&
+                 header.num_samples <= UINT32_MAX &&
+                 header.num_columns <= SampleLogWriter::MAX_COLUMNS &&
+                 data_start(header.num_columns) <= size &&
+                 crc_crc32(0, reinterpret_cast<const uint8_t *>(columns), header.num_columns * sizeof(SampleLogColumn)) == header.directory_crc;
+    // each column's data must be after the directory and inside the file
+    uint64_t column_end[SampleLogWriter::MAX_COLUMNS];
+    for (uint16_t i = 0; valid && i < header.num_columns; i++) {
+        const SampleLogColumn &c = columns[i];
+        const uint64_t stride = component_stride(c.type, header.num_samples);
+        valid = sample_log_type_size(c.type) != 0 &&
+                c.components >= 1 && c.components <= SampleLogColumn::MAX_COMPONENTS &&
+                memchr(c.name, 0, sizeof(c.name)) != nullptr &&
+                c.offset % ALIGN == 0 &&
+                c.offset >= data_start(header.num_columns) &&
+                c.offset <= size &&
+                stride * c.components <= size - c.offset;
+        column_end[i] = c.offset + stride * c.components;
+    }
+    // and no two columns may share bytes
+    for (uint16_t i = 0; valid && i < header.num_columns; i++) {
+        for (uint16_t j = i + 1; valid && j < header.num_columns; j++) {
+            valid = column_end[i] <= columns[j].offset || column_end[j] <= columns[i].offset;
+        }
+    }
+    if (!valid) {
+        munmap(base, size);
+        return false;
+    }
+
+    _base = static_cast<uint8_t *>(base);
+    _size = size;
+    _columns = columns;
+    _num_samples = header.num_samples;
+    _num_columns = header.num_columns;
+    return true;
+}
+
+void SampleLogReader::close()
+{
+    if (_base != nullptr) {
+        munmap(_base, _size);
+    }
+    _base = nullptr;
+    _size = 0;
+    _columns = nullptr;
+    _num_samples = 0;
+    _num_columns = 0;
+}
+
+/*
+  the pages of each component holding samples start to start+count.
+  Released pages must hold no samples after the range, or changes to
+  them would be lost before they are processed
+ */
+void SampleLogReader::prefetch(uint32_t start, uint32_t count) const
+{
+    const uintptr_t page = sysconf(_SC_PAGESIZE);
+    for (uint16_t i = 0; i < _num_columns; i++) {
+        const SampleLogColumn &c = _columns[i];
+        const uint8_t size = sample_log_type_size(c.type);
+        for (uint8_t k = 0; k < c.components; k++) {
+            const uintptr_t begin = uintptr_t(component(c, k)) + uintptr_t(start) * size;
+            const uintptr_t end = begin + uintptr_t(count) * size;
+            const uintptr_t aligned = begin & ~(page - 1);
+            madvise(reinterpret_cast<void *>(aligned), end - aligned, MADV_WILLNEED);
+        }
+    }
+}
+
+void SampleLogReader::release(uint32_t start, uint32_t count) const
+{
+    const uintptr_t page = sysconf(_SC_PAGESIZE);
+    const bool last = start + count == _num_samples;
+    for (uint16_t i = 0; i < _num_columns; i++) {
+        const SampleLogColumn &c = _columns[i];
+        const uint8_t size = sample_log_type_size(c.type);
+        for (uint8_t k = 0; k < c.components; k++) {
+            const uintptr_t begin = (uintptr_t(component(c, k)) + uintptr_t(start) * size) & ~(page - 1);
+            uintptr_t end = uintptr_t(component(c, k)) + uintptr_t(start + count) * size;
+            end = last ? (end + page - 1) & ~(page - 1) : end & ~(page - 1);
+            if (end > begin) {
+                madvise(reinterpret_cast<void *>(begin), end - begin, MADV_DONTNEED);
+            }
+        }
+    }
+}
+
+#else  // AP_MATH_SAMPLE_LOG_ENABLED
+
+bool SampleLogReader::open(const char *)
+{
+    return false;
+}
+
+void SampleLogReader::close()
+{
+}
+
+void SampleLogReader::prefetch(uint32_t, uint32_t) const
+{
+}
+
+void SampleLogReader::release(uint32_t, uint32_t) const
+{
+}
+
+#endif  // AP_MATH_SAMPLE_LOG_ENABLED
+
+int16_t SampleLogReader::find_column(const char *name) const
+{
+    for (uint16_t i = 0; i < _num_columns; i++) {
+        if (strncmp(_columns[i].name, name, sizeof(_columns[i].name)) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void *SampleLogReader::component(const SampleLogColumn &c, uint8_t i) const
+{
+    return _base + c.offset + i * component_stride(c.type, _num_samples);
+}
+
+bool SampleLogReader::get_components(const char *name, SampleLogType type, uint8_t components, void **data) const
+{
+    const int16_t i = find_column(name);
+    if (i < 0 || _columns[i].type != uint8_t(type) || _columns[i].components != components) {
+        return false;
+    }
+    for (uint8_t k = 0; k < components; k++) {
+        data[k] = component(_columns[i], k);
+    }
+    return true;
+}
+
+template <typename T>
+bool SampleLogReader::get_view(const char *name, T *&v) const
+{
+    void *data[1];
+    if (!get_components(name, SampleLogTypeOf<T>::type, 1, data)) {
+        return false;
+    }
+    v = static_cast<T *>(data[0]);
+    return true;
+}
+
+template <typename T>
+bool SampleLogReader::get_view(const char *name, Vector3SoA<T> &v) const
+{
+    void *data[3];
+    if (!get_components(name, SampleLogTypeOf<T>::type, 3, data)) {
+        return false;
+    }
+    v = Vector3SoA<T>(static_cast<T *>(data[0]), static_cast<T *>(data[1]), static_cast<T *>(data[2]));
+    return true;
+}
+
+template <typename T>
+bool SampleLogReader::get_view(const char *name, QuaternionSoA<T> &v) const
+{
+    void *data[4];
+    if (!get_components(name, SampleLogTypeOf<T>::type, 4, data)) {
+        return false;
+    }
+    v = QuaternionSoA<T>(static_cast<T *>(data[0]), static_cast<T *>(data[1]),
+                         static_cast<T *>(data[2]), static_cast<T *>(data[3]));
+    return true;
+}
+
+SampleLogWriter::~SampleLogWriter()
+{
+    if (_file != nullptr) {
+        fclose(_file);
+    }
+}
+
+bool SampleLogWriter::add_column(const char *name, SampleLogType type, uint8_t components, const void *const *data)
+{
+    const size_t len = strlen(name);
+    if (_file != nullptr || _num_columns >= MAX_COLUMNS || len == 0 || len >= SampleLogColumn::NAME_LEN ||
+        sample_log_type_size(uint8_t(type)) == 0 || components < 1 || components > SampleLogColumn::MAX_COMPONENTS) {
+        return false;
+    }
+    for (uint16_t i = 0; i < _num_columns; i++) {
+        if (strncmp(_columns[i].desc.name, name, SampleLogColumn::NAME_LEN) == 0) {
+            return false;
+        }
+    }
+    Column &c = _columns[_num_columns++];
+    memset(&c.desc, 0, sizeof(c.desc));
+    memcpy(c.desc.name, name, len);
+    c.desc.type = uint8_t(type);
+    c.desc.components = components;
+    for (uint8_t k = 0; k < components; k++) {
+        c.data[k] = data[k];
+    }
+    return true;
+}
+
+template <typename T>
+bool SampleLogWriter::add_column(const char *name, const T *v)
+{
+    const void *data[] { v };
+    return add_column(name, SampleLogTypeOf<T>::type, 1, data);
+}
+
+template <typename T>
+bool SampleLogWriter::add_column(const char *name, const Vector3SoA<T> &v)
+{
+    const void *data[] { v.x, v.y, v.z };
+    return add_column(name, SampleLogTypeOf<T>::type, 3, data);
+}
+
+template <typename T>
+bool SampleLogWriter::add_column(const char *name, const QuaternionSoA<T> &v)
+{
+    const void *data[] { v.q1, v.q2, v.q3, v.q4 };
+    return add_column(name, SampleLogTypeOf<T>::type, 4, data);
+}
+
+bool SampleLogWriter::write(const char *path)
+{
+    const bool ok = open(path) && append(_num_samples);
+    if (!close() || !ok) {
+        remove(path);
+        return false;
+    }
+    return true;
+}
+
+bool SampleLogWriter::open(const char *path)
+{
+    if (_file != nullptr) {
+        return false;
+    }
+    SampleLogColumn directory[MAX_COLUMNS];
+    uint64_t offset = data_start(_num_columns);
+    for (uint16_t i = 0; i < _num_columns; i++) {
+        _columns[i].desc.offset = offset;
+        directory[i] = _columns[i].desc;
+        offset += _columns[i].desc.components * component_stride(directory[i].type, _num_samples);
+    }
+
+    SampleLogHeader header {};
+    header.magic = SampleLogHeader::MAGIC;
+    header.version = SampleLogHeader::VERSION;
+    header.num_columns = _num_columns;
+    header.num_samples = _num_samples;
+    header.directory_crc = crc_crc32(0, reinterpret_cast<const uint8_t *>(directory), _num_columns * sizeof(SampleLogColumn));
+
+    _file = fopen(path, "wb");
+    if (_file == nullptr) {
+        return false;
+    }
+    _appended = 0;
+    // write the last byte first, so the padding and any samples never
+    // appended read as zero
+    _failed = fwrite(&header, sizeof(header), 1, _file) != 1 ||
+              fwrite(directory, sizeof(SampleLogColumn), _num_columns, _file) != _num_columns ||
+              fseeko(_file, off_t(offset - 1), SEEK_SET) != 0 ||
+              fputc(0, _file) == EOF;
+    return !_failed;
+}
+
+bool SampleLogWriter::append(uint32_t count)
+{
+    if (_file == nullptr || _failed || count > _num_samples - _appended) {
+        return false;
+    }
+    for (uint16_t i = 0; !_failed && i < _num_columns; i++) {
+        const SampleLogColumn &c = _columns[i].desc;
+        const uint8_t size = sample_log_type_size(c.type);
+        const size_t len = size_t(count) * size;
+        for (uint8_t k = 0; !_failed && k < c.components; k++) {
+            const uint64_t offset = c.offset + k * component_stride(c.type, _num_samples) + uint64_t(_appended) * size;
+            _failed = fseeko(_file, off_t(offset), SEEK_SET) != 0 ||
+                      fwrite(_columns[i].data[k], 1, len, _file) != len;
+        }
+    }
+    _appended += count;
+    return !_failed;
+}
+
+bool SampleLogWriter::close()
+{
+    if (_file == nullptr) {
+        return false;
+    }
+    bool ok = !_failed && _appended == _num_samples;
+    if (fclose(_file) != 0) {
+        ok = false;
+    }
+    _file = nullptr;
+    return ok;
+}
+
+template bool SampleLogReader::get_view<float>(const char *name, float *&v) const;
+template bool SampleLogReader::get_view<double>(const char *name, double *&v) const;
+template bool SampleLogReader::get_view<uint64_t>(const char *name, uint64_t *&v) const;
+template bool SampleLogReader::get_view<int32_t>(const char *name, int32_t *&v) const;
+template bool SampleLogReader::get_view<float>(const char *name, Vector3SoA<float> &v) const;
+template bool SampleLogReader::get_view<double>(const char *name, Vector3SoA<double> &v) const;
+template bool SampleLogReader::get_view<float>(const char *name, QuaternionSoA<float> &v) const;
+template bool SampleLogReader::get_view<double>(const char *name, QuaternionSoA<double> &v) const;
+
+template bool SampleLogWriter::add_column<float>(const char *name, const float *v);
+template bool SampleLogWriter::add_column<double>(const char *name, const double *v);
+template bool SampleLogWriter::add_column<uint64_t>(const char *name, const uint64_t *v);
+template bool SampleLogWriter::add_column<int32_t>(const char *name, const int32_t *v);
+template bool SampleLogWriter::add_column<float>(const char *name, const Vector3SoA<float> &v);
+template bool SampleLogWriter::add_column<double>(const char *name, const Vector3SoA<double> &v);
+template bool SampleLogWriter::add_column<float>(const char *name, const QuaternionSoA<float> &v);
+template bool SampleLogWriter::add_column<double>(const char *name, const QuaternionSoA<double> &v);
@@ -0,0 +1,240 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  a columnar file of logged samples, read through a memory map so the
+  batch functions work on the file's pages without copying.
+
+  The file is a SampleLogHeader, a directory of num_columns
+  SampleLogColumn and the column data, all little endian. A column
+  holds num_samples values of each of its components, one component
+  after another, so a three component float column is x[n], y[n],
+  z[n] and is used directly as a Vector3SoA<float>. Each component
+  starts on a 64 byte boundary. The header holds a crc_crc32() of the
+  directory.
+
+  The reader maps the file copy on write, so views can be written, for
+  example to rotate samples in place, without changing the file. A
+  whole log is processed a chunk at a time with for_each_chunk(),
+  which has the kernel read ahead a bounded number of chunks and
+  drops chunks once done, so disk reads overlap the processing and the
+  memory used doesn't grow with the log.
+
+  Logs recorded in other formats are converted with SampleLogWriter,
+  either from whole columns in memory or a chunk at a time for logs
+  too large to hold. Memory maps are only available on Linux and
+  macOS.
+ */
+#pragma once
+
+#include "quaternion_batch.h"
+
+#include <stdio.h>
+
+#ifndef AP_MATH_SAMPLE_LOG_ENABLED
+#if defined(__linux__) || defined(__APPLE__)
+#define AP_MATH_SAMPLE_LOG_ENABLED 1
+#else
+#define AP_MATH_SAMPLE_LOG_ENABLED 0
+#endif
+#endif
+
+enum class SampleLogType : uint8_t {
+    FLOAT = 0,
+    DOUBLE = 1,
+    UINT64 = 2,
+    INT32 = 3,
+};
+
+// the SampleLogType of a value type
+template <typename T> struct SampleLogTypeOf;
+template <> struct SampleLogTypeOf<float> { static constexpr SampleLogType type = SampleLogType::FLOAT; };
+template <> struct SampleLogTypeOf<double> { static constexpr SampleLogType type = SampleLogType::DOUBLE; };
+template <> struct SampleLogTypeOf<uint64_t> { static constexpr SampleLogType type = SampleLogType::UINT64; };
+template <> struct SampleLogTypeOf<int32_t> { static constexpr SampleLogType type = SampleLogType::INT32; };
+
+// bytes per value of a type, 0 for an unknown type
+uint8_t sample_log_type_size(uint8_t type);
+
+struct SampleLogHeader {
+    static constexpr uint32_t MAGIC = 0x474c5345;  // "ESLG"
+    static constexpr uint16_t VERSION = 1;
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t num_columns;
+    uint64_t num_samples;
+    uint32_t directory_crc;
+    uint32_t reserved;
+};
+
+struct SampleLogColumn {
+    static constexpr uint8_t NAME_LEN = 16;
+    static constexpr uint8_t MAX_COMPONENTS = 4;
+
+    // nul padded, at most NAME_LEN-1 characters
+    char name[NAME_LEN];
+    uint8_t type;
+    uint8_t components;
+    uint8_t reserved[6];
+    // file offset of the first component
+    uint64_t offset;
+};
+
+static_assert(sizeof(SampleLogHeader) == 24, "SampleLogHeader must not be padded");
+static_assert(sizeof(SampleLogColumn) == 32, "SampleLogColumn must not be padded");
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "sample logs are read and written without byte swapping");
+
+class SampleLogReader {
+public:
+    SampleLogReader() {}
+    ~SampleLogReader() { close(); }
+
+    SampleLogReader(const SampleLogReader &) = delete;
+    SampleLogReader &operator=(const SampleLogReader &) = delete;
+
+    /*
+      map a log. Returns false if it can't be read or isn't a valid
+      log, including columns outside the data or overlapping each other
+     */
+    bool open(const char *path) WARN_IF_UNUSED;
+    void close();
+
+    uint32_t get_num_samples() const { return _num_samples; }
+    uint16_t get_num_columns() const { return _num_columns; }
+    const SampleLogColumn &get_column(uint16_t i) const { return _columns[i]; }
+
+    // index of the named column, -1 if there is none
+    int16_t find_column(const char *name) const;
+
+    /*
+      views of a whole column. Return false, leaving the view
+      unchanged, if the column doesn't exist or has a different type
+      or number of components
+     */
+    template <typename T>
+    bool get_view(const char *name, T *&v) const WARN_IF_UNUSED;
+    template <typename T>
+    bool get_view(const char *name, Vector3SoA<T> &v) const WARN_IF_UNUSED;
+    template <typename T>
+    bool get_view(const char *name, QuaternionSoA<T> &v) const WARN_IF_UNUSED;
+
+    /*
+      call fn(start, count) for consecutive chunks of chunk_samples
+      samples, the last maybe shorter, covering the log. Views offset
+      by start give the chunk's samples. While a chunk is processed the
+      next prefetch_chunks are being read, and once it is done it is
+      dropped from memory, losing any changes made to it
+     */
+    template <typename F>
+    void for_each_chunk(uint32_t chunk_samples, uint32_t prefetch_chunks, const F &fn);
+
+private:
+    // start of component i of a column in the mapping
+    void *component(const SampleLogColumn &c, uint8_t i) const;
+
+    // fill data with the components of a column, checking its type
+    bool get_components(const char *name, SampleLogType type, uint8_t components, void **data) const;
+
+    // ask for samples to be read ahead, or drop them from memory
+    void prefetch(uint32_t start, uint32_t count) const;
+    void release(uint32_t start, uint32_t count) const;
+
+    uint8_t *_base = nullptr;
+    size_t _size = 0;
+    const SampleLogColumn *_columns = nullptr;
+    uint32_t _num_samples = 0;
+    uint16_t _num_columns = 0;
+};
+
+template <typename F>
+void SampleLogReader::for_each_chunk(uint32_t chunk_samples, uint32_t prefetch_chunks, const F &fn)
+{
+    if (chunk_samples == 0) {
+        return;
+    }
+    // window of samples asked for but not yet processed
+    uint32_t prefetched = 0;
+    for (uint32_t start = 0; start < _num_samples; start += MIN(chunk_samples, _num_samples - start)) {
+        const uint32_t count = MIN(chunk_samples, _num_samples - start);
+        const uint64_t window_end = MIN(uint64_t(start) + uint64_t(chunk_samples) * (prefetch_chunks + 1), uint64_t(_num_samples));
+        if (window_end > prefetched) {
+            prefetch(prefetched, uint32_t(window_end) - prefetched);
+            prefetched = uint32_t(window_end);
+        }
+        fn(start, count);
+        release(start, count);
+    }
+}
+
+/*
+  writes a log of num_samples samples, either all at once with
+  write() or a chunk at a time with open(), append() and close()
+ */
+class SampleLogWriter {
+public:
+    static constexpr uint16_t MAX_COLUMNS = 32;
+
+    explicit SampleLogWriter(uint32_t num_samples) : _num_samples(num_samples) {}
+    ~SampleLogWriter();
+
+    SampleLogWriter(const SampleLogWriter &) = delete;
+    SampleLogWriter &operator=(const SampleLogWriter &) = delete;
+
+    /*
+      add a column before writing, with a pointer to the values of
+      each component: num_samples values for write(), or a chunk for
+      append(). The data must stay valid until the last write. Returns
+      false for a bad or duplicate name, type or number of components,
+      or if there are too many columns or the log is open
+     */
+    bool add_column(const char *name, SampleLogType type, uint8_t components, const void *const *data) WARN_IF_UNUSED;
+
+    template <typename T>
+    bool add_column(const char *name, const T *v) WARN_IF_UNUSED;
+    template <typename T>
+    bool add_column(const char *name, const Vector3SoA<T> &v) WARN_IF_UNUSED;
+    template <typename T>
+    bool add_column(const char *name, const QuaternionSoA<T> &v) WARN_IF_UNUSED;
+
+    // write the whole log from the columns' data, removing the file if that fails
+    bool write(const char *path) WARN_IF_UNUSED;
+
+    /*
+      write a log a chunk at a time. After open() each append() writes
+      the next count samples from the start of the columns' data,
+      which the caller refills between calls. close() returns false
+      if fewer than num_samples samples were appended or any write
+      failed
+     */
+    bool open(const char *path) WARN_IF_UNUSED;
+    bool append(uint32_t count) WARN_IF_UNUSED;
+    bool close() WARN_IF_UNUSED;
+
+private:
+    struct Column {
+        SampleLogColumn desc;
+        const void *data[SampleLogColumn::MAX_COMPONENTS];
+    };
+
+    uint32_t _num_samples;
+    uint16_t _num_columns = 0;
+    Column _columns[MAX_COLUMNS];
+
+    FILE *_file = nullptr;
+    bool _failed = false;
+    // samples written since open()
+    uint32_t _appended = 0;
+};
@@ -0,0 +1,327 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma GCC optimize("O2")
+
+#include "segment_bvh.h"
+
+void SegmentBVH::clear()
+{
+    delete[] _nodes;
+    delete[] _storage;
+    delete[] _index;
+    _nodes = nullptr;
+    _storage = nullptr;
+    _index = nullptr;
+    _seg = Segment3SoA<float>();
+    _num_nodes = 0;
+    _num_segments = 0;
+}
+
+// number of nodes in the tree for count segments
+uint32_t SegmentBVH::count_nodes(uint32_t count)
+{
+    if (count <= SEGMENT_BVH_LEAF_SIZE) {
+        return 1;
+    }
+    return 1 + count_nodes(count / 2) + count_nodes(count - count / 2);
+}
+
+/*
+  reorder order[0..count-1] so that the element at k has the k'th
+  smallest centroid on axis, with smaller or equal centroids before it
+ */
+static void select_median(uint32_t *order, const Vector3f *centroid, uint8_t axis, uint32_t count, uint32_t k)
+{
+    uint32_t lo = 0;
+    uint32_t hi = count - 1;
+    while (lo < hi) {
+        const float pivot = centroid[order[(lo + hi) / 2]][axis];
+        uint32_t i = lo;
+        uint32_t j = hi;
+        while (i <= j) {
+            while (centroid[order[i]][axis] < pivot) {
+                i++;
+            }
+            while (centroid[order[j]][axis] > pivot) {
+                j--;
+            }
+            if (i <= j) {
+                const uint32_t tmp = order[i];
+                order[i] = order[j];
+                order[j] = tmp;
+                i++;
+                if (j == 0) {
+                    break;
+                }
+                j--;
+            }
+        }
+        if (k <= j) {
+            hi = j;
+        } else if (k >= i) {
+            lo = i;
+        } else {
+            break;
+        }
+    }
+}
+
+uint32_t SegmentBVH::build_node(uint32_t *order, const Vector3f *centroid, uint32_t first, uint32_t count,
+                                const Vector3f *seg_start, const Vector3f *seg_end)
+{
+    const uint32_t idx = _num_nodes++;
+    Node &node = _nodes[idx];
+
+    if (count <= SEGMENT_BVH_LEAF_SIZE) {
+        node.min = node.max = seg_start[order[first]];
+        for (uint32_t i = first; i < first + count; i++) {
+            const Vector3f &s = seg_start[order[i]];
+            const Vector3f &e = seg_end[order[i]];
+            for (uint8_t a = 0; a < 3; a++) {
+                node.min[a] = MIN(node.min[a], MIN(s[a], e[a]));
+                node.max[a] = MAX(node.max[a], MAX(s[a], e[a]));
+            }
+        }
+        node.first = first;
+        node.count = count;
+        return idx;
+    }
+
+    // split at the median centroid on the longest axis of the centroids
+    Vector3f cmin = centroid[order[first]];
+    Vector3f cmax = cmin;
+    for (uint32_t i = first + 1; i < first + count; i++) {
+        const Vector3f &c = centroid[order[i]];
+        for (uint8_t a = 0; a < 3; a++) {
+            cmin[a] = MIN(cmin[a], c[a]);
+            cmax[a] = MAX(cmax[a], c[a]);
+        }
+    }
+    const Vector3f extent = cmax - cmin;
+    uint8_t axis = 0;
+    if (extent.y > extent[axis]) {
+        axis = 1;
+    }
+    if (extent.z > extent[axis]) {
+        axis = 2;
+    }
+    const uint32_t half = count / 2;
+    select_median(&order[first], centroid, axis, count, half);
+
+    const uint32_t left = build_node(order, centroid, first, half, seg_start, seg_end);
+    const uint32_t right = build_node(order, centroid, first + half, count - half, seg_start, seg_end);
+    for (uint8_t a = 0; a < 3; a++) {
+        node.min[a] = MIN(_nodes[left].min[a], _nodes[right].min[a]);
+        node.max[a] = MAX(_nodes[left].max[a], _nodes[right].max[a]);
+    }
+    node.first = right;
+    node.count = 0;
+    return idx;
+}
+
+bool SegmentBVH::build(const Vector3f *seg_start, const Vector3f *seg_end, uint32_t count)
+{
+    clear();
+    if (count == 0) {
+        return true;
+    }
+
+    const uint32_t nodes = count_nodes(count);
+    _nodes = NEW_NOTHROW Node[nodes];
+    _storage = NEW_NOTHROW float[6 * count];
+    _index = NEW_NOTHROW uint32_t[count];
+    Vector3f *centroid = NEW_NOTHROW Vector3f[count];
+    if (_nodes == nullptr || _storage == nullptr || _index == nullptr || centroid == nullptr) {
+        delete[] centroid;
+        clear();
+        return false;
+    }
+
+    // build with _index as the working order
+    for (uint32_t i = 0; i < count; i++) {
+        _index[i] = i;
+        centroid[i] = (seg_start[i] + seg_end[i]) * 0.5f;
+    }
+    build_node(_index, centroid, 0, count, seg_start, seg_end);
+    delete[] centroid;
+
+    // copy the segments in leaf order
+    _seg.start = Vector3SoA<float>(&_storage[0], &_storage[count], &_storage[2 * count]);
+    _seg.end = Vector3SoA<float>(&_storage[3 * count], &_storage[4 * count], &_storage[5 * count]);
+    for (uint32_t i = 0; i < count; i++) {
+        _seg.start.set(i, seg_start[_index[i]]);
+        _seg.end.set(i, seg_end[_index[i]]);
+    }
+    _num_segments = count;
+    return true;
+}
+
+// squared distance from point to the node's bounding box, zero if inside
+float SegmentBVH::box_distance_sq(const Node &node, const Vector3f &point)
+{
+    float d2 = 0;
+    for (uint8_t a = 0; a < 3; a++) {
+        const float d = MAX(MAX(node.min[a] - point[a], point[a] - node.max[a]), 0.0f);
+        d2 += d * d;
+    }
+    return d2;
+}
+
+// squared distance between the node's bounding box and another box
+float SegmentBVH::box_distance_sq(const Node &node, const Vector3f &box_min, const Vector3f &box_max)
+{
+    float d2 = 0;
+    for (uint8_t a = 0; a < 3; a++) {
+        const float d = MAX(MAX(node.min[a] - box_max[a], box_min[a] - node.max[a]), 0.0f);
+        d2 += d * d;
+    }
+    return d2;
+}
+
+bool SegmentBVH::nearest(const Vector3f &point, uint32_t &index, float &dist, float max_dist) const
+{
+    if (_num_nodes == 0) {
+        return false;
+    }
+    bool found = false;
+    float best = max_dist;
+    float leaf_dist[SEGMENT_BVH_LEAF_SIZE];
+    uint32_t stack[max_depth];
+    uint8_t depth = 0;
+    stack[depth++] = 0;
+
+    while (depth > 0) {
+        const uint32_t idx = stack[--depth];
+        const Node &node = _nodes[idx];
+        if (box_distance_sq(node, point) > sq(best)) {
+            continue;
+        }
+        if (node.count > 0) {
+            closest_distance_between_line_and_point(_seg.offset(node.first), point, leaf_dist, node.count);
+            for (uint32_t i = 0; i < node.count; i++) {
+                if (leaf_dist[i] <= best) {
+                    best = leaf_dist[i];
+                    index = _index[node.first + i];
+                    found = true;
+                }
+            }
+            continue;
+        }
+        // visit the nearer child first
+        const float d_left = box_distance_sq(_nodes[idx + 1], point);
+        const float d_right = box_distance_sq(_nodes[node.first], point);
+        if (d_left < d_right) {
+            stack[depth++] = node.first;
+            stack[depth++] = idx + 1;
+        } else {
+            stack[depth++] = idx + 1;
+            stack[depth++] = node.first;
+        }
+    }
+    if (found) {
+        dist = best;
+    }
+    return found;
+}
+
+bool SegmentBVH::nearest_to_segment(const Vector3f &start, const Vector3f &end, uint32_t &index, float &dist,
+                                    float max_dist) const
+{
+    if (_num_nodes == 0) {
+        return false;
+    }
+    Vector3f box_min, box_max;
+    for (uint8_t a = 0; a < 3; a++) {
+        box_min[a] = MIN(start[a], end[a]);
+        box_max[a] = MAX(start[a], end[a]);
+    }
+
+    bool found = false;
+    float best = max_dist;
+    float leaf_dist[SEGMENT_BVH_LEAF_SIZE];
+    float cx[SEGMENT_BVH_LEAF_SIZE], cy[SEGMENT_BVH_LEAF_SIZE], cz[SEGMENT_BVH_LEAF_SIZE];
+    const Vector3SoA<float> closest(cx, cy, cz);
+    uint32_t stack[max_depth];
+    uint8_t depth = 0;
+    stack[depth++] = 0;
+
+    while (depth > 0) {
+        const uint32_t idx = stack[--depth];
+        const Node &node = _nodes[idx];
+        if (box_distance_sq(node, box_min, box_max) > sq(best)) {
+            continue;
+        }
+        if (node.count > 0) {
+            segment_to_segment_closest_point(start, end, _seg.offset(node.first), closest, node.count, leaf_dist);
+            for (uint32_t i = 0; i < node.count; i++) {
+                if (leaf_dist[i] <= best) {
+                    best = leaf_dist[i];
+                    index = _index[node.first + i];
+                    found = true;
+                }
+            }
+            continue;
+        }
+        const float d_left = box_distance_sq(_nodes[idx + 1], box_min, box_max);
+        const float d_right = box_distance_sq(_nodes[node.first], box_min, box_max);
+        if (d_left < d_right) {
+            stack[depth++] = node.first;
+            stack[depth++] = idx + 1;
+        } else {
+            stack[depth++] = idx + 1;
+            stack[depth++] = node.first;
+        }
+    }
+    if (found) {
+        dist = best;
+    }
+    return found;
+}
+
+uint32_t SegmentBVH::within_radius(const Vector3f &point, float radius, uint32_t *indices, uint32_t max_results) const
+{
+    if (_num_nodes == 0) {
+        return 0;
+    }
+    uint32_t found = 0;
+    float leaf_dist[SEGMENT_BVH_LEAF_SIZE];
+    uint32_t stack[max_depth];
+    uint8_t depth = 0;
+    stack[depth++] = 0;
+
+    while (depth > 0) {
+        const uint32_t idx = stack[--depth];
+        const Node &node = _nodes[idx];
+        if (box_distance_sq(node, point) > sq(radius)) {
+            continue;
+        }
+        if (node.count > 0) {
+            closest_distance_between_line_and_point(_seg.offset(node.first), point, leaf_dist, node.count);
+            for (uint32_t i = 0; i < node.count; i++) {
+                if (leaf_dist[i] <= radius) {
+                    if (found < max_results) {
+                        indices[found] = _index[node.first + i];
+                    }
+                    found++;
+                }
+            }
+            continue;
+        }
+        stack[depth++] = node.first;
+        stack[depth++] = idx + 1;
+    }
+    return found;
+}
@@ -0,0 +1,110 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  static bounding volume hierarchy over 3D segments, for nearest and
+  within-radius queries against large obstacle sets (wires, poles,
+  points given as zero length segments).
+
+  The tree is built once by splitting at the median centroid on the
+  longest axis, so it is balanced and the node count is known up
+  front. Each leaf holds up to SEGMENT_BVH_LEAF_SIZE segments stored as
+  structure of arrays, and the leaves are tested with the batch
+  queries from vector3_batch.h.
+ */
+#pragma once
+
+#include "vector3_batch.h"
+
+#ifndef SEGMENT_BVH_LEAF_SIZE
+#define SEGMENT_BVH_LEAF_SIZE 8
+#endif
+
+class SegmentBVH {
+public:
+    SegmentBVH() {}
+    ~SegmentBVH() { clear(); }
+
+    SegmentBVH(const SegmentBVH &other) = delete;
+    SegmentBVH &operator=(const SegmentBVH&) = delete;
+
+    /*
+      build the tree over count segments from seg_start[i] to
+      seg_end[i]. The inputs are copied. Returns false if memory could
+      not be allocated, leaving the tree empty
+     */
+    bool build(const Vector3f *seg_start, const Vector3f *seg_end, uint32_t count);
+
+    // build the tree over points
+    bool build(const Vector3f *points, uint32_t count) {
+        return build(points, points, count);
+    }
+
+    // free all memory
+    void clear();
+
+    /*
+      find the segment closest to point, returning its index in the
+      arrays passed to build() and the distance. Segments further than
+      max_dist are ignored. Returns false if none was found
+     */
+    bool nearest(const Vector3f &point, uint32_t &index, float &dist, float max_dist = FLT_MAX) const;
+
+    /*
+      find the segment with the closest approach to the segment from
+      start to end. Returns false if none was found within max_dist
+     */
+    bool nearest_to_segment(const Vector3f &start, const Vector3f &end, uint32_t &index, float &dist,
+                            float max_dist = FLT_MAX) const;
+
+    /*
+      find the segments within radius of point. Up to max_results
+      indices are written to indices, in no particular order. Returns
+      the total number found, which may be more than max_results
+     */
+    uint32_t within_radius(const Vector3f &point, float radius, uint32_t *indices, uint32_t max_results) const;
+
+    uint32_t num_segments() const { return _num_segments; }
+    uint32_t num_nodes() const { return _num_nodes; }
+
+private:
+    struct Node {
+        Vector3f min;
+        Vector3f max;
+        // leaves have count > 0 and hold segments first..first+count-1,
+        // otherwise the children are this+1 and first
+        uint32_t first;
+        uint32_t count;
+    };
+
+    static uint32_t count_nodes(uint32_t count);
+    uint32_t build_node(uint32_t *order, const Vector3f *centroid, uint32_t first, uint32_t count,
+                        const Vector3f *seg_start, const Vector3f *seg_end);
+
+    static float box_distance_sq(const Node &node, const Vector3f &point);
+    static float box_distance_sq(const Node &node, const Vector3f &box_min, const Vector3f &box_max);
+
+    // maximum tree depth, ample for a median split of 2^32 segments
+    static const uint8_t max_depth = 64;
+
+    Node *_nodes = nullptr;
+    uint32_t _num_nodes = 0;
+    uint32_t _num_segments = 0;
+
+    // segments in leaf order, with their index in the build() arrays
+    float *_storage = nullptr;
+    Segment3SoA<float> _seg;
+    uint32_t *_index = nullptr;
+};
@@ -0,0 +1,144 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/attitude_integrator.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// angle in radians of the rotation between two attitudes
+static double attitude_error(const QuaternionD &a, const QuaternionD &b)
+{
+    const QuaternionD d = a.inverse() * b;
+    return 2 * asin(MIN(1.0, Vector3d(d.q2, d.q3, d.q4).length()));
+}
+
+/*
+  coning motion with half angle cone_angle at rate omega rad/s:
+  q(t) = [cos(a/2), sin(a/2) cos(wt), sin(a/2) sin(wt), 0]
+ */
+static QuaternionD coning_attitude(double cone_angle, double omega, double t)
+{
+    const double s = sin(cone_angle * 0.5);
+    return QuaternionD(cos(cone_angle * 0.5), s * cos(omega * t), s * sin(omega * t), 0);
+}
+
+// exact integral of the body rate of the coning motion from t0 to t1
+static Vector3d coning_delta_angle(double cone_angle, double omega, double t0, double t1)
+{
+    return Vector3d(sin(cone_angle) * (cos(omega * t1) - cos(omega * t0)),
+                    sin(cone_angle) * (sin(omega * t1) - sin(omega * t0)),
+                    -omega * (1 - cos(cone_angle)) * (t1 - t0));
+}
+
+TEST(AttitudeIntegratorTest, ConstantRate)
+{
+    const Vector3d gyro(0.3, -1.2, 2.0);
+    const double dt = 1.0 / 1000;
+    AttitudeIntegratorD integrator;
+    for (uint16_t i = 0; i < 1000; i++) {
+        integrator.update(gyro, dt);
+    }
+    // a constant rate is a rotation about a fixed axis
+    QuaternionD expected;
+    expected.from_axis_angle(gyro);
+    EXPECT_LT(attitude_error(expected, integrator.get_attitude()), 1e-8);
+}
+
+TEST(AttitudeIntegratorTest, ConingError)
+{
+    const double cone_angle = 0.3;
+    const double omega = M_2PI * 20;
+    const double dt = 1.0 / 1000;
+    const uint16_t num_samples = 1000;
+
+    AttitudeIntegratorD integrator;
+    integrator.reset(coning_attitude(cone_angle, omega, 0));
+    AttitudeIntegrator integrator_f;
+    integrator_f.reset(coning_attitude(cone_angle, omega, 0).tofloat());
+
+    // integrating without coning correction, as rotate_fast() per sample
+    QuaternionD uncorrected = coning_attitude(cone_angle, omega, 0);
+
+    for (uint16_t i = 0; i < num_samples; i++) {
+        const Vector3d delta_angle = coning_delta_angle(cone_angle, omega, i * dt, (i + 1) * dt);
+        integrator.update_delta_angle(delta_angle);
+        integrator_f.update_delta_angle(delta_angle.tofloat());
+        uncorrected.rotate_fast(delta_angle);
+        uncorrected.normalize();
+    }
+
+    const QuaternionD exact = coning_attitude(cone_angle, omega, num_samples * dt);
+    const double error = attitude_error(exact, integrator.get_attitude());
+    const double error_f = attitude_error(exact, integrator_f.get_attitude().todouble());
+    const double error_uncorrected = attitude_error(exact, uncorrected);
+
+    // the uncorrected drift is about 10 mrad over one second here
+    EXPECT_GT(error_uncorrected, 5e-3);
+    EXPECT_LT(error, error_uncorrected * 0.01);
+    EXPECT_LT(error_f, error_uncorrected * 0.05);
+}
+
+TEST(AttitudeIntegratorTest, BlockMatchesSingle)
+{
+    Vector3f gyro[333];
+    for (uint16_t i = 0; i < ARRAY_SIZE(gyro); i++) {
+        gyro[i] = Vector3f(rand_float(), rand_float(), rand_float()) * 5;
+    }
+    const float dt = 1.0f / 8000;
+
+    AttitudeIntegrator single, block;
+    for (uint16_t i = 0; i < ARRAY_SIZE(gyro); i++) {
+        single.update(gyro[i], dt);
+    }
+    // split so the previous sample is carried across blocks
+    block.update(gyro, 100, dt);
+    block.update(&gyro[100], ARRAY_SIZE(gyro) - 100, dt);
+
+    const Quaternion &a = single.get_attitude();
+    const Quaternion &b = block.get_attitude();
+    for (uint8_t i = 0; i < 4; i++) {
+        EXPECT_EQ(a[i], b[i]);
+    }
+}
+
+TEST(AttitudeIntegratorTest, LazyRenormalisation)
+{
+    AttitudeIntegrator integrator;
+    const float threshold = AttitudeIntegrator::default_renormalise_threshold;
+    for (uint32_t i = 0; i < 80000; i++) {
+        integrator.update(Vector3f(rand_float(), rand_float(), rand_float()) * 10, 1.0f / 8000);
+        ASSERT_LE(fabsf(integrator.get_attitude().length_squared() - 1), 2 * threshold);
+    }
+}
+
+TEST(AttitudeIntegratorTest, SoAMatchesScalar)
+{
+    const uint16_t num_vehicles = 37;
+    AttitudeIntegratorSoA<float, num_vehicles> swarm;
+    AttitudeIntegrator single[num_vehicles];
+    for (uint16_t v = 0; v < num_vehicles; v++) {
+        Quaternion q;
+        q.from_euler(rand_float(), rand_float(), rand_float() * M_PI);
+        swarm.reset(v, q);
+        single[v].reset(q);
+    }
+
+    float gx[num_vehicles], gy[num_vehicles], gz[num_vehicles];
+    Vector3SoA<float> gyro{gx, gy, gz};
+    for (uint16_t s = 0; s < 200; s++) {
+        for (uint16_t v = 0; v < num_vehicles; v++) {
+            const Vector3f g = Vector3f(rand_float(), rand_float(), rand_float()) * 3;
+            gyro.set(v, g);
+            single[v].update(g, 1.0f / 1000);
+        }
+        swarm.update(gyro, 1.0f / 1000);
+    }
+
+    for (uint16_t v = 0; v < num_vehicles; v++) {
+        const Quaternion a = swarm.get_attitude(v);
+        for (uint8_t i = 0; i < 4; i++) {
+            EXPECT_EQ(a[i], single[v].get_attitude()[i]);
+        }
+    }
+}
+
+AP_GTEST_MAIN()
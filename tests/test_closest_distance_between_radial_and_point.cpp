@@ -1,6 +1,6 @@
 #include <AP_gtest.h>
 
-#include <AP_Math/vector2.h>
+#include <AP_Math/vector2_batch.h>
 
 #define TEST_DISTANCE_BOTH(line_segment_x,line_segment_y, point_x, point_y, expected_length) \
     do {                                                                \
@@ -13,6 +13,15 @@
                 );                                                      \
             EXPECT_FLOAT_EQ(result, expected_length);                   \
         }                                                               \
+        {                                                               \
+            float wx = line_segment_x, wy = line_segment_y;             \
+            float px = point_x, py = point_y;                           \
+            float result;                                               \
+            closest_distance_between_radial_and_point(Vector2SoA<float>(&wx, &wy), \
+                                                      Vector2SoA<float>(&px, &py), \
+                                                      &result, 1);      \
+            EXPECT_FLOAT_EQ(result, expected_length);                   \
+        }                                                               \
     } while (false)
 
 
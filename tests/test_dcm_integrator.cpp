@@ -0,0 +1,109 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/dcm_integrator.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// largest element difference
+static double max_error(const Matrix3d &m1, const Matrix3d &m2)
+{
+    double err = 0;
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            err = MAX(err, std::fabs(m1[i][j] - m2[i][j]));
+        }
+    }
+    return err;
+}
+
+// largest element of m * m^T - I
+static double orthogonality_error(const Matrix3d &m)
+{
+    Matrix3d identity;
+    identity.identity();
+    return max_error(m * m.transposed(), identity);
+}
+
+TEST(DcmIntegratorTest, ConstantRate)
+{
+    const Vector3d gyro(0.3, -1.2, 2.0);
+    const double dt = 1.0 / 1000;
+    DcmIntegratorD integrator;
+    Matrix3d stepped;
+    stepped.identity();
+    for (uint16_t i = 0; i < 1000; i++) {
+        integrator.update(gyro, dt);
+        // first order update with a full renormalisation every step
+        stepped.rotate(gyro * dt);
+        stepped.normalize();
+    }
+
+    // a constant rate is a rotation about a fixed axis
+    const double theta = std::sqrt(gyro.length_squared());
+    const Vector3d k = gyro / theta;
+    const Matrix3d K(0, -k.z, k.y,
+                     k.z, 0, -k.x,
+                     -k.y, k.x, 0);
+    Matrix3d expected;
+    expected.identity();
+    expected += K * std::sin(theta) + K * K * (1 - std::cos(theta));
+    const double error = max_error(expected, integrator.get_dcm());
+    EXPECT_LT(error, 1e-12);
+    EXPECT_GT(max_error(expected, stepped), 1e4 * error);
+}
+
+TEST(DcmIntegratorTest, BlockMatchesSingle)
+{
+    Vector3f gyro[333];
+    for (uint16_t i = 0; i < ARRAY_SIZE(gyro); i++) {
+        gyro[i] = Vector3f(rand_float(), rand_float(), rand_float()) * 5;
+    }
+    const float dt = 1.0f / 8000;
+
+    DcmIntegrator single, block;
+    for (uint16_t i = 0; i < ARRAY_SIZE(gyro); i++) {
+        single.update(gyro[i], dt);
+    }
+    block.update(gyro, 100, dt);
+    block.update(&gyro[100], ARRAY_SIZE(gyro) - 100, dt);
+
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            EXPECT_EQ(single.get_dcm()[i][j], block.get_dcm()[i][j]);
+        }
+    }
+    EXPECT_EQ(single.get_renormalise_count(), block.get_renormalise_count());
+}
+
+TEST(DcmIntegratorTest, LazyRenormalisation)
+{
+    DcmIntegrator integrator;
+    const float threshold = DcmIntegrator::default_renormalise_threshold;
+    const uint32_t num_steps = 80000;
+    for (uint32_t i = 0; i < num_steps; i++) {
+        integrator.update(Vector3f(rand_float(), rand_float(), rand_float()) * 10, 1.0f / 8000);
+        ASSERT_LE(orthogonality_error(integrator.get_dcm().todouble()), 2 * threshold);
+    }
+    EXPECT_GT(integrator.get_renormalise_count(), 0U);
+    EXPECT_LT(integrator.get_renormalise_count(), num_steps / 10);
+
+    // a threshold of zero renormalises at every check
+    integrator.reset();
+    integrator.set_renormalise_threshold(0);
+    for (uint8_t i = 0; i < DcmIntegrator::CHECK_INTERVAL; i++) {
+        integrator.update(Vector3f(1, 2, 3), 1.0f / 8000);
+    }
+    EXPECT_EQ(1U, integrator.get_renormalise_count());
+}
+
+TEST(DcmIntegratorTest, Reset)
+{
+    Matrix3f m;
+    m.from_euler(0.1f, -0.4f, 2.0f);
+    DcmIntegrator integrator;
+    integrator.reset(m * 1.001f);
+    EXPECT_LT(orthogonality_error(integrator.get_dcm().todouble()), 1e-6);
+    EXPECT_EQ(0U, integrator.get_renormalise_count());
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,167 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/divisor.h>
+
+#include <limits>
+#include <string.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  simple xorshift generator so the randomised tests are repeatable
+ */
+static uint64_t test_rand64(void)
+{
+    static uint64_t state = 0x9E3779B97F4A7C15ULL;
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// a random value with a random number of leading zeros
+template <typename T>
+static T test_rand(void)
+{
+    const T v = T(test_rand64());
+    return T(v >> (test_rand64() % (sizeof(T)*8)));
+}
+
+// a + b wrapping around, without signed overflow
+template <typename T>
+static T wrap_add(const T a, const T b)
+{
+    typedef typename std::make_unsigned<T>::type U;
+    return T(U(a) + U(b));
+}
+
+template <typename T, typename D>
+static void check_divisor(const T d)
+{
+    const D div(d);
+    const T special[] = { 0, 1, 2, 3, wrap_add(d, T(-1)), d, wrap_add(d, T(1)),
+                          std::numeric_limits<T>::max(),
+                          T(std::numeric_limits<T>::max() - 1),
+                          std::numeric_limits<T>::min(),
+                          T(std::numeric_limits<T>::min() + 1) };
+    for (const T n : special) {
+        if (std::is_signed<T>::value && d == T(-1) && n == std::numeric_limits<T>::min()) {
+            // overflows for the / operator too
+            continue;
+        }
+        EXPECT_EQ(T(n / d), div.divide(n)) << "n=" << n << " d=" << d;
+        EXPECT_EQ(T(n % d), div.remainder(n)) << "n=" << n << " d=" << d;
+    }
+    for (uint16_t i = 0; i < 200; i++) {
+        T n = test_rand<T>();
+        if (i & 1) {
+            n = T(typename std::make_unsigned<T>::type(0) - typename std::make_unsigned<T>::type(n));
+        }
+        if (std::is_signed<T>::value && d == T(-1) && n == std::numeric_limits<T>::min()) {
+            continue;
+        }
+        EXPECT_EQ(T(n / d), div.divide(n)) << "n=" << n << " d=" << d;
+    }
+}
+
+template <typename T, typename D>
+static void check_all_divisors(void)
+{
+    // small divisors, and their negatives for signed types
+    for (int32_t d = 1; d < 1100; d++) {
+        check_divisor<T, D>(T(d));
+        if (std::is_signed<T>::value) {
+            check_divisor<T, D>(T(-d));
+        }
+    }
+    // powers of two and their neighbours
+    for (uint8_t s = 1; s < sizeof(T)*8; s++) {
+        const T p = T(typename std::make_unsigned<T>::type(1) << s);
+        check_divisor<T, D>(wrap_add(p, T(-1)));
+        check_divisor<T, D>(p);
+        check_divisor<T, D>(wrap_add(p, T(1)));
+    }
+    check_divisor<T, D>(std::numeric_limits<T>::max());
+    // random divisors
+    for (uint16_t i = 0; i < 1000; i++) {
+        const T d = test_rand<T>();
+        if (d != 0) {
+            check_divisor<T, D>(d);
+        }
+    }
+}
+
+TEST(DivisorTest, Unsigned32)
+{
+    check_all_divisors<uint32_t, UDivisor<uint32_t>>();
+}
+
+TEST(DivisorTest, Unsigned64)
+{
+    check_all_divisors<uint64_t, UDivisor<uint64_t>>();
+}
+
+TEST(DivisorTest, Signed32)
+{
+    check_all_divisors<int32_t, SDivisor<int32_t>>();
+}
+
+TEST(DivisorTest, Signed64)
+{
+    check_all_divisors<int64_t, SDivisor<int64_t>>();
+}
+
+TEST(DivisorTest, Exhaustive16BitRange)
+{
+    // every 16 bit numerator against the divisors we use for time units
+    const uint32_t divisors[] { 3, 7, 60, 1000, 3600, 400, 1000000 };
+    for (const uint32_t d : divisors) {
+        const UDivisor<uint32_t> div(d);
+        for (uint32_t n = 0; n <= 0xFFFF; n++) {
+            ASSERT_EQ(n / d, div.divide(n));
+        }
+    }
+}
+
+TEST(DivisorTest, Constant)
+{
+    static_assert(ConstDivisor<uint64_t, 1000000ULL>::divide(123456789012ULL) == 123456ULL, "bad const divide");
+    static_assert(ConstDivisor<int32_t, -7>::divide(100) == -14, "bad const divide");
+    static_assert(ConstDivisor<int64_t, 3>::remainder(-7) == -1, "bad const remainder");
+
+    for (uint32_t i = 0; i < 10000; i++) {
+        const uint64_t x = test_rand64();
+        EXPECT_EQ(x / 1000000ULL, uint64_div1e6(x));
+        EXPECT_EQ(x / 1000000000ULL, uint64_div1e9(x));
+        EXPECT_EQ(x / 60ULL, uint64_div60(x));
+        EXPECT_EQ(x / 3600ULL, uint64_div3600(x));
+        EXPECT_EQ(int32_t(x) / 400, (ConstDivisor<int32_t, 400>::divide(int32_t(x))));
+    }
+}
+
+TEST(DivisorTest, Batch)
+{
+    uint64_t n[64], q[64];
+    int32_t sn[64], sq[64];
+    for (uint8_t i = 0; i < 64; i++) {
+        n[i] = test_rand64();
+        sn[i] = int32_t(test_rand64());
+    }
+    const UDivisor<uint64_t> udiv(1000);
+    udiv.divide(n, q, 64);
+    const SDivisor<int32_t> sdiv(-333);
+    sdiv.divide(sn, sq, 64);
+    for (uint8_t i = 0; i < 64; i++) {
+        EXPECT_EQ(n[i] / 1000, q[i]);
+        EXPECT_EQ(sn[i] / -333, sq[i]);
+    }
+
+    // in place
+    memcpy(q, n, sizeof(q));
+    ConstDivisor<uint64_t, 3600ULL>::divide(q, q, 64);
+    for (uint8_t i = 0; i < 64; i++) {
+        EXPECT_EQ(n[i] / 3600, q[i]);
+    }
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,138 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/ellipsoid_fit.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static Vector3f rand_direction()
+{
+    Vector3f v;
+    do {
+        v = Vector3f(rand_float(), rand_float(), rand_float());
+    } while (v.length() < 0.1f || v.length() > 1);
+    return v.normalized();
+}
+
+/*
+  raw sample whose corrected value S * (x + offset) is radius along
+  the direction, plus noise
+ */
+static Vector3f ellipsoid_sample(const Vector3f &direction, const EllipsoidFit::Result &truth, float noise)
+{
+    const Matrix3f S(truth.diag.x, truth.offdiag.x, truth.offdiag.y,
+                     truth.offdiag.x, truth.diag.y, truth.offdiag.z,
+                     truth.offdiag.y, truth.offdiag.z, truth.diag.z);
+    Matrix3f S_inv;
+    if (!S.inverse(S_inv)) {
+        return Vector3f();
+    }
+    const Vector3f noise_v(rand_float(), rand_float(), rand_float());
+    return S_inv * (direction * truth.radius) - truth.offset + noise_v * noise;
+}
+
+static void expect_result_near(const EllipsoidFit::Result &truth, const EllipsoidFit::Result &result, float tolerance)
+{
+    EXPECT_NEAR(truth.offset.x, result.offset.x, tolerance);
+    EXPECT_NEAR(truth.offset.y, result.offset.y, tolerance);
+    EXPECT_NEAR(truth.offset.z, result.offset.z, tolerance);
+    EXPECT_NEAR(truth.diag.x, result.diag.x, tolerance / truth.radius);
+    EXPECT_NEAR(truth.diag.y, result.diag.y, tolerance / truth.radius);
+    EXPECT_NEAR(truth.diag.z, result.diag.z, tolerance / truth.radius);
+    EXPECT_NEAR(truth.offdiag.x, result.offdiag.x, tolerance / truth.radius);
+    EXPECT_NEAR(truth.offdiag.y, result.offdiag.y, tolerance / truth.radius);
+    EXPECT_NEAR(truth.offdiag.z, result.offdiag.z, tolerance / truth.radius);
+}
+
+TEST(EllipsoidFitTest, Sphere)
+{
+    const EllipsoidFit::Result truth { Vector3f(120, -45, 300), Vector3f(1, 1, 1), Vector3f(), 450, 0 };
+    EllipsoidFit fit;
+    for (uint16_t i = 0; i < 5000; i++) {
+        fit.update(ellipsoid_sample(rand_direction(), truth, 0));
+    }
+    EXPECT_EQ(5000U, fit.get_sample_count());
+    EXPECT_EQ(EllipsoidFit::NUM_SECTIONS, fit.num_sections_covered());
+
+    EllipsoidFit::Result result;
+    ASSERT_TRUE(fit.fit_sphere(result));
+    expect_result_near(truth, result, 0.01f);
+    EXPECT_NEAR(truth.radius, result.radius, 0.01f);
+    EXPECT_LT(result.fitness, 0.01f);
+}
+
+TEST(EllipsoidFitTest, Ellipsoid)
+{
+    const EllipsoidFit::Result truth { Vector3f(-80, 210, 35), Vector3f(1.1f, 0.92f, 1.0f),
+                                       Vector3f(0.04f, -0.03f, 0.02f), 400, 0 };
+    EllipsoidFit fit;
+    for (uint32_t i = 0; i < 20000; i++) {
+        fit.update(ellipsoid_sample(rand_direction(), truth, 2));
+    }
+    EllipsoidFit::Result result;
+    ASSERT_TRUE(fit.fit_ellipsoid(result));
+    // the shape is relative to the sphere fit radius
+    EllipsoidFit::Result scaled = truth;
+    scaled.diag *= result.radius / truth.radius;
+    scaled.offdiag *= result.radius / truth.radius;
+    expect_result_near(scaled, result, 0.5f);
+    // uniform noise of +-2 in each axis
+    EXPECT_NEAR(2 / sqrtf(3), result.fitness, 0.1f);
+
+    // the sphere fit can't absorb the shape
+    EllipsoidFit::Result sphere;
+    ASSERT_TRUE(fit.fit_sphere(sphere));
+    EXPECT_GT(sphere.fitness, 5 * result.fitness);
+}
+
+TEST(EllipsoidFitTest, RepeatedDirection)
+{
+    // a vehicle left still in one direction, with a disturbed field
+    const EllipsoidFit::Result truth { Vector3f(30, 60, -90), Vector3f(1, 1, 1), Vector3f(), 500, 0 };
+    EllipsoidFit::Result disturbed = truth;
+    disturbed.radius = 540;
+    const Vector3f still = Vector3f(1, 2, 3).normalized();
+
+    EllipsoidFit fit;
+    for (uint32_t i = 0; i < 4000; i++) {
+        fit.update(ellipsoid_sample(rand_direction(), truth, 1));
+    }
+    for (uint32_t i = 0; i < 100000; i++) {
+        fit.update(ellipsoid_sample(still, disturbed, 1));
+    }
+
+    EllipsoidFit::Result capped, uncapped;
+    ASSERT_TRUE(fit.fit_sphere(capped));
+    fit.set_section_cap(UINT32_MAX);
+    ASSERT_TRUE(fit.fit_sphere(uncapped));
+
+    const float capped_error = (capped.offset - truth.offset).length();
+    const float uncapped_error = (uncapped.offset - truth.offset).length();
+    EXPECT_LT(capped_error, 2);
+    EXPECT_GT(uncapped_error, 5 * capped_error);
+}
+
+TEST(EllipsoidFitTest, Coverage)
+{
+    EllipsoidFit fit(Vector3f(100, 100, 100));
+    EllipsoidFit::Result result;
+    EXPECT_FALSE(fit.fit_sphere(result));
+
+    // no direction from the centre
+    EXPECT_FALSE(fit.update(Vector3f(100, 100, 100)));
+    EXPECT_TRUE(fit.update(Vector3f(100, 100, 200)));
+    EXPECT_EQ(1U, fit.get_sample_count());
+    EXPECT_EQ(1, fit.num_sections_covered());
+    EXPECT_EQ(0, fit.num_sections_covered(2));
+
+    // one direction has no radius
+    for (uint8_t i = 0; i < 20; i++) {
+        fit.update(Vector3f(100, 100, 200));
+    }
+    EXPECT_FALSE(fit.fit_sphere(result));
+
+    fit.reset();
+    EXPECT_EQ(0U, fit.get_sample_count());
+    EXPECT_EQ(0, fit.num_sections_covered());
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,234 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/filter.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define SAMPLE_RATE_HZ 1000.0f
+
+// run a sine through a filter and return the output amplitude once settled
+template <class F>
+static float sine_gain(F &filter, float freq_hz)
+{
+    filter.reset();
+    float max_out = 0;
+    const uint32_t n = 4000;
+    for (uint32_t i = 0; i < n; i++) {
+        const float in = sinf(M_2PI * freq_hz * i / SAMPLE_RATE_HZ);
+        const float out = filter.apply(in);
+        if (i > n / 2) {
+            max_out = MAX(max_out, fabsf(out));
+        }
+    }
+    return max_out;
+}
+
+TEST(FilterTest, LowPass1)
+{
+    LowPassFilter1Float lpf;
+    lpf.set_cutoff_frequency(1.0f / SAMPLE_RATE_HZ, 10);
+    EXPECT_FLOAT_EQ(calc_lowpass_alpha_dt(1.0f / SAMPLE_RATE_HZ, 10), lpf.get_alpha());
+
+    // step response reaches 63% after one time constant
+    const uint32_t tau_samples = uint32_t(roundf(SAMPLE_RATE_HZ / (M_2PI * 10)));
+    for (uint32_t i = 0; i < tau_samples; i++) {
+        lpf.apply(1.0f);
+    }
+    EXPECT_NEAR(0.63f, lpf.get(), 0.03f);
+
+    // block apply matches sample by sample
+    LowPassFilter1Vector3f lpf3;
+    lpf3.set_cutoff_frequency(1.0f / SAMPLE_RATE_HZ, 10);
+    LowPassFilter1Vector3f lpf3b = lpf3;
+    Vector3f in[50], out[50];
+    for (uint8_t i = 0; i < 50; i++) {
+        in[i] = Vector3f(i, -i, 2*i);
+    }
+    lpf3b.apply(in, out, 50);
+    for (uint8_t i = 0; i < 50; i++) {
+        const Vector3f v = lpf3.apply(in[i]);
+        EXPECT_FLOAT_EQ(v.x, out[i].x);
+        EXPECT_FLOAT_EQ(v.y, out[i].y);
+        EXPECT_FLOAT_EQ(v.z, out[i].z);
+    }
+}
+
+TEST(FilterTest, BiquadLowPass)
+{
+    BiquadFilterFloat lpf;
+    lpf.set_lowpass(SAMPLE_RATE_HZ, 50);
+
+    // unity DC gain, -3dB at cutoff, 40dB/decade above
+    EXPECT_NEAR(1.0f, sine_gain(lpf, 1), 0.01f);
+    EXPECT_NEAR(HALF_SQRT_2, sine_gain(lpf, 50), 0.02f);
+    EXPECT_LT(sine_gain(lpf, 400), 0.02f);
+
+    // reset to a value gives a steady output
+    lpf.reset(3.0f);
+    EXPECT_NEAR(3.0f, lpf.apply(3.0f), 1.0e-5f);
+
+    // cutoff above nyquist passes through
+    lpf.set_lowpass(SAMPLE_RATE_HZ, 600);
+    lpf.reset();
+    EXPECT_FLOAT_EQ(1.5f, lpf.apply(1.5f));
+}
+
+TEST(FilterTest, Notch)
+{
+    BiquadFilterFloat notch;
+    notch.set_notch(SAMPLE_RATE_HZ, 100, 20, 40);
+
+    EXPECT_LT(sine_gain(notch, 100), 0.02f);
+    EXPECT_NEAR(1.0f, sine_gain(notch, 10), 0.02f);
+    EXPECT_NEAR(1.0f, sine_gain(notch, 300), 0.05f);
+}
+
+TEST(FilterTest, HarmonicNotch)
+{
+    HarmonicNotchFilterFloat notch;
+    // fundamental, 2nd and 3rd harmonics
+    notch.init(SAMPLE_RATE_HZ, 0x07, 80, 20, 40);
+    EXPECT_EQ(3, notch.num_notches());
+
+    EXPECT_LT(sine_gain(notch, 80), 0.02f);
+    EXPECT_LT(sine_gain(notch, 160), 0.02f);
+    EXPECT_LT(sine_gain(notch, 240), 0.02f);
+    EXPECT_GT(sine_gain(notch, 20), 0.95f);
+
+    notch.update(100);
+    EXPECT_LT(sine_gain(notch, 200), 0.02f);
+    EXPECT_GT(sine_gain(notch, 160), 0.5f);
+
+    // harmonics above nyquist are passed through
+    notch.update(200);
+    EXPECT_LT(sine_gain(notch, 400), 0.02f);
+
+    // disabled with a zero frequency
+    notch.update(0);
+    EXPECT_FLOAT_EQ(0.25f, notch.apply(0.25f));
+}
+
+TEST(FilterTest, VectorMatchesScalar)
+{
+    BiquadFilterFloat fx, fy, fz;
+    BiquadFilterVector3f fv;
+    HarmonicNotchFilterVector3f hv;
+    HarmonicNotchFilterFloat hx;
+    fx.set_lowpass(SAMPLE_RATE_HZ, 30);
+    fy.set_lowpass(SAMPLE_RATE_HZ, 30);
+    fz.set_lowpass(SAMPLE_RATE_HZ, 30);
+    fv.set_lowpass(SAMPLE_RATE_HZ, 30);
+    hv.init(SAMPLE_RATE_HZ, 0x03, 70, 10, 30);
+    hx.init(SAMPLE_RATE_HZ, 0x03, 70, 10, 30);
+
+    Vector3f in[100], out[100];
+    for (uint8_t i = 0; i < 100; i++) {
+        in[i] = rand_vec3f();
+    }
+    HarmonicNotchFilterVector3f hv_block = hv;
+    hv_block.apply(in, out, 100);
+    for (uint8_t i = 0; i < 100; i++) {
+        const Vector3f v = fv.apply(in[i]);
+        EXPECT_FLOAT_EQ(fx.apply(in[i].x), v.x);
+        EXPECT_FLOAT_EQ(fy.apply(in[i].y), v.y);
+        EXPECT_FLOAT_EQ(fz.apply(in[i].z), v.z);
+
+        const Vector3f h = hv.apply(in[i]);
+        EXPECT_FLOAT_EQ(hx.apply(in[i].x), h.x);
+        EXPECT_FLOAT_EQ(h.x, out[i].x);
+        EXPECT_FLOAT_EQ(h.y, out[i].y);
+        EXPECT_FLOAT_EQ(h.z, out[i].z);
+    }
+}
+
+TEST(FilterTest, SoAMatchesScalar)
+{
+    const uint8_t nchan = 6;
+    BiquadFilterSoA<nchan> soa;
+    LowPassFilter1SoA<nchan> lpf_soa;
+    BiquadFilterFloat scalar[nchan];
+    LowPassFilter1Float lpf[nchan];
+    soa.set_notch(SAMPLE_RATE_HZ, 120, 30, 40);
+    lpf_soa.set_cutoff_frequency(1.0f / SAMPLE_RATE_HZ, 15);
+    for (uint8_t c = 0; c < nchan; c++) {
+        scalar[c].set_notch(SAMPLE_RATE_HZ, 120, 30, 40);
+        lpf[c].set_cutoff_frequency(1.0f / SAMPLE_RATE_HZ, 15);
+    }
+
+    const uint16_t nsamples = 200;
+    float in[nsamples * nchan], out[nsamples * nchan], lpf_out[nsamples * nchan];
+    for (uint16_t i = 0; i < nsamples * nchan; i++) {
+        in[i] = rand_float();
+    }
+    soa.apply(in, out, nsamples);
+    lpf_soa.apply(in, lpf_out, nsamples);
+    for (uint16_t s = 0; s < nsamples; s++) {
+        for (uint8_t c = 0; c < nchan; c++) {
+            EXPECT_FLOAT_EQ(scalar[c].apply(in[s*nchan + c]), out[s*nchan + c]);
+            EXPECT_FLOAT_EQ(lpf[c].apply(in[s*nchan + c]), lpf_out[s*nchan + c]);
+        }
+    }
+}
+
+TEST(FilterTest, FastSincos)
+{
+    for (float a = -100; a < 100; a += 0.0123f) {
+        float s, c;
+        fast_sincosf(a, s, c);
+        EXPECT_NEAR(sinf(a), s, 2.0e-7f);
+        EXPECT_NEAR(cosf(a), c, 2.0e-7f);
+    }
+}
+
+TEST(FilterTest, HarmonicNotchBank)
+{
+    // 4 harmonics on 3 axes of 2 IMUs
+    const uint8_t nchan = 6;
+    HarmonicNotchBank<4, nchan> bank;
+    HarmonicNotchFilterFloat scalar[nchan];
+    bank.init(SAMPLE_RATE_HZ, 0x0B, 60, 15, 40);
+    EXPECT_EQ(3, bank.num_notches());
+    for (uint8_t c = 0; c < nchan; c++) {
+        scalar[c].init(SAMPLE_RATE_HZ, 0x0B, 60, 15, 40);
+    }
+
+    // matches the cascaded scalar filters
+    float sample[nchan];
+    for (uint16_t s = 0; s < 500; s++) {
+        for (uint8_t c = 0; c < nchan; c++) {
+            sample[c] = rand_float();
+        }
+        float expected[nchan];
+        for (uint8_t c = 0; c < nchan; c++) {
+            expected[c] = scalar[c].apply(sample[c]);
+        }
+        bank.apply(sample);
+        for (uint8_t c = 0; c < nchan; c++) {
+            EXPECT_NEAR(expected[c], sample[c], 1.0e-5f);
+        }
+    }
+
+    // second IMU moved to a different frequency, check the 4th harmonic
+    // is removed on those channels only
+    bank.update(3, 3, 50);
+    bank.reset();
+    float in[1000 * nchan], out[1000 * nchan];
+    for (uint16_t s = 0; s < 1000; s++) {
+        for (uint8_t c = 0; c < nchan; c++) {
+            in[s*nchan + c] = sinf(M_2PI * 200 * s / SAMPLE_RATE_HZ);
+        }
+    }
+    bank.apply(in, out, 1000);
+    float max_out[nchan] {};
+    for (uint16_t s = 500; s < 1000; s++) {
+        for (uint8_t c = 0; c < nchan; c++) {
+            max_out[c] = MAX(max_out[c], fabsf(out[s*nchan + c]));
+        }
+    }
+    for (uint8_t c = 0; c < 3; c++) {
+        EXPECT_GT(max_out[c], 0.5f);
+        EXPECT_LT(max_out[c+3], 0.02f);
+    }
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,154 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/instrumentation.h>
+
+#include <thread>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static float probed_function(float x)
+{
+    AP_MATH_PROBE("probed_function");
+    return sqrtf(x) + 1;
+}
+
+static bool find_probe(const char *name, MathProbeStats &stats)
+{
+    for (uint16_t id = 0; id < MathInstrumentation::get_num_probes(); id++) {
+        if (MathInstrumentation::get_stats(id, stats) && strcmp(stats.name, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#if AP_MATH_INSTRUMENTATION_ENABLED
+
+static uint64_t histogram_total(const MathProbeStats &stats)
+{
+    uint64_t total = 0;
+    for (uint8_t b = 0; b < MathProbeStats::HISTOGRAM_BUCKETS; b++) {
+        total += stats.histogram[b];
+    }
+    return total;
+}
+
+TEST(InstrumentationTest, CountsCalls)
+{
+    MathInstrumentation::reset();
+    float sum = 0;
+    for (uint16_t i = 0; i < 1000; i++) {
+        sum += probed_function(i);
+    }
+    EXPECT_GT(sum, 0);
+
+    MathProbeStats stats;
+    ASSERT_TRUE(find_probe("probed_function", stats));
+    EXPECT_EQ(stats.calls, 1000U);
+    EXPECT_GT(stats.cycles, 0U);
+    EXPECT_EQ(histogram_total(stats), 1000U);
+
+    MathInstrumentation::reset();
+    ASSERT_TRUE(find_probe("probed_function", stats));
+    EXPECT_EQ(stats.calls, 0U);
+    EXPECT_EQ(stats.cycles, 0U);
+}
+
+// each thread counts into its own storage and the snapshot sums them
+TEST(InstrumentationTest, Threads)
+{
+    MathInstrumentation::reset();
+    std::thread threads[4];
+    for (auto &t : threads) {
+        t = std::thread([]() {
+            for (uint16_t i = 0; i < 10000; i++) {
+                probed_function(i);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    MathProbeStats stats;
+    ASSERT_TRUE(find_probe("probed_function", stats));
+    EXPECT_EQ(stats.calls, 40000U);
+    EXPECT_EQ(histogram_total(stats), 40000U);
+}
+
+// threads that have exited keep their counts when a new thread takes over their counters
+TEST(InstrumentationTest, ThreadsExiting)
+{
+    MathInstrumentation::reset();
+    for (uint16_t i = 0; i < 100; i++) {
+        std::thread t([]() {
+            for (uint16_t k = 0; k < 100; k++) {
+                probed_function(k);
+            }
+        });
+        t.join();
+    }
+
+    MathProbeStats stats;
+    ASSERT_TRUE(find_probe("probed_function", stats));
+    EXPECT_EQ(stats.calls, 10000U);
+    EXPECT_EQ(histogram_total(stats), 10000U);
+}
+
+TEST(InstrumentationTest, LibraryProbes)
+{
+    MathInstrumentation::reset();
+    for (uint8_t i = 0; i < 10; i++) {
+        sqrt_controller(i, 1.0f, 5.0f, 0.0025f);
+    }
+    MathProbeStats stats;
+    ASSERT_TRUE(find_probe("sqrt_controller", stats));
+    EXPECT_EQ(stats.calls, 10U);
+
+    const Vector2f square[] { {0, 0}, {10, 0}, {10, 10}, {0, 10}, {0, 0} };
+    EXPECT_FALSE(Polygon_outside(Vector2f(5, 5), square, ARRAY_SIZE(square)));
+    ASSERT_TRUE(find_probe("Polygon_outside<float>", stats));
+    EXPECT_EQ(stats.calls, 1U);
+}
+
+TEST(InstrumentationTest, Export)
+{
+    MathInstrumentation::reset();
+    for (uint8_t i = 0; i < 3; i++) {
+        probed_function(i);
+    }
+
+    char buf[4096];
+    size_t len = MathInstrumentation::export_json(buf, sizeof(buf));
+    EXPECT_EQ(len, strlen(buf));
+    EXPECT_EQ(strncmp(buf, "{\"unit\":\"", 9), 0);
+    EXPECT_NE(strstr(buf, "{\"name\":\"probed_function\",\"calls\":3,"), nullptr);
+
+    len = MathInstrumentation::export_text(buf, sizeof(buf));
+    EXPECT_EQ(len, strlen(buf));
+    EXPECT_NE(strstr(buf, "probed_function"), nullptr);
+
+    // truncated output is still terminated, and the full length returned
+    char small[16];
+    EXPECT_EQ(MathInstrumentation::export_text(small, sizeof(small)), len);
+    EXPECT_EQ(strlen(small), sizeof(small) - 1);
+}
+
+#else
+
+TEST(InstrumentationTest, Disabled)
+{
+    EXPECT_FLOAT_EQ(probed_function(4), 3);
+    MathProbeStats stats;
+    EXPECT_FALSE(find_probe("probed_function", stats));
+    EXPECT_EQ(MathInstrumentation::snapshot(&stats, 1), 0);
+
+    char buf[64];
+    MathInstrumentation::export_json(buf, sizeof(buf));
+    EXPECT_STREQ(buf, "{\"unit\":\"none\",\"probes\":[]}\n");
+}
+
+#endif
+
+AP_GTEST_MAIN()
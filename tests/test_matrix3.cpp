@@ -111,6 +111,187 @@ INSTANTIATE_TEST_CASE_P(NonInvertibleMatrices,
                         Matrix3fTest,
                         ::testing::ValuesIn(non_invertible));
 
+template <typename T>
+static Matrix3<T> rand_matrix(T scale)
+{
+    return Matrix3<T>(rand_float(), rand_float(), rand_float(),
+                      rand_float(), rand_float(), rand_float(),
+                      rand_float(), rand_float(), rand_float()) * scale;
+}
+
+template <typename T>
+static Matrix3<T> diag(const Vector3<T> &v)
+{
+    return Matrix3<T>(v.x, 0, 0,
+                      0, v.y, 0,
+                      0, 0, v.z);
+}
+
+// largest element difference
+template <typename T>
+static T max_error(const Matrix3<T> &m1, const Matrix3<T> &m2)
+{
+    T err = 0;
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            err = MAX(err, T(std::fabs(m1[i][j] - m2[i][j])));
+        }
+    }
+    return err;
+}
+
+template <typename T>
+static void check_orthogonal(const Matrix3<T> &m, T tolerance)
+{
+    Matrix3<T> identity;
+    identity.identity();
+    EXPECT_LT(max_error(m.transposed() * m, identity), tolerance);
+}
+
+// random rotation, orthogonal to the precision of T
+template <typename T>
+static Matrix3<T> rand_rotation()
+{
+    Matrix3<T> r;
+    r.a = Vector3<T>(rand_float(), rand_float(), rand_float()) + Vector3<T>(2, 0, 0);
+    r.a /= std::sqrt(r.a.length_squared());
+    r.b = Vector3<T>(rand_float(), rand_float(), rand_float()) + Vector3<T>(0, 2, 0);
+    r.b -= r.a * (r.a * r.b);
+    r.b /= std::sqrt(r.b.length_squared());
+    r.c = r.a % r.b;
+    return r;
+}
+
+// symmetric matrices with known eigenvalues, some repeated
+template <typename T>
+static Matrix3<T> rand_symmetric(Vector3<T> &eigenvalues, uint16_t i)
+{
+    const Matrix3<T> r = rand_rotation<T>();
+    eigenvalues = Vector3<T>(rand_float(), rand_float(), rand_float()) * 100;
+    switch (i % 4) {
+    case 1:
+        eigenvalues.y = eigenvalues.x;
+        break;
+    case 2:
+        eigenvalues.z = eigenvalues.y = eigenvalues.x;
+        break;
+    case 3:
+        eigenvalues.z = 0;
+        break;
+    }
+    return r * diag(eigenvalues) * r.transposed();
+}
+
+template <typename T>
+static void check_symmetric_eigen(T tolerance)
+{
+    for (uint16_t i = 0; i < 1000; i++) {
+        Vector3<T> expected;
+        const Matrix3<T> m = rand_symmetric(expected, i);
+        Vector3<T> values;
+        Matrix3<T> vectors;
+        m.symmetric_eigen(values, vectors);
+
+        EXPECT_LE(values.x, values.y);
+        EXPECT_LE(values.y, values.z);
+        check_orthogonal(vectors, tolerance);
+        EXPECT_LT(max_error(vectors * diag(values) * vectors.transposed(), m), 100 * tolerance);
+
+        // sort the expected values to compare
+        for (uint8_t j = 0; j < 2; j++) {
+            for (uint8_t k = 2; k > j; k--) {
+                if (expected[k] < expected[k-1]) {
+                    const T tmp = expected[k];
+                    expected[k] = expected[k-1];
+                    expected[k-1] = tmp;
+                }
+            }
+        }
+        for (uint8_t j = 0; j < 3; j++) {
+            EXPECT_NEAR(expected[j], values[j], 100 * tolerance);
+        }
+
+        // the closed form loses precision with repeated eigenvalues
+        const Vector3<T> closed = m.symmetric_eigenvalues();
+        for (uint8_t j = 0; j < 3; j++) {
+            EXPECT_NEAR(expected[j], closed[j], 100 * std::sqrt(tolerance));
+        }
+    }
+
+    // diagonal, zero and identity
+    Vector3<T> values;
+    Matrix3<T> vectors;
+    diag(Vector3<T>(3, -1, 2)).symmetric_eigen(values, vectors);
+    EXPECT_EQ(Vector3<T>(-1, 2, 3), values);
+    diag(Vector3<T>(0, 0, 0)).symmetric_eigen(values, vectors);
+    EXPECT_EQ(Vector3<T>(0, 0, 0), values);
+    check_orthogonal(vectors, tolerance);
+    EXPECT_EQ(Vector3<T>(2, 2, 2), diag(Vector3<T>(2, 2, 2)).symmetric_eigenvalues());
+}
+
+TEST(Matrix3Test, SymmetricEigen)
+{
+    check_symmetric_eigen<float>(1.0e-5f);
+    check_symmetric_eigen<double>(1.0e-12);
+}
+
+template <typename T>
+static void check_svd(const Matrix3<T> &m, T tolerance)
+{
+    Matrix3<T> U, V;
+    Vector3<T> S;
+    m.svd(U, S, V);
+    check_orthogonal(U, tolerance);
+    check_orthogonal(V, tolerance);
+    EXPECT_GE(S.x, S.y);
+    EXPECT_GE(S.y, S.z);
+    EXPECT_GE(S.z, 0);
+    const T scale = MAX(S.x, T(1));
+    EXPECT_LT(max_error(U * diag(S) * V.transposed(), m), tolerance * scale);
+}
+
+template <typename T>
+static void check_svds(T tolerance)
+{
+    for (uint16_t i = 0; i < 1000; i++) {
+        Matrix3<T> m = rand_matrix(T(100));
+        switch (i % 5) {
+        case 1:
+            // rank 2
+            m.c = m.a * 2 - m.b;
+            break;
+        case 2:
+            // rank 1
+            m.b = m.a * 3;
+            m.c = -m.a;
+            break;
+        case 3:
+            // repeated singular values
+            m = rand_rotation<T>() * T(5);
+            break;
+        }
+        check_svd(m, tolerance);
+    }
+
+    Matrix3<T> zero;
+    zero.zero();
+    check_svd(zero, tolerance);
+
+    // a reflection has unit singular values
+    Matrix3<T> U, V;
+    Vector3<T> S;
+    diag(Vector3<T>(1, 1, -1)).svd(U, S, V);
+    EXPECT_NEAR(1, S.x, tolerance);
+    EXPECT_NEAR(1, S.y, tolerance);
+    EXPECT_NEAR(1, S.z, tolerance);
+}
+
+TEST(Matrix3Test, SVD)
+{
+    check_svds<float>(1.0e-4f);
+    check_svds<double>(1.0e-11);
+}
+
 AP_GTEST_MAIN()
 
 #pragma GCC diagnostic pop
@@ -0,0 +1,268 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/matrix_batch.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define NUM_MATRICES 500
+
+template <uint8_t N>
+class MatrixBatchTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        for (uint16_t i = 0; i < NUM_MATRICES; i++) {
+            // keep the random matrices well conditioned so the
+            // comparisons aren't dominated by rounding
+            for (uint8_t k = 0; k < N*N; k++) {
+                mat[i*N*N + k] = rand_float() * 10 + ((k % (N + 1)) == 0 ? 30 : 0);
+            }
+        }
+        // zero, repeated row, rank one and infinite determinant
+        // matrices, with integer elements so the determinants are
+        // exactly zero
+        for (uint8_t k = 0; k < N*N; k++) {
+            mat[k] = 0;
+            mat[N*N + k] = k < N ? (k + N) : k;
+            mat[2*N*N + k] = 3;
+            mat[3*N*N + k] = (k % (N + 1)) == 0 ? 1.0e30f : 0;
+        }
+        soa.pack(mat, NUM_MATRICES);
+    }
+
+    float mat[NUM_MATRICES*N*N];
+    float storage[NUM_MATRICES*N*N];
+    MatrixSoA<float,N> soa{storage, NUM_MATRICES};
+    float inv_storage[NUM_MATRICES*N*N];
+    MatrixSoA<float,N> inv{inv_storage, NUM_MATRICES};
+    bool singular[NUM_MATRICES];
+
+    void check_inverse() {
+        mat_inverse(soa, inv, singular, NUM_MATRICES);
+        float out[N*N];
+        for (uint16_t i = 0; i < NUM_MATRICES; i++) {
+            const float *m = &mat[i*N*N];
+            EXPECT_EQ(!mat_inverse(m, out, N), singular[i]) << i;
+            if (singular[i]) {
+                continue;
+            }
+            for (uint8_t k = 0; k < N*N; k++) {
+                EXPECT_NEAR(out[k], inv.e[k][i], 1.0e-4f * MAX(1.0f, fabsf(out[k]))) << i;
+            }
+            // m * inv is the identity
+            for (uint8_t r = 0; r < N; r++) {
+                for (uint8_t c = 0; c < N; c++) {
+                    float sum = 0;
+                    for (uint8_t k = 0; k < N; k++) {
+                        sum += m[r*N + k] * inv.element(k, c)[i];
+                    }
+                    EXPECT_NEAR(r == c ? 1.0f : 0.0f, sum, 1.0e-3f) << i;
+                }
+            }
+        }
+        for (uint8_t i = 0; i < 4; i++) {
+            EXPECT_TRUE(singular[i]) << int(i);
+        }
+    }
+};
+
+typedef MatrixBatchTest<3> MatrixBatch3Test;
+typedef MatrixBatchTest<4> MatrixBatch4Test;
+
+TEST_F(MatrixBatch3Test, Determinant)
+{
+    float det[NUM_MATRICES];
+    mat_det(soa, det, NUM_MATRICES);
+    for (uint16_t i = 4; i < NUM_MATRICES; i++) {
+        Matrix3f m;
+        for (uint8_t r = 0; r < 3; r++) {
+            m[r] = Vector3f(mat[i*9 + r*3], mat[i*9 + r*3 + 1], mat[i*9 + r*3 + 2]);
+        }
+        EXPECT_FLOAT_EQ(m.det(), det[i]);
+    }
+    EXPECT_FLOAT_EQ(0, det[0]);
+    EXPECT_FLOAT_EQ(0, det[1]);
+    EXPECT_FLOAT_EQ(0, det[2]);
+    EXPECT_TRUE(isinf(det[3]));
+}
+
+TEST_F(MatrixBatch3Test, Inverse)
+{
+    check_inverse();
+}
+
+TEST_F(MatrixBatch4Test, Determinant)
+{
+    float det[NUM_MATRICES];
+    mat_det(soa, det, NUM_MATRICES);
+    mat_inverse(soa, inv, singular, NUM_MATRICES);
+    for (uint16_t i = 4; i < NUM_MATRICES; i++) {
+        // the inverse of the inverse has determinant 1/det
+        float inv_det[1];
+        const MatrixSoA<float,4> one = inv.offset(i);
+        mat_det(one, inv_det, 1);
+        EXPECT_NEAR(1.0f, det[i] * inv_det[0], 1.0e-3f) << i;
+    }
+    EXPECT_FLOAT_EQ(0, det[0]);
+}
+
+TEST_F(MatrixBatch4Test, Inverse)
+{
+    check_inverse();
+}
+
+TEST_F(MatrixBatch3Test, InPlace)
+{
+    mat_inverse(soa, soa, singular, NUM_MATRICES);
+    for (uint16_t i = 4; i < NUM_MATRICES; i++) {
+        float out[9];
+        ASSERT_TRUE(mat_inverse(&mat[i*9], out, 3));
+        for (uint8_t k = 0; k < 9; k++) {
+            EXPECT_NEAR(out[k], soa.e[k][i], 1.0e-4f * MAX(1.0f, fabsf(out[k])));
+        }
+    }
+}
+
+#define NUM_DECOMPOSITIONS 500
+
+// element (r, c) of matrix i of a 3x3 MatrixSoA
+template <typename T>
+static T elem(const MatrixSoA<T,3> &m, uint32_t i, uint8_t r, uint8_t c)
+{
+    return m.element(r, c)[i];
+}
+
+/*
+  check that m ~= u * diag(s) * v^T for matrix i, with u and v
+  orthogonal
+ */
+template <typename T>
+static void check_decomposition(const Matrix3<T> &m, const MatrixSoA<T,3> &u, const Vector3SoA<T> &s,
+                                const MatrixSoA<T,3> &v, uint32_t i, T tolerance)
+{
+    const T scale = MAX(T(1), MAX(T(std::fabs(s.x[i])), MAX(T(std::fabs(s.y[i])), T(std::fabs(s.z[i])))));
+    const T sv[3] { s.x[i], s.y[i], s.z[i] };
+    for (uint8_t r = 0; r < 3; r++) {
+        for (uint8_t c = 0; c < 3; c++) {
+            T usv = 0;
+            T utu = 0;
+            T vtv = 0;
+            for (uint8_t k = 0; k < 3; k++) {
+                usv += elem(u, i, r, k) * sv[k] * elem(v, i, c, k);
+                utu += elem(u, i, k, r) * elem(u, i, k, c);
+                vtv += elem(v, i, k, r) * elem(v, i, k, c);
+            }
+            EXPECT_NEAR(m[r][c], usv, tolerance * scale) << i;
+            EXPECT_NEAR(r == c ? 1 : 0, utu, tolerance) << i;
+            EXPECT_NEAR(r == c ? 1 : 0, vtv, tolerance) << i;
+        }
+    }
+}
+
+template <typename T>
+static void check_batch_eigen(T tolerance)
+{
+    T storage[NUM_DECOMPOSITIONS*9], vec_storage[NUM_DECOMPOSITIONS*9];
+    T vx[NUM_DECOMPOSITIONS], vy[NUM_DECOMPOSITIONS], vz[NUM_DECOMPOSITIONS];
+    const MatrixSoA<T,3> m{storage, NUM_DECOMPOSITIONS};
+    const MatrixSoA<T,3> vectors{vec_storage, NUM_DECOMPOSITIONS};
+    const Vector3SoA<T> values{vx, vy, vz};
+    Matrix3<T> mat[NUM_DECOMPOSITIONS];
+
+    for (uint16_t i = 0; i < NUM_DECOMPOSITIONS; i++) {
+        for (uint8_t r = 0; r < 3; r++) {
+            for (uint8_t c = r; c < 3; c++) {
+                mat[i][r][c] = mat[i][c][r] = rand_float() * 100;
+            }
+        }
+        switch (i % 4) {
+        case 1:
+            // already diagonal
+            mat[i].a.y = mat[i].b.x = mat[i].a.z = mat[i].c.x = mat[i].b.z = mat[i].c.y = 0;
+            break;
+        case 2:
+            // repeated eigenvalues
+            mat[i].identity();
+            mat[i] *= T(3);
+            mat[i].a.x += 1;
+            break;
+        }
+        for (uint8_t k = 0; k < 9; k++) {
+            m.e[k][i] = mat[i][k/3][k%3];
+        }
+    }
+
+    mat_symmetric_eigen(m, values, vectors, NUM_DECOMPOSITIONS);
+    for (uint16_t i = 0; i < NUM_DECOMPOSITIONS; i++) {
+        Vector3<T> expected;
+        Matrix3<T> expected_vectors;
+        mat[i].symmetric_eigen(expected, expected_vectors);
+        EXPECT_NEAR(expected.x, values.x[i], 100 * tolerance) << i;
+        EXPECT_NEAR(expected.y, values.y[i], 100 * tolerance) << i;
+        EXPECT_NEAR(expected.z, values.z[i], 100 * tolerance) << i;
+        check_decomposition(mat[i], vectors, values, vectors, i, tolerance);
+    }
+}
+
+TEST(MatrixBatchDecompositionTest, SymmetricEigen)
+{
+    check_batch_eigen<float>(2.0e-5f);
+    check_batch_eigen<double>(1.0e-12);
+}
+
+template <typename T>
+static void check_batch_svd(T tolerance)
+{
+    T storage[NUM_DECOMPOSITIONS*9], u_storage[NUM_DECOMPOSITIONS*9], v_storage[NUM_DECOMPOSITIONS*9];
+    T sx[NUM_DECOMPOSITIONS], sy[NUM_DECOMPOSITIONS], sz[NUM_DECOMPOSITIONS];
+    const MatrixSoA<T,3> m{storage, NUM_DECOMPOSITIONS};
+    const MatrixSoA<T,3> u{u_storage, NUM_DECOMPOSITIONS};
+    const MatrixSoA<T,3> v{v_storage, NUM_DECOMPOSITIONS};
+    const Vector3SoA<T> s{sx, sy, sz};
+    Matrix3<T> mat[NUM_DECOMPOSITIONS];
+
+    for (uint16_t i = 0; i < NUM_DECOMPOSITIONS; i++) {
+        for (uint8_t k = 0; k < 9; k++) {
+            mat[i][k/3][k%3] = rand_float() * 100;
+        }
+        switch (i % 5) {
+        case 1:
+            // rank 2
+            mat[i].c = mat[i].a - mat[i].b * 2;
+            break;
+        case 2:
+            // rank 1
+            mat[i].b = mat[i].a * 2;
+            mat[i].c = -mat[i].a;
+            break;
+        case 3:
+            // zero
+            mat[i].zero();
+            break;
+        }
+        for (uint8_t k = 0; k < 9; k++) {
+            m.e[k][i] = mat[i][k/3][k%3];
+        }
+    }
+
+    mat_svd(m, u, s, v, NUM_DECOMPOSITIONS);
+    for (uint16_t i = 0; i < NUM_DECOMPOSITIONS; i++) {
+        Matrix3<T> U, V;
+        Vector3<T> S;
+        mat[i].svd(U, S, V);
+        EXPECT_NEAR(S.x, s.x[i], 100 * tolerance * MAX(T(1), S.x)) << i;
+        EXPECT_NEAR(S.y, s.y[i], 100 * tolerance * MAX(T(1), S.x)) << i;
+        EXPECT_NEAR(S.z, s.z[i], 100 * tolerance * MAX(T(1), S.x)) << i;
+        EXPECT_GE(s.x[i], s.y[i]);
+        EXPECT_GE(s.y[i], s.z[i]);
+        EXPECT_GE(s.z[i], 0);
+        check_decomposition(mat[i], u, s, v, i, tolerance);
+    }
+}
+
+TEST(MatrixBatchDecompositionTest, SVD)
+{
+    check_batch_svd<float>(2.0e-5f);
+    check_batch_svd<double>(1.0e-12);
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,59 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+template <typename T>
+static void check_fill_and_find(void)
+{
+    // sizes either side of the old 2048 element limit and the scan block size
+    const size_t sizes[] { 0, 1, 15, 17, 63, 64, 65, 2048, 2049, 100000 };
+    for (const size_t count : sizes) {
+        T *buf = new T[count + 2];
+        buf[0] = 1;
+        buf[count + 1] = 2;
+        fill_nanf(&buf[1], count);
+        for (size_t i = 0; i < count; i++) {
+            ASSERT_TRUE(isnan(buf[i+1])) << "count=" << count << " i=" << i;
+        }
+        // guard elements untouched
+        EXPECT_EQ(T(1), buf[0]);
+        EXPECT_EQ(T(2), buf[count + 1]);
+        EXPECT_EQ(size_t(0), find_nanf(&buf[1], count));
+
+        // clear, then place a single NaN at various positions
+        for (size_t i = 0; i < count; i++) {
+            buf[i+1] = T(i);
+        }
+        EXPECT_EQ(count, find_nanf(&buf[1], count));
+        for (size_t pos = 0; pos < count; pos += 1 + pos / 2) {
+            buf[pos+1] = std::numeric_limits<T>::quiet_NaN();
+            EXPECT_EQ(pos, find_nanf(&buf[1], count));
+            buf[pos+1] = std::numeric_limits<T>::signaling_NaN();
+            EXPECT_EQ(pos, find_nanf(&buf[1], count));
+            buf[pos+1] = -std::numeric_limits<T>::quiet_NaN();
+            EXPECT_EQ(pos, find_nanf(&buf[1], count));
+            buf[pos+1] = T(pos);
+        }
+        // infinities are not NaN
+        if (count > 0) {
+            buf[1] = std::numeric_limits<T>::infinity();
+            buf[count] = -std::numeric_limits<T>::infinity();
+            EXPECT_EQ(count, find_nanf(&buf[1], count));
+        }
+        delete[] buf;
+    }
+}
+
+TEST(NanFill, Float)
+{
+    check_fill_and_find<float>();
+}
+
+TEST(NanFill, Double)
+{
+    check_fill_and_find<double>();
+}
+
+AP_GTEST_MAIN()
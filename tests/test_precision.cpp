@@ -0,0 +1,207 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/precision.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define NUM_SAMPLES 2000
+
+static float random_angle(float limit)
+{
+    return rand_float() * limit;
+}
+
+#if !HAL_WITH_EKF_DOUBLE
+// PrecisionFloat is the float code without a policy
+TEST(PrecisionTest, FloatMatchesDefault)
+{
+    for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+        const float roll = random_angle(M_PI);
+        const float pitch = random_angle(M_PI_2);
+        const float yaw = random_angle(M_PI);
+
+        Quaternion q, qp;
+        q.from_euler(roll, pitch, yaw);
+        qp.from_euler<PrecisionFloat>(roll, pitch, yaw);
+        EXPECT_EQ(q.q1, qp.q1);
+        EXPECT_EQ(q.q2, qp.q2);
+        EXPECT_EQ(q.q3, qp.q3);
+        EXPECT_EQ(q.q4, qp.q4);
+
+        float r, p, y, rp, pp, yp;
+        q.to_euler(r, p, y);
+        q.to_euler<PrecisionFloat>(rp, pp, yp);
+        EXPECT_EQ(r, rp);
+        EXPECT_EQ(p, pp);
+        EXPECT_EQ(y, yp);
+
+        Matrix3f m, mp;
+        m.from_euler(roll, pitch, yaw);
+        mp.from_euler<PrecisionFloat>(roll, pitch, yaw);
+        EXPECT_TRUE(m == mp);
+        m.to_euler(&r, &p, &y);
+        m.to_euler<PrecisionFloat>(&rp, &pp, &yp);
+        EXPECT_EQ(r, rp);
+        EXPECT_EQ(p, pp);
+        EXPECT_EQ(y, yp);
+
+        const Vector3f v(rand_float() * 100, rand_float() * 100, rand_float() * 100);
+        EXPECT_EQ(v.length(), v.length<PrecisionFloat>());
+        Vector3f vn = v, vnp = v;
+        vn.normalize();
+        vnp.normalize<PrecisionFloat>();
+        EXPECT_EQ(vn.x, vnp.x);
+        EXPECT_EQ(vn.y, vnp.y);
+        EXPECT_EQ(vn.z, vnp.z);
+        Quaternion qn(1 + rand_float(), rand_float(), rand_float(), rand_float());
+        Quaternion qnp = qn;
+        qn.normalize();
+        qnp.normalize<PrecisionFloat>();
+        EXPECT_EQ(qn.q1, qnp.q1);
+        EXPECT_EQ(qn.q2, qnp.q2);
+        EXPECT_EQ(qn.q3, qnp.q3);
+        EXPECT_EQ(qn.q4, qnp.q4);
+
+        const Vector2f origin(rand_float() * 100, rand_float() * 100);
+        const Vector2f destination(rand_float() * 100, rand_float() * 100);
+        EXPECT_EQ(get_bearing_rad(origin, destination), get_bearing_rad<PrecisionFloat>(origin, destination));
+        EXPECT_FLOAT_EQ(get_horizontal_distance(origin, destination), get_horizontal_distance<PrecisionFloat>(origin, destination));
+    }
+
+    // sqrt_controller() forwards to sqrt_controller<PrecisionFloat>(),
+    // so both are checked against outputs of the float implementation
+    // from before the precision policies
+    const struct {
+        float error, p, second_ord_lim, dt, output;
+    } sqrt_controller_tests[] {
+        { -25.0f, 0.5f, 2.0f, 0.0025f, -9.1651516f },
+        { -0.4f, 0.5f, 2.0f, 0.0025f, -0.200000003f },
+        { 0.002f, 0.5f, 2.0f, 0.0025f, 0.00100000005f },
+        { 1.7f, 0.5f, 2.0f, 0.0025f, 0.850000024f },
+        { 42.0f, 0.5f, 2.0f, 0.0025f, 12.3288279f },
+        { -25.0f, 0.0f, 2.0f, 0.0f, -10.0f },
+        { -0.4f, 0.0f, 2.0f, 0.0f, -1.26491106f },
+        { 0.002f, 0.0f, 2.0f, 0.0f, 0.0894427225f },
+        { 1.7f, 0.0f, 2.0f, 0.0f, 2.60768104f },
+        { 42.0f, 0.0f, 2.0f, 0.0f, 12.9614811f },
+        { -25.0f, 3.0f, 0.0f, 0.01f, -75.0f },
+        { -0.4f, 3.0f, 0.0f, 0.01f, -1.20000005f },
+        { 0.002f, 3.0f, 0.0f, 0.01f, 0.00600000005f },
+        { 1.7f, 3.0f, 0.0f, 0.01f, 5.10000038f },
+        { 42.0f, 3.0f, 0.0f, 0.01f, 126.0f },
+        { -25.0f, 1.2f, 8.0f, 0.1f, -18.8561802f },
+        { -0.4f, 1.2f, 8.0f, 0.1f, -0.480000019f },
+        { 0.002f, 1.2f, 8.0f, 0.1f, 0.00240000011f },
+        { 1.7f, 1.2f, 8.0f, 0.1f, 2.0400002f },
+        { 42.0f, 1.2f, 8.0f, 0.1f, 25.0510578f },
+    };
+    for (const auto &t : sqrt_controller_tests) {
+        EXPECT_EQ(sqrt_controller(t.error, t.p, t.second_ord_lim, t.dt), t.output) << "error " << t.error;
+        EXPECT_EQ(sqrt_controller<PrecisionFloat>(t.error, t.p, t.second_ord_lim, t.dt), t.output) << "error " << t.error;
+    }
+}
+#endif
+
+// PrecisionDouble keeps double precision even where the default code drops to ftype
+TEST(PrecisionTest, DoubleAccuracy)
+{
+    double max_default_error = 0;
+    double max_double_error = 0;
+    for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+        const double roll = random_angle(M_PI);
+        const double pitch = random_angle(1.5);
+        const double yaw = random_angle(M_PI);
+
+        QuaternionD q;
+        double r, p, y;
+        q.from_euler<PrecisionDouble>(roll, pitch, yaw);
+        q.to_euler<PrecisionDouble>(r, p, y);
+        max_double_error = MAX(max_double_error, fabs(r - roll));
+        max_double_error = MAX(max_double_error, fabs(p - pitch));
+        max_double_error = MAX(max_double_error, fabs(y - yaw));
+
+        q.from_euler(roll, pitch, yaw);
+        q.to_euler(r, p, y);
+        max_default_error = MAX(max_default_error, fabs(r - roll));
+        max_default_error = MAX(max_default_error, fabs(p - pitch));
+        max_default_error = MAX(max_default_error, fabs(y - yaw));
+
+        Matrix3d m;
+        m.from_euler<PrecisionDouble>(roll, pitch, yaw);
+        m.to_euler<PrecisionDouble>(&r, &p, &y);
+        EXPECT_NEAR(r, roll, 1e-12);
+        EXPECT_NEAR(p, pitch, 1e-12);
+        EXPECT_NEAR(y, yaw, 1e-12);
+
+        Vector3d v(rand_float() * 1e6, rand_float() * 1e6, rand_float() * 1e6);
+        const double length = std::sqrt(v.x*v.x + v.y*v.y + v.z*v.z);
+        EXPECT_NEAR(v.length<PrecisionDouble>(), length, 1e-15 * length);
+        v.normalize<PrecisionDouble>();
+        EXPECT_NEAR(v.length<PrecisionDouble>(), 1.0, 1e-15);
+    }
+    EXPECT_LT(max_double_error, 1e-12);
+#if !HAL_WITH_EKF_DOUBLE
+    // the default code computes the angles in float
+    EXPECT_GT(max_default_error, 1e-8);
+#endif
+
+    // sqrt controller with a distance float can't resolve
+    const double error = 1e6 + 1e-3;
+    const double rate = sqrt_controller<PrecisionDouble>(error, 0.0, 2.0, 0.0);
+    EXPECT_NEAR(rate, std::sqrt(4.0 * error), 1e-9);
+    EXPECT_NEAR(get_horizontal_distance<PrecisionDouble>(Vector2d(1e7, 0), Vector2d(1e7 + 1e-3, 0)), 1e-3, 1e-9);
+    EXPECT_NEAR(get_bearing_rad<PrecisionDouble>(Vector2d(0, 0), Vector2d(-1, -1)), 1.25 * M_PI, 1e-15);
+}
+
+// PrecisionFast stays within the errors its functions document
+TEST(PrecisionTest, FastAccuracy)
+{
+    for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+        const float x = rand_float() * 100;
+        const float y = rand_float() * 100;
+        EXPECT_NEAR(PrecisionFast::atan2(y, x), atan2(double(y), double(x)), 5e-7);
+        const float s = rand_float();
+        EXPECT_NEAR(PrecisionFast::safe_asin(s), asin(double(s)), 1e-6);
+        const float v = fabsf(x) * powf(10, y * 0.3f);
+        if (v > 0) {
+            EXPECT_NEAR(PrecisionFast::inv_sqrt(v) * sqrt(double(v)), 1.0, 5e-6);
+        }
+
+        const float roll = random_angle(M_PI);
+        const float pitch = random_angle(1.5);
+        const float yaw = random_angle(M_PI);
+        Quaternion q;
+        q.from_euler<PrecisionFast>(roll, pitch, yaw);
+        float r, p, yw;
+        q.to_euler<PrecisionFast>(r, p, yw);
+        EXPECT_NEAR(r, roll, 2e-5);
+        EXPECT_NEAR(p, pitch, 2e-5);
+        EXPECT_NEAR(yw, yaw, 2e-5);
+        q.q1 *= 1.01f;
+        q.normalize<PrecisionFast>();
+        EXPECT_NEAR(q.length(), 1.0f, 1e-5);
+
+        Matrix3f m;
+        m.from_euler<PrecisionFast>(roll, pitch, yaw);
+        m.to_euler<PrecisionFast>(&r, &p, &yw);
+        EXPECT_NEAR(r, roll, 2e-5);
+        EXPECT_NEAR(p, pitch, 2e-5);
+        EXPECT_NEAR(yw, yaw, 2e-5);
+
+        const Vector2f origin(rand_float() * 100, rand_float() * 100);
+        const Vector2f destination(rand_float() * 100, rand_float() * 100);
+        EXPECT_NEAR(get_bearing_rad<PrecisionFast>(origin, destination), get_bearing_rad(origin, destination), 1e-5);
+    }
+
+    // special cases
+    EXPECT_EQ(PrecisionFast::atan2(0, 0), 0);
+    EXPECT_FLOAT_EQ(PrecisionFast::atan2(0, -1), M_PI);
+    EXPECT_FLOAT_EQ(PrecisionFast::atan2(1, 0), M_PI_2);
+    EXPECT_FLOAT_EQ(PrecisionFast::atan2(-1, 0), -M_PI_2);
+    EXPECT_FLOAT_EQ(PrecisionFast::safe_asin(2), M_PI_2);
+    EXPECT_FLOAT_EQ(PrecisionFast::safe_asin(-2), -M_PI_2);
+    EXPECT_EQ(PrecisionFast::safe_asin(NAN), 0);
+}
+
+AP_GTEST_MAIN()
@@ -251,4 +251,69 @@ TEST(QuaternionTest, Quaternion_length_squared)
     EXPECT_FLOAT_EQ(q.length_squared(), 1.44);
 }
 
+// Tests that earth_to_body() and body_to_earth() match the rotation matrix
+// and its transpose, evaluated in double, for random rotations and vectors
+// of length up to ~170, so within a few float ulps
+TEST(QuaternionTest, QuaternionEarthToBodyAccuracy)
+{
+    for (uint16_t n = 0; n < 1000; n++) {
+        Quaternion q(rand_float(), rand_float(), rand_float(), rand_float());
+        q.normalize();
+        const Vector3f v = Vector3f(rand_float(), rand_float(), rand_float()) * 100;
+
+        Matrix3d m;
+        q.todouble().rotation_matrix(m);
+        const Vector3d expected_e2b = m * v.todouble();
+        const Vector3d expected_b2e = m.mul_transpose(v.todouble());
+
+        Vector3f e2b = v;
+        q.earth_to_body(e2b);
+        Vector3f b2e = v;
+        q.body_to_earth(b2e);
+        Vector3f round_trip = e2b;
+        q.body_to_earth(round_trip);
+
+        for (uint8_t i = 0; i < 3; i++) {
+            EXPECT_NEAR(expected_e2b[i], e2b[i], 2e-4);
+            EXPECT_NEAR(expected_b2e[i], b2e[i], 2e-4);
+            EXPECT_NEAR(v[i], round_trip[i], 2e-4);
+        }
+        EXPECT_NEAR(v.length(), e2b.length(), 2e-4);
+
+        // body_to_earth() is rotation by the inverse
+        const Vector3f inv = q.inverse() * v;
+        for (uint8_t i = 0; i < 3; i++) {
+            EXPECT_FLOAT_EQ(inv[i], b2e[i]);
+        }
+    }
+}
+
+// Tests that the fast Euler conversions match the libm versions
+TEST(QuaternionTest, QuaternionFromEulerFast)
+{
+    for (uint16_t n = 0; n < 1000; n++) {
+        const Vector3f euler = Vector3f(rand_float(), rand_float(), rand_float()) * M_PI;
+
+        Quaternion q, q_fast;
+        q.from_euler(euler);
+        q_fast.from_euler_fast(euler.x, euler.y, euler.z);
+
+        Matrix3f m, m_fast, m312, m312_fast;
+        m.from_euler(euler.x, euler.y, euler.z);
+        m_fast.from_euler_fast(euler.x, euler.y, euler.z);
+        m312.from_euler312(euler.x, euler.y, euler.z);
+        m312_fast.from_euler312_fast(euler.x, euler.y, euler.z);
+
+        for (uint8_t i = 0; i < 4; i++) {
+            EXPECT_NEAR(q[i], q_fast[i], 1e-6);
+        }
+        for (uint8_t i = 0; i < 3; i++) {
+            for (uint8_t j = 0; j < 3; j++) {
+                EXPECT_NEAR(m[i][j], m_fast[i][j], 1e-6);
+                EXPECT_NEAR(m312[i][j], m312_fast[i][j], 1e-6);
+            }
+        }
+    }
+}
+
 AP_GTEST_MAIN()
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/quaternion_average.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// angle in radians between two attitudes
+static double attitude_error(const QuaternionD &a, const QuaternionD &b)
+{
+    const double dot = a.q1*b.q1 + a.q2*b.q2 + a.q3*b.q3 + a.q4*b.q4;
+    return 2 * acos(MIN(1.0, std::fabs(dot)));
+}
+
+// rotation by a random angle up to max_angle about a random axis
+static QuaternionD rand_rotation(double max_angle)
+{
+    Vector3d axis;
+    do {
+        axis = Vector3d(rand_float(), rand_float(), rand_float());
+    } while (axis.length_squared() < 0.01);
+    axis /= std::sqrt(axis.length_squared());
+    const double half_angle = 0.5 * max_angle * rand_float();
+    return QuaternionD(cos(half_angle), axis.x * sin(half_angle), axis.y * sin(half_angle), axis.z * sin(half_angle));
+}
+
+TEST(QuaternionAverageTest, Mean)
+{
+    QuaternionD truth;
+    truth.from_euler(0.3, -0.2, 1.0);
+
+    // pairs of opposite rotations about the truth, some with the sign flipped
+    QuaternionAverageD average;
+    for (uint16_t i = 0; i < 500; i++) {
+        const QuaternionD d = rand_rotation(0.5);
+        const double sign = (i % 3) == 0 ? -1 : 1;
+        const QuaternionD a = truth * d;
+        const QuaternionD b = truth * d.inverse();
+        average.update(QuaternionD(sign * a.q1, sign * a.q2, sign * a.q3, sign * a.q4));
+        average.update(b);
+    }
+    EXPECT_EQ(1000U, average.get_count());
+    EXPECT_DOUBLE_EQ(1000, average.get_weight());
+
+    QuaternionD mean;
+    double concentration;
+    ASSERT_TRUE(average.get_mean(mean, &concentration));
+    EXPECT_LT(attitude_error(truth, mean), 1e-12);
+    EXPECT_GT(mean.q1, 0);
+    EXPECT_GT(concentration, 0.9);
+    EXPECT_LT(concentration, 1);
+}
+
+TEST(QuaternionAverageTest, Weights)
+{
+    const double angle = 0.8;
+    QuaternionD a, b;
+    a.from_axis_angle(Vector3d(0, 0, 1), 0);
+    b.from_axis_angle(Vector3d(0, 0, 1), angle);
+
+    QuaternionAverageD average;
+    QuaternionD mean;
+    EXPECT_FALSE(average.get_mean(mean));
+
+    // equal weights give the midpoint
+    average.update(a, 2);
+    average.update(b, 2);
+    ASSERT_TRUE(average.get_mean(mean));
+    EXPECT_NEAR(angle / 2, attitude_error(a, mean), 1e-6);
+
+    // more weight pulls the mean towards a
+    average.update(a, 4);
+    ASSERT_TRUE(average.get_mean(mean));
+    EXPECT_LT(attitude_error(a, mean), angle / 3);
+    EXPECT_GT(attitude_error(a, mean), 0);
+
+    // identical samples are fully concentrated
+    QuaternionAverage same;
+    float concentration;
+    for (uint8_t i = 0; i < 10; i++) {
+        same.update(a.tofloat(), 0.5f);
+    }
+    Quaternion mean_f;
+    ASSERT_TRUE(same.get_mean(mean_f, &concentration));
+    EXPECT_NEAR(1, concentration, 1e-6);
+    EXPECT_LT(attitude_error(a, mean_f.todouble()), 1e-3);
+}
+
+TEST(QuaternionAverageTest, Merge)
+{
+    QuaternionD truth;
+    truth.from_euler(-1.0, 0.4, 2.5);
+    QuaternionD samples[1000];
+    for (uint16_t i = 0; i < ARRAY_SIZE(samples); i++) {
+        samples[i] = truth * rand_rotation(0.3);
+    }
+
+    QuaternionAverageD single;
+    single.update(samples, ARRAY_SIZE(samples));
+
+    // as if filled by four threads
+    QuaternionAverageD parts[4];
+    for (uint16_t i = 0; i < ARRAY_SIZE(samples); i++) {
+        parts[i % 4].update(samples[i]);
+    }
+    QuaternionAverageD merged;
+    for (uint8_t i = 0; i < 4; i++) {
+        merged.merge(parts[i]);
+    }
+
+    QuaternionD mean_single, mean_merged;
+    ASSERT_TRUE(single.get_mean(mean_single));
+    ASSERT_TRUE(merged.get_mean(mean_merged));
+    EXPECT_EQ(single.get_count(), merged.get_count());
+    EXPECT_LT(attitude_error(mean_single, mean_merged), 1e-12);
+    EXPECT_LT(attitude_error(truth, mean_single), 0.02);
+}
+
+TEST(QuaternionAverageTest, OutlierRejection)
+{
+    QuaternionD truth;
+    truth.from_euler(0.1, 0.2, -0.7);
+    // one in ten samples is from a sensor with a 1 rad error
+    QuaternionD faulty;
+    faulty.from_euler(1.1, 0.2, -0.7);
+
+    QuaternionAverageD robust, plain;
+    robust.set_outlier_rejection(0.3);
+    for (uint16_t i = 0; i < 2000; i++) {
+        const QuaternionD q = ((i % 10) == 3 ? faulty : truth) * rand_rotation(0.05);
+        robust.update(q);
+        plain.update(q);
+    }
+
+    QuaternionD mean_robust, mean_plain;
+    ASSERT_TRUE(robust.get_mean(mean_robust));
+    ASSERT_TRUE(plain.get_mean(mean_plain));
+    EXPECT_LT(attitude_error(truth, mean_robust), 0.005);
+    EXPECT_GT(attitude_error(truth, mean_plain), 0.05);
+    // the outliers in the first min_samples are kept
+    EXPECT_GE(robust.get_rejected_count(), 195U);
+    EXPECT_EQ(2000U, robust.get_count() + robust.get_rejected_count());
+    EXPECT_EQ(0U, plain.get_rejected_count());
+
+    robust.reset();
+    EXPECT_EQ(0U, robust.get_count());
+    EXPECT_EQ(0U, robust.get_rejected_count());
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,167 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/quaternion_batch.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define NUM_SAMPLES 257
+
+class QuaternionBatchTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+            quat[i] = Quaternion(rand_float(), rand_float(), rand_float(), rand_float());
+            quat[i].normalize();
+            vec[i] = Vector3f(rand_float(), rand_float(), rand_float()) * 20;
+        }
+        q.pack(quat, NUM_SAMPLES);
+        v.pack(vec, NUM_SAMPLES);
+    }
+
+    Quaternion quat[NUM_SAMPLES];
+    Vector3f vec[NUM_SAMPLES];
+    float q1[NUM_SAMPLES], q2[NUM_SAMPLES], q3[NUM_SAMPLES], q4[NUM_SAMPLES];
+    QuaternionSoA<float> q{q1, q2, q3, q4};
+    float vx[NUM_SAMPLES], vy[NUM_SAMPLES], vz[NUM_SAMPLES];
+    Vector3SoA<float> v{vx, vy, vz};
+    float ox[NUM_SAMPLES], oy[NUM_SAMPLES], oz[NUM_SAMPLES];
+    Vector3SoA<float> out{ox, oy, oz};
+};
+
+TEST_F(QuaternionBatchTest, PackUnpack)
+{
+    Quaternion quat2[NUM_SAMPLES];
+    q.unpack(quat2, NUM_SAMPLES);
+    for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+        for (uint8_t j = 0; j < 4; j++) {
+            EXPECT_EQ(quat[i][j], quat2[i][j]);
+        }
+        EXPECT_EQ(quat[i][0], q.offset(i).get(0)[0]);
+    }
+}
+
+// the batch results are bitwise identical to the scalar functions
+TEST_F(QuaternionBatchTest, OneQuaternion)
+{
+    const Quaternion &rot = quat[0];
+    Vector3f aos[NUM_SAMPLES];
+
+    memcpy(aos, vec, sizeof(aos));
+    earth_to_body(rot, aos, NUM_SAMPLES);
+    earth_to_body(rot, v, out, NUM_SAMPLES);
+    for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+        Vector3f expected = vec[i];
+        rot.earth_to_body(expected);
+        EXPECT_TRUE(expected == aos[i]);
+        EXPECT_TRUE(expected == out.get(i));
+    }
+
+    memcpy(aos, vec, sizeof(aos));
+    body_to_earth(rot, aos, NUM_SAMPLES);
+    body_to_earth(rot, v, out, NUM_SAMPLES);
+    for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+        Vector3f expected = vec[i];
+        rot.body_to_earth(expected);
+        EXPECT_TRUE(expected == aos[i]);
+        EXPECT_TRUE(expected == out.get(i));
+    }
+}
+
+TEST_F(QuaternionBatchTest, PerSampleQuaternion)
+{
+    Vector3f aos[NUM_SAMPLES];
+
+    memcpy(aos, vec, sizeof(aos));
+    earth_to_body(quat, aos, NUM_SAMPLES);
+    earth_to_body(q, v, out, NUM_SAMPLES);
+    for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+        Vector3f expected = vec[i];
+        quat[i].earth_to_body(expected);
+        EXPECT_TRUE(expected == aos[i]);
+        EXPECT_TRUE(expected == out.get(i));
+    }
+
+    memcpy(aos, vec, sizeof(aos));
+    body_to_earth(quat, aos, NUM_SAMPLES);
+    body_to_earth(q, v, out, NUM_SAMPLES);
+    for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+        Vector3f expected = vec[i];
+        quat[i].body_to_earth(expected);
+        EXPECT_TRUE(expected == aos[i]);
+        EXPECT_TRUE(expected == out.get(i));
+    }
+}
+
+// rotating in place and back returns the original vectors
+TEST_F(QuaternionBatchTest, InPlaceRoundTrip)
+{
+    earth_to_body(q, v, v, NUM_SAMPLES);
+    body_to_earth(q, v, v, NUM_SAMPLES);
+    for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+        const Vector3f r = v.get(i);
+        for (uint8_t j = 0; j < 3; j++) {
+            EXPECT_NEAR(vec[i][j], r[j], 1e-4);
+        }
+    }
+}
+
+TEST_F(QuaternionBatchTest, FromEuler)
+{
+    // use the vectors as Euler angles, wrapped to +-PI
+    for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+        v.set(i, Vector3f(wrap_PI(vec[i].x), wrap_PI(vec[i].y), wrap_PI(vec[i].z)));
+    }
+    Matrix3f m[NUM_SAMPLES], m_fast[NUM_SAMPLES], m312[NUM_SAMPLES], m312_fast[NUM_SAMPLES];
+    float f1[NUM_SAMPLES], f2[NUM_SAMPLES], f3[NUM_SAMPLES], f4[NUM_SAMPLES];
+    const QuaternionSoA<float> q_fast{f1, f2, f3, f4};
+
+    from_euler(v, q, NUM_SAMPLES);
+    from_euler_fast(v, q_fast, NUM_SAMPLES);
+    from_euler(v, m, NUM_SAMPLES);
+    from_euler_fast(v, m_fast, NUM_SAMPLES);
+    from_euler312(v, m312, NUM_SAMPLES);
+    from_euler312_fast(v, m312_fast, NUM_SAMPLES);
+
+    for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+        const Vector3f euler = v.get(i);
+        Quaternion expected_q;
+        expected_q.from_euler(euler);
+        Matrix3f expected_m, expected_m312;
+        expected_m.from_euler(euler.x, euler.y, euler.z);
+        expected_m312.from_euler312(euler.x, euler.y, euler.z);
+
+        const Quaternion batch_q = q.get(i);
+        const Quaternion batch_q_fast = q_fast.get(i);
+        for (uint8_t j = 0; j < 4; j++) {
+            EXPECT_EQ(expected_q[j], batch_q[j]);
+            EXPECT_NEAR(expected_q[j], batch_q_fast[j], 1e-6);
+        }
+        for (uint8_t j = 0; j < 3; j++) {
+            EXPECT_TRUE(expected_m[j] == m[i][j]);
+            EXPECT_TRUE(expected_m312[j] == m312[i][j]);
+            for (uint8_t k = 0; k < 3; k++) {
+                EXPECT_NEAR(expected_m[j][k], m_fast[i][j][k], 1e-6);
+                EXPECT_NEAR(expected_m312[j][k], m312_fast[i][j][k], 1e-6);
+            }
+        }
+    }
+}
+
+TEST(QuaternionBatchDouble, MatchesMatrix)
+{
+    QuaternionD rot(0.8365163, 0.48296291, 0.22414387, -0.12940952);
+    rot.normalize();
+    Matrix3d m;
+    rot.rotation_matrix(m);
+    Vector3d aos[3] {{1, 2, 3}, {-4, 5, 0.5}, {0, 0, 1}};
+    const Vector3d orig[3] {aos[0], aos[1], aos[2]};
+    earth_to_body(rot, aos, 3);
+    for (uint8_t i = 0; i < 3; i++) {
+        const Vector3d expected = m * orig[i];
+        for (uint8_t j = 0; j < 3; j++) {
+            EXPECT_NEAR(expected[j], aos[i][j], 1e-12);
+        }
+    }
+}
+
+AP_GTEST_MAIN()
@@ -189,6 +189,124 @@ TEST(RotationsTest, TestFailedGetLinux)
     }
 }*/
 
+static bool rotated_equal(const Vector3f &v1, const Vector3f &v2)
+{
+    return (v1 - v2).length() < 1.0e-4f;
+}
+
+// check the compile time rotation tables against Vector3::rotate()
+TEST(RotationsTest, TestRotationTables)
+{
+    const Vector3f v(1, 2, 3);
+    for (uint8_t i = 0; i < ROTATION_MAX; i++) {
+        const enum Rotation r = (enum Rotation)i;
+        Vector3f v1 = v;
+        v1.rotate(r);
+
+        // canonical rotation is the first equivalent one
+        const enum Rotation canonical = rotation_canonical(r);
+        EXPECT_LE(canonical, r);
+        Vector3f v2 = v;
+        v2.rotate(canonical);
+        EXPECT_TRUE(rotated_equal(v1, v2));
+        for (uint8_t j = 0; j < canonical; j++) {
+            Vector3f v3 = v;
+            v3.rotate((enum Rotation)j);
+            EXPECT_FALSE(rotated_equal(v1, v3));
+        }
+
+        // inverse undoes the rotation, if it is in the list
+        const enum Rotation inverse = rotation_inverse(r);
+        if (inverse != ROTATION_MAX) {
+            v2 = v1;
+            v2.rotate(inverse);
+            EXPECT_TRUE(rotated_equal(v, v2));
+        }
+        v2 = v1;
+        v2.rotate_inverse(r);
+        EXPECT_TRUE(rotated_equal(v, v2));
+
+        // composition matches rotating twice
+        for (uint8_t j = 0; j < ROTATION_MAX; j++) {
+            const enum Rotation r2 = (enum Rotation)j;
+            const enum Rotation composed = rotation_compose(r, r2);
+            Vector3f twice = v1;
+            twice.rotate(r2);
+            if (composed == ROTATION_MAX) {
+                for (uint8_t k = 0; k < ROTATION_MAX; k++) {
+                    Vector3f v3 = v;
+                    v3.rotate((enum Rotation)k);
+                    EXPECT_FALSE(rotated_equal(twice, v3));
+                }
+            } else {
+                Vector3f v3 = v;
+                v3.rotate(composed);
+                EXPECT_TRUE(rotated_equal(twice, v3));
+            }
+        }
+    }
+    EXPECT_TRUE(rotation_equal(ROTATION_PITCH_180_YAW_90, ROTATION_ROLL_180_YAW_270));
+    EXPECT_FALSE(rotation_equal(ROTATION_PITCH_180_YAW_90, ROTATION_ROLL_180_YAW_90));
+}
+
+// check the matrix and quaternion lookups against Vector3::rotate() for every rotation
+TEST(RotationsTest, TestRotationConstants)
+{
+    const Vector3d v(1, 2, 3);
+    for (uint8_t i = 0; i < ROTATION_MAX; i++) {
+        const enum Rotation r = (enum Rotation)i;
+        Vector3d v1 = v;
+        v1.rotate(r);
+
+        Matrix3d m;
+        m.from_rotation(r);
+        EXPECT_LE((m * v - v1).length(), 1.0e-12);
+
+        // unit length, with the rotation matrix of the matrix lookup
+        QuaternionD q;
+        q.from_rotation(r);
+        EXPECT_NEAR(q.q1 * q.q1 + q.q2 * q.q2 + q.q3 * q.q3 + q.q4 * q.q4, 1.0, 1.0e-15);
+        Matrix3d qm;
+        q.rotation_matrix(qm);
+        for (uint8_t j = 0; j < 3; j++) {
+            for (uint8_t k = 0; k < 3; k++) {
+                EXPECT_NEAR(qm[j][k], m[j][k], 1.0e-15);
+            }
+        }
+
+        // same sign as from_rotation_matrix(), as the constants in the old switch were
+        Matrix3f mf;
+        mf.from_rotation(r);
+        Quaternion qf, qf_from_m;
+        qf.from_rotation(r);
+        qf_from_m.from_rotation_matrix(mf);
+        EXPECT_NEAR(qf.q1, qf_from_m.q1, 1.0e-6);
+        EXPECT_NEAR(qf.q2, qf_from_m.q2, 1.0e-6);
+        EXPECT_NEAR(qf.q3, qf_from_m.q3, 1.0e-6);
+        EXPECT_NEAR(qf.q4, qf_from_m.q4, 1.0e-6);
+
+        // rotate() multiplies by the rotation
+        QuaternionD q0(0.5, -0.1, 0.7, 0.2);
+        q0.normalize();
+        QuaternionD q_rotated = q0;
+        q_rotated.rotate(r);
+        const QuaternionD expected = q0 * q;
+        EXPECT_NEAR(q_rotated.q1, expected.q1, 1.0e-15);
+        EXPECT_NEAR(q_rotated.q2, expected.q2, 1.0e-15);
+        EXPECT_NEAR(q_rotated.q3, expected.q3, 1.0e-15);
+        EXPECT_NEAR(q_rotated.q4, expected.q4, 1.0e-15);
+    }
+
+    // custom rotations are outside the tables
+    AP::custom_rotations().set(ROTATION_CUSTOM_2, 10, 20, 30);
+    Matrix3f m, m_euler;
+    m.from_rotation(ROTATION_CUSTOM_2);
+    m_euler.from_euler(radians(10), radians(20), radians(30));
+    for (uint8_t j = 0; j < 3; j++) {
+        EXPECT_LE((m[j] - m_euler[j]).length(), 1.0e-6);
+    }
+}
+
 /*
   rotate a matrix using a give order, specified as a string
   for example "321"
@@ -0,0 +1,146 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define NUM_VALUES 200
+
+// values covering saturation on both sides, NaN and infinities
+static void fill_test_values(float *v, float range)
+{
+    for (uint16_t i = 0; i < NUM_VALUES; i++) {
+        v[i] = range * 1.5f * rand_float();
+    }
+    v[0] = std::numeric_limits<float>::quiet_NaN();
+    v[1] = -range * 2;
+    v[2] = 0.5f;
+    v[3] = -0.5f;
+    v[4] = -std::numeric_limits<float>::infinity();
+}
+
+TEST(SampleConversion, FloatToInt16)
+{
+    float v[NUM_VALUES];
+    fill_test_values(v, 40000);
+    v[5] = std::numeric_limits<float>::infinity();
+    int16_t i16[NUM_VALUES];
+    uint16_t u16[NUM_VALUES];
+    float_to_int16(v, i16, NUM_VALUES);
+    float_to_uint16(v, u16, NUM_VALUES);
+    for (uint16_t i = 0; i < NUM_VALUES; i++) {
+        EXPECT_EQ(float_to_int16(v[i]), i16[i]) << v[i];
+        EXPECT_EQ(float_to_uint16(v[i]), u16[i]) << v[i];
+    }
+}
+
+TEST(SampleConversion, FloatToInt32)
+{
+    // stay below the upper limit, which can't be represented exactly as a float
+    float v[NUM_VALUES];
+    fill_test_values(v, 1.0e9f);
+    int32_t i32[NUM_VALUES];
+    uint32_t u32[NUM_VALUES];
+    float_to_int32(v, i32, NUM_VALUES);
+    float_to_uint32(v, u32, NUM_VALUES);
+    for (uint16_t i = 0; i < NUM_VALUES; i++) {
+        EXPECT_EQ(float_to_int32(v[i]), i32[i]) << v[i];
+        EXPECT_EQ(float_to_uint32(v[i]), u32[i]) << v[i];
+    }
+}
+
+TEST(SampleConversion, Fixed)
+{
+    uint16_t fixed[NUM_VALUES];
+    float f[NUM_VALUES];
+    for (uint16_t i = 0; i < NUM_VALUES; i++) {
+        fixed[i] = get_random16();
+    }
+    for (uint8_t bits = 0; bits < 16; bits += 5) {
+        fixed2float(fixed, f, NUM_VALUES, bits);
+        for (uint16_t i = 0; i < NUM_VALUES; i++) {
+            EXPECT_FLOAT_EQ(fixed2float(fixed[i], bits), f[i]);
+        }
+        uint16_t back[NUM_VALUES];
+        float2fixed(f, back, NUM_VALUES, bits);
+        for (uint16_t i = 0; i < NUM_VALUES; i++) {
+            EXPECT_EQ(float2fixed(f[i], bits), back[i]);
+        }
+    }
+}
+
+TEST(SampleConversion, TwosComplement)
+{
+    uint32_t raw[NUM_VALUES];
+    int32_t out[NUM_VALUES];
+    for (uint8_t length = 1; length < 32; length++) {
+        for (uint16_t i = 0; i < NUM_VALUES; i++) {
+            raw[i] = (uint32_t(get_random16()) << 16 | get_random16()) & ((1U << length) - 1);
+        }
+        get_twos_complement(raw, out, NUM_VALUES, length);
+        for (uint16_t i = 0; i < NUM_VALUES; i++) {
+            EXPECT_EQ(get_twos_complement(raw[i], length), out[i]);
+        }
+    }
+}
+
+TEST(SampleConversion, BitCast)
+{
+    const float f[3] { 1.5f, -2.25f, 1.0e-30f };
+    uint32_t u[3];
+    float f2[3];
+    for (uint8_t i = 0; i < 3; i++) {
+        u[i] = uint32_t(float_to_int32_le(f[i]));
+    }
+    int32_to_float_le(u, f2, 3);
+    for (uint8_t i = 0; i < 3; i++) {
+        EXPECT_EQ(int32_to_float_le(u[i]), f2[i]);
+    }
+}
+
+/*
+  reference LSB first bit packer
+ */
+static void pack_le_samples(const int32_t *samples, uint16_t count, uint8_t bits, uint8_t *buf)
+{
+    memset(buf, 0, (count * bits + 7) / 8);
+    uint32_t bitpos = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        const uint32_t raw = uint32_t(samples[i]) & ((1U << bits) - 1);
+        for (uint8_t b = 0; b < bits; b++, bitpos++) {
+            if (raw & (1U << b)) {
+                buf[bitpos / 8] |= 1U << (bitpos % 8);
+            }
+        }
+    }
+}
+
+TEST(SampleConversion, UnpackPacked)
+{
+    int32_t samples[NUM_VALUES+1];
+    int32_t out[NUM_VALUES+1];
+    float fout[NUM_VALUES+1];
+    uint8_t buf[(NUM_VALUES+1)*3];
+    const uint8_t widths[] { 12, 16, 20, 24 };
+    for (const uint8_t bits : widths) {
+        // include an odd count so the pair decoding tail is covered
+        for (const uint16_t count : { uint16_t(NUM_VALUES), uint16_t(NUM_VALUES+1) }) {
+            for (uint16_t i = 0; i < count; i++) {
+                const uint32_t raw = (uint32_t(get_random16()) << 16 | get_random16()) & ((1U << bits) - 1);
+                samples[i] = get_twos_complement(raw, bits);
+            }
+            samples[0] = -(1 << (bits-1));
+            samples[1] = (1 << (bits-1)) - 1;
+            pack_le_samples(samples, count, bits, buf);
+            EXPECT_TRUE(unpack_le_samples(buf, bits, count, out));
+            EXPECT_TRUE(unpack_le_samples(buf, bits, count, 0.5f, fout));
+            for (uint16_t i = 0; i < count; i++) {
+                EXPECT_EQ(samples[i], out[i]) << "bits=" << int(bits) << " i=" << i;
+                EXPECT_FLOAT_EQ(samples[i] * 0.5f, fout[i]);
+            }
+        }
+    }
+    EXPECT_FALSE(unpack_le_samples(buf, 8, 1, out));
+}
+
+AP_GTEST_MAIN()
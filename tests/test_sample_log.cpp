@@ -0,0 +1,273 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/sample_log.h>
+#include <AP_Math/crc.h>
+
+#include <stdio.h>
+#include <unistd.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_MATH_SAMPLE_LOG_ENABLED
+
+static const char *path = "test_sample_log.bin";
+
+#define NUM_SAMPLES 5000
+
+static float gyro[3][NUM_SAMPLES];
+static float att[4][NUM_SAMPLES];
+static double alt[NUM_SAMPLES];
+static uint64_t time_us[NUM_SAMPLES];
+
+static void write_log()
+{
+    for (uint32_t i = 0; i < NUM_SAMPLES; i++) {
+        gyro[0][i] = rand_float();
+        gyro[1][i] = rand_float();
+        gyro[2][i] = rand_float();
+        QuaternionF q;
+        q.from_euler(rand_float(), rand_float(), rand_float() * M_PI);
+        att[0][i] = q.q1;
+        att[1][i] = q.q2;
+        att[2][i] = q.q3;
+        att[3][i] = q.q4;
+        alt[i] = 100 + i * 0.01;
+        time_us[i] = 1000000 + i * 2500;
+    }
+    SampleLogWriter writer(NUM_SAMPLES);
+    EXPECT_TRUE(writer.add_column("time_us", time_us));
+    EXPECT_TRUE(writer.add_column("gyro", Vector3SoA<float>(gyro[0], gyro[1], gyro[2])));
+    EXPECT_TRUE(writer.add_column("att", QuaternionSoA<float>(att[0], att[1], att[2], att[3])));
+    EXPECT_TRUE(writer.add_column("alt", alt));
+    // duplicate and too long names
+    EXPECT_FALSE(writer.add_column("alt", alt));
+    EXPECT_FALSE(writer.add_column("a_very_long_name", alt));
+    EXPECT_TRUE(writer.write(path));
+}
+
+TEST(SampleLogTest, RoundTrip)
+{
+    write_log();
+    SampleLogReader reader;
+    ASSERT_TRUE(reader.open(path));
+    EXPECT_EQ(reader.get_num_samples(), NUM_SAMPLES);
+    EXPECT_EQ(reader.get_num_columns(), 4);
+    EXPECT_EQ(reader.find_column("att"), 2);
+    EXPECT_EQ(reader.find_column("mag"), -1);
+
+    uint64_t *t;
+    double *a;
+    Vector3SoA<float> g;
+    QuaternionSoA<float> q;
+    ASSERT_TRUE(reader.get_view("time_us", t));
+    ASSERT_TRUE(reader.get_view("alt", a));
+    ASSERT_TRUE(reader.get_view("gyro", g));
+    ASSERT_TRUE(reader.get_view("att", q));
+    EXPECT_EQ(memcmp(t, time_us, sizeof(time_us)), 0);
+    EXPECT_EQ(memcmp(a, alt, sizeof(alt)), 0);
+    EXPECT_EQ(memcmp(g.z, gyro[2], sizeof(gyro[2])), 0);
+    EXPECT_EQ(memcmp(q.q4, att[3], sizeof(att[3])), 0);
+
+    // views are aligned for the batch functions
+    EXPECT_EQ(uintptr_t(g.y) % 64, 0U);
+    EXPECT_EQ(uintptr_t(q.q3) % 64, 0U);
+
+    // wrong type or number of components
+    float *f;
+    Vector3SoA<double> gd;
+    EXPECT_FALSE(reader.get_view("alt", f));
+    EXPECT_FALSE(reader.get_view("gyro", gd));
+    EXPECT_FALSE(reader.get_view("att", g));
+    EXPECT_FALSE(reader.get_view("mag", g));
+
+    // changes to views don't reach the file
+    g.x[0] = 1000;
+    SampleLogReader reader2;
+    ASSERT_TRUE(reader2.open(path));
+    ASSERT_TRUE(reader2.get_view("gyro", g));
+    EXPECT_EQ(g.x[0], gyro[0][0]);
+
+    reader.close();
+    EXPECT_EQ(reader.get_num_samples(), 0U);
+    remove(path);
+}
+
+static void corrupt(uint32_t offset, uint8_t value)
+{
+    FILE *f = fopen(path, "r+b");
+    ASSERT_NE(f, nullptr);
+    fseek(f, offset, SEEK_SET);
+    fputc(value, f);
+    fclose(f);
+}
+
+TEST(SampleLogTest, Invalid)
+{
+    SampleLogReader reader;
+    EXPECT_FALSE(reader.open("no_such_file.bin"));
+
+    // magic
+    write_log();
+    corrupt(0, 'X');
+    EXPECT_FALSE(reader.open(path));
+
+    // directory, caught by the CRC
+    write_log();
+    corrupt(sizeof(SampleLogHeader) + 1, 'X');
+    EXPECT_FALSE(reader.open(path));
+
+    // truncated column data
+    write_log();
+    ASSERT_TRUE(reader.open(path));
+    const off_t size = reader.get_column(3).offset + NUM_SAMPLES * sizeof(double) - 1;
+    reader.close();
+    ASSERT_EQ(truncate(path, size), 0);
+    EXPECT_FALSE(reader.open(path));
+
+    // too short for a header
+    ASSERT_EQ(truncate(path, 10), 0);
+    EXPECT_FALSE(reader.open(path));
+    remove(path);
+}
+
+// change a column's offset, keeping the directory CRC valid
+static void move_column(uint16_t column, uint64_t offset)
+{
+    FILE *f = fopen(path, "r+b");
+    ASSERT_NE(f, nullptr);
+    SampleLogHeader header;
+    SampleLogColumn directory[4];
+    ASSERT_EQ(fread(&header, sizeof(header), 1, f), 1U);
+    ASSERT_EQ(fread(directory, sizeof(directory), 1, f), 1U);
+    directory[column].offset = offset;
+    header.directory_crc = crc_crc32(0, reinterpret_cast<const uint8_t *>(directory), sizeof(directory));
+    fseek(f, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, f);
+    fwrite(directory, sizeof(directory), 1, f);
+    fclose(f);
+}
+
+TEST(SampleLogTest, BadColumnOffsets)
+{
+    SampleLogReader reader;
+    write_log();
+    ASSERT_TRUE(reader.open(path));
+    const uint64_t first = reader.get_column(0).offset;
+    const uint64_t gyro = reader.get_column(1).offset;
+    reader.close();
+
+    // over the header and directory
+    move_column(0, 0);
+    EXPECT_FALSE(reader.open(path));
+    move_column(0, first - 64);
+    EXPECT_FALSE(reader.open(path));
+
+    // over another column
+    move_column(0, gyro + 64);
+    EXPECT_FALSE(reader.open(path));
+    move_column(0, gyro);
+    EXPECT_FALSE(reader.open(path));
+
+    move_column(0, first);
+    EXPECT_TRUE(reader.open(path));
+    remove(path);
+}
+
+// a log appended a chunk at a time is the same as one written at once
+TEST(SampleLogTest, Append)
+{
+    write_log();
+    const char *chunked_path = "test_sample_log_chunked.bin";
+    static float cx[777], cy[777], cz[777];
+    static double calt[777];
+    SampleLogWriter writer(NUM_SAMPLES);
+    EXPECT_TRUE(writer.add_column("gyro", Vector3SoA<float>(cx, cy, cz)));
+    EXPECT_TRUE(writer.add_column("alt", calt));
+    EXPECT_FALSE(writer.append(1));
+    ASSERT_TRUE(writer.open(chunked_path));
+    EXPECT_FALSE(writer.add_column("late", calt));
+    for (uint32_t start = 0; start < NUM_SAMPLES; start += 777) {
+        const uint32_t count = MIN(777U, NUM_SAMPLES - start);
+        memcpy(cx, &gyro[0][start], count * sizeof(float));
+        memcpy(cy, &gyro[1][start], count * sizeof(float));
+        memcpy(cz, &gyro[2][start], count * sizeof(float));
+        memcpy(calt, &alt[start], count * sizeof(double));
+        ASSERT_TRUE(writer.append(count));
+    }
+    // no more than num_samples
+    EXPECT_FALSE(writer.append(1));
+    EXPECT_TRUE(writer.close());
+
+    SampleLogReader reader, whole_reader;
+    ASSERT_TRUE(reader.open(chunked_path));
+    ASSERT_TRUE(whole_reader.open(path));
+    Vector3SoA<float> g, whole_g;
+    double *a, *whole_a;
+    ASSERT_TRUE(reader.get_view("gyro", g));
+    ASSERT_TRUE(reader.get_view("alt", a));
+    ASSERT_TRUE(whole_reader.get_view("gyro", whole_g));
+    ASSERT_TRUE(whole_reader.get_view("alt", whole_a));
+    EXPECT_EQ(memcmp(g.x, whole_g.x, sizeof(gyro[0])), 0);
+    EXPECT_EQ(memcmp(g.y, whole_g.y, sizeof(gyro[1])), 0);
+    EXPECT_EQ(memcmp(g.z, whole_g.z, sizeof(gyro[2])), 0);
+    EXPECT_EQ(memcmp(a, whole_a, sizeof(alt)), 0);
+
+    // closing early leaves an incomplete log
+    SampleLogWriter short_writer(NUM_SAMPLES);
+    EXPECT_TRUE(short_writer.add_column("alt", calt));
+    ASSERT_TRUE(short_writer.open(chunked_path));
+    ASSERT_TRUE(short_writer.append(10));
+    EXPECT_FALSE(short_writer.close());
+    remove(chunked_path);
+    remove(path);
+}
+
+// views go straight into the batch functions, chunk by chunk
+TEST(SampleLogTest, Chunks)
+{
+    write_log();
+    SampleLogReader reader;
+    ASSERT_TRUE(reader.open(path));
+    Vector3SoA<float> g;
+    QuaternionSoA<float> q;
+    ASSERT_TRUE(reader.get_view("gyro", g));
+    ASSERT_TRUE(reader.get_view("att", q));
+
+    static float ex[NUM_SAMPLES], ey[NUM_SAMPLES], ez[NUM_SAMPLES];
+    const Vector3SoA<float> earth(ex, ey, ez);
+    uint32_t next = 0;
+    bool in_order = true;
+    reader.for_each_chunk(1024, 2, [&](uint32_t start, uint32_t count) {
+        if (start != next || count > 1024) {
+            in_order = false;
+        }
+        next = start + count;
+        body_to_earth(q.offset(start), g.offset(start), earth.offset(start), count);
+    });
+    EXPECT_TRUE(in_order);
+    EXPECT_EQ(next, NUM_SAMPLES);
+
+    for (uint32_t i = 0; i < NUM_SAMPLES; i++) {
+        const QuaternionF quat(att[0][i], att[1][i], att[2][i], att[3][i]);
+        Vector3f v(gyro[0][i], gyro[1][i], gyro[2][i]);
+        quat.body_to_earth(v);
+        EXPECT_EQ(earth.get(i), v) << "sample " << i;
+    }
+
+    // released chunks are read from the file again
+    EXPECT_EQ(memcmp(g.x, gyro[0], sizeof(gyro[0])), 0);
+    remove(path);
+}
+
+#else
+
+TEST(SampleLogTest, Disabled)
+{
+    SampleLogReader reader;
+    EXPECT_FALSE(reader.open("test_sample_log.bin"));
+}
+
+#endif  // AP_MATH_SAMPLE_LOG_ENABLED
+
+AP_GTEST_MAIN()
@@ -0,0 +1,138 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/segment_bvh.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define NUM_SEGMENTS 2000
+
+static Vector3f rand_vec3f(float scale)
+{
+    return Vector3f(rand_float(), rand_float(), rand_float()) * scale;
+}
+
+class SegmentBVHTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        for (uint16_t i = 0; i < NUM_SEGMENTS; i++) {
+            start_v[i] = rand_vec3f(1000);
+            end_v[i] = start_v[i] + rand_vec3f(20);
+        }
+        // duplicates and zero length segments
+        for (uint16_t i = 0; i < 50; i++) {
+            start_v[i] = end_v[i] = Vector3f(5, 5, 5);
+        }
+        ASSERT_TRUE(bvh.build(start_v, end_v, NUM_SEGMENTS));
+    }
+
+    // index of the nearest segment and its distance by brute force
+    float brute_nearest(const Vector3f &p, uint32_t &index) const {
+        float best = FLT_MAX;
+        for (uint32_t i = 0; i < NUM_SEGMENTS; i++) {
+            const float d = Vector3f::closest_distance_between_line_and_point(start_v[i], end_v[i], p);
+            if (d < best) {
+                best = d;
+                index = i;
+            }
+        }
+        return best;
+    }
+
+    Vector3f start_v[NUM_SEGMENTS];
+    Vector3f end_v[NUM_SEGMENTS];
+    SegmentBVH bvh;
+};
+
+TEST_F(SegmentBVHTest, Build)
+{
+    EXPECT_EQ(uint32_t(NUM_SEGMENTS), bvh.num_segments());
+    EXPECT_GT(bvh.num_nodes(), uint32_t(NUM_SEGMENTS / SEGMENT_BVH_LEAF_SIZE));
+
+    SegmentBVH empty;
+    EXPECT_TRUE(empty.build(start_v, end_v, 0));
+    uint32_t index;
+    float dist;
+    EXPECT_FALSE(empty.nearest(Vector3f(), index, dist));
+    EXPECT_EQ(0U, empty.within_radius(Vector3f(), 100, &index, 1));
+}
+
+TEST_F(SegmentBVHTest, Nearest)
+{
+    for (uint16_t n = 0; n < 200; n++) {
+        const Vector3f p = rand_vec3f(1100);
+        uint32_t expected_index = 0;
+        const float expected = brute_nearest(p, expected_index);
+        uint32_t index;
+        float dist;
+        ASSERT_TRUE(bvh.nearest(p, index, dist));
+        EXPECT_NEAR(expected, dist, 1.0e-3f);
+        EXPECT_NEAR(expected, Vector3f::closest_distance_between_line_and_point(start_v[index], end_v[index], p), 1.0e-3f);
+
+        // nothing within a smaller distance
+        EXPECT_FALSE(bvh.nearest(p, index, dist, expected * 0.99f));
+    }
+
+    // exact hit on the duplicated points
+    uint32_t index;
+    float dist;
+    ASSERT_TRUE(bvh.nearest(Vector3f(5, 5, 5), index, dist));
+    EXPECT_FLOAT_EQ(0, dist);
+    EXPECT_LT(index, 50U);
+}
+
+TEST_F(SegmentBVHTest, NearestToSegment)
+{
+    float cx[NUM_SEGMENTS], cy[NUM_SEGMENTS], cz[NUM_SEGMENTS];
+    float sx[NUM_SEGMENTS], sy[NUM_SEGMENTS], sz[NUM_SEGMENTS];
+    float ex[NUM_SEGMENTS], ey[NUM_SEGMENTS], ez[NUM_SEGMENTS];
+    Segment3SoA<float> seg{{sx, sy, sz}, {ex, ey, ez}};
+    seg.start.pack(start_v, NUM_SEGMENTS);
+    seg.end.pack(end_v, NUM_SEGMENTS);
+    float all_dist[NUM_SEGMENTS];
+
+    for (uint16_t n = 0; n < 100; n++) {
+        const Vector3f s = rand_vec3f(1000);
+        const Vector3f e = s + rand_vec3f(100);
+        segment_to_segment_closest_point(s, e, seg, Vector3SoA<float>(cx, cy, cz), NUM_SEGMENTS, all_dist);
+        float expected = FLT_MAX;
+        for (uint32_t i = 0; i < NUM_SEGMENTS; i++) {
+            expected = MIN(expected, all_dist[i]);
+        }
+        uint32_t index;
+        float dist;
+        ASSERT_TRUE(bvh.nearest_to_segment(s, e, index, dist));
+        EXPECT_NEAR(expected, dist, 1.0e-3f);
+        EXPECT_NEAR(expected, all_dist[index], 1.0e-3f);
+    }
+}
+
+TEST_F(SegmentBVHTest, WithinRadius)
+{
+    uint32_t indices[NUM_SEGMENTS];
+    bool in_result[NUM_SEGMENTS];
+    for (uint16_t n = 0; n < 100; n++) {
+        const Vector3f p = rand_vec3f(1000);
+        const float radius = 50 + n;
+        const uint32_t found = bvh.within_radius(p, radius, indices, NUM_SEGMENTS);
+        memset(in_result, 0, sizeof(in_result));
+        for (uint32_t i = 0; i < found; i++) {
+            EXPECT_FALSE(in_result[indices[i]]);
+            in_result[indices[i]] = true;
+        }
+        uint32_t expected = 0;
+        for (uint32_t i = 0; i < NUM_SEGMENTS; i++) {
+            const float d = Vector3f::closest_distance_between_line_and_point(start_v[i], end_v[i], p);
+            // ignore rounding at the boundary
+            if (fabsf(d - radius) > 1.0e-3f) {
+                EXPECT_EQ(d < radius, in_result[i]);
+            }
+            expected += in_result[i] ? 1 : 0;
+        }
+        EXPECT_EQ(expected, found);
+
+        // the total is returned even if the results are truncated
+        EXPECT_EQ(found, bvh.within_radius(p, radius, indices, 1));
+    }
+}
+
+AP_GTEST_MAIN()
@@ -1,6 +1,6 @@
 #include <AP_gtest.h>
 
-#include <AP_Math/vector2.h>
+#include <AP_Math/vector2_batch.h>
 
 const AP_HAL::HAL& hal = AP_HAL::get_HAL();
 
@@ -31,6 +31,16 @@ const AP_HAL::HAL& hal = AP_HAL::get_HAL();
             EXPECT_EQ(Vector2f::point_on_segment(calculated_intersection,s1p1, s1p2), true); \
             EXPECT_EQ(Vector2f::point_on_segment(calculated_intersection,s2p1, s2p2), true); \
         }                                                               \
+        float bsx = s2p1x, bsy = s2p1y, bex = s2p2x, bey = s2p2y;       \
+        float bix, biy;                                                 \
+        bool batch_result;                                              \
+        const Segment2SoA<float> seg2{{&bsx, &bsy}, {&bex, &bey}};      \
+        segment_intersection(s1p1, s1p2, seg2, Vector2SoA<float>(&bix, &biy), &batch_result, 1); \
+        EXPECT_EQ(expected, batch_result);                              \
+        if (expected) {                                                 \
+            Vector2f expected_intersection{ix, iy};                     \
+            EXPECT_VECTOR2F_EQ(Vector2f(bix, biy), expected_intersection); \
+        }                                                               \
     } while (false);
 
 #define SHOULD_INTERSECT(s1p1x,s1p1y,s1p2x,s1p2y, s2p1x,s2p1y,s2p2x,s2p2y, ix, iy) \
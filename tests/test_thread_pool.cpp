@@ -0,0 +1,230 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/matrix_batch.h>
+#include <AP_Math/thread_pool.h>
+
+#include <atomic>
+#include <thread>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const uint16_t thread_counts[] { 1, 2, 3, 8 };
+
+TEST(ThreadPoolTest, SetThreads)
+{
+    MathThreadPool pool;
+    EXPECT_EQ(pool.get_threads(), 1);
+    EXPECT_TRUE(pool.set_threads(1));
+#if AP_MATH_THREAD_POOL_ENABLED
+    EXPECT_TRUE(pool.set_threads(3));
+    EXPECT_EQ(pool.get_threads(), 3);
+    const uint16_t cpus[] { 0 };
+    EXPECT_TRUE(pool.set_threads(2, cpus, ARRAY_SIZE(cpus)));
+    EXPECT_EQ(pool.get_threads(), 2);
+    EXPECT_TRUE(pool.set_threads(0));
+    EXPECT_GE(pool.get_threads(), 1);
+#else
+    EXPECT_FALSE(pool.set_threads(3));
+    EXPECT_EQ(pool.get_threads(), 1);
+#endif
+}
+
+// every index is passed exactly once, in ranges of at most grain
+TEST(ThreadPoolTest, ParallelForCoversRange)
+{
+    static std::atomic<uint32_t> hits[10010];
+    for (uint16_t threads : thread_counts) {
+        MathThreadPool pool(threads);
+        for (uint32_t grain : { 1U, 7U, 1000U, 20000U }) {
+            for (auto &h : hits) {
+                h = 0;
+            }
+            std::atomic<bool> too_long { false };
+            pool.parallel_for(5, 10005, grain, [&](uint32_t start, uint32_t end) {
+                if (end - start > grain || end <= start) {
+                    too_long = true;
+                }
+                for (uint32_t i = start; i < end; i++) {
+                    hits[i]++;
+                }
+            });
+            EXPECT_FALSE(too_long);
+            for (uint32_t i = 0; i < ARRAY_SIZE(hits); i++) {
+                EXPECT_EQ(hits[i], (i >= 5 && i < 10005) ? 1U : 0U) << "index " << i;
+            }
+        }
+        // empty ranges call nothing
+        pool.parallel_for(10, 10, 1, [&](uint32_t, uint32_t) { hits[0]++; });
+        pool.parallel_for(10, 5, 1, [&](uint32_t, uint32_t) { hits[0]++; });
+        EXPECT_EQ(hits[0], 0U);
+    }
+}
+
+static float sum_range(uint32_t start, uint32_t end)
+{
+    float sum = 0;
+    for (uint32_t i = start; i < end; i++) {
+        sum += 1.0f / (i + 1);
+    }
+    return sum;
+}
+
+// float sums come out the same whatever the number of threads
+TEST(ThreadPoolTest, ReduceIsDeterministic)
+{
+    float first = 0;
+    for (uint16_t threads : thread_counts) {
+        MathThreadPool pool(threads);
+        const float sum = pool.parallel_reduce(0, 1000000, 1000, 0.0f, sum_range,
+                                               [](float a, float b) { return a + b; });
+        if (threads == thread_counts[0]) {
+            first = sum;
+            EXPECT_NEAR(sum, 14.39f, 0.01f);
+        }
+        EXPECT_EQ(sum, first);
+    }
+
+    MathThreadPool pool(4);
+    EXPECT_EQ(pool.parallel_reduce(3, 3, 1, 42.0f, sum_range, [](float a, float b) { return a + b; }), 42.0f);
+    const uint32_t max = pool.parallel_reduce(0, 5000, 1, 0U,
+                                              [](uint32_t, uint32_t end) { return end - 1; },
+                                              [](uint32_t a, uint32_t b) { return MAX(a, b); });
+    EXPECT_EQ(max, 4999U);
+}
+
+// a parallel call from inside a chunk runs serially in that thread
+TEST(ThreadPoolTest, Nested)
+{
+    MathThreadPool pool(4);
+    std::atomic<uint32_t> count { 0 };
+    pool.parallel_for(0, 64, 1, [&](uint32_t, uint32_t) {
+        pool.parallel_for(0, 100, 10, [&](uint32_t start, uint32_t end) {
+            count += end - start;
+        });
+    });
+    EXPECT_EQ(count, 6400U);
+}
+
+// callers that find the pool busy run serially rather than wait
+TEST(ThreadPoolTest, ConcurrentCallers)
+{
+    MathThreadPool pool(4);
+    const float expected = sum_range(0, 200000);
+    std::atomic<uint32_t> wrong { 0 };
+    std::thread callers[4];
+    for (auto &t : callers) {
+        t = std::thread([&]() {
+            for (uint8_t i = 0; i < 50; i++) {
+                const float sum = pool.parallel_reduce(0, 200000, 200000 / MathThreadPool::MAX_REDUCE_CHUNKS, 0.0f,
+                                                       sum_range, [](float a, float b) { return a + b; });
+                if (fabsf(sum - expected) > 1e-3f) {
+                    wrong++;
+                }
+            }
+        });
+    }
+    for (auto &t : callers) {
+        t.join();
+    }
+    EXPECT_EQ(wrong, 0U);
+}
+
+// changing the threads while other threads make calls
+TEST(ThreadPoolTest, SetThreadsWhileRunning)
+{
+    MathThreadPool pool(2);
+    std::atomic<bool> done { false };
+    std::atomic<uint32_t> wrong { 0 };
+    std::thread callers[2];
+    for (auto &t : callers) {
+        t = std::thread([&]() {
+            while (!done) {
+                std::atomic<uint32_t> count { 0 };
+                pool.parallel_for(0, 1000, 10, [&](uint32_t start, uint32_t end) {
+                    count += end - start;
+                });
+                if (count != 1000 || pool.get_threads() < 1) {
+                    wrong++;
+                }
+            }
+        });
+    }
+    for (uint16_t i = 0; i < 50; i++) {
+        const uint16_t threads = 1 + i % 4;
+        EXPECT_EQ(pool.set_threads(threads), AP_MATH_THREAD_POOL_ENABLED || threads == 1);
+    }
+    done = true;
+    for (auto &t : callers) {
+        t.join();
+    }
+    EXPECT_EQ(wrong, 0U);
+}
+
+// the batch functions give the same results with any number of threads
+TEST(ThreadPoolTest, BatchFunctions)
+{
+    const uint32_t num_points = 300;
+    const uint32_t num_segments = 500;
+    const uint32_t num_matrices = 5000;
+    float px[num_points], py[num_points], pz[num_points];
+    float sx[num_segments], sy[num_segments], sz[num_segments];
+    float ex[num_segments], ey[num_segments], ez[num_segments];
+    for (uint32_t i = 0; i < num_points; i++) {
+        px[i] = rand_float() * 100;
+        py[i] = rand_float() * 100;
+        pz[i] = rand_float() * 100;
+    }
+    for (uint32_t i = 0; i < num_segments; i++) {
+        sx[i] = rand_float() * 100;
+        sy[i] = rand_float() * 100;
+        sz[i] = rand_float() * 100;
+        ex[i] = sx[i] + rand_float() * 10;
+        ey[i] = sy[i] + rand_float() * 10;
+        ez[i] = sz[i] + rand_float() * 10;
+    }
+    const Vector3SoA<float> points(px, py, pz);
+    const Segment3SoA<float> seg { Vector3SoA<float>(sx, sy, sz), Vector3SoA<float>(ex, ey, ez) };
+
+    static float m[9 * num_matrices];
+    for (float &e : m) {
+        e = rand_float();
+    }
+    const MatrixSoA<float,3> mats(m, num_matrices);
+
+    static float dist[2][num_points * num_segments];
+    static float min_dist[2][num_points];
+    static uint32_t index[2][num_points];
+    static float u[2][9 * num_matrices], s[2][3 * num_matrices], v[2][9 * num_matrices];
+
+    MathThreadPool &pool = MathThreadPool::get_shared();
+    const uint16_t threads[2] { 1, 4 };
+    for (uint8_t k = 0; k < 2; k++) {
+        pool.set_threads(threads[k]);
+        points_segments_distance(points, num_points, seg, num_segments, dist[k]);
+        points_segments_nearest(points, num_points, seg, num_segments, min_dist[k], index[k]);
+        mat_svd(mats, MatrixSoA<float,3>(u[k], num_matrices),
+                Vector3SoA<float>(&s[k][0], &s[k][num_matrices], &s[k][2 * num_matrices]),
+                MatrixSoA<float,3>(v[k], num_matrices), num_matrices);
+    }
+    pool.set_threads(0);
+
+    EXPECT_EQ(memcmp(dist[0], dist[1], sizeof(dist[0])), 0);
+    EXPECT_EQ(memcmp(min_dist[0], min_dist[1], sizeof(min_dist[0])), 0);
+    EXPECT_EQ(memcmp(index[0], index[1], sizeof(index[0])), 0);
+    EXPECT_EQ(memcmp(u[0], u[1], sizeof(u[0])), 0);
+    EXPECT_EQ(memcmp(s[0], s[1], sizeof(s[0])), 0);
+    EXPECT_EQ(memcmp(v[0], v[1], sizeof(v[0])), 0);
+
+    // and match the scalar function
+    for (uint32_t p = 0; p < num_points; p += 37) {
+        const Vector3f point(px[p], py[p], pz[p]);
+        float best = FLT_MAX;
+        for (uint32_t i = 0; i < num_segments; i++) {
+            best = MIN(best, Vector3f::closest_distance_between_line_and_point(Vector3f(sx[i], sy[i], sz[i]), Vector3f(ex[i], ey[i], ez[i]), point));
+        }
+        EXPECT_NEAR(min_dist[1][p], best, 1e-3);
+    }
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,253 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/time_series.h>
+
+#include <stdio.h>
+#include <unistd.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const char *path = "test_time_series.bin";
+
+#define NUM_SAMPLES 2500
+#define BLOCK_SAMPLES 256
+
+static Vector3f pos[NUM_SAMPLES];
+static Vector3d pos_d[NUM_SAMPLES];
+static QuaternionF att[NUM_SAMPLES];
+static float speed[NUM_SAMPLES];
+static int32_t mode[NUM_SAMPLES];
+static uint64_t time_us[NUM_SAMPLES];
+
+// a smooth trajectory at 400Hz, with a gap and repeated times
+static void write_series(uint32_t block_samples = BLOCK_SAMPLES)
+{
+    uint64_t t = 5000000;
+    for (uint32_t i = 0; i < NUM_SAMPLES; i++) {
+        const float s = i * 0.0025f;
+        pos[i] = Vector3f(10 * cosf(s), 10 * sinf(s), -5 - s);
+        pos_d[i] = Vector3d(-35.363261 + s * 1e-6, 149.165230 - s * 1e-6, 584.0 + s);
+        att[i].from_euler(0.1f * sinf(s), 0.05f, wrap_PI(s + 1.0f));
+        speed[i] = 10;
+        mode[i] = i < 1000 ? 3 : -2;
+        time_us[i] = t;
+        if (i == 1500) {
+            t += 1000000;
+        } else if (i < 300 || i > 320) {
+            t += 2500;
+        }
+    }
+
+    TimeSeriesWriter writer(block_samples);
+    const int16_t c_pos = writer.add_column("pos", SampleLogType::FLOAT, 3);
+    const int16_t c_pos_d = writer.add_column("pos_d", SampleLogType::DOUBLE, 3);
+    const int16_t c_att = writer.add_column("att", SampleLogType::FLOAT, 4);
+    const int16_t c_speed = writer.add_column("speed", SampleLogType::FLOAT, 1);
+    const int16_t c_mode = writer.add_column("mode", SampleLogType::INT32, 1);
+    EXPECT_EQ(writer.add_column("mode", SampleLogType::INT32, 1), -1);
+    EXPECT_EQ(writer.add_column("bad", SampleLogType::FLOAT, 5), -1);
+    ASSERT_TRUE(writer.open(path));
+    EXPECT_EQ(writer.add_column("late", SampleLogType::FLOAT, 1), -1);
+    for (uint32_t i = 0; i < NUM_SAMPLES; i++) {
+        ASSERT_TRUE(writer.append(time_us[i]));
+        EXPECT_TRUE(writer.set(c_pos, pos[i]));
+        EXPECT_TRUE(writer.set(c_pos_d, pos_d[i]));
+        EXPECT_TRUE(writer.set(c_att, att[i]));
+        EXPECT_TRUE(writer.set(c_speed, speed[i]));
+        EXPECT_TRUE(writer.set(c_mode, mode[i]));
+        // wrong type or number of components
+        EXPECT_FALSE(writer.set(c_speed, 1.0));
+        EXPECT_FALSE(writer.set(c_att, pos[i]));
+    }
+    // time can't go backwards
+    EXPECT_FALSE(writer.append(time_us[NUM_SAMPLES-1] - 1));
+    EXPECT_TRUE(writer.close());
+}
+
+static long file_size()
+{
+    FILE *f = fopen(path, "rb");
+    fseek(f, 0, SEEK_END);
+    const long size = ftell(f);
+    fclose(f);
+    return size;
+}
+
+TEST(TimeSeriesTest, RoundTrip)
+{
+    write_series();
+    TimeSeriesReader reader;
+    ASSERT_TRUE(reader.open(path));
+    EXPECT_EQ(reader.get_num_samples(), NUM_SAMPLES);
+    EXPECT_EQ(reader.get_num_blocks(), (NUM_SAMPLES + BLOCK_SAMPLES - 1) / BLOCK_SAMPLES);
+    EXPECT_EQ(reader.get_num_columns(), 5);
+    EXPECT_EQ(reader.find_column("att"), 2);
+    EXPECT_EQ(reader.find_column("vel"), -1);
+
+    uint32_t n = 0;
+    while (reader.read_block()) {
+        Vector3SoA<float> p;
+        Vector3SoA<double> pd;
+        QuaternionSoA<float> q;
+        float *s;
+        int32_t *m;
+        ASSERT_TRUE(reader.get_view("pos", p));
+        ASSERT_TRUE(reader.get_view("pos_d", pd));
+        ASSERT_TRUE(reader.get_view("att", q));
+        ASSERT_TRUE(reader.get_view("speed", s));
+        ASSERT_TRUE(reader.get_view("mode", m));
+        EXPECT_FALSE(reader.get_view("pos", q));
+        EXPECT_FALSE(reader.get_view("pos_d", p));
+        const uint64_t *t = reader.get_block_time_us();
+        for (uint32_t i = 0; i < reader.get_block_samples(); i++, n++) {
+            ASSERT_LT(n, NUM_SAMPLES);
+            EXPECT_EQ(t[i], time_us[n]);
+            // bit exact
+            const Vector3f v = p.get(i);
+            const QuaternionF a = q.get(i);
+            EXPECT_EQ(memcmp(&pos[n], &v, sizeof(v)), 0) << "sample " << n;
+            EXPECT_EQ(pd.get(i), pos_d[n]);
+            EXPECT_EQ(memcmp(&att[n], &a, sizeof(a)), 0) << "sample " << n;
+            EXPECT_EQ(s[i], speed[n]);
+            EXPECT_EQ(m[i], mode[n]);
+        }
+    }
+    EXPECT_EQ(n, NUM_SAMPLES);
+
+    // smaller than the values alone
+    const long raw = NUM_SAMPLES * (sizeof(uint64_t) + 8 * sizeof(float) + 3 * sizeof(double) + sizeof(int32_t));
+    EXPECT_LT(file_size(), raw * 3 / 5);
+    remove(path);
+}
+
+TEST(TimeSeriesTest, Seek)
+{
+    write_series();
+    TimeSeriesReader reader;
+    ASSERT_TRUE(reader.open(path));
+
+    const uint32_t samples[] { 0, 1, 255, 256, 300, 310, 321, 1000, 1500, 1501, NUM_SAMPLES-1 };
+    for (uint32_t n : samples) {
+        ASSERT_TRUE(reader.seek(time_us[n]));
+        const uint64_t *t = reader.get_block_time_us();
+        const uint32_t i = reader.get_seek_index();
+        // the first sample with the time
+        uint32_t first = n;
+        while (first > 0 && time_us[first-1] == time_us[n]) {
+            first--;
+        }
+        EXPECT_EQ(t[i], time_us[n]);
+        Vector3SoA<float> p;
+        ASSERT_TRUE(reader.get_view("pos", p));
+        EXPECT_EQ(p.get(i), pos[first]) << "sample " << n;
+
+        // between samples
+        if (n + 1 < NUM_SAMPLES && time_us[n+1] > time_us[n] + 1) {
+            ASSERT_TRUE(reader.seek(time_us[n] + 1));
+            EXPECT_EQ(reader.get_block_time_us()[reader.get_seek_index()], time_us[n+1]);
+        }
+    }
+
+    // before the start and after the end
+    ASSERT_TRUE(reader.seek(0));
+    EXPECT_EQ(reader.get_seek_index(), 0U);
+    EXPECT_EQ(reader.get_block_time_us()[0], time_us[0]);
+    EXPECT_FALSE(reader.seek(time_us[NUM_SAMPLES-1] + 1));
+
+    // reading carries on after the block found
+    ASSERT_TRUE(reader.seek(time_us[1000]));
+    ASSERT_TRUE(reader.read_block());
+    EXPECT_EQ(reader.get_block_time_us()[0], time_us[1024]);
+    remove(path);
+}
+
+static void corrupt(long offset)
+{
+    FILE *f = fopen(path, "r+b");
+    ASSERT_NE(f, nullptr);
+    fseek(f, offset, SEEK_SET);
+    const int c = fgetc(f);
+    fseek(f, offset, SEEK_SET);
+    fputc(c ^ 0x10, f);
+    fclose(f);
+}
+
+TEST(TimeSeriesTest, DamagedBlock)
+{
+    write_series();
+    // damage the data of the second block
+    const long first_block = sizeof(TimeSeriesHeader) + 5 * sizeof(TimeSeriesColumn);
+    FILE *f = fopen(path, "rb");
+    fseek(f, first_block, SEEK_SET);
+    TimeSeriesBlock block;
+    ASSERT_EQ(fread(&block, sizeof(block), 1, f), 1U);
+    fclose(f);
+    corrupt(first_block + sizeof(block) + block.data_size + sizeof(block) + 100);
+
+    TimeSeriesReader reader;
+    ASSERT_TRUE(reader.open(path));
+    EXPECT_TRUE(reader.read_block());
+    EXPECT_FALSE(reader.read_block());
+    EXPECT_EQ(reader.get_block_samples(), 0U);
+    // the rest can still be read
+    uint32_t n = 2 * BLOCK_SAMPLES;
+    while (reader.read_block()) {
+        EXPECT_EQ(reader.get_block_time_us()[0], time_us[n]);
+        n += reader.get_block_samples();
+    }
+    EXPECT_EQ(n, NUM_SAMPLES);
+    EXPECT_FALSE(reader.seek(time_us[BLOCK_SAMPLES + 10]));
+    EXPECT_TRUE(reader.seek(time_us[3 * BLOCK_SAMPLES]));
+    remove(path);
+}
+
+TEST(TimeSeriesTest, Invalid)
+{
+    TimeSeriesReader reader;
+    EXPECT_FALSE(reader.open("no_such_file.bin"));
+
+    // header
+    write_series();
+    corrupt(0);
+    EXPECT_FALSE(reader.open(path));
+
+    // directory
+    write_series();
+    corrupt(sizeof(TimeSeriesHeader) + 3);
+    EXPECT_FALSE(reader.open(path));
+
+    // index
+    write_series();
+    corrupt(file_size() - sizeof(TimeSeriesFooter) - 20);
+    EXPECT_FALSE(reader.open(path));
+
+    // no index, as if the writer wasn't closed
+    write_series();
+    ASSERT_EQ(truncate(path, file_size() - 8), 0);
+    EXPECT_FALSE(reader.open(path));
+    remove(path);
+}
+
+// one sample per block, and a file with no samples
+TEST(TimeSeriesTest, Sizes)
+{
+    write_series(1);
+    TimeSeriesReader reader;
+    ASSERT_TRUE(reader.open(path));
+    EXPECT_EQ(reader.get_num_blocks(), NUM_SAMPLES);
+    ASSERT_TRUE(reader.seek(time_us[2000]));
+    EXPECT_EQ(reader.get_block_time_us()[0], time_us[2000]);
+
+    TimeSeriesWriter writer;
+    EXPECT_EQ(writer.add_column("x", SampleLogType::UINT64, 1), 0);
+    ASSERT_TRUE(writer.open(path));
+    EXPECT_TRUE(writer.close());
+    ASSERT_TRUE(reader.open(path));
+    EXPECT_EQ(reader.get_num_samples(), 0U);
+    EXPECT_FALSE(reader.read_block());
+    EXPECT_FALSE(reader.seek(0));
+    remove(path);
+}
+
+AP_GTEST_MAIN()
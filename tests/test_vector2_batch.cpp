@@ -0,0 +1,127 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/vector2_batch.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define NUM_SEGMENTS 1000
+
+static Vector2f rand_vec2f(float scale)
+{
+    return Vector2f(rand_float(), rand_float()) * scale;
+}
+
+class Vector2BatchTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        for (uint16_t i = 0; i < NUM_SEGMENTS; i++) {
+            start_v[i] = rand_vec2f(100);
+            end_v[i] = start_v[i] + rand_vec2f(100);
+        }
+        // zero length, axis aligned and parallel to the test segment
+        end_v[0] = start_v[0];
+        end_v[1] = start_v[1] + Vector2f(10, 0);
+        end_v[2] = start_v[2] + Vector2f(0, -10);
+        start_v[3] = Vector2f(0, 1);
+        end_v[3] = Vector2f(2, 3);
+        seg.start.pack(start_v, NUM_SEGMENTS);
+        seg.end.pack(end_v, NUM_SEGMENTS);
+    }
+
+    float sx[NUM_SEGMENTS], sy[NUM_SEGMENTS];
+    float ex[NUM_SEGMENTS], ey[NUM_SEGMENTS];
+    Segment2SoA<float> seg{{sx, sy}, {ex, ey}};
+    Vector2f start_v[NUM_SEGMENTS];
+    Vector2f end_v[NUM_SEGMENTS];
+    float ox[NUM_SEGMENTS], oy[NUM_SEGMENTS];
+    Vector2SoA<float> out{ox, oy};
+    bool hit[NUM_SEGMENTS];
+};
+
+TEST_F(Vector2BatchTest, SegmentIntersection)
+{
+    uint32_t hits = 0;
+    for (uint8_t n = 0; n < 50; n++) {
+        const Vector2f s1 = n == 0 ? Vector2f(0, 0) : rand_vec2f(100);
+        const Vector2f e1 = n == 0 ? Vector2f(2, 2) : s1 + rand_vec2f(100);
+        segment_intersection(s1, e1, seg, out, hit, NUM_SEGMENTS);
+        for (uint16_t i = 0; i < NUM_SEGMENTS; i++) {
+            Vector2f expected;
+            EXPECT_EQ(Vector2f::segment_intersection(s1, e1, start_v[i], end_v[i], expected), hit[i]);
+            if (hit[i]) {
+                EXPECT_LT((expected - out.get(i)).length(), 1.0e-4f);
+                hits++;
+            }
+        }
+    }
+    EXPECT_GT(hits, 100U);
+}
+
+TEST_F(Vector2BatchTest, CircleSegmentIntersection)
+{
+    uint32_t hits = 0;
+    for (uint8_t n = 0; n < 50; n++) {
+        const Vector2f center = rand_vec2f(100);
+        const float radius = n == 0 ? 0 : fabsf(rand_float()) * 30;
+        circle_segment_intersection(seg, center, radius, out, hit, NUM_SEGMENTS);
+        for (uint16_t i = 0; i < NUM_SEGMENTS; i++) {
+            Vector2f expected;
+            EXPECT_EQ(Vector2f::circle_segment_intersection(start_v[i], end_v[i], center, radius, expected), hit[i]);
+            if (hit[i]) {
+                EXPECT_LT((expected - out.get(i)).length(), 1.0e-3f);
+                hits++;
+            }
+        }
+    }
+    EXPECT_GT(hits, 100U);
+}
+
+TEST_F(Vector2BatchTest, SegmentCircles)
+{
+    // one segment against many circles, reusing the segment starts as centres
+    float radius[NUM_SEGMENTS];
+    for (uint16_t i = 0; i < NUM_SEGMENTS; i++) {
+        radius[i] = fabsf(rand_float()) * 30;
+    }
+    for (uint8_t n = 0; n < 50; n++) {
+        const Vector2f s = rand_vec2f(100);
+        const Vector2f e = s + rand_vec2f(100);
+        circle_segment_intersection(s, e, seg.start, radius, out, hit, NUM_SEGMENTS);
+        for (uint16_t i = 0; i < NUM_SEGMENTS; i++) {
+            Vector2f expected;
+            EXPECT_EQ(Vector2f::circle_segment_intersection(s, e, start_v[i], radius[i], expected), hit[i]);
+            if (hit[i]) {
+                EXPECT_LT((expected - out.get(i)).length(), 1.0e-3f);
+            }
+        }
+    }
+}
+
+TEST_F(Vector2BatchTest, ClosestPoint)
+{
+    for (uint8_t n = 0; n < 50; n++) {
+        const Vector2f p = rand_vec2f(150);
+        closest_point(p, seg, out, NUM_SEGMENTS);
+        for (uint16_t i = 0; i < NUM_SEGMENTS; i++) {
+            const Vector2f expected = Vector2f::closest_point(p, start_v[i], end_v[i]);
+            EXPECT_LT((expected - out.get(i)).length(), 1.0e-4f);
+        }
+    }
+}
+
+TEST_F(Vector2BatchTest, RadialDistance)
+{
+    float px[NUM_SEGMENTS], py[NUM_SEGMENTS];
+    float dist[NUM_SEGMENTS];
+    for (uint16_t i = 0; i < NUM_SEGMENTS; i++) {
+        px[i] = rand_float() * 150;
+        py[i] = rand_float() * 150;
+    }
+    closest_distance_between_radial_and_point(seg.end, Vector2SoA<float>(px, py), dist, NUM_SEGMENTS);
+    for (uint16_t i = 0; i < NUM_SEGMENTS; i++) {
+        const float expected = Vector2f::closest_distance_between_radial_and_point(end_v[i], Vector2f(px[i], py[i]));
+        EXPECT_NEAR(expected, dist[i], 1.0e-4f);
+    }
+}
+
+AP_GTEST_MAIN()
@@ -172,6 +172,40 @@ TEST(Vector3Test, normalized)
     EXPECT_EQ(Vector3f(-3, 3, 3).normalized(), Vector3f(-5, 5, 5).normalized());
     EXPECT_NE(Vector3f(-3, 3, 3).normalized(), Vector3f(5, 5, 5).normalized());
 }
+
+TEST(Vector3Test, FusedHelpers)
+{
+    // operators are usable in constant expressions
+    constexpr Vector3f a{1, 2, 3};
+    constexpr Vector3f b{-4, 5, 0.5f};
+    static_assert((a + b * 2 - a % b).x == 7, "constexpr operators");
+
+    EXPECT_TRUE(Vector3f::fma(a, 2, b) == a * 2 + b);
+    EXPECT_TRUE(Vector3f::lerp(a, b, 0) == a);
+    EXPECT_TRUE(Vector3f::lerp(a, b, 1) == b);
+    EXPECT_TRUE(Vector3f::lerp(a, b, 0.25f) == a + (b - a) * 0.25f);
+
+    Vector3f v{0.5f, -1, 2};
+    Vector3f expected = v + b * 3;
+    v.axpy(3, b);
+    EXPECT_TRUE(v == expected);
+
+    expected = v + a % b;
+    v.cross_add(a, b);
+    EXPECT_TRUE(v == expected);
+
+    // aliased operand
+    expected = v + v % b;
+    v.cross_add(v, b);
+    EXPECT_TRUE(v == expected);
+
+    Vector3l l{1, 2, 3};
+    l.axpy(2, Vector3l{1, 1, 1});
+    EXPECT_EQ(3, l.x);
+    EXPECT_EQ(4, l.y);
+    EXPECT_EQ(5, l.z);
+}
+
 /*
 TEST(Vector3Test, Project)
 {
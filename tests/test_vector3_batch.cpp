@@ -0,0 +1,151 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/vector3_batch.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define NUM_SEGMENTS 300
+
+static Vector3f rand_vec3f(float scale)
+{
+    return Vector3f(rand_float(), rand_float(), rand_float()) * scale;
+}
+
+class Vector3BatchTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        for (uint16_t i = 0; i < NUM_SEGMENTS; i++) {
+            start_v[i] = rand_vec3f(100);
+            end_v[i] = start_v[i] + rand_vec3f(50);
+        }
+        // degenerate and axis aligned cases
+        end_v[0] = start_v[0];
+        end_v[1] = start_v[1] + Vector3f(10, 0, 0);
+        end_v[2] = start_v[2] + Vector3f(0, 0, -10);
+        seg.start.pack(start_v, NUM_SEGMENTS);
+        seg.end.pack(end_v, NUM_SEGMENTS);
+    }
+
+    float sx[NUM_SEGMENTS], sy[NUM_SEGMENTS], sz[NUM_SEGMENTS];
+    float ex[NUM_SEGMENTS], ey[NUM_SEGMENTS], ez[NUM_SEGMENTS];
+    Segment3SoA<float> seg{{sx, sy, sz}, {ex, ey, ez}};
+    Vector3f start_v[NUM_SEGMENTS];
+    Vector3f end_v[NUM_SEGMENTS];
+    float dist[NUM_SEGMENTS];
+};
+
+TEST_F(Vector3BatchTest, DistanceToSegment)
+{
+    for (uint8_t n = 0; n < 20; n++) {
+        const Vector3f p = rand_vec3f(100);
+        distance_to_segment(p, seg, dist, NUM_SEGMENTS);
+        for (uint16_t i = 0; i < NUM_SEGMENTS; i++) {
+            // distance_to_segment() uses the triangle area which loses
+            // precision for thin triangles, so compare with the exact distance
+            const Vector3d line = (end_v[i] - start_v[i]).todouble();
+            const double expected = i == 0 ? 0 : ((p - start_v[i]).todouble() % line).length() / line.length();
+            EXPECT_NEAR(expected, dist[i], 1.0e-4 * MAX(1.0, expected));
+            EXPECT_NEAR(p.distance_to_segment(start_v[i], end_v[i]), dist[i], 0.05f);
+        }
+    }
+}
+
+TEST_F(Vector3BatchTest, ClosestDistanceToPoint)
+{
+    float cx[NUM_SEGMENTS], cy[NUM_SEGMENTS], cz[NUM_SEGMENTS];
+    const Vector3SoA<float> closest{cx, cy, cz};
+    for (uint8_t n = 0; n < 20; n++) {
+        const Vector3f p = rand_vec3f(100);
+        closest_distance_between_line_and_point(seg, p, dist, NUM_SEGMENTS, closest);
+        for (uint16_t i = 0; i < NUM_SEGMENTS; i++) {
+            EXPECT_NEAR(Vector3f::closest_distance_between_line_and_point(start_v[i], end_v[i], p), dist[i], 1.0e-3f);
+            const Vector3f expected = Vector3f::point_on_line_closest_to_other_point(start_v[i], end_v[i], p);
+            EXPECT_LT((expected - closest.get(i)).length(), 1.0e-3f);
+        }
+    }
+    // segment end points
+    closest_distance_between_line_and_point(seg, start_v[5], dist, NUM_SEGMENTS);
+    EXPECT_FLOAT_EQ(0, dist[5]);
+    closest_distance_between_line_and_point(seg, end_v[7], dist, NUM_SEGMENTS);
+    EXPECT_NEAR(0, dist[7], 1.0e-5f);
+}
+
+TEST_F(Vector3BatchTest, SegmentToSegment)
+{
+    float cx[NUM_SEGMENTS], cy[NUM_SEGMENTS], cz[NUM_SEGMENTS];
+    const Vector3SoA<float> closest{cx, cy, cz};
+    for (uint8_t n = 0; n < 20; n++) {
+        const Vector3f s1 = rand_vec3f(100);
+        // include a segment parallel to one of the test segments
+        const Vector3f e1 = n == 0 ? s1 + Vector3f(5, 0, 0) : s1 + rand_vec3f(50);
+        segment_to_segment_closest_point(s1, e1, seg, closest, NUM_SEGMENTS, dist);
+        for (uint16_t i = 0; i < NUM_SEGMENTS; i++) {
+            Vector3f expected;
+            Vector3f::segment_to_segment_closest_point(s1, e1, start_v[i], end_v[i], expected);
+            EXPECT_LT((expected - closest.get(i)).length(), 1.0e-3f);
+            // no point on the first segment is closer than the distance found
+            for (float t = 0; t <= 1; t += 0.05f) {
+                EXPECT_GE((s1 + (e1 - s1) * t - closest.get(i)).length(), dist[i] - 1.0e-3f);
+            }
+        }
+    }
+}
+
+TEST_F(Vector3BatchTest, SegmentPlane)
+{
+    bool hit[NUM_SEGMENTS];
+    for (uint8_t n = 0; n < 20; n++) {
+        const Vector3f normal = n == 0 ? Vector3f(0, 0, 1) : rand_vec3f(1).normalized();
+        const Vector3f point = rand_vec3f(100);
+        segment_plane_intersect(seg, normal, point, hit, NUM_SEGMENTS);
+        for (uint16_t i = 0; i < NUM_SEGMENTS; i++) {
+            EXPECT_EQ(Vector3f::segment_plane_intersect(start_v[i], end_v[i], normal, point), hit[i]);
+        }
+    }
+}
+
+TEST_F(Vector3BatchTest, PointsSegments)
+{
+    const uint16_t num_points = 7;
+    Vector3f points_v[num_points];
+    float px[num_points], py[num_points], pz[num_points];
+    Vector3SoA<float> points{px, py, pz};
+    for (uint16_t p = 0; p < num_points; p++) {
+        points_v[p] = rand_vec3f(100);
+    }
+    points.pack(points_v, num_points);
+
+    float all_dist[num_points * NUM_SEGMENTS];
+    points_segments_distance(points, num_points, seg, NUM_SEGMENTS, all_dist);
+
+    float min_dist[num_points];
+    uint32_t index[num_points];
+    points_segments_nearest(points, num_points, seg, NUM_SEGMENTS, min_dist, index);
+
+    for (uint16_t p = 0; p < num_points; p++) {
+        float best = FLT_MAX;
+        uint32_t best_index = 0;
+        for (uint16_t i = 0; i < NUM_SEGMENTS; i++) {
+            const float d = Vector3f::closest_distance_between_line_and_point(start_v[i], end_v[i], points_v[p]);
+            EXPECT_NEAR(d, all_dist[p * NUM_SEGMENTS + i], 1.0e-3f);
+            if (d < best) {
+                best = d;
+                best_index = i;
+            }
+        }
+        EXPECT_NEAR(best, min_dist[p], 1.0e-3f);
+        EXPECT_EQ(best_index, index[p]);
+    }
+
+    // splitting the points gives the same answer
+    float min_dist2[num_points];
+    uint32_t index2[num_points];
+    points_segments_nearest(points, 3, seg, NUM_SEGMENTS, min_dist2, index2);
+    points_segments_nearest(points.offset(3), num_points - 3, seg, NUM_SEGMENTS, &min_dist2[3], &index2[3]);
+    for (uint16_t p = 0; p < num_points; p++) {
+        EXPECT_EQ(min_dist[p], min_dist2[p]);
+        EXPECT_EQ(index[p], index2[p]);
+    }
+}
+
+AP_GTEST_MAIN()
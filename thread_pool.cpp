@@ -0,0 +1,329 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "thread_pool.h"
+#include "Embed_Math.h"
+
+#if AP_MATH_THREAD_POOL_ENABLED
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// the chunks a thread hasn't started, as begin << 32 | end
+struct alignas(64) ChunkRange {
+    std::atomic<uint64_t> range;
+};
+
+uint64_t pack_range(uint32_t begin, uint32_t end)
+{
+    return (uint64_t(begin) << 32) | end;
+}
+
+// set while a thread runs chunks, so calls from inside a chunk run serially
+thread_local bool in_pool;
+
+uint16_t default_threads()
+{
+    return MIN(MAX(std::thread::hardware_concurrency(), 1U), uint32_t(MathThreadPool::MAX_THREADS));
+}
+
+}
+
+struct MathThreadPool::State {
+    // held while a call runs on the workers, and while they are changed
+    std::mutex job_mutex;
+
+    // start default_threads() at the next call, unless set_threads() comes first
+    std::atomic<bool> start_pending { false };
+
+    // protects generation, stop and busy
+    std::mutex mutex;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+    uint32_t generation = 0;
+    bool stop = false;
+    // workers that haven't finished the current call
+    uint16_t busy = 0;
+
+    std::thread *workers = nullptr;
+    // only changed with job_mutex held. Atomic so get_threads() can read it
+    std::atomic<uint16_t> num_workers { 0 };
+
+    // the current call. Thread 0 is the caller, worker i is thread i+1
+    chunk_fn_t fn = nullptr;
+    void *ctx = nullptr;
+    ChunkRange ranges[MAX_THREADS];
+
+    bool start_workers(uint16_t num_threads, const uint16_t *cpus, uint16_t num_cpus);
+    void stop_workers();
+    void worker_main(uint16_t id, uint32_t seen);
+    bool take(uint16_t id, uint32_t &chunk);
+    void work(uint16_t id);
+};
+
+bool MathThreadPool::State::start_workers(uint16_t num_threads, const uint16_t *cpus, uint16_t num_cpus)
+{
+    if (num_threads == 0) {
+        num_threads = default_threads();
+    }
+    const uint16_t n = MIN(num_threads, MAX_THREADS) - 1;
+    if (n == 0) {
+        return true;
+    }
+    workers = NEW_NOTHROW std::thread[n];
+    if (workers == nullptr) {
+        return false;
+    }
+    for (uint16_t i = 0; i < n; i++) {
+        workers[i] = std::thread(&State::worker_main, this, i + 1, generation);
+#if defined(__linux__)
+        if (cpus != nullptr && num_cpus > 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpus[i % num_cpus], &set);
+            pthread_setaffinity_np(workers[i].native_handle(), sizeof(set), &set);
+        }
+#else
+        (void)cpus;
+        (void)num_cpus;
+#endif
+    }
+    num_workers = n;
+    return true;
+}
+
+void MathThreadPool::State::stop_workers()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    start_cv.notify_all();
+    for (uint16_t i = 0; i < num_workers; i++) {
+        workers[i].join();
+    }
+    delete[] workers;
+    workers = nullptr;
+    num_workers = 0;
+    stop = false;
+}
+
+void MathThreadPool::State::worker_main(uint16_t id, uint32_t seen)
+{
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start_cv.wait(lock, [&]() { return stop || generation != seen; });
+            if (stop) {
+                return;
+            }
+            seen = generation;
+        }
+        work(id);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busy == 0) {
+                done_cv.notify_one();
+            }
+        }
+    }
+}
+
+/*
+  take the next chunk of this thread, or steal the back half of the
+  first thread found with chunks left. Chunks only move between threads
+  by stealing, so a thread that finds none can stop: any chunk in
+  transit belongs to the thief
+ */
+bool MathThreadPool::State::take(uint16_t id, uint32_t &chunk)
+{
+    std::atomic<uint64_t> &own = ranges[id].range;
+    uint64_t r = own.load(std::memory_order_acquire);
+    while (uint32_t(r >> 32) < uint32_t(r)) {
+        if (own.compare_exchange_weak(r, r + (uint64_t(1) << 32), std::memory_order_acq_rel, std::memory_order_acquire)) {
+            chunk = uint32_t(r >> 32);
+            return true;
+        }
+    }
+    const uint16_t n = num_workers + 1;
+    for (uint16_t k = 1; k < n; k++) {
+        std::atomic<uint64_t> &victim = ranges[(id + k) % n].range;
+        uint64_t v = victim.load(std::memory_order_acquire);
+        while (uint32_t(v >> 32) < uint32_t(v)) {
+            const uint32_t begin = uint32_t(v >> 32);
+            const uint32_t end = uint32_t(v);
+            const uint32_t mid = begin + (end - begin) / 2;
+            if (victim.compare_exchange_weak(v, pack_range(begin, mid), std::memory_order_acq_rel, std::memory_order_acquire)) {
+                // own range is empty, so no other thread writes it
+                own.store(pack_range(mid + 1, end), std::memory_order_release);
+                chunk = mid;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void MathThreadPool::State::work(uint16_t id)
+{
+    in_pool = true;
+    uint32_t chunk;
+    while (take(id, chunk)) {
+        fn(ctx, chunk);
+    }
+    in_pool = false;
+}
+
+MathThreadPool::MathThreadPool(uint16_t num_threads) :
+    _state(NEW_NOTHROW State())
+{
+    if (_state != nullptr) {
+        _state->start_workers(num_threads, nullptr, 0);
+    }
+}
+
+MathThreadPool::~MathThreadPool()
+{
+    if (_state != nullptr) {
+        _state->stop_workers();
+        delete _state;
+    }
+}
+
+bool MathThreadPool::set_threads(uint16_t num_threads, const uint16_t *cpus, uint16_t num_cpus)
+{
+    if (_state == nullptr) {
+        return num_threads == 1;
+    }
+    std::lock_guard<std::mutex> lock(_state->job_mutex);
+    _state->start_pending = false;
+    _state->stop_workers();
+    return _state->start_workers(num_threads, cpus, num_cpus);
+}
+
+uint16_t MathThreadPool::get_threads() const
+{
+    if (_state == nullptr) {
+        return 1;
+    }
+    if (_state->start_pending) {
+        return default_threads();
+    }
+    return _state->num_workers + 1;
+}
+
+void MathThreadPool::start_on_first_use()
+{
+    if (_state != nullptr) {
+        _state->start_pending = true;
+    }
+}
+
+void MathThreadPool::run(uint32_t num_chunks, chunk_fn_t fn, void *ctx)
+{
+    State *s = _state;
+    // the workers can only be read once job_mutex stops set_threads() changing them
+    if (num_chunks > 1 && s != nullptr && !in_pool && s->job_mutex.try_lock()) {
+        if (s->start_pending) {
+            s->start_pending = false;
+            s->start_workers(0, nullptr, 0);
+        }
+        if (s->num_workers == 0) {
+            s->job_mutex.unlock();
+            for (uint32_t chunk = 0; chunk < num_chunks; chunk++) {
+                fn(ctx, chunk);
+            }
+            return;
+        }
+        s->fn = fn;
+        s->ctx = ctx;
+        const uint16_t n = s->num_workers + 1;
+        for (uint16_t k = 0; k < n; k++) {
+            s->ranges[k].range.store(pack_range(uint64_t(num_chunks) * k / n, uint64_t(num_chunks) * (k + 1) / n),
+                                     std::memory_order_relaxed);
+        }
+        {
+            std::lock_guard<std::mutex> lock(s->mutex);
+            s->busy = s->num_workers;
+            s->generation++;
+        }
+        s->start_cv.notify_all();
+        s->work(0);
+        {
+            std::unique_lock<std::mutex> lock(s->mutex);
+            s->done_cv.wait(lock, [s]() { return s->busy == 0; });
+        }
+        s->job_mutex.unlock();
+        return;
+    }
+    for (uint32_t chunk = 0; chunk < num_chunks; chunk++) {
+        fn(ctx, chunk);
+    }
+}
+
+#else  // AP_MATH_THREAD_POOL_ENABLED
+
+MathThreadPool::MathThreadPool(uint16_t) :
+    _state(nullptr)
+{
+}
+
+MathThreadPool::~MathThreadPool()
+{
+}
+
+bool MathThreadPool::set_threads(uint16_t num_threads, const uint16_t *, uint16_t)
+{
+    return num_threads == 1;
+}
+
+uint16_t MathThreadPool::get_threads() const
+{
+    return 1;
+}
+
+void MathThreadPool::start_on_first_use()
+{
+}
+
+void MathThreadPool::run(uint32_t num_chunks, chunk_fn_t fn, void *ctx)
+{
+    for (uint32_t chunk = 0; chunk < num_chunks; chunk++) {
+        fn(ctx, chunk);
+    }
+}
+
+#endif  // AP_MATH_THREAD_POOL_ENABLED
+
+MathThreadPool &MathThreadPool::create_shared()
+{
+    static MathThreadPool pool(1);
+    // one thread per CPU, started by the first parallel call
+    pool.start_on_first_use();
+    return pool;
+}
+
+MathThreadPool &MathThreadPool::get_shared()
+{
+    static MathThreadPool &pool = create_shared();
+    return pool;
+}
@@ -0,0 +1,155 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  a small work stealing thread pool, shared by the batch functions so
+  they don't start threads of their own on every call.
+
+  parallel_for() splits an index range into chunks of grain indexes.
+  Each thread starts with an equal share of the chunks and takes them
+  from the front of its share; a thread that runs out steals the back
+  half of another's. The calling thread takes part, so a pool of N
+  threads starts N-1 workers.
+
+  Everything runs serially in the calling thread when the library is
+  built without AP_MATH_THREAD_POOL_ENABLED, when the pool has one
+  thread, when the range is a single chunk, when called from inside
+  another parallel call, and when another thread is already using the
+  pool. The last means concurrent callers never wait on each other, so
+  their latency is no worse than without the pool. Threads are needed,
+  so this is meant for Linux and SITL rather than flight firmware.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#ifndef AP_MATH_THREAD_POOL_ENABLED
+#define AP_MATH_THREAD_POOL_ENABLED 0
+#endif
+
+class MathThreadPool {
+public:
+    static constexpr uint16_t MAX_THREADS = 64;
+
+    // most chunks parallel_reduce() splits a range into
+    static constexpr uint16_t MAX_REDUCE_CHUNKS = 64;
+
+    explicit MathThreadPool(uint16_t num_threads = 1);
+    ~MathThreadPool();
+
+    MathThreadPool(const MathThreadPool &) = delete;
+    MathThreadPool &operator=(const MathThreadPool &) = delete;
+
+    /*
+      the pool used by the library. Its workers, one thread per CPU,
+      are started by the first parallel call, so calling set_threads()
+      before then starts only the threads asked for
+     */
+    static MathThreadPool &get_shared();
+
+    /*
+      use num_threads threads including the calling thread, 0 for one
+      per CPU. If cpus is given, worker i is pinned to CPU
+      cpus[i % num_cpus] (Linux only). Waits for a running call to
+      finish. Returns false if the workers couldn't be started, leaving
+      the pool serial
+     */
+    bool set_threads(uint16_t num_threads, const uint16_t *cpus = nullptr, uint16_t num_cpus = 0);
+
+    // number of threads including the caller, 1 when serial
+    uint16_t get_threads() const;
+
+    /*
+      call fn(start, end) for consecutive ranges of grain indexes, the
+      last maybe shorter, covering begin to end. Calls for different
+      ranges may run at the same time, in any order
+     */
+    template <typename F>
+    void parallel_for(uint32_t begin, uint32_t end, uint32_t grain, const F &fn);
+
+    /*
+      reduce(...reduce(reduce(identity, map(r0)), map(r1))..., map(rn))
+      over ranges r of at least grain indexes covering begin to end, as
+      parallel_for(). The ranges depend only on the arguments and are
+      combined in order, so the result is the same for any number of
+      threads
+     */
+    template <typename T, typename Map, typename Reduce>
+    T parallel_reduce(uint32_t begin, uint32_t end, uint32_t grain, T identity,
+                      const Map &map, const Reduce &reduce);
+
+private:
+    typedef void (*chunk_fn_t)(void *ctx, uint32_t chunk);
+
+    // call fn(ctx, chunk) for each chunk below num_chunks
+    void run(uint32_t num_chunks, chunk_fn_t fn, void *ctx);
+
+    // start one thread per CPU at the first call rather than now
+    void start_on_first_use();
+
+    // the pool returned by get_shared(), constructed once
+    static MathThreadPool &create_shared();
+
+    struct State;
+    State *_state;
+};
+
+template <typename F>
+void MathThreadPool::parallel_for(uint32_t begin, uint32_t end, uint32_t grain, const F &fn)
+{
+    if (end <= begin) {
+        return;
+    }
+    struct Context {
+        const F &fn;
+        uint32_t begin;
+        uint32_t end;
+        uint32_t grain;
+    } ctx { fn, begin, end, grain > 0 ? grain : 1 };
+    run((end - begin - 1) / ctx.grain + 1, [](void *p, uint32_t chunk) {
+        const Context &c = *static_cast<const Context *>(p);
+        const uint32_t start = c.begin + chunk * c.grain;
+        c.fn(start, c.end - start > c.grain ? start + c.grain : c.end);
+    }, &ctx);
+}
+
+template <typename T, typename Map, typename Reduce>
+T MathThreadPool::parallel_reduce(uint32_t begin, uint32_t end, uint32_t grain, T identity,
+                                  const Map &map, const Reduce &reduce)
+{
+    if (end <= begin) {
+        return identity;
+    }
+    const uint32_t min_grain = (end - begin - 1) / MAX_REDUCE_CHUNKS + 1;
+    T partial[MAX_REDUCE_CHUNKS];
+    struct Context {
+        const Map &map;
+        T *partial;
+        uint32_t begin;
+        uint32_t end;
+        uint32_t grain;
+    } ctx { map, partial, begin, end, grain > min_grain ? grain : min_grain };
+    const uint32_t num_chunks = (end - begin - 1) / ctx.grain + 1;
+    run(num_chunks, [](void *p, uint32_t chunk) {
+        const Context &c = *static_cast<const Context *>(p);
+        const uint32_t start = c.begin + chunk * c.grain;
+        c.partial[chunk] = c.map(start, c.end - start > c.grain ? start + c.grain : c.end);
+    }, &ctx);
+    T ret = identity;
+    for (uint32_t i = 0; i < num_chunks; i++) {
+        ret = reduce(ret, partial[i]);
+    }
+    return ret;
+}
@@ -0,0 +1,677 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// 64 bit file offsets on 32 bit Linux, for files over 2GB
+#ifndef _FILE_OFFSET_BITS
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include "time_series.h"
+#include "crc.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <sys/types.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+static_assert(sizeof(off_t) == 8, "time series files need 64 bit file offsets");
+#endif
+
+namespace {
+
+// longest variable length encoding of a value
+constexpr uint8_t MAX_VARINT = 10;
+
+// values of each component take this many bytes in a block, whatever the type
+constexpr uint8_t SLOT_SIZE = 8;
+
+uint8_t *put_varint(uint8_t *p, uint64_t v)
+{
+    while (v >= 0x80) {
+        *p++ = uint8_t(v) | 0x80;
+        v >>= 7;
+    }
+    *p++ = uint8_t(v);
+    return p;
+}
+
+bool get_varint(const uint8_t *&p, const uint8_t *end, uint64_t &v)
+{
+    v = 0;
+    for (uint8_t shift = 0; shift < 64; shift += 7) {
+        if (p == end) {
+            return false;
+        }
+        const uint8_t b = *p++;
+        v |= uint64_t(b & 0x7f) << shift;
+        if ((b & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// signed differences as small unsigned integers, 0, -1, 1, -2...
+uint64_t zigzag(int64_t v)
+{
+    return (uint64_t(v) << 1) ^ uint64_t(v >> 63);
+}
+
+int64_t unzigzag(uint64_t v)
+{
+    return int64_t((v >> 1) ^ (~(v & 1) + 1));
+}
+
+// largest compressed size of a block
+uint32_t max_data_size(const TimeSeriesColumn *columns, uint16_t num_columns, uint32_t block_samples)
+{
+    uint32_t sample = MAX_VARINT;
+    for (uint16_t i = 0; i < num_columns; i++) {
+        sample += columns[i].components * (sample_log_type_size(columns[i].type) == 4 ? 5 : MAX_VARINT);
+    }
+    return sample * block_samples;
+}
+
+uint32_t block_crc(const TimeSeriesBlock &block, const uint8_t *data)
+{
+    const uint32_t crc = crc_crc32(0, reinterpret_cast<const uint8_t *>(&block), offsetof(TimeSeriesBlock, crc));
+    return crc_crc32(crc, data, block.data_size);
+}
+
+bool valid_name(const char *name, uint8_t len)
+{
+    return memchr(name, 0, len) != nullptr && name[0] != 0;
+}
+
+bool valid_column(const TimeSeriesColumn &c)
+{
+    return valid_name(c.name, sizeof(c.name)) &&
+           sample_log_type_size(c.type) != 0 &&
+           c.components >= 1 && c.components <= SampleLogColumn::MAX_COMPONENTS;
+}
+
+uint8_t *encode_time(uint8_t *p, const uint64_t *time_us, uint32_t count)
+{
+    uint64_t prev_delta = 0;
+    for (uint32_t i = 1; i < count; i++) {
+        const uint64_t delta = time_us[i] - time_us[i-1];
+        p = put_varint(p, zigzag(int64_t(delta - prev_delta)));
+        prev_delta = delta;
+    }
+    return p;
+}
+
+bool decode_time(const uint8_t *&p, const uint8_t *end, uint64_t *time_us, uint32_t count)
+{
+    uint64_t delta = 0;
+    for (uint32_t i = 1; i < count; i++) {
+        uint64_t v;
+        if (!get_varint(p, end, v)) {
+            return false;
+        }
+        delta += uint64_t(unzigzag(v));
+        time_us[i] = time_us[i-1] + delta;
+    }
+    return true;
+}
+
+uint8_t *encode(uint8_t *p, uint8_t type, const uint8_t *values, uint32_t count)
+{
+    switch (SampleLogType(type)) {
+    case SampleLogType::FLOAT:
+    case SampleLogType::DOUBLE: {
+        // xor with the previous value, leaving the high bits zero when
+        // the sign, exponent and top of the mantissa don't change
+        const uint8_t size = sample_log_type_size(type);
+        uint64_t prev = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            uint64_t bits = 0;
+            memcpy(&bits, values + i * size, size);
+            p = put_varint(p, bits ^ prev);
+            prev = bits;
+        }
+        break;
+    }
+    case SampleLogType::INT32: {
+        int32_t prev = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            int32_t v;
+            memcpy(&v, values + i * sizeof(v), sizeof(v));
+            p = put_varint(p, zigzag(int64_t(v) - prev));
+            prev = v;
+        }
+        break;
+    }
+    case SampleLogType::UINT64: {
+        uint64_t prev = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            uint64_t v;
+            memcpy(&v, values + i * sizeof(v), sizeof(v));
+            p = put_varint(p, zigzag(int64_t(v - prev)));
+            prev = v;
+        }
+        break;
+    }
+    }
+    return p;
+}
+
+bool decode(const uint8_t *&p, const uint8_t *end, uint8_t type, uint8_t *values, uint32_t count)
+{
+    const uint8_t size = sample_log_type_size(type);
+    uint64_t prev = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t v;
+        if (!get_varint(p, end, v)) {
+            return false;
+        }
+        switch (SampleLogType(type)) {
+        case SampleLogType::FLOAT:
+        case SampleLogType::DOUBLE:
+            v ^= prev;
+            break;
+        case SampleLogType::INT32:
+        case SampleLogType::UINT64:
+            v = prev + uint64_t(unzigzag(v));
+            break;
+        }
+        if (size == 4 && type != uint8_t(SampleLogType::INT32) && v > UINT32_MAX) {
+            return false;
+        }
+        prev = v;
+        memcpy(values + i * size, &v, size);
+    }
+    return true;
+}
+
+}
+
+TimeSeriesWriter::TimeSeriesWriter(uint32_t block_samples) :
+    _block_samples(constrain_uint32(block_samples, 1, MAX_BLOCK_SAMPLES)),
+    _num_columns(0),
+    _num_components(0),
+    _file(nullptr),
+    _failed(false),
+    _values(nullptr),
+    _time_us(nullptr),
+    _count(0),
+    _data(nullptr),
+    _num_samples(0),
+    _last_time_us(0),
+    _offset(0),
+    _index_file(nullptr),
+    _num_blocks(0)
+{
+}
+
+TimeSeriesWriter::~TimeSeriesWriter()
+{
+    close();
+}
+
+int16_t TimeSeriesWriter::add_column(const char *name, SampleLogType type, uint8_t components)
+{
+    const size_t len = strlen(name);
+    if (_file != nullptr || _num_columns >= MAX_COLUMNS || len == 0 || len >= TimeSeriesColumn::NAME_LEN ||
+        sample_log_type_size(uint8_t(type)) == 0 || components < 1 || components > SampleLogColumn::MAX_COMPONENTS) {
+        return -1;
+    }
+    for (uint16_t i = 0; i < _num_columns; i++) {
+        if (strncmp(_columns[i].name, name, TimeSeriesColumn::NAME_LEN) == 0) {
+            return -1;
+        }
+    }
+    TimeSeriesColumn &c = _columns[_num_columns];
+    memset(&c, 0, sizeof(c));
+    memcpy(c.name, name, len);
+    c.type = uint8_t(type);
+    c.components = components;
+    _first_component[_num_columns] = _num_components;
+    _num_components += components;
+    return _num_columns++;
+}
+
+bool TimeSeriesWriter::open(const char *path)
+{
+    if (_file != nullptr) {
+        return false;
+    }
+    _values = NEW_NOTHROW uint8_t[uint32_t(_num_components) * _block_samples * SLOT_SIZE];
+    _time_us = NEW_NOTHROW uint64_t[_block_samples];
+    _data = NEW_NOTHROW uint8_t[max_data_size(_columns, _num_columns, _block_samples)];
+    // the index is kept in a temporary file until close()
+    _index_file = tmpfile();
+    if (_values == nullptr || _time_us == nullptr || _data == nullptr || _index_file == nullptr) {
+        free_buffers();
+        return false;
+    }
+    memset(_values, 0, uint32_t(_num_components) * _block_samples * SLOT_SIZE);
+
+    TimeSeriesHeader header {};
+    header.magic = TimeSeriesHeader::MAGIC;
+    header.version = TimeSeriesHeader::VERSION;
+    header.num_columns = _num_columns;
+    header.block_samples = _block_samples;
+    header.directory_crc = crc_crc32(0, reinterpret_cast<const uint8_t *>(_columns), _num_columns * sizeof(TimeSeriesColumn));
+
+    _file = fopen(path, "wb");
+    if (_file == nullptr) {
+        free_buffers();
+        return false;
+    }
+    _failed = fwrite(&header, sizeof(header), 1, _file) != 1 ||
+              fwrite(_columns, sizeof(TimeSeriesColumn), _num_columns, _file) != _num_columns;
+    _offset = sizeof(header) + _num_columns * sizeof(TimeSeriesColumn);
+    _count = 0;
+    _num_samples = 0;
+    _last_time_us = 0;
+    _num_blocks = 0;
+    return !_failed;
+}
+
+bool TimeSeriesWriter::append(uint64_t time_us)
+{
+    if (_file == nullptr || _failed || (_num_samples > 0 && time_us < _last_time_us)) {
+        return false;
+    }
+    if (_count == _block_samples && !write_block()) {
+        return false;
+    }
+    _time_us[_count++] = time_us;
+    _num_samples++;
+    _last_time_us = time_us;
+    return true;
+}
+
+uint8_t *TimeSeriesWriter::component(uint16_t column, uint8_t i) const
+{
+    return _values + (_first_component[column] + i) * _block_samples * SLOT_SIZE;
+}
+
+bool TimeSeriesWriter::set_components(uint16_t column, SampleLogType type, uint8_t components, const void *v)
+{
+    if (_count == 0 || column >= _num_columns ||
+        _columns[column].type != uint8_t(type) || _columns[column].components != components) {
+        return false;
+    }
+    const uint8_t size = sample_log_type_size(uint8_t(type));
+    for (uint8_t k = 0; k < components; k++) {
+        memcpy(component(column, k) + (_count - 1) * size, static_cast<const uint8_t *>(v) + k * size, size);
+    }
+    return true;
+}
+
+template <typename T>
+bool TimeSeriesWriter::set(uint16_t column, T v)
+{
+    return set_components(column, SampleLogTypeOf<T>::type, 1, &v);
+}
+
+template <typename T>
+bool TimeSeriesWriter::set(uint16_t column, const Vector3<T> &v)
+{
+    const T c[] { v.x, v.y, v.z };
+    return set_components(column, SampleLogTypeOf<T>::type, 3, c);
+}
+
+template <typename T>
+bool TimeSeriesWriter::set(uint16_t column, const QuaternionT<T> &v)
+{
+    const T c[] { v.q1, v.q2, v.q3, v.q4 };
+    return set_components(column, SampleLogTypeOf<T>::type, 4, c);
+}
+
+bool TimeSeriesWriter::write_block()
+{
+    if (_count == 0) {
+        return true;
+    }
+
+    uint8_t *p = encode_time(_data, _time_us, _count);
+    for (uint16_t i = 0; i < _num_columns; i++) {
+        for (uint8_t k = 0; k < _columns[i].components; k++) {
+            p = encode(p, _columns[i].type, component(i, k), _count);
+        }
+    }
+
+    TimeSeriesBlock block {};
+    block.magic = TimeSeriesBlock::MAGIC;
+    block.num_samples = _count;
+    block.first_time_us = _time_us[0];
+    block.last_time_us = _time_us[_count-1];
+    block.data_size = p - _data;
+    block.crc = block_crc(block, _data);
+    TimeSeriesIndexEntry entry;
+    entry.first_time_us = block.first_time_us;
+    entry.offset = _offset;
+    if (_num_blocks == UINT32_MAX ||
+        fwrite(&block, sizeof(block), 1, _file) != 1 ||
+        fwrite(_data, 1, block.data_size, _file) != block.data_size ||
+        fwrite(&entry, sizeof(entry), 1, _index_file) != 1) {
+        _failed = true;
+        return false;
+    }
+
+    _num_blocks++;
+    _offset += sizeof(block) + block.data_size;
+    _count = 0;
+    memset(_values, 0, uint32_t(_num_components) * _block_samples * SLOT_SIZE);
+    return true;
+}
+
+bool TimeSeriesWriter::close()
+{
+    if (_file == nullptr) {
+        return false;
+    }
+    bool ok = !_failed && write_block() && fseeko(_index_file, 0, SEEK_SET) == 0;
+
+    // copy the index after the blocks a piece at a time
+    uint32_t crc = 0;
+    for (uint32_t i = 0; ok && i < _num_blocks; ) {
+        TimeSeriesIndexEntry entries[64];
+        const uint32_t n = MIN(_num_blocks - i, uint32_t(ARRAY_SIZE(entries)));
+        ok = fread(entries, sizeof(entries[0]), n, _index_file) == n &&
+             fwrite(entries, sizeof(entries[0]), n, _file) == n;
+        crc = crc_crc32(crc, reinterpret_cast<const uint8_t *>(entries), n * sizeof(entries[0]));
+        i += n;
+    }
+
+    TimeSeriesFooter footer {};
+    footer.index_offset = _offset;
+    footer.num_samples = _num_samples;
+    footer.num_blocks = _num_blocks;
+    footer.index_crc = crc;
+    footer.magic = TimeSeriesFooter::MAGIC;
+    ok = ok && fwrite(&footer, sizeof(footer), 1, _file) == 1;
+    if (fclose(_file) != 0) {
+        ok = false;
+    }
+    _file = nullptr;
+    free_buffers();
+    return ok;
+}
+
+void TimeSeriesWriter::free_buffers()
+{
+    delete[] _values;
+    delete[] _time_us;
+    delete[] _data;
+    if (_index_file != nullptr) {
+        fclose(_index_file);
+    }
+    _values = nullptr;
+    _time_us = nullptr;
+    _data = nullptr;
+    _index_file = nullptr;
+}
+
+bool TimeSeriesReader::open(const char *path)
+{
+    close();
+    _file = fopen(path, "rb");
+    if (_file == nullptr) {
+        return false;
+    }
+
+    TimeSeriesHeader header;
+    if (fread(&header, sizeof(header), 1, _file) != 1 ||
+        header.magic != TimeSeriesHeader::MAGIC ||
+        header.version != TimeSeriesHeader::VERSION ||
+        header.num_columns > TimeSeriesWriter::MAX_COLUMNS ||
+        header.block_samples < 1 || header.block_samples > TimeSeriesWriter::MAX_BLOCK_SAMPLES ||
+        fread(_columns, sizeof(TimeSeriesColumn), header.num_columns, _file) != header.num_columns ||
+        crc_crc32(0, reinterpret_cast<const uint8_t *>(_columns), header.num_columns * sizeof(TimeSeriesColumn)) != header.directory_crc) {
+        close();
+        return false;
+    }
+    uint8_t num_components = 0;
+    for (uint16_t i = 0; i < header.num_columns; i++) {
+        if (!valid_column(_columns[i])) {
+            close();
+            return false;
+        }
+        _first_component[i] = num_components;
+        num_components += _columns[i].components;
+    }
+
+    TimeSeriesFooter footer;
+    const uint64_t data_start = sizeof(header) + header.num_columns * sizeof(TimeSeriesColumn);
+    if (fseeko(_file, -off_t(sizeof(footer)), SEEK_END) != 0) {
+        close();
+        return false;
+    }
+    const uint64_t footer_offset = ftello(_file);
+    if (fread(&footer, sizeof(footer), 1, _file) != 1 ||
+        footer.magic != TimeSeriesFooter::MAGIC ||
+        footer.index_offset < data_start || footer.index_offset > footer_offset ||
+        footer.index_offset + uint64_t(footer.num_blocks) * sizeof(TimeSeriesIndexEntry) != footer_offset ||
+        footer.num_samples > uint64_t(footer.num_blocks) * header.block_samples ||
+        fseeko(_file, off_t(footer.index_offset), SEEK_SET) != 0) {
+        close();
+        return false;
+    }
+    // check the index a piece at a time
+    uint32_t crc = 0;
+    for (uint32_t i = 0; i < footer.num_blocks; ) {
+        TimeSeriesIndexEntry entries[64];
+        const uint32_t n = MIN(footer.num_blocks - i, uint32_t(ARRAY_SIZE(entries)));
+        if (fread(entries, sizeof(entries[0]), n, _file) != n) {
+            close();
+            return false;
+        }
+        crc = crc_crc32(crc, reinterpret_cast<const uint8_t *>(entries), n * sizeof(entries[0]));
+        i += n;
+    }
+    if (crc != footer.index_crc) {
+        close();
+        return false;
+    }
+
+    _values = NEW_NOTHROW uint8_t[uint32_t(num_components) * header.block_samples * SLOT_SIZE];
+    _time_us = NEW_NOTHROW uint64_t[header.block_samples];
+    _data = NEW_NOTHROW uint8_t[max_data_size(_columns, header.num_columns, header.block_samples)];
+    if (_values == nullptr || _time_us == nullptr || _data == nullptr) {
+        close();
+        return false;
+    }
+
+    _block_samples = header.block_samples;
+    _num_columns = header.num_columns;
+    _num_samples = footer.num_samples;
+    _num_blocks = footer.num_blocks;
+    _index_offset = footer.index_offset;
+    _next_block = 0;
+    return true;
+}
+
+void TimeSeriesReader::close()
+{
+    if (_file != nullptr) {
+        fclose(_file);
+    }
+    delete[] _values;
+    delete[] _time_us;
+    delete[] _data;
+    _file = nullptr;
+    _values = nullptr;
+    _time_us = nullptr;
+    _data = nullptr;
+    _num_columns = 0;
+    _num_samples = 0;
+    _num_blocks = 0;
+    _count = 0;
+    _seek_index = 0;
+}
+
+int16_t TimeSeriesReader::find_column(const char *name) const
+{
+    for (uint16_t i = 0; i < _num_columns; i++) {
+        if (strncmp(_columns[i].name, name, sizeof(_columns[i].name)) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool TimeSeriesReader::read_index(uint32_t i, TimeSeriesIndexEntry &entry) const
+{
+    return fseeko(_file, off_t(_index_offset + uint64_t(i) * sizeof(entry)), SEEK_SET) == 0 &&
+           fread(&entry, sizeof(entry), 1, _file) == 1;
+}
+
+bool TimeSeriesReader::read_block()
+{
+    _count = 0;
+    if (_file == nullptr || _next_block >= _num_blocks) {
+        return false;
+    }
+    // blocks are found through the index, so a damaged one can be skipped
+    TimeSeriesIndexEntry entry;
+    TimeSeriesBlock block;
+    if (!read_index(_next_block++, entry) ||
+        entry.offset + sizeof(block) > _index_offset ||
+        fseeko(_file, off_t(entry.offset), SEEK_SET) != 0 ||
+        fread(&block, sizeof(block), 1, _file) != 1 ||
+        block.magic != TimeSeriesBlock::MAGIC ||
+        block.num_samples < 1 || block.num_samples > _block_samples ||
+        block.first_time_us != entry.first_time_us ||
+        block.data_size > max_data_size(_columns, _num_columns, _block_samples) ||
+        fread(_data, 1, block.data_size, _file) != block.data_size ||
+        block_crc(block, _data) != block.crc) {
+        return false;
+    }
+
+    const uint8_t *p = _data;
+    const uint8_t *end = _data + block.data_size;
+    _time_us[0] = block.first_time_us;
+    if (!decode_time(p, end, _time_us, block.num_samples)) {
+        return false;
+    }
+    for (uint16_t i = 0; i < _num_columns; i++) {
+        for (uint8_t k = 0; k < _columns[i].components; k++) {
+            uint8_t *values = _values + (_first_component[i] + k) * _block_samples * SLOT_SIZE;
+            if (!decode(p, end, _columns[i].type, values, block.num_samples)) {
+                return false;
+            }
+        }
+    }
+    if (p != end || _time_us[block.num_samples-1] != block.last_time_us) {
+        return false;
+    }
+    _count = block.num_samples;
+    return true;
+}
+
+bool TimeSeriesReader::seek(uint64_t time_us)
+{
+    if (_file == nullptr) {
+        return false;
+    }
+    // first block starting at or after time_us
+    uint32_t lo = 0;
+    uint32_t hi = _num_blocks;
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        TimeSeriesIndexEntry entry;
+        if (!read_index(mid, entry)) {
+            return false;
+        }
+        if (entry.first_time_us < time_us) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    // the sample may be at the end of the block before
+    for (uint32_t b = lo > 0 ? lo - 1 : 0; b <= lo && b < _num_blocks; b++) {
+        _next_block = b;
+        if (!read_block()) {
+            return false;
+        }
+        for (uint32_t i = 0; i < _count; i++) {
+            if (_time_us[i] >= time_us) {
+                _seek_index = i;
+                return true;
+            }
+        }
+    }
+    _count = 0;
+    return false;
+}
+
+bool TimeSeriesReader::get_components(const char *name, SampleLogType type, uint8_t components, void **data) const
+{
+    const int16_t i = find_column(name);
+    if (i < 0 || _columns[i].type != uint8_t(type) || _columns[i].components != components) {
+        return false;
+    }
+    for (uint8_t k = 0; k < components; k++) {
+        data[k] = _values + (_first_component[i] + k) * _block_samples * SLOT_SIZE;
+    }
+    return true;
+}
+
+template <typename T>
+bool TimeSeriesReader::get_view(const char *name, T *&v) const
+{
+    void *data[1];
+    if (!get_components(name, SampleLogTypeOf<T>::type, 1, data)) {
+        return false;
+    }
+    v = static_cast<T *>(data[0]);
+    return true;
+}
+
+template <typename T>
+bool TimeSeriesReader::get_view(const char *name, Vector3SoA<T> &v) const
+{
+    void *data[3];
+    if (!get_components(name, SampleLogTypeOf<T>::type, 3, data)) {
+        return false;
+    }
+    v = Vector3SoA<T>(static_cast<T *>(data[0]), static_cast<T *>(data[1]), static_cast<T *>(data[2]));
+    return true;
+}
+
+template <typename T>
+bool TimeSeriesReader::get_view(const char *name, QuaternionSoA<T> &v) const
+{
+    void *data[4];
+    if (!get_components(name, SampleLogTypeOf<T>::type, 4, data)) {
+        return false;
+    }
+    v = QuaternionSoA<T>(static_cast<T *>(data[0]), static_cast<T *>(data[1]),
+                         static_cast<T *>(data[2]), static_cast<T *>(data[3]));
+    return true;
+}
+
+template bool TimeSeriesWriter::set<float>(uint16_t column, float v);
+template bool TimeSeriesWriter::set<double>(uint16_t column, double v);
+template bool TimeSeriesWriter::set<int32_t>(uint16_t column, int32_t v);
+template bool TimeSeriesWriter::set<uint64_t>(uint16_t column, uint64_t v);
+template bool TimeSeriesWriter::set<float>(uint16_t column, const Vector3<float> &v);
+template bool TimeSeriesWriter::set<double>(uint16_t column, const Vector3<double> &v);
+template bool TimeSeriesWriter::set<float>(uint16_t column, const QuaternionT<float> &v);
+template bool TimeSeriesWriter::set<double>(uint16_t column, const QuaternionT<double> &v);
+
+template bool TimeSeriesReader::get_view<float>(const char *name, float *&v) const;
+template bool TimeSeriesReader::get_view<double>(const char *name, double *&v) const;
+template bool TimeSeriesReader::get_view<uint64_t>(const char *name, uint64_t *&v) const;
+template bool TimeSeriesReader::get_view<int32_t>(const char *name, int32_t *&v) const;
+template bool TimeSeriesReader::get_view<float>(const char *name, Vector3SoA<float> &v) const;
+template bool TimeSeriesReader::get_view<double>(const char *name, Vector3SoA<double> &v) const;
+template bool TimeSeriesReader::get_view<float>(const char *name, QuaternionSoA<float> &v) const;
+template bool TimeSeriesReader::get_view<double>(const char *name, QuaternionSoA<double> &v) const;
@@ -0,0 +1,250 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  a compressed columnar file of timestamped samples, such as planned
+  trajectories and attitudes, written and read a block at a time.
+
+  The file is a TimeSeriesHeader, a directory of num_columns
+  TimeSeriesColumn, the blocks, an index of the blocks and a
+  TimeSeriesFooter, all little endian. Each block is a TimeSeriesBlock
+  followed by up to block_samples samples, compressed one column
+  component after another as variable length integers:
+
+   - timestamps as the change in the time between samples, so a fixed
+     rate costs one byte per sample
+   - integers as the difference from the previous sample
+   - floats and doubles as the bits changed from the previous sample,
+     so slowly changing values cost fewer bytes
+
+  Blocks are compressed on their own and hold a crc_crc32() of their
+  header and data, so a damaged block is detected and doesn't stop the
+  others being read. The index gives the first time of each block, so
+  seek() finds a time with a binary search of the index in the file.
+
+  Timestamps must not decrease. The writer keeps one block of samples
+  in memory and the index in a temporary file until close(), and the
+  reader keeps one block, however long the file.
+ */
+#pragma once
+
+#include "sample_log.h"
+
+#include <stdio.h>
+
+struct TimeSeriesHeader {
+    static constexpr uint32_t MAGIC = 0x53544d45;  // "EMTS"
+    static constexpr uint16_t VERSION = 1;
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t num_columns;
+    uint32_t block_samples;
+    uint32_t directory_crc;
+};
+
+struct TimeSeriesColumn {
+    static constexpr uint8_t NAME_LEN = 16;
+
+    // nul padded, at most NAME_LEN-1 characters
+    char name[NAME_LEN];
+    // a SampleLogType
+    uint8_t type;
+    uint8_t components;
+    uint8_t reserved[6];
+};
+
+struct TimeSeriesBlock {
+    static constexpr uint32_t MAGIC = 0x4b4c4254;  // "TBLK"
+
+    uint32_t magic;
+    uint32_t num_samples;
+    uint64_t first_time_us;
+    uint64_t last_time_us;
+    uint32_t data_size;
+    // crc_crc32() of the fields above and the data
+    uint32_t crc;
+};
+
+struct TimeSeriesIndexEntry {
+    uint64_t first_time_us;
+    // file offset of the TimeSeriesBlock
+    uint64_t offset;
+};
+
+struct TimeSeriesFooter {
+    static constexpr uint32_t MAGIC = 0x58444e49;  // "INDX"
+
+    uint64_t index_offset;
+    uint64_t num_samples;
+    uint32_t num_blocks;
+    // crc_crc32() of the index
+    uint32_t index_crc;
+    uint32_t magic;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(TimeSeriesHeader) == 16, "TimeSeriesHeader must not be padded");
+static_assert(sizeof(TimeSeriesColumn) == 24, "TimeSeriesColumn must not be padded");
+static_assert(sizeof(TimeSeriesBlock) == 32, "TimeSeriesBlock must not be padded");
+static_assert(sizeof(TimeSeriesIndexEntry) == 16, "TimeSeriesIndexEntry must not be padded");
+static_assert(sizeof(TimeSeriesFooter) == 32, "TimeSeriesFooter must not be padded");
+
+class TimeSeriesWriter {
+public:
+    static constexpr uint16_t MAX_COLUMNS = 32;
+    static constexpr uint32_t MAX_BLOCK_SAMPLES = 65536;
+
+    explicit TimeSeriesWriter(uint32_t block_samples = 1024);
+    ~TimeSeriesWriter();
+
+    TimeSeriesWriter(const TimeSeriesWriter &) = delete;
+    TimeSeriesWriter &operator=(const TimeSeriesWriter &) = delete;
+
+    /*
+      add a column before open(). Returns its index, or -1 for a bad
+      or duplicate name, type or number of components, or if there are
+      too many columns
+     */
+    int16_t add_column(const char *name, SampleLogType type, uint8_t components);
+
+    bool open(const char *path) WARN_IF_UNUSED;
+
+    /*
+      start a sample. Values not set are zero. Returns false if the
+      time is before the previous sample's or a full block couldn't be
+      written
+     */
+    bool append(uint64_t time_us) WARN_IF_UNUSED;
+
+    /*
+      set a value of the current sample. Returns false if the column's
+      type or number of components doesn't match
+     */
+    template <typename T>
+    bool set(uint16_t column, T v);
+    template <typename T>
+    bool set(uint16_t column, const Vector3<T> &v);
+    template <typename T>
+    bool set(uint16_t column, const QuaternionT<T> &v);
+
+    // write the last block and the index. Returns false if any write failed
+    bool close();
+
+private:
+    // start of a column component's values in the block
+    uint8_t *component(uint16_t column, uint8_t i) const;
+
+    bool set_components(uint16_t column, SampleLogType type, uint8_t components, const void *v);
+    bool write_block();
+    void free_buffers();
+
+    uint32_t _block_samples;
+    uint16_t _num_columns;
+    TimeSeriesColumn _columns[MAX_COLUMNS];
+    // first component of each column
+    uint8_t _first_component[MAX_COLUMNS];
+    uint8_t _num_components;
+
+    FILE *_file;
+    bool _failed;
+
+    // the block being filled, each component's values one after another
+    uint8_t *_values;
+    uint64_t *_time_us;
+    uint32_t _count;
+    uint8_t *_data;
+
+    uint64_t _num_samples;
+    uint64_t _last_time_us;
+    uint64_t _offset;
+
+    // index entries of the blocks written
+    FILE *_index_file;
+    uint32_t _num_blocks;
+};
+
+class TimeSeriesReader {
+public:
+    TimeSeriesReader() {}
+    ~TimeSeriesReader() { close(); }
+
+    TimeSeriesReader(const TimeSeriesReader &) = delete;
+    TimeSeriesReader &operator=(const TimeSeriesReader &) = delete;
+
+    // open a file and check its directory and index
+    bool open(const char *path) WARN_IF_UNUSED;
+    void close();
+
+    uint16_t get_num_columns() const { return _num_columns; }
+    const TimeSeriesColumn &get_column(uint16_t i) const { return _columns[i]; }
+    int16_t find_column(const char *name) const;
+
+    uint64_t get_num_samples() const { return _num_samples; }
+    uint32_t get_num_blocks() const { return _num_blocks; }
+
+    /*
+      read the next block, the first after open(). Returns false at the
+      end of the file and for a damaged block, after which the
+      following block can be read
+     */
+    bool read_block() WARN_IF_UNUSED;
+
+    /*
+      read the block holding the first sample at or after time_us,
+      with get_seek_index() its index in the block. Returns false if
+      there is no such sample or the block is damaged
+     */
+    bool seek(uint64_t time_us) WARN_IF_UNUSED;
+    uint32_t get_seek_index() const { return _seek_index; }
+
+    // samples of the last block read
+    uint32_t get_block_samples() const { return _count; }
+    const uint64_t *get_block_time_us() const { return _time_us; }
+
+    /*
+      views of a column in the last block read. Return false, leaving
+      the view unchanged, if the column doesn't exist or has a
+      different type or number of components
+     */
+    template <typename T>
+    bool get_view(const char *name, T *&v) const WARN_IF_UNUSED;
+    template <typename T>
+    bool get_view(const char *name, Vector3SoA<T> &v) const WARN_IF_UNUSED;
+    template <typename T>
+    bool get_view(const char *name, QuaternionSoA<T> &v) const WARN_IF_UNUSED;
+
+private:
+    bool get_components(const char *name, SampleLogType type, uint8_t components, void **data) const;
+    bool read_index(uint32_t i, TimeSeriesIndexEntry &entry) const;
+
+    FILE *_file = nullptr;
+    uint32_t _block_samples = 0;
+    uint16_t _num_columns = 0;
+    TimeSeriesColumn _columns[TimeSeriesWriter::MAX_COLUMNS];
+    uint8_t _first_component[TimeSeriesWriter::MAX_COLUMNS];
+
+    uint64_t _num_samples = 0;
+    uint32_t _num_blocks = 0;
+    uint64_t _index_offset = 0;
+    uint32_t _next_block = 0;
+
+    // the last block read, as TimeSeriesWriter
+    uint8_t *_values = nullptr;
+    uint64_t *_time_us = nullptr;
+    uint32_t _count = 0;
+    uint8_t *_data = nullptr;
+    uint32_t _seek_index = 0;
+};
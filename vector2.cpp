@@ -75,41 +75,6 @@ bool Vector2<T>::limit_length(T max_length)
     return false;
 }
 
-// dot product
-template <typename T>
-T Vector2<T>::operator *(const Vector2<T> &v) const
-{
-    return x*v.x + y*v.y;
-}
-
-// cross product
-template <typename T>
-T Vector2<T>::operator %(const Vector2<T> &v) const
-{
-    return x*v.y - y*v.x;
-}
-
-template <typename T>
-Vector2<T> &Vector2<T>::operator *=(const T num)
-{
-    x*=num; y*=num;
-    return *this;
-}
-
-template <typename T>
-Vector2<T> &Vector2<T>::operator /=(const T num)
-{
-    x /= num; y /= num;
-    return *this;
-}
-
-template <typename T>
-Vector2<T> &Vector2<T>::operator -=(const Vector2<T> &v)
-{
-    x -= v.x; y -= v.y;
-    return *this;
-}
-
 template <typename T>
 bool Vector2<T>::is_nan(void) const
 {
@@ -122,43 +87,6 @@ bool Vector2<T>::is_inf(void) const
     return std::isinf(x) || std::isinf(y);
 }
 
-template <typename T>
-Vector2<T> &Vector2<T>::operator +=(const Vector2<T> &v)
-{
-    x+=v.x; y+=v.y;
-    return *this;
-}
-
-template <typename T>
-Vector2<T> Vector2<T>::operator /(const T num) const
-{
-    return Vector2<T>(x/num, y/num);
-}
-
-template <typename T>
-Vector2<T> Vector2<T>::operator *(const T num) const
-{
-    return Vector2<T>(x*num, y*num);
-}
-
-template <typename T>
-Vector2<T> Vector2<T>::operator -(const Vector2<T> &v) const
-{
-    return Vector2<T>(x-v.x, y-v.y);
-}
-
-template <typename T>
-Vector2<T> Vector2<T>::operator +(const Vector2<T> &v) const
-{
-    return Vector2<T>(x+v.x, y+v.y);
-}
-
-template <typename T>
-Vector2<T> Vector2<T>::operator -(void) const
-{
-    return Vector2<T>(-x,-y);
-}
-
 template <typename T>
 bool Vector2<T>::operator ==(const Vector2<T> &v) const
 {
@@ -74,34 +74,58 @@ struct Vector2
     bool operator !=(const Vector2<T> &v) const;
 
     // negation
-    Vector2<T> operator -(void) const;
+    constexpr Vector2<T> operator -(void) const {
+        return Vector2<T>(-x, -y);
+    }
 
     // addition
-    Vector2<T> operator +(const Vector2<T> &v) const;
+    constexpr Vector2<T> operator +(const Vector2<T> &v) const {
+        return Vector2<T>(x+v.x, y+v.y);
+    }
 
     // subtraction
-    Vector2<T> operator -(const Vector2<T> &v) const;
+    constexpr Vector2<T> operator -(const Vector2<T> &v) const {
+        return Vector2<T>(x-v.x, y-v.y);
+    }
 
     // uniform scaling
-    Vector2<T> operator *(const T num) const;
+    constexpr Vector2<T> operator *(const T num) const {
+        return Vector2<T>(x*num, y*num);
+    }
 
     // uniform scaling
-    Vector2<T> operator  /(const T num) const;
+    constexpr Vector2<T> operator  /(const T num) const {
+        return Vector2<T>(x/num, y/num);
+    }
 
     // addition
-    Vector2<T> &operator +=(const Vector2<T> &v);
+    Vector2<T> &operator +=(const Vector2<T> &v) {
+        x += v.x; y += v.y;
+        return *this;
+    }
 
     // subtraction
-    Vector2<T> &operator -=(const Vector2<T> &v);
+    Vector2<T> &operator -=(const Vector2<T> &v) {
+        x -= v.x; y -= v.y;
+        return *this;
+    }
 
     // uniform scaling
-    Vector2<T> &operator *=(const T num);
+    Vector2<T> &operator *=(const T num) {
+        x *= num; y *= num;
+        return *this;
+    }
 
     // uniform scaling
-    Vector2<T> &operator /=(const T num);
+    Vector2<T> &operator /=(const T num) {
+        x /= num; y /= num;
+        return *this;
+    }
 
     // dot product
-    T operator *(const Vector2<T> &v) const;
+    constexpr T operator *(const Vector2<T> &v) const {
+        return x*v.x + y*v.y;
+    }
 
     // dot product (same as above but a more easily understood name)
     T dot(const Vector2<T> &v) const {
@@ -109,7 +133,25 @@ struct Vector2
     }
 
     // cross product
-    T operator %(const Vector2<T> &v) const;
+    constexpr T operator %(const Vector2<T> &v) const {
+        return x*v.y - y*v.x;
+    }
+
+    // return a*k + b
+    static constexpr Vector2<T> fma(const Vector2<T> &a, const T k, const Vector2<T> &b) {
+        return Vector2<T>(a.x*k + b.x, a.y*k + b.y);
+    }
+
+    // this += v*k
+    Vector2<T> &axpy(const T k, const Vector2<T> &v) {
+        x += v.x*k; y += v.y*k;
+        return *this;
+    }
+
+    // linear interpolation from a (t=0) to b (t=1)
+    static constexpr Vector2<T> lerp(const Vector2<T> &a, const Vector2<T> &b, const T t) {
+        return Vector2<T>(a.x + (b.x-a.x)*t, a.y + (b.y-a.y)*t);
+    }
 
     // computes the angle between this vector and another vector
     // returns 0 if the vectors are parallel, and M_PI if they are antiparallel
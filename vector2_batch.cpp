@@ -0,0 +1,182 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma GCC optimize("O2")
+
+#include "vector2_batch.h"
+
+template <typename T>
+void Vector2SoA<T>::pack(const Vector2<T> *v, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        x[i] = v[i].x;
+        y[i] = v[i].y;
+    }
+}
+
+template <typename T>
+void Vector2SoA<T>::unpack(Vector2<T> *v, uint32_t count) const
+{
+    for (uint32_t i = 0; i < count; i++) {
+        v[i].x = x[i];
+        v[i].y = y[i];
+    }
+}
+
+// divide with a substitute denominator for masked out lanes, so the
+// division doesn't need a branch around it
+template <typename T>
+static inline T masked_div(T n, T d, bool mask)
+{
+    return n / (mask ? T(1) : d);
+}
+
+template <typename T>
+void segment_intersection(const Vector2<T> &seg1_start, const Vector2<T> &seg1_end,
+                          const Segment2SoA<T> &seg2, const Vector2SoA<T> &intersection,
+                          bool *hit, uint32_t count)
+{
+    const Vector2<T> r1 = seg1_end - seg1_start;
+    for (uint32_t i = 0; i < count; i++) {
+        const T r2x = seg2.end.x[i] - seg2.start.x[i];
+        const T r2y = seg2.end.y[i] - seg2.start.y[i];
+        const T qx = seg2.start.x[i] - seg1_start.x;
+        const T qy = seg2.start.y[i] - seg1_start.y;
+        const T r1xr2 = r1.x*r2y - r1.y*r2x;
+        const T q_pxr = qx*r1.y - qy*r1.x;
+        // collinear or parallel segments don't intersect
+        const bool parallel = ::is_zero(r1xr2);
+        const T t = masked_div(qx*r2y - qy*r2x, r1xr2, parallel);
+        const T u = masked_div(q_pxr, r1xr2, parallel);
+        hit[i] = !parallel & (u >= 0) & (u <= 1) & (t >= 0) & (t <= 1);
+        intersection.x[i] = seg1_start.x + r1.x*t;
+        intersection.y[i] = seg1_start.y + r1.y*t;
+    }
+}
+
+/*
+  one lane of circle_segment_intersection(), with the segment given by
+  its start and direction
+ */
+template <typename T>
+static inline bool circle_segment_lane(const T sx, const T sy, const T dx, const T dy,
+                                       const T cx, const T cy, const T radius, T &ix, T &iy)
+{
+    const T lx = sx - cx;
+    const T ly = sy - cy;
+    const T a = sq(dx) + sq(dy);
+    const T b = 2 * (dx*lx + dy*ly);
+    const T c = sq(lx) + sq(ly) - sq(radius);
+    const T delta = sq(b) - (4.0f * a * c);
+
+    // a NaN in a, b or c makes delta NaN, failing the comparison
+    const bool valid = !::is_zero(a) & (delta >= 0);
+    const T delta_sqrt = std::sqrt(valid ? delta : T(0));
+    const T t1 = masked_div(-b + delta_sqrt, 2.0f * a, !valid);
+    const T t2 = masked_div(-b - delta_sqrt, 2.0f * a, !valid);
+
+    // t1 is preferred, as in the scalar version
+    const bool hit1 = (t1 >= 0) & (t1 <= 1);
+    const bool hit2 = (t2 >= 0) & (t2 <= 1);
+    const T t = hit1 ? t1 : t2;
+    ix = sx + dx*t;
+    iy = sy + dy*t;
+    return valid & (hit1 | hit2);
+}
+
+template <typename T>
+void circle_segment_intersection(const Segment2SoA<T> &seg, const Vector2<T> &circle_center, T radius,
+                                 const Vector2SoA<T> &intersection, bool *hit, uint32_t count)
+{
+    const T cx = circle_center.x;
+    const T cy = circle_center.y;
+    for (uint32_t i = 0; i < count; i++) {
+        T ix, iy;
+        hit[i] = circle_segment_lane(seg.start.x[i], seg.start.y[i],
+                                     seg.end.x[i] - seg.start.x[i], seg.end.y[i] - seg.start.y[i],
+                                     cx, cy, radius, ix, iy);
+        intersection.x[i] = ix;
+        intersection.y[i] = iy;
+    }
+}
+
+template <typename T>
+void circle_segment_intersection(const Vector2<T> &seg_start, const Vector2<T> &seg_end,
+                                 const Vector2SoA<T> &circle_center, const T *radius,
+                                 const Vector2SoA<T> &intersection, bool *hit, uint32_t count)
+{
+    const Vector2<T> d = seg_end - seg_start;
+    for (uint32_t i = 0; i < count; i++) {
+        T ix, iy;
+        hit[i] = circle_segment_lane(seg_start.x, seg_start.y, d.x, d.y,
+                                     circle_center.x[i], circle_center.y[i], radius[i], ix, iy);
+        intersection.x[i] = ix;
+        intersection.y[i] = iy;
+    }
+}
+
+template <typename T>
+void closest_point(const Vector2<T> &p, const Segment2SoA<T> &seg,
+                   const Vector2SoA<T> &closest, uint32_t count)
+{
+    const T px = p.x;
+    const T py = p.y;
+    for (uint32_t i = 0; i < count; i++) {
+        const T vx = seg.start.x[i];
+        const T vy = seg.start.y[i];
+        const T wx = seg.end.x[i];
+        const T wy = seg.end.y[i];
+        const T dx = wx - vx;
+        const T dy = wy - vy;
+        const T l2 = sq(vx - wx) + sq(vy - wy);
+        const bool degenerate = l2 <= T(0);
+        const T t = masked_div((px - vx)*dx + (py - vy)*dy, l2, degenerate);
+        // end points are returned exactly
+        const bool at_start = degenerate | (t <= 0);
+        const bool at_end = !at_start & (t >= 1);
+        const T tc = at_start ? T(0) : t;
+        closest.x[i] = at_end ? wx : vx + dx*tc;
+        closest.y[i] = at_end ? wy : vy + dy*tc;
+    }
+}
+
+template <typename T>
+void closest_distance_between_radial_and_point(const Vector2SoA<T> &w, const Vector2SoA<T> &p,
+                                               T *dist, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        const T wx = w.x[i];
+        const T wy = w.y[i];
+        const T l2 = sq(wx) + sq(wy);
+        const bool degenerate = l2 <= T(0);
+        const T t = masked_div(p.x[i]*wx + p.y[i]*wy, l2, degenerate);
+        const bool at_end = degenerate | (t >= 1);
+        const T tc = t <= 0 ? T(0) : t;
+        const T cx = at_end ? wx : wx*tc;
+        const T cy = at_end ? wy : wy*tc;
+        dist[i] = std::sqrt(sq(cx - p.x[i]) + sq(cy - p.y[i]));
+    }
+}
+
+#define VECTOR2_BATCH_INSTANTIATE(T) \
+    template struct Vector2SoA<T>; \
+    template void segment_intersection<T>(const Vector2<T> &, const Vector2<T> &, const Segment2SoA<T> &, const Vector2SoA<T> &, bool *, uint32_t); \
+    template void circle_segment_intersection<T>(const Segment2SoA<T> &, const Vector2<T> &, T, const Vector2SoA<T> &, bool *, uint32_t); \
+    template void circle_segment_intersection<T>(const Vector2<T> &, const Vector2<T> &, const Vector2SoA<T> &, const T *, const Vector2SoA<T> &, bool *, uint32_t); \
+    template void closest_point<T>(const Vector2<T> &, const Segment2SoA<T> &, const Vector2SoA<T> &, uint32_t); \
+    template void closest_distance_between_radial_and_point<T>(const Vector2SoA<T> &, const Vector2SoA<T> &, T *, uint32_t);
+
+VECTOR2_BATCH_INSTANTIATE(float)
+VECTOR2_BATCH_INSTANTIATE(double)
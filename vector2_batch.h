@@ -0,0 +1,110 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  batch versions of the Vector2 segment and circle queries, over
+  structure of arrays inputs. See vector3_batch.h for the 3D versions
+  and the compiler options needed to vectorise the loops.
+
+  Every lane returns the same answer as the scalar Vector2 function of
+  the same name, including its edge cases (parallel segments, zero
+  length segments, circles containing the whole segment). Outputs for
+  lanes with a false hit flag are unspecified.
+ */
+#pragma once
+
+#include "Embed_Math.h"
+
+/*
+  non-owning structure of arrays view of Vector2 values
+ */
+template <typename T>
+struct Vector2SoA {
+    T *x;
+    T *y;
+
+    constexpr Vector2SoA() : x(nullptr), y(nullptr) {}
+    constexpr Vector2SoA(T *x0, T *y0) : x(x0), y(y0) {}
+
+    Vector2<T> get(uint32_t i) const {
+        return Vector2<T>(x[i], y[i]);
+    }
+    void set(uint32_t i, const Vector2<T> &v) {
+        x[i] = v.x;
+        y[i] = v.y;
+    }
+
+    // view starting at element i
+    Vector2SoA<T> offset(uint32_t i) const {
+        return Vector2SoA<T>(x + i, y + i);
+    }
+
+    // copy from/to an array of Vector2
+    void pack(const Vector2<T> *v, uint32_t count);
+    void unpack(Vector2<T> *v, uint32_t count) const;
+};
+
+/*
+  segments from start[i] to end[i]
+ */
+template <typename T>
+struct Segment2SoA {
+    Vector2SoA<T> start;
+    Vector2SoA<T> end;
+
+    Segment2SoA<T> offset(uint32_t i) const {
+        return Segment2SoA<T>{start.offset(i), end.offset(i)};
+    }
+};
+
+/*
+  intersection of seg1 with each of seg2, as
+  Vector2::segment_intersection()
+ */
+template <typename T>
+void segment_intersection(const Vector2<T> &seg1_start, const Vector2<T> &seg1_end,
+                          const Segment2SoA<T> &seg2, const Vector2SoA<T> &intersection,
+                          bool *hit, uint32_t count);
+
+/*
+  intersection of each segment with one circle, as
+  Vector2::circle_segment_intersection()
+ */
+template <typename T>
+void circle_segment_intersection(const Segment2SoA<T> &seg, const Vector2<T> &circle_center, T radius,
+                                 const Vector2SoA<T> &intersection, bool *hit, uint32_t count);
+
+/*
+  intersection of one segment with each circle
+ */
+template <typename T>
+void circle_segment_intersection(const Vector2<T> &seg_start, const Vector2<T> &seg_end,
+                                 const Vector2SoA<T> &circle_center, const T *radius,
+                                 const Vector2SoA<T> &intersection, bool *hit, uint32_t count);
+
+/*
+  point on each segment closest to p, as Vector2::closest_point()
+ */
+template <typename T>
+void closest_point(const Vector2<T> &p, const Segment2SoA<T> &seg,
+                   const Vector2SoA<T> &closest, uint32_t count);
+
+/*
+  distance between each radial (0,w[i]) and point p[i], as
+  Vector2::closest_distance_between_radial_and_point()
+ */
+template <typename T>
+void closest_distance_between_radial_and_point(const Vector2SoA<T> &w, const Vector2SoA<T> &p,
+                                               T *dist, uint32_t count);
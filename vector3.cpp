@@ -276,6 +276,13 @@ void Vector3<T>::rotate(enum Rotation rotation)
 template <typename T>
 void Vector3<T>::rotate_inverse(enum Rotation rotation)
 {
+    // most rotations have their inverse in the list
+    const enum Rotation inverse = rotation_inverse(rotation);
+    if (inverse != ROTATION_MAX) {
+        rotate(inverse);
+        return;
+    }
+
     Vector3<T> x_vec(1.0f,0.0f,0.0f);
     Vector3<T> y_vec(0.0f,1.0f,0.0f);
     Vector3<T> z_vec(0.0f,0.0f,1.0f);
@@ -305,21 +312,6 @@ void Vector3<T>::rotate_xy(T angle_rad)
     y = ry;
 }
 
-// vector cross product
-template <typename T>
-Vector3<T> Vector3<T>::operator %(const Vector3<T> &v) const
-{
-    Vector3<T> temp(y*v.z - z*v.y, z*v.x - x*v.z, x*v.y - y*v.x);
-    return temp;
-}
-
-// dot product
-template <typename T>
-T Vector3<T>::operator *(const Vector3<T> &v) const
-{
-    return x*v.x + y*v.y + z*v.z;
-}
-
 template <typename T>
 T Vector3<T>::length(void) const
 {
@@ -339,27 +331,6 @@ bool Vector3<T>::limit_length_xy(T max_length)
     return false;
 }
 
-template <typename T>
-Vector3<T> &Vector3<T>::operator *=(const T num)
-{
-    x*=num; y*=num; z*=num;
-    return *this;
-}
-
-template <typename T>
-Vector3<T> &Vector3<T>::operator /=(const T num)
-{
-    x /= num; y /= num; z /= num;
-    return *this;
-}
-
-template <typename T>
-Vector3<T> &Vector3<T>::operator -=(const Vector3<T> &v)
-{
-    x -= v.x; y -= v.y; z -= v.z;
-    return *this;
-}
-
 template <typename T>
 bool Vector3<T>::is_nan(void) const
 {
@@ -372,43 +343,6 @@ bool Vector3<T>::is_inf(void) const
     return isinf(x) || isinf(y) || isinf(z);
 }
 
-template <typename T>
-Vector3<T> &Vector3<T>::operator +=(const Vector3<T> &v)
-{
-    x+=v.x; y+=v.y; z+=v.z;
-    return *this;
-}
-
-template <typename T>
-Vector3<T> Vector3<T>::operator /(const T num) const
-{
-    return Vector3<T>(x/num, y/num, z/num);
-}
-
-template <typename T>
-Vector3<T> Vector3<T>::operator *(const T num) const
-{
-    return Vector3<T>(x*num, y*num, z*num);
-}
-
-template <typename T>
-Vector3<T> Vector3<T>::operator -(const Vector3<T> &v) const
-{
-    return Vector3<T>(x-v.x, y-v.y, z-v.z);
-}
-
-template <typename T>
-Vector3<T> Vector3<T>::operator +(const Vector3<T> &v) const
-{
-    return Vector3<T>(x+v.x, y+v.y, z+v.z);
-}
-
-template <typename T>
-Vector3<T> Vector3<T>::operator -(void) const
-{
-    return Vector3<T>(-x,-y,-z);
-}
-
 template <typename T>
 bool Vector3<T>::operator ==(const Vector3<T> &v) const
 {
@@ -633,5 +567,4 @@ template class Vector3<float>;
 template class Vector3<double>;
 
 // define needed ops for Vector3l, Vector3i as needed
-template Vector3<int32_t> &Vector3<int32_t>::operator +=(const Vector3<int32_t> &v);
 template bool Vector3<int16_t>::operator ==(const Vector3<int16_t> &v) const;
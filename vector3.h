@@ -100,31 +100,53 @@ public:
     bool operator !=(const Vector3<T> &v) const;
 
     // negation
-    Vector3<T> operator -(void) const;
+    constexpr Vector3<T> operator -(void) const {
+        return Vector3<T>(-x, -y, -z);
+    }
 
     // addition
-    Vector3<T> operator +(const Vector3<T> &v) const;
+    constexpr Vector3<T> operator +(const Vector3<T> &v) const {
+        return Vector3<T>(x+v.x, y+v.y, z+v.z);
+    }
 
     // subtraction
-    Vector3<T> operator -(const Vector3<T> &v) const;
+    constexpr Vector3<T> operator -(const Vector3<T> &v) const {
+        return Vector3<T>(x-v.x, y-v.y, z-v.z);
+    }
 
     // uniform scaling
-    Vector3<T> operator *(const T num) const;
+    constexpr Vector3<T> operator *(const T num) const {
+        return Vector3<T>(x*num, y*num, z*num);
+    }
 
     // uniform scaling
-    Vector3<T> operator  /(const T num) const;
+    constexpr Vector3<T> operator  /(const T num) const {
+        return Vector3<T>(x/num, y/num, z/num);
+    }
 
     // addition
-    Vector3<T> &operator +=(const Vector3<T> &v);
+    Vector3<T> &operator +=(const Vector3<T> &v) {
+        x += v.x; y += v.y; z += v.z;
+        return *this;
+    }
 
     // subtraction
-    Vector3<T> &operator -=(const Vector3<T> &v);
+    Vector3<T> &operator -=(const Vector3<T> &v) {
+        x -= v.x; y -= v.y; z -= v.z;
+        return *this;
+    }
 
     // uniform scaling
-    Vector3<T> &operator *=(const T num);
+    Vector3<T> &operator *=(const T num) {
+        x *= num; y *= num; z *= num;
+        return *this;
+    }
 
     // uniform scaling
-    Vector3<T> &operator /=(const T num);
+    Vector3<T> &operator /=(const T num) {
+        x /= num; y /= num; z /= num;
+        return *this;
+    }
 
     // non-uniform scaling
     Vector3<T> &operator *=(const Vector3<T> &v) {
@@ -150,7 +172,9 @@ public:
     }
 
     // dot product
-    T operator *(const Vector3<T> &v) const;
+    constexpr T operator *(const Vector3<T> &v) const {
+        return x*v.x + y*v.y + z*v.z;
+    }
 
     // dot product for Lua
     T dot(const Vector3<T> &v) const {
@@ -164,7 +188,9 @@ public:
     Matrix3<T> mul_rowcol(const Vector3<T> &v) const;
 
     // cross product
-    Vector3<T> operator %(const Vector3<T> &v) const;
+    constexpr Vector3<T> operator %(const Vector3<T> &v) const {
+        return Vector3<T>(y*v.z - z*v.y, z*v.x - x*v.z, x*v.y - y*v.x);
+    }
 
     // cross product for Lua
     Vector3<T> cross(const Vector3<T> &v) const {
@@ -175,6 +201,36 @@ public:
     Vector3<T> scale(const T v) const {
         return *this * v;
     }
+
+    /*
+      fused helpers for common controller expressions. These evaluate
+      element-wise without building intermediate vectors
+     */
+
+    // return a*k + b
+    static constexpr Vector3<T> fma(const Vector3<T> &a, const T k, const Vector3<T> &b) {
+        return Vector3<T>(a.x*k + b.x, a.y*k + b.y, a.z*k + b.z);
+    }
+
+    // this += v*k
+    Vector3<T> &axpy(const T k, const Vector3<T> &v) {
+        x += v.x*k; y += v.y*k; z += v.z*k;
+        return *this;
+    }
+
+    // linear interpolation from a (t=0) to b (t=1)
+    static constexpr Vector3<T> lerp(const Vector3<T> &a, const Vector3<T> &b, const T t) {
+        return Vector3<T>(a.x + (b.x-a.x)*t, a.y + (b.y-a.y)*t, a.z + (b.z-a.z)*t);
+    }
+
+    // this += a % b, a or b may be this vector
+    Vector3<T> &cross_add(const Vector3<T> &a, const Vector3<T> &b) {
+        const T cx = a.y*b.z - a.z*b.y;
+        const T cy = a.z*b.x - a.x*b.z;
+        const T cz = a.x*b.y - a.y*b.x;
+        x += cx; y += cy; z += cz;
+        return *this;
+    }
     
     // computes the angle between this vector and another vector
     T angle(const Vector3<T> &v2) const;
@@ -216,6 +272,14 @@ public:
     // gets the length of this vector
     T length(void) const;
 
+    // as length(), in precision policy P (see precision.h)
+    template <typename P>
+    T length(void) const
+    {
+        typedef typename P::type F;
+        return P::sqrt(F(x)*F(x) + (F(y)*F(y) + F(z)*F(z)));
+    }
+
     // limit xy component vector to a given length. returns true if vector was limited
     bool limit_length_xy(T max_length);
 
@@ -225,6 +289,26 @@ public:
         *this /= length();
     }
 
+    // as normalize(), in precision policy P. Policies with an
+    // approximate inv_sqrt() multiply by it instead of dividing
+    template <typename P>
+    void normalize()
+    {
+        typedef typename P::type F;
+        const F length_sq = F(x)*F(x) + (F(y)*F(y) + F(z)*F(z));
+        if (P::approx_inv_sqrt) {
+            const F inv_length = P::inv_sqrt(length_sq);
+            x *= inv_length;
+            y *= inv_length;
+            z *= inv_length;
+        } else {
+            const F length = P::sqrt(length_sq);
+            x = T(F(x) / length);
+            y = T(F(y) / length);
+            z = T(F(z) / length);
+        }
+    }
+
     // zero the vector
     void zero()
     {
@@ -328,83 +412,6 @@ template<> inline bool Vector3<double>::is_zero(void) const {
     return ::is_zero(x) && ::is_zero(y) && ::is_zero(z);
 }
 
-// The creation of temporary vector objects as return types creates a significant overhead in certain hot 
-// code paths. This allows callers to select the inline versions where profiling shows a significant benefit
-#if defined(AP_INLINE_VECTOR_OPS) && !defined(HAL_DEBUG_BUILD)
-
-// vector cross product
-template <typename T>
-inline Vector3<T> Vector3<T>::operator %(const Vector3<T> &v) const
-{
-    return Vector3<T>(y*v.z - z*v.y, z*v.x - x*v.z, x*v.y - y*v.x);
-}
-
-// dot product
-template <typename T>
-inline T Vector3<T>::operator *(const Vector3<T> &v) const
-{
-    return x*v.x + y*v.y + z*v.z;
-}
-
-template <typename T>
-inline Vector3<T> &Vector3<T>::operator *=(const T num)
-{
-    x*=num; y*=num; z*=num;
-    return *this;
-}
-
-template <typename T>
-inline Vector3<T> &Vector3<T>::operator /=(const T num)
-{
-    x /= num; y /= num; z /= num;
-    return *this;
-}
-
-template <typename T>
-inline Vector3<T> &Vector3<T>::operator -=(const Vector3<T> &v)
-{
-    x -= v.x; y -= v.y; z -= v.z;
-    return *this;
-}
-
-template <typename T>
-inline Vector3<T> &Vector3<T>::operator +=(const Vector3<T> &v)
-{
-    x+=v.x; y+=v.y; z+=v.z;
-    return *this;
-}
-
-template <typename T>
-inline Vector3<T> Vector3<T>::operator /(const T num) const
-{
-    return Vector3<T>(x/num, y/num, z/num);
-}
-
-template <typename T>
-inline Vector3<T> Vector3<T>::operator *(const T num) const
-{
-    return Vector3<T>(x*num, y*num, z*num);
-}
-
-template <typename T>
-inline Vector3<T> Vector3<T>::operator -(const Vector3<T> &v) const
-{
-    return Vector3<T>(x-v.x, y-v.y, z-v.z);
-}
-
-template <typename T>
-inline Vector3<T> Vector3<T>::operator +(const Vector3<T> &v) const
-{
-    return Vector3<T>(x+v.x, y+v.y, z+v.z);
-}
-
-template <typename T>
-inline Vector3<T> Vector3<T>::operator -(void) const
-{
-    return Vector3<T>(-x,-y,-z);
-}
-#endif
-
 typedef Vector3<int16_t>                Vector3i;
 typedef Vector3<uint16_t>               Vector3ui;
 typedef Vector3<int32_t>                Vector3l;
@@ -0,0 +1,329 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma GCC optimize("O2")
+
+#include "vector3_batch.h"
+#include "thread_pool.h"
+
+// number of segments processed per tile in the many-vs-many queries
+#define VECTOR3_BATCH_TILE 128
+
+// point to segment distances per thread pool chunk in the many-vs-many queries
+#define VECTOR3_BATCH_CHUNK_WORK 65536
+
+template <typename T>
+void Vector3SoA<T>::pack(const Vector3<T> *v, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        x[i] = v[i].x;
+        y[i] = v[i].y;
+        z[i] = v[i].z;
+    }
+}
+
+template <typename T>
+void Vector3SoA<T>::unpack(Vector3<T> *v, uint32_t count) const
+{
+    for (uint32_t i = 0; i < count; i++) {
+        v[i].x = x[i];
+        v[i].y = y[i];
+        v[i].z = z[i];
+    }
+}
+
+// branch free versions of ::is_zero() for a squared length
+static inline bool is_zero_sq(float v2)
+{
+    return v2 <= 1.0e-12f;
+}
+
+static inline bool is_zero_sq(double v2)
+{
+    return v2 <= 1.0e-24;
+}
+
+template <typename T>
+static inline T clamp01(T v)
+{
+    return v < 0 ? T(0) : (v > 1 ? T(1) : v);
+}
+
+/*
+  n / d, or zero if zero is true. The division is done for every lane
+  so the select doesn't become a branch
+ */
+template <typename T>
+static inline T div_or_zero(T n, T d, bool zero)
+{
+    const T q = n / (zero ? T(1) : d);
+    return zero ? T(0) : q;
+}
+
+template <typename T>
+void distance_to_segment(const Vector3<T> &point, const Segment3SoA<T> &seg,
+                         T *dist, uint32_t count)
+{
+    // |(p - s) x (e - s)| / |e - s| rather than the triangle area,
+    // avoiding three square roots per segment
+    for (uint32_t i = 0; i < count; i++) {
+        const T lx = seg.end.x[i] - seg.start.x[i];
+        const T ly = seg.end.y[i] - seg.start.y[i];
+        const T lz = seg.end.z[i] - seg.start.z[i];
+        const T vx = point.x - seg.start.x[i];
+        const T vy = point.y - seg.start.y[i];
+        const T vz = point.z - seg.start.z[i];
+        const T cx = vy*lz - vz*ly;
+        const T cy = vz*lx - vx*lz;
+        const T cz = vx*ly - vy*lx;
+        const T len2 = lx*lx + ly*ly + lz*lz;
+        dist[i] = std::sqrt(div_or_zero(cx*cx + cy*cy + cz*cz, len2, is_zero_sq(len2)));
+    }
+}
+
+/*
+  squared distance from p to segment i and the position of the closest
+  point along it
+ */
+template <typename T>
+static inline T point_segment_dist_sq(const Segment3SoA<T> &seg, uint32_t i,
+                                      const T px, const T py, const T pz, T &t)
+{
+    const T lx = seg.end.x[i] - seg.start.x[i];
+    const T ly = seg.end.y[i] - seg.start.y[i];
+    const T lz = seg.end.z[i] - seg.start.z[i];
+    const T vx = px - seg.start.x[i];
+    const T vy = py - seg.start.y[i];
+    const T vz = pz - seg.start.z[i];
+    const T len2 = lx*lx + ly*ly + lz*lz;
+    t = clamp01(div_or_zero(lx*vx + ly*vy + lz*vz, len2, is_zero_sq(len2)));
+    const T dx = lx*t - vx;
+    const T dy = ly*t - vy;
+    const T dz = lz*t - vz;
+    return dx*dx + dy*dy + dz*dz;
+}
+
+template <typename T>
+void closest_distance_between_line_and_point(const Segment3SoA<T> &seg, const Vector3<T> &point,
+                                             T *dist, uint32_t count,
+                                             const Vector3SoA<T> &closest)
+{
+    // copy the point so the stores can't alias it
+    const T px = point.x;
+    const T py = point.y;
+    const T pz = point.z;
+    if (closest.x == nullptr) {
+        for (uint32_t i = 0; i < count; i++) {
+            T t;
+            dist[i] = std::sqrt(point_segment_dist_sq(seg, i, px, py, pz, t));
+        }
+        return;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        T t;
+        dist[i] = std::sqrt(point_segment_dist_sq(seg, i, px, py, pz, t));
+        closest.x[i] = seg.start.x[i] + (seg.end.x[i] - seg.start.x[i]) * t;
+        closest.y[i] = seg.start.y[i] + (seg.end.y[i] - seg.start.y[i]) * t;
+        closest.z[i] = seg.start.z[i] + (seg.end.z[i] - seg.start.z[i]) * t;
+    }
+}
+
+/*
+  the edge cases of Vector3::segment_to_segment_closest_point() written
+  as selects so each lane can take a different case
+ */
+template <typename T>
+void segment_to_segment_closest_point(const Vector3<T> &seg1_start, const Vector3<T> &seg1_end,
+                                      const Segment3SoA<T> &seg2, const Vector3SoA<T> &closest,
+                                      uint32_t count, T *dist)
+{
+    const Vector3<T> line1 = seg1_end - seg1_start;
+    const T a = line1 * line1;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const T l2x = seg2.end.x[i] - seg2.start.x[i];
+        const T l2y = seg2.end.y[i] - seg2.start.y[i];
+        const T l2z = seg2.end.z[i] - seg2.start.z[i];
+        const T dx = seg1_start.x - seg2.start.x[i];
+        const T dy = seg1_start.y - seg2.start.y[i];
+        const T dz = seg1_start.z - seg2.start.z[i];
+
+        const T b = line1.x*l2x + line1.y*l2y + line1.z*l2z;
+        const T c = l2x*l2x + l2y*l2y + l2z*l2z;
+        const T d = line1.x*dx + line1.y*dy + line1.z*dz;
+        const T e = l2x*dx + l2y*dy + l2z*dz;
+        const T discriminant = a*c - b*b;
+
+        // closest points on the infinite lines, or s = 0 when parallel
+        const bool parallel = discriminant < FLT_EPSILON;
+        T sN = parallel ? T(0) : b*e - c*d;
+        T sD = parallel ? T(1) : discriminant;
+        T tN = parallel ? e : a*e - b*d;
+        T tD = parallel ? c : discriminant;
+
+        // s = 0 or s = 1 edge visible
+        const bool s_lo = !parallel && sN < 0;
+        const bool s_hi = !parallel && !s_lo && sN > sD;
+        tN = s_lo ? e : (s_hi ? e + b : tN);
+        tD = (s_lo || s_hi) ? c : tD;
+        sN = s_lo ? T(0) : (s_hi ? sD : sN);
+
+        // t = 0 or t = 1 edge visible, recompute s for that edge
+        const bool t_lo = tN < 0;
+        const bool t_hi = !t_lo && tN > tD;
+        const T s_edge = t_lo ? -d : -d + b;
+        const bool t_edge = t_lo || t_hi;
+        tN = t_lo ? T(0) : (t_hi ? tD : tN);
+        const T sN_edge = s_edge < 0 ? T(0) : (s_edge > a ? sD : s_edge);
+        const T sD_edge = (s_edge < 0 || s_edge > a) ? sD : a;
+        sN = t_edge ? sN_edge : sN;
+        sD = t_edge ? sD_edge : sD;
+
+        const T tc = div_or_zero(tN, tD, ::is_zero(tN));
+        const T px = seg2.start.x[i] + l2x*tc;
+        const T py = seg2.start.y[i] + l2y*tc;
+        const T pz = seg2.start.z[i] + l2z*tc;
+        closest.x[i] = px;
+        closest.y[i] = py;
+        closest.z[i] = pz;
+        if (dist != nullptr) {
+            // a zero length seg2 leaves s at 0 above, project it onto seg1 instead
+            const T s_point = clamp01(div_or_zero(-d, a, ::is_zero(a)));
+            const T sc = ::is_zero(c) ? s_point : div_or_zero(sN, sD, ::is_zero(sN));
+            const T ex = seg1_start.x + line1.x*sc - px;
+            const T ey = seg1_start.y + line1.y*sc - py;
+            const T ez = seg1_start.z + line1.z*sc - pz;
+            dist[i] = std::sqrt(ex*ex + ey*ey + ez*ez);
+        }
+    }
+}
+
+template <typename T>
+void segment_plane_intersect(const Segment3SoA<T> &seg, const Vector3<T> &plane_normal,
+                             const Vector3<T> &plane_point, bool *hit, uint32_t count)
+{
+    const T n_p = plane_normal * plane_point;
+    for (uint32_t i = 0; i < count; i++) {
+        const T ux = seg.end.x[i] - seg.start.x[i];
+        const T uy = seg.end.y[i] - seg.start.y[i];
+        const T uz = seg.end.z[i] - seg.start.z[i];
+        const T D = plane_normal.x*ux + plane_normal.y*uy + plane_normal.z*uz;
+        const T N = n_p - (plane_normal.x*seg.start.x[i] + plane_normal.y*seg.start.y[i] + plane_normal.z*seg.start.z[i]);
+        // N/D in [0,1], without the division
+        const bool crosses = D > 0 ? ((N >= 0) & (N <= D)) : ((N <= 0) & (N >= D));
+        hit[i] = ::is_zero(D) ? ::is_zero(N) : crosses;
+    }
+}
+
+template <typename T>
+static void points_segments_distance_range(const Vector3SoA<T> &points, uint32_t num_points,
+                                           const Segment3SoA<T> &seg, uint32_t num_segments,
+                                           T *dist)
+{
+    for (uint32_t s0 = 0; s0 < num_segments; s0 += VECTOR3_BATCH_TILE) {
+        const uint32_t n = MIN(uint32_t(VECTOR3_BATCH_TILE), num_segments - s0);
+        const Segment3SoA<T> tile = seg.offset(s0);
+        for (uint32_t p = 0; p < num_points; p++) {
+            const T px = points.x[p];
+            const T py = points.y[p];
+            const T pz = points.z[p];
+            T *row = &dist[size_t(p) * num_segments + s0];
+            for (uint32_t i = 0; i < n; i++) {
+                T t;
+                row[i] = std::sqrt(point_segment_dist_sq(tile, i, px, py, pz, t));
+            }
+        }
+    }
+}
+
+template <typename T>
+static void points_segments_nearest_range(const Vector3SoA<T> &points, uint32_t num_points,
+                                          const Segment3SoA<T> &seg, uint32_t num_segments,
+                                          T *min_dist, uint32_t *index)
+{
+    // keep the squared distance until the end
+    for (uint32_t p = 0; p < num_points; p++) {
+        min_dist[p] = std::numeric_limits<T>::max();
+        index[p] = 0;
+    }
+    T dist_sq[VECTOR3_BATCH_TILE];
+    for (uint32_t s0 = 0; s0 < num_segments; s0 += VECTOR3_BATCH_TILE) {
+        const uint32_t n = MIN(uint32_t(VECTOR3_BATCH_TILE), num_segments - s0);
+        const Segment3SoA<T> tile = seg.offset(s0);
+        for (uint32_t p = 0; p < num_points; p++) {
+            const T px = points.x[p];
+            const T py = points.y[p];
+            const T pz = points.z[p];
+            for (uint32_t i = 0; i < n; i++) {
+                T t;
+                dist_sq[i] = point_segment_dist_sq(tile, i, px, py, pz, t);
+            }
+            T best = min_dist[p];
+            uint32_t best_index = index[p];
+            for (uint32_t i = 0; i < n; i++) {
+                if (dist_sq[i] < best) {
+                    best = dist_sq[i];
+                    best_index = s0 + i;
+                }
+            }
+            min_dist[p] = best;
+            index[p] = best_index;
+        }
+    }
+    if (num_segments > 0) {
+        for (uint32_t p = 0; p < num_points; p++) {
+            min_dist[p] = std::sqrt(min_dist[p]);
+        }
+    }
+}
+
+// points per thread pool chunk for the many-vs-many queries
+static uint32_t points_per_chunk(uint32_t num_segments)
+{
+    return MAX(uint32_t(VECTOR3_BATCH_CHUNK_WORK) / MAX(num_segments, 1U), 1U);
+}
+
+// the points are split across the shared thread pool
+template <typename T>
+void points_segments_distance(const Vector3SoA<T> &points, uint32_t num_points,
+                              const Segment3SoA<T> &seg, uint32_t num_segments,
+                              T *dist)
+{
+    MathThreadPool::get_shared().parallel_for(0, num_points, points_per_chunk(num_segments), [&](uint32_t start, uint32_t end) {
+        points_segments_distance_range(points.offset(start), end - start, seg, num_segments, &dist[size_t(start) * num_segments]);
+    });
+}
+
+template <typename T>
+void points_segments_nearest(const Vector3SoA<T> &points, uint32_t num_points,
+                             const Segment3SoA<T> &seg, uint32_t num_segments,
+                             T *min_dist, uint32_t *index)
+{
+    MathThreadPool::get_shared().parallel_for(0, num_points, points_per_chunk(num_segments), [&](uint32_t start, uint32_t end) {
+        points_segments_nearest_range(points.offset(start), end - start, seg, num_segments, &min_dist[start], &index[start]);
+    });
+}
+
+#define VECTOR3_BATCH_INSTANTIATE(T) \
+    template struct Vector3SoA<T>; \
+    template void distance_to_segment<T>(const Vector3<T> &, const Segment3SoA<T> &, T *, uint32_t); \
+    template void closest_distance_between_line_and_point<T>(const Segment3SoA<T> &, const Vector3<T> &, T *, uint32_t, const Vector3SoA<T> &); \
+    template void segment_to_segment_closest_point<T>(const Vector3<T> &, const Vector3<T> &, const Segment3SoA<T> &, const Vector3SoA<T> &, uint32_t, T *); \
+    template void segment_plane_intersect<T>(const Segment3SoA<T> &, const Vector3<T> &, const Vector3<T> &, bool *, uint32_t); \
+    template void points_segments_distance<T>(const Vector3SoA<T> &, uint32_t, const Segment3SoA<T> &, uint32_t, T *); \
+    template void points_segments_nearest<T>(const Vector3SoA<T> &, uint32_t, const Segment3SoA<T> &, uint32_t, T *, uint32_t *);
+
+VECTOR3_BATCH_INSTANTIATE(float)
+VECTOR3_BATCH_INSTANTIATE(double)
@@ -0,0 +1,137 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  batch versions of the Vector3 point/segment/plane queries
+
+  Each function evaluates one point or segment against count segments
+  stored as structure of arrays, writing one result per segment. The
+  results match the scalar Vector3 functions of the same name to
+  within rounding.
+
+  The loops are branch free so the compiler can vectorise them. With
+  gcc that needs the vectoriser enabled beyond -O2's cheap cost model,
+  and -fno-math-errno -fno-trapping-math so the square roots and the
+  masked divisions don't become branches.
+
+  The points_segments_*() functions evaluate many points against many
+  segments. The segments are processed in tiles so each tile stays in
+  cache while every point is tested against it. The points are split
+  across the shared thread pool (see thread_pool.h), and as the results
+  for different points are independent they don't depend on the number
+  of threads.
+ */
+#pragma once
+
+#include "Embed_Math.h"
+
+/*
+  non-owning structure of arrays view of Vector3 values
+ */
+template <typename T>
+struct Vector3SoA {
+    T *x;
+    T *y;
+    T *z;
+
+    constexpr Vector3SoA() : x(nullptr), y(nullptr), z(nullptr) {}
+    constexpr Vector3SoA(T *x0, T *y0, T *z0) : x(x0), y(y0), z(z0) {}
+
+    Vector3<T> get(uint32_t i) const {
+        return Vector3<T>(x[i], y[i], z[i]);
+    }
+    void set(uint32_t i, const Vector3<T> &v) {
+        x[i] = v.x;
+        y[i] = v.y;
+        z[i] = v.z;
+    }
+
+    // view starting at element i
+    Vector3SoA<T> offset(uint32_t i) const {
+        return Vector3SoA<T>(x + i, y + i, z + i);
+    }
+
+    // copy from/to an array of Vector3
+    void pack(const Vector3<T> *v, uint32_t count);
+    void unpack(Vector3<T> *v, uint32_t count) const;
+};
+
+/*
+  segments from start[i] to end[i]
+ */
+template <typename T>
+struct Segment3SoA {
+    Vector3SoA<T> start;
+    Vector3SoA<T> end;
+
+    Segment3SoA<T> offset(uint32_t i) const {
+        return Segment3SoA<T>{start.offset(i), end.offset(i)};
+    }
+};
+
+/*
+  distance from point to the line through each segment, as
+  Vector3::distance_to_segment(). Zero for zero length segments
+ */
+template <typename T>
+void distance_to_segment(const Vector3<T> &point, const Segment3SoA<T> &seg,
+                         T *dist, uint32_t count);
+
+/*
+  distance from point to the closest point on each segment, as
+  Vector3::closest_distance_between_line_and_point(). The closest
+  points are written to closest unless its x pointer is null
+ */
+template <typename T>
+void closest_distance_between_line_and_point(const Segment3SoA<T> &seg, const Vector3<T> &point,
+                                             T *dist, uint32_t count,
+                                             const Vector3SoA<T> &closest = Vector3SoA<T>());
+
+/*
+  closest point on each of seg2 to seg1, as
+  Vector3::segment_to_segment_closest_point(). If dist is not null
+  the distance between the closest points of the two segments is also
+  returned
+ */
+template <typename T>
+void segment_to_segment_closest_point(const Vector3<T> &seg1_start, const Vector3<T> &seg1_end,
+                                      const Segment3SoA<T> &seg2, const Vector3SoA<T> &closest,
+                                      uint32_t count, T *dist = nullptr);
+
+/*
+  true for each segment that passes through the plane defined by its
+  normal and a point on it, as Vector3::segment_plane_intersect()
+ */
+template <typename T>
+void segment_plane_intersect(const Segment3SoA<T> &seg, const Vector3<T> &plane_normal,
+                             const Vector3<T> &plane_point, bool *hit, uint32_t count);
+
+/*
+  distance from each of num_points points to each of num_segments
+  segments. dist is num_points rows of num_segments values
+ */
+template <typename T>
+void points_segments_distance(const Vector3SoA<T> &points, uint32_t num_points,
+                              const Segment3SoA<T> &seg, uint32_t num_segments,
+                              T *dist);
+
+/*
+  distance from each point to the nearest segment and its index. Points
+  with no segments get a distance of FLT_MAX/DBL_MAX and index 0
+ */
+template <typename T>
+void points_segments_nearest(const Vector3SoA<T> &points, uint32_t num_points,
+                             const Segment3SoA<T> &seg, uint32_t num_segments,
+                             T *min_dist, uint32_t *index);